@@ -53,6 +53,7 @@ HEADERS += remoteutil.h
 HEADERS += rssmanager.h
 HEADERS += rssparse.h
 HEADERS += unziputil.h
+HEADERS += seekindexfile.h
 HEADERS += sizetliteral.h
 HEADERS += qtuplift.h
 
@@ -89,6 +90,7 @@ SOURCES += programtypes.cpp
 SOURCES += recordingstatus.cpp
 SOURCES += recordingtypes.cpp
 SOURCES += remoteutil.cpp
+SOURCES += seekindexfile.cpp
 SOURCES += rssmanager.cpp
 SOURCES += rssparse.cpp
 SOURCES += unziputil.cpp
@@ -208,6 +210,7 @@ inc.files += programtypeflags.h
 inc.files += recordingstatus.h
 inc.files += recordingtypes.h
 inc.files += remoteutil.h
+inc.files += seekindexfile.h
 inc.files += rssmanager.h
 inc.files += rssparse.h
 inc.files += stringutil.h
@@ -240,6 +243,8 @@ macx {
 }
 
 linux {
+    SOURCES += mythsocketreactor.cpp
+    HEADERS += mythsocketreactor.h
     !android {
     SOURCES += mythcdrom-linux.cpp
     HEADERS += mythcdrom-linux.h
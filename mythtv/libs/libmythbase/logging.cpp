@@ -4,13 +4,14 @@
 #include <QMutexLocker>
 #include <QWaitCondition>
 #include <QList>
-#include <QQueue>
 #include <QHash>
 #include <QFileInfo>
 #include <QStringList>
 #include <QMap>
 #include <QRegularExpression>
 #include <QVariantMap>
+#include <array>
+#include <atomic>
 #include <iostream>
 
 #include "mythlogging.h"
@@ -58,8 +59,147 @@ extern "C" {
 #include <android/log.h>
 #endif
 
+/// \brief Unbounded lock free queue of LoggingItems, with many producers and
+///        a single consumer.  This is Dmitry Vyukov's intrusive MPSC queue,
+///        so LOG() never blocks or allocates to queue an item.  Only the
+///        LoggerThread dequeues, or whoever holds logQueueMutex once that
+///        thread has finished.
+class LoggingQueue
+{
+  public:
+    void enqueue(LoggingItem *item)
+    {
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        push(item);
+    }
+
+    LoggingItem *dequeue(void);
+
+    bool isEmpty(void) const
+    {
+        return m_count.load(std::memory_order_acquire) == 0;
+    }
+
+  private:
+    void push(LogQueueLink *link)
+    {
+        link->m_next.store(nullptr, std::memory_order_relaxed);
+        LogQueueLink *prev = m_head.exchange(link, std::memory_order_acq_rel);
+        prev->m_next.store(link, std::memory_order_release);
+    }
+
+    LogQueueLink                 m_stub;
+    std::atomic<LogQueueLink *>  m_head  {&m_stub}; ///< last item pushed
+    LogQueueLink                *m_tail  {&m_stub}; ///< next item to dequeue
+    std::atomic<int>             m_count {0};
+};
+
+/// \brief Take the oldest item off the queue
+/// \return The item, or nullptr if the queue is empty or the next item is
+///         still being linked in by its producer
+LoggingItem *LoggingQueue::dequeue(void)
+{
+    LogQueueLink *tail = m_tail;
+    LogQueueLink *next = tail->m_next.load(std::memory_order_acquire);
+
+    if (tail == &m_stub)
+    {
+        if (next == nullptr)
+            return nullptr;
+        m_tail = next;
+        tail = next;
+        next = next->m_next.load(std::memory_order_acquire);
+    }
+
+    if (next == nullptr)
+    {
+        // This is the last item, put the stub back behind it so that it
+        // can be unlinked.
+        if (tail != m_head.load(std::memory_order_acquire))
+            return nullptr;
+        push(&m_stub);
+        next = tail->m_next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return nullptr;
+    }
+
+    m_tail = next;
+    m_count.fetch_sub(1, std::memory_order_release);
+    return static_cast<LoggingItem *>(tail);
+}
+
+/// \brief Fixed pool of reusable LoggingItems, so that LOG() does not have to
+///        allocate one per message.  The free slots are kept on a lock free
+///        stack of slot indexes, which carries a generation count to guard
+///        against ABA.  Slots are only given an item the first time they are
+///        needed.
+class LoggingItemPool
+{
+  public:
+    LoggingItem *acquire(void);
+    bool release(LoggingItem *item);
+
+  private:
+    static constexpr uint32_t kPoolSize { 1024 };
+    static constexpr uint32_t kNoSlot   { UINT32_MAX };
+
+    static uint64_t makeHead(uint64_t old, uint32_t slot)
+        { return (((old >> 32) + 1) << 32) | slot; }
+
+    std::array<LoggingItem *, kPoolSize>        m_items {};
+    std::array<std::atomic<uint32_t>, kPoolSize> m_next {};
+    std::atomic<uint64_t>                       m_free  { kNoSlot };
+    std::atomic<uint32_t>                       m_used  { 0 };
+};
+
+/// \brief Get a free item from the pool
+/// \return The item, or nullptr if every slot in the pool is in use
+LoggingItem *LoggingItemPool::acquire(void)
+{
+    uint64_t head = m_free.load(std::memory_order_acquire);
+    while (static_cast<uint32_t>(head) != kNoSlot)
+    {
+        auto slot = static_cast<uint32_t>(head);
+        uint64_t next = makeHead(head, m_next[slot].load(std::memory_order_relaxed));
+        if (m_free.compare_exchange_weak(head, next, std::memory_order_acquire,
+                                         std::memory_order_acquire))
+            return m_items[slot];
+    }
+
+    if (m_used.load(std::memory_order_relaxed) >= kPoolSize)
+        return nullptr;
+    uint32_t slot = m_used.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= kPoolSize)
+        return nullptr;
+
+    auto *item = new LoggingItem();
+    item->m_poolSlot = static_cast<int>(slot);
+    m_items[slot] = item;
+    return item;
+}
+
+/// \brief Put an item that is no longer referenced back into the pool
+/// \return false if the item did not come from the pool
+bool LoggingItemPool::release(LoggingItem *item)
+{
+    if (item->m_poolSlot < 0)
+        return false;
+
+    auto slot = static_cast<uint32_t>(item->m_poolSlot);
+    uint64_t head = m_free.load(std::memory_order_relaxed);
+    uint64_t next = 0;
+    do
+    {
+        m_next[slot].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = makeHead(head, slot);
+    } while (!m_free.compare_exchange_weak(head, next, std::memory_order_release,
+                                           std::memory_order_relaxed));
+    return true;
+}
+
 static QMutex                  logQueueMutex;
-static QQueue<LoggingItem *>   logQueue;
+static LoggingQueue            logQueue;
+static LoggingItemPool         logItemPool;
 
 static LoggerThread           *logThread = nullptr;
 static QMutex                  logThreadMutex;
@@ -119,17 +259,29 @@ void resetLogging(void)
     verboseInit();
 }
 
-LoggingItem::LoggingItem(const char *_file, const char *_function,
-                         int _line, LogLevel_t _level, LoggingType _type) :
-        ReferenceCounter("LoggingItem", false),
-        m_threadId((uint64_t)(QThread::currentThreadId())),
-        m_line(_line), m_type(_type), m_level(_level),
-        m_function(_function)
+/// \brief Drop a reference to the item.  The last one returns the item to
+///        logItemPool instead of deleting it.
+/// \return last reference count, 0 if released
+int LoggingItem::DecrRef(void)
 {
-    const char *slash = std::strrchr(_file, '/');
-    m_file = (slash != nullptr) ? slash+1 : _file;
-    m_epoch = nowAsDuration<std::chrono::microseconds>();
-    setThreadTid();
+    int val = m_referenceCount.fetchAndAddOrdered(-1) - 1;
+    if (val != 0)
+        return val;
+
+    if (m_poolSlot < 0)
+    {
+        delete this;
+        return val;
+    }
+
+    m_file.clear();
+    m_function.clear();
+    m_threadName.clear();
+    m_appName.clear();
+    m_logFile.clear();
+    m_message.clear();
+    logItemPool.release(this);
+    return val;
 }
 
 /// \brief Get the name of the thread that produced the LoggingItem
@@ -159,12 +311,20 @@ int64_t LoggingItem::getThreadTid(void)
 
 /// \brief Set the thread ID of the thread that produced the LoggingItem.  This
 ///        code is actually run in the thread in question as part of the call
-///        to LOG()
+///        to LOG(), so the ID is only looked up on the first call from each
+///        thread.
 /// \note  In different platforms, the actual value returned here will vary.
 ///        The intention is to get a thread ID that will map well to what is
 ///        shown in gdb.
 void LoggingItem::setThreadTid(void)
 {
+    static thread_local int64_t t_tid = -1;
+    if (t_tid != -1)
+    {
+        m_tid = t_tid;
+        return;
+    }
+
     QMutexLocker locker(&logThreadTidMutex);
 
     m_tid = logThreadTidHash.value(m_threadId, -1);
@@ -185,6 +345,7 @@ void LoggingItem::setThreadTid(void)
 #endif
         logThreadTidHash[m_threadId] = m_tid;
     }
+    t_tid = m_tid;
 }
 
 /// \brief Convert numerical timestamp to a readable date and time.
@@ -263,35 +424,31 @@ void LoggerThread::run(void)
 
     bool dieNow = false;
 
-    QMutexLocker qLock(&logQueueMutex);
-
-    while (!m_aborted || !logQueue.isEmpty())
+    while (true)
     {
-        qLock.unlock();
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(nullptr, QEvent::DeferredDelete);
 
-        qLock.relock();
-        if (logQueue.isEmpty())
+        LoggingItem *item = logQueue.dequeue();
+        if (item == nullptr)
         {
-            m_waitEmpty->wakeAll();
-            m_waitNotEmpty->wait(qLock.mutex(), 100);
+            QMutexLocker qLock(&logQueueMutex);
+            if (logQueue.isEmpty())
+            {
+                if (m_aborted)
+                    break;
+                m_waitEmpty->wakeAll();
+                m_waitNotEmpty->wait(qLock.mutex(), 100);
+            }
             continue;
         }
 
-        LoggingItem *item = logQueue.dequeue();
-        qLock.unlock();
-
         fillItem(item);
         handleItem(item);
         logConsole(item);
         item->DecrRef();
-
-        qLock.relock();
     }
 
-    qLock.unlock();
-
     // This must be before the timer stop below or we deadlock when the timer
     // thread tries to deregister, and we wait for it.
     logThreadFinished = true;
@@ -492,6 +649,10 @@ void LoggerThread::fillItem(LoggingItem *item)
     if (!item)
         return;
 
+    const char *slash = std::strrchr(item->m_rawFile, '/');
+    item->m_file = (slash != nullptr) ? slash+1 : item->m_rawFile;
+    item->m_function = item->m_rawFunction;
+
     item->setPid(m_pid);
     item->setThreadName(item->getThreadName());
     item->setAppName(m_appname);
@@ -500,7 +661,9 @@ void LoggerThread::fillItem(LoggingItem *item)
 }
 
 
-/// \brief  Create a new LoggingItem
+/// \brief  Create a new LoggingItem, reusing one from logItemPool if possible.
+///         Only what has to be captured in the calling thread is filled in
+///         here, the strings are left to LoggerThread::fillItem().
 /// \param  _file   filename of the source file where the log message is from
 /// \param  _function source function where the log message is from
 /// \param  _line   line number in the source where the log message is from
@@ -512,7 +675,21 @@ LoggingItem *LoggingItem::create(const char *_file,
                                  int _line, LogLevel_t _level,
                                  LoggingType _type)
 {
-    auto *item = new LoggingItem(_file, _function, _line, _level, _type);
+    LoggingItem *item = logItemPool.acquire();
+    if (item == nullptr)
+        item = new LoggingItem();
+    item->m_referenceCount.fetchAndStoreRelaxed(1);
+
+    item->m_pid      = -1;
+    item->m_threadId = (uint64_t)(QThread::currentThreadId());
+    item->m_line     = _line;
+    item->m_type     = _type;
+    item->m_level    = _level;
+    item->m_facility = 0;
+    item->m_rawFile  = _file;
+    item->m_rawFunction = _function;
+    item->m_epoch    = nowAsDuration<std::chrono::microseconds>();
+    item->setThreadTid();
 
     return item;
 }
@@ -538,8 +715,6 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
 
     item->m_message = std::move(message);
 
-    QMutexLocker qLock(&logQueueMutex);
-
 #if defined( _MSC_VER ) && defined( _DEBUG )
         OutputDebugStringA( qPrintable(item->m_message) );
         OutputDebugStringA( "\n" );
@@ -549,10 +724,11 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
 
     if (logThread && logThreadFinished && !logThread->isRunning())
     {
-        while (!logQueue.isEmpty())
+        QMutexLocker qLock(&logQueueMutex);
+        while ((item = logQueue.dequeue()) != nullptr)
         {
-            item = logQueue.dequeue();
             qLock.unlock();
+            logThread->fillItem(item);
             logThread->handleItem(item);
             logThread->logConsole(item);
             item->DecrRef();
@@ -561,6 +737,7 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
     }
     else if (logThread && !logThreadFinished && (type & kFlush))
     {
+        QMutexLocker qLock(&logQueueMutex);
         logThread->flush();
     }
 }
@@ -686,8 +863,6 @@ void loggingRegisterThread(const QString &name)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
                                             __LINE__, LOG_DEBUG,
                                             kRegistering);
@@ -705,8 +880,6 @@ void loggingDeregisterThread(void)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__, __LINE__,
                                             LOG_DEBUG,
                                             kDeregistering);
@@ -7,6 +7,7 @@
 #include <QPointer>
 #include <QCoreApplication>
 
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 
@@ -48,9 +49,16 @@ class LoggerThread;
 
 using tmType = struct tm;
 
+/// \brief Link that chains LoggingItems together on the lock free logging
+///        queue.
+struct LogQueueLink
+{
+    std::atomic<LogQueueLink *> m_next {nullptr};
+};
+
 /// \brief The logging items that are generated by LOG() and are sent to the
 ///        console
-class LoggingItem: public QObject, public ReferenceCounter
+class LoggingItem: public QObject, public ReferenceCounter, public LogQueueLink
 {
     Q_OBJECT
 
@@ -70,6 +78,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     Q_PROPERTY(QString message READ message WRITE setMessage)
 
     friend class LoggerThread;
+    friend class LoggingItemPool;
     friend MBASE_PUBLIC void LogPrintLine(uint64_t mask, LogLevel_t level, const char *file, int line,
                              const char *function, QString message);
 
@@ -79,6 +88,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     void setThreadTid(void);
     static LoggingItem *create(const char *_file, const char *_function, int _line, LogLevel_t _level,
                                LoggingType _type);
+    int DecrRef(void) override; // ReferenceCounter
     QString getTimestamp(const char *format = "yyyy-MM-dd HH:mm:ss") const;
     QString getTimestampUs(const char *format = "yyyy-MM-dd HH:mm:ss") const;
     char getLevelChar(void);
@@ -130,13 +140,17 @@ class LoggingItem: public QObject, public ReferenceCounter
     QString             m_appName    {};
     QString             m_logFile    {};
     QString             m_message    {};
+    /// __FILE__ and __FUNCTION__ of the LOG() call, only converted to
+    /// m_file and m_function by the LoggerThread.
+    const char         *m_rawFile     {nullptr};
+    const char         *m_rawFunction {nullptr};
 
   private:
     LoggingItem()
         : ReferenceCounter("LoggingItem", false) {};
-    LoggingItem(const char *_file, const char *_function,
-                int _line, LogLevel_t _level, LoggingType _type);
     Q_DISABLE_COPY(LoggingItem);
+
+    int                 m_poolSlot   {-1}; ///< -1 if not from the item pool
 };
 
 /// \brief The logging thread that consumes the logging queue and dispatches
@@ -24,17 +24,23 @@ extern MBASE_PUBLIC QStringList logPropagateArgList;
 extern MBASE_PUBLIC QString     logPropagateArgs;
 extern MBASE_PUBLIC QString     verboseString;
 
-// Helper for checking verbose mask & level outside of LOG macro
+// Helper for checking verbose mask & level outside of LOG macro.
+// This runs for every LOG() call, before its message is built, so it
+// only looks in componentLogLevel when there are component levels set.
 static inline bool VERBOSE_LEVEL_NONE() { return verboseMask == 0; };
 static inline bool VERBOSE_LEVEL_CHECK(uint64_t mask, LogLevel_t level)
 {
-    if (componentLogLevel.contains(mask))
-        return *(componentLogLevel.find(mask)) >= level;
+    if (!componentLogLevel.isEmpty())
+    {
+        auto it = componentLogLevel.constFind(mask);
+        if (it != componentLogLevel.constEnd())
+            return *it >= level;
+    }
     return (((verboseMask & mask) == mask) && (logLevel >= level));
 }
 
-// This doesn't lock the calling thread other than momentarily to put
-// the log message onto a queue.
+// This doesn't lock the calling thread, the log message is put onto a
+// lock free queue and formatted by the logging thread.
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
 #define LOG(_MASK_, _LEVEL_, _QSTRING_)                                 \
     do {                                                                \
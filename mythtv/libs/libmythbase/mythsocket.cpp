@@ -17,8 +17,17 @@
 #else
 #include <sys/socket.h>
 #endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#endif
 #include <unistd.h> // for usleep (and socket code on Q_OS_WIN)
 #include <algorithm> // for max
+#include <cstring> // for memcpy
+#include <utility> // for swap
 #include <vector> // for vector
 
 // MythTV
@@ -29,8 +38,13 @@
 #include "mythlogging.h"
 #include "mythcorecontext.h"
 #include "portchecker.h"
+#ifdef __linux__
+#include "mythsocketreactor.h"
+#endif
 
 const int MythSocket::kSocketReceiveBufferSize = 128 * 1024;
+/// A reactor stops reading a socket with this much unread data buffered
+const int MythSocket::kReactorMaxBuffer = 4 * 1024 * 1024;
 
 QMutex MythSocket::s_loopbackCacheLock;
 QHash<QString, QHostAddress::SpecialAddress> MythSocket::s_loopbackCache;
@@ -68,16 +82,65 @@ static QString to_sample(const QByteArray &payload)
     return sample;
 }
 
+#ifdef __linux__
+/// Sends size bytes of the file from offset on with sendfile(), waiting
+/// for the non-blocking socket to drain as needed. Returns the number of
+/// bytes sent, which is less than size at the end of the file, or -1.
+static int sendfile_all(int sock, int fd, long long offset, int size,
+                        const QString &loc)
+{
+    int tot = 0;
+    auto off = static_cast<off_t>(offset);
+    while (tot < size)
+    {
+        ssize_t sent = sendfile(sock, fd, &off, static_cast<size_t>(size - tot));
+        if (sent > 0)
+        {
+            tot += static_cast<int>(sent);
+            continue;
+        }
+        if (sent == 0)
+            break; // end of file
+
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            LOG(VB_GENERAL, LOG_ERR, loc + "SendFile(): sendfile failed" + ENO);
+            return -1;
+        }
+
+        // The socket is non-blocking, wait for the peer to catch up.
+        struct pollfd pfd {sock, POLLOUT, 0};
+        if (poll(&pfd, 1, static_cast<int>(MythSocket::kLongTimeout.count())) <= 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, loc + "SendFile(): Timed out writing");
+            return -1;
+        }
+    }
+    return tot;
+}
+#endif
+
 MythSocket::MythSocket(
     qintptr socket, MythSocketCBs *cb, bool use_shared_thread) :
     ReferenceCounter(QString("MythSocket(%1)").arg(socket)),
-    m_tcpSocket(new QTcpSocket()),
     m_callback(cb),
     m_useSharedThread(use_shared_thread)
 {
     LOG(VB_SOCKET, LOG_INFO, LOC() + QString("MythSocket(%1, 0x%2) ctor")
         .arg(socket).arg((intptr_t)(cb),0,16));
 
+#ifdef __linux__
+    if (socket != -1 && MythSocketReactor::IsEnabled() && InitReactor(socket))
+    {
+        m_useSharedThread = false;
+        return;
+    }
+#endif
+
+    m_tcpSocket = new QTcpSocket();
+
     if (socket != -1)
     {
         m_tcpSocket->setSocketDescriptor(
@@ -148,6 +211,15 @@ MythSocket::~MythSocket()
     LOG(VB_SOCKET, LOG_INFO, LOC() + QString("MythSocket dtor : cb 0x%2")
         .arg((intptr_t)(m_callback),0,16));
 
+#ifdef __linux__
+    if (m_reactor)
+    {
+        m_reactor->Remove(this, m_reactorFd);
+        close(m_reactorFd);
+        return;
+    }
+#endif
+
     if (IsConnected())
         DisconnectFromHost();
 
@@ -293,6 +365,13 @@ void MythSocket::CallReadyReadHandler(void)
 bool MythSocket::ConnectToHost(
     const QHostAddress &address, quint16 port)
 {
+    if (!m_tcpSocket)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC() +
+            "connect() called on an accepted socket");
+        return false;
+    }
+
     bool ret = false;
     QMetaObject::invokeMethod(
         this, "ConnectToHostReal",
@@ -306,6 +385,11 @@ bool MythSocket::ConnectToHost(
 
 bool MythSocket::WriteStringList(const QStringList &list)
 {
+#ifdef __linux__
+    if (m_reactor)
+        return WriteStringListReactor(list);
+#endif
+
     bool ret = false;
     QMetaObject::invokeMethod(
         this, "WriteStringListReal",
@@ -318,6 +402,11 @@ bool MythSocket::WriteStringList(const QStringList &list)
 
 bool MythSocket::ReadStringList(QStringList &list, std::chrono::milliseconds timeoutMS)
 {
+#ifdef __linux__
+    if (m_reactor)
+        return ReadStringListReactor(list, timeoutMS);
+#endif
+
     bool ret = false;
     QMetaObject::invokeMethod(
         this, "ReadStringListReal",
@@ -481,8 +570,8 @@ bool MythSocket::Announce(const QStringList &new_announce)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC() +
             QString("\n\t\t\tCould not read string list from server %1:%2")
-            .arg(m_tcpSocket->peerAddress().toString())
-            .arg(m_tcpSocket->peerPort()));
+            .arg(GetPeerAddress().toString())
+            .arg(GetPeerPort()));
         m_announce.clear();
         m_isAnnounced = false;
     }
@@ -503,6 +592,16 @@ void MythSocket::SetAnnounce(const QStringList &new_announce)
 
 void MythSocket::DisconnectFromHost(void)
 {
+#ifdef __linux__
+    if (m_reactor)
+    {
+        // The reactor sees the connection close and calls
+        // DisconnectHandler() like QTcpSocket would.
+        shutdown(m_reactorFd, SHUT_RDWR);
+        return;
+    }
+#endif
+
     if (QThread::currentThread() != m_thread->qthread() &&
         gCoreContext && gCoreContext->IsExiting())
     {
@@ -519,6 +618,11 @@ void MythSocket::DisconnectFromHost(void)
 
 int MythSocket::Write(const char *data, int size)
 {
+#ifdef __linux__
+    if (m_reactor)
+        return WriteReactor(data, size);
+#endif
+
     int ret = -1;
     QMetaObject::invokeMethod(
         this, "WriteReal",
@@ -530,8 +634,99 @@ int MythSocket::Write(const char *data, int size)
     return ret;
 }
 
+/** \brief Send part of a file to the peer.
+ *
+ *  Anything already queued by Write() goes out first. On Linux the
+ *  data goes from the file to the socket with sendfile(), without
+ *  passing through user space.
+ *
+ *  The waiting for the peer is done on the calling thread, so a slow
+ *  peer does not hold up the socket thread, which may be shared.
+ *
+ *  \param fd     File descriptor of a regular file
+ *  \param offset Offset of the first byte in the file to send
+ *  \param size   Number of bytes to send
+ *  \return Number of bytes sent, which is less than size if the end of
+ *          the file was reached, or -1 on error
+ */
+int MythSocket::SendFile(int fd, long long offset, int size)
+{
+#ifdef __linux__
+    if (m_reactor)
+    {
+        QMutexLocker locker(&m_writeLock);
+        return sendfile_all(m_reactorFd, fd, offset, size, LOC());
+    }
+#endif
+
+#ifdef __linux__
+    // Let Qt write out what Write() queued. Qt only writes to the
+    // descriptor while it has data queued, after that sendfile() has
+    // the socket to itself.
+    MythTimer timer;
+    timer.start();
+    while (true)
+    {
+        bool flushed = false;
+        QMetaObject::invokeMethod(
+            this, "FlushReal",
+            (QThread::currentThread() != m_thread->qthread()) ?
+            Qt::BlockingQueuedConnection : Qt::DirectConnection,
+            Q_ARG(bool*, &flushed));
+        if (flushed)
+            break;
+
+        if (!IsConnected() || timer.elapsed() > kLongTimeout)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC() +
+                "SendFile(): Timed out flushing queued data");
+            return -1;
+        }
+
+        struct pollfd pfd {GetSocketDescriptor(), POLLOUT, 0};
+        poll(&pfd, 1, 100);
+    }
+
+    return sendfile_all(GetSocketDescriptor(), fd, offset, size, LOC());
+#else
+    if (lseek(fd, offset, SEEK_SET) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC() + "SendFile(): seek failed" + ENO);
+        return -1;
+    }
+
+    // Write() only queues the data with Qt, like the caller did before.
+    std::vector<char> buf(std::min(size, kSocketReceiveBufferSize));
+    int tot = 0;
+    while (tot < size)
+    {
+        int request = std::min(size - tot, static_cast<int>(buf.size()));
+        int got = static_cast<int>(read(fd, buf.data(), request));
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC() + "SendFile(): read failed" + ENO);
+            return -1;
+        }
+        if (got == 0)
+            break; // end of file
+        if (Write(buf.data(), got) != got)
+            return -1;
+        tot += got;
+    }
+
+    return tot;
+#endif
+}
+
 int MythSocket::Read(char *data, int size,  std::chrono::milliseconds max_wait)
 {
+#ifdef __linux__
+    if (m_reactor)
+        return ReadReactor(data, size, max_wait);
+#endif
+
     int ret = -1;
     QMetaObject::invokeMethod(
         this, "ReadReal",
@@ -546,6 +741,14 @@ int MythSocket::Read(char *data, int size,  std::chrono::milliseconds max_wait)
 
 void MythSocket::Reset(void)
 {
+#ifdef __linux__
+    if (m_reactor)
+    {
+        ResetReactor();
+        return;
+    }
+#endif
+
     QMetaObject::invokeMethod(
         this, "ResetReal",
         (QThread::currentThread() != m_thread->qthread()) ?
@@ -562,6 +765,14 @@ bool MythSocket::IsConnected(void) const
 
 bool MythSocket::IsDataAvailable(void)
 {
+#ifdef __linux__
+    if (m_reactor)
+    {
+        QMutexLocker locker(&m_readLock);
+        return m_readBuffer.size() > m_readPos;
+    }
+#endif
+
     if (QThread::currentThread() == m_thread->qthread())
         return m_tcpSocket->bytesAvailable() > 0;
 
@@ -692,6 +903,67 @@ void MythSocket::DisconnectFromHostReal(void)
     m_tcpSocket->disconnectFromHost();
 }
 
+/// Joins the list into a message with the 8 byte size prefix
+bool MythSocket::BuildPayload(const QStringList &list, QByteArray &payload)
+{
+    QString str = list.join("[]:[]");
+    if (str.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC() +
+            "WriteStringList: Error, joined null string.");
+        return false;
+    }
+
+    QByteArray utf8 = str.toUtf8();
+    payload = payload.setNum(utf8.length());
+    payload += "        ";
+    payload.truncate(8);
+    payload += utf8;
+
+    if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
+    {
+        QString msg = QString("write -> %1 %2")
+            .arg(GetSocketDescriptor(), 2).arg(payload.data());
+
+        if (logLevel < LOG_DEBUG && msg.length() > 128)
+        {
+            msg.truncate(127);
+            msg += "…";
+        }
+        LOG(VB_NETWORK, LOG_INFO, LOC() + msg);
+    }
+
+    return true;
+}
+
+/// Splits the body of a message back into a list
+QStringList MythSocket::DecodeStringList(const QByteArray &utf8)
+{
+    QString str = QString::fromUtf8(utf8.data());
+
+    if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
+    {
+        QByteArray payload;
+        payload = payload.setNum(str.length());
+        payload += "        ";
+        payload.truncate(8);
+        payload += utf8.data();
+
+        QString msg = QString("read  <- %1 %2")
+            .arg(GetSocketDescriptor(), 2)
+            .arg(payload.data());
+
+        if (logLevel < LOG_DEBUG && msg.length() > 128)
+        {
+            msg.truncate(127);
+            msg += "…";
+        }
+        LOG(VB_NETWORK, LOG_INFO, LOC() + msg);
+    }
+
+    return str.split("[]:[]");
+}
+
 void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
 {
     if (list->empty())
@@ -710,40 +982,16 @@ void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
         return;
     }
 
-    QString str = list->join("[]:[]");
-    if (str.isEmpty())
+    QByteArray payload;
+    if (!BuildPayload(*list, payload))
     {
-        LOG(VB_GENERAL, LOG_ERR, LOC() +
-            "WriteStringList: Error, joined null string.");
         *ret = false;
         return;
     }
-
-    QByteArray utf8 = str.toUtf8();
-    int size = utf8.length();
+    int size = payload.length();
     int written = 0;
     int written_since_timer_restart = 0;
 
-    QByteArray payload;
-    payload = payload.setNum(size);
-    payload += "        ";
-    payload.truncate(8);
-    payload += utf8;
-    size = payload.length();
-
-    if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
-    {
-        QString msg = QString("write -> %1 %2")
-            .arg(m_tcpSocket->socketDescriptor(), 2).arg(payload.data());
-
-        if (logLevel < LOG_DEBUG && msg.length() > 128)
-        {
-            msg.truncate(127);
-            msg += "…";
-        }
-        LOG(VB_NETWORK, LOG_INFO, LOC() + msg);
-    }
-
     MythTimer timer; timer.start();
     unsigned int errorcount = 0;
     while (size > 0)
@@ -924,29 +1172,7 @@ void MythSocket::ReadStringListReal(
         }
     }
 
-    QString str = QString::fromUtf8(utf8.data());
-
-    if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
-    {
-        QByteArray payload;
-        payload = payload.setNum(str.length());
-        payload += "        ";
-        payload.truncate(8);
-        payload += utf8.data();
-
-        QString msg = QString("read  <- %1 %2")
-            .arg(m_tcpSocket->socketDescriptor(), 2)
-            .arg(payload.data());
-
-        if (logLevel < LOG_DEBUG && msg.length() > 128)
-        {
-            msg.truncate(127);
-            msg += "…";
-        }
-        LOG(VB_NETWORK, LOG_INFO, LOC() + msg);
-    }
-
-    *list = str.split("[]:[]");
+    *list = DecodeStringList(utf8);
 
     m_dataAvailable.fetchAndStoreOrdered(
         (m_tcpSocket->bytesAvailable() > 0) ? 1 : 0);
@@ -959,6 +1185,13 @@ void MythSocket::WriteReal(const char *data, int size, int *ret)
     *ret = m_tcpSocket->write(data, size);
 }
 
+void MythSocket::FlushReal(bool *ret)
+{
+    if (m_tcpSocket->state() == QAbstractSocket::ConnectedState)
+        m_tcpSocket->flush();
+    *ret = (m_tcpSocket->bytesToWrite() == 0);
+}
+
 void MythSocket::ReadReal(char *data, int size, std::chrono::milliseconds max_wait_ms, int *ret)
 {
     MythTimer t; t.start();
@@ -1005,3 +1238,492 @@ void MythSocket::ResetReal(void)
 
     m_dataAvailable.fetchAndStoreOrdered(0);
 }
+
+#ifdef __linux__
+//////////////////////////////////////////////////////////////////////////
+// MythSocketReactor mode
+
+/// Hands the socket to a reactor. Returns false, leaving the descriptor
+/// as it was, if the socket should use a QTcpSocket instead.
+bool MythSocket::InitReactor(qintptr socket)
+{
+    int fd = static_cast<int>(socket);
+
+    struct sockaddr_storage addr {};
+    socklen_t addrlen = sizeof(addr);
+    QHostAddress peer;
+    int port = -1;
+    if (getpeername(fd, reinterpret_cast<struct sockaddr*>(&addr), &addrlen) == 0)
+    {
+        peer.setAddress(reinterpret_cast<struct sockaddr*>(&addr));
+        if (addr.ss_family == AF_INET)
+            port = ntohs(reinterpret_cast<struct sockaddr_in*>(&addr)->sin_port);
+        else if (addr.ss_family == AF_INET6)
+            port = ntohs(reinterpret_cast<struct sockaddr_in6*>(&addr)->sin6_port);
+    }
+
+    // The QTcpSocket path rejects the connection.
+    if (!gCoreContext->CheckSubnet(peer))
+        return false;
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC() + "Failed to set O_NONBLOCK" + ENO);
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0)
+        LOG(VB_SOCKET, LOG_INFO, LOC() + "Failed to set SO_REUSEADDR" + ENO);
+    int rcv_buf_val = kSocketReceiveBufferSize;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv_buf_val,
+                   sizeof(rcv_buf_val)) < 0)
+        LOG(VB_SOCKET, LOG_INFO, LOC() + "Failed to set SO_RCVBUF" + ENO);
+
+    {
+        QMutexLocker locker(&m_lock);
+        m_connected = true;
+        m_socketDescriptor = fd;
+        m_peerAddress = peer;
+        m_peerPort = port;
+    }
+    m_reactorFd = fd;
+
+    // With the capacity reserved, emptying the buffer keeps it allocated.
+    m_readBuffer.reserve(2 * kSocketReceiveBufferSize);
+
+    m_reactor = MythSocketReactor::Add(this, fd);
+    if (!m_reactor)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC() +
+            "No socket reactor, falling back to a socket thread");
+        {
+            QMutexLocker locker(&m_lock);
+            m_connected = false;
+            m_socketDescriptor = -1;
+            m_peerAddress.clear();
+            m_peerPort = -1;
+        }
+        m_reactorFd = -1;
+        fcntl(fd, F_SETFL, flags);
+        return false;
+    }
+
+    if (m_callback)
+    {
+        LOG(VB_SOCKET, LOG_DEBUG, LOC() +
+            "calling m_callback->connected()");
+        m_callback->connected(this);
+    }
+
+    return true;
+}
+
+/// Reads everything the socket has to offer into the buffer. Called by
+/// the reactor thread, returns false once the connection is closed.
+/// After a hangup the rest of the data is read even if the reader is
+/// behind, the peer sends no more than what the kernel has buffered.
+bool MythSocket::ReactorRead(bool hangup)
+{
+    bool open = true;
+    bool notify = false;
+    {
+        QMutexLocker locker(&m_readLock);
+        while (true)
+        {
+            if (!hangup && m_readBuffer.size() - m_readPos >=
+                std::max(kReactorMaxBuffer, m_readWanted))
+            {
+                if (!m_readPaused)
+                {
+                    m_readPaused = true;
+                    m_reactor->SetReading(this, m_reactorFd, false);
+                }
+                break;
+            }
+
+            int old = m_readBuffer.size();
+            m_readBuffer.resize(old + kSocketReceiveBufferSize);
+            ssize_t got = recv(m_reactorFd, m_readBuffer.data() + old,
+                               kSocketReceiveBufferSize, 0);
+            int err = errno;
+            m_readBuffer.resize(old + static_cast<int>(std::max(got, ssize_t(0))));
+
+            if (got > 0)
+                continue;
+            if (got < 0 && err == EINTR)
+                continue;
+            if (got < 0 && (err == EAGAIN || err == EWOULDBLOCK))
+                break;
+            if (got < 0)
+            {
+                errno = err;
+                LOG(VB_SOCKET, LOG_INFO, LOC() + "recv() failed" + ENO);
+            }
+            m_readClosed = true;
+            open = false;
+            break;
+        }
+        m_readWait.wakeAll();
+
+        if (!m_readyReadPending && m_callback &&
+            m_disableReadyReadCallback.testAndSetOrdered(0,0) && HasMessage())
+        {
+            m_readyReadPending = true;
+            notify = true;
+        }
+    }
+
+    if (notify)
+        QueueCallbacks(true, false);
+
+    return open;
+}
+
+/// Takes a reference unless the socket is already being deleted.
+bool MythSocket::TryIncrRef(void)
+{
+    int count = m_referenceCount.loadAcquire();
+    while (count > 0)
+    {
+        if (m_referenceCount.testAndSetOrdered(count, count + 1))
+            return true;
+        count = m_referenceCount.loadAcquire();
+    }
+    return false;
+}
+
+/// Queues callbacks to be run off the reactor thread. The callbacks of
+/// a socket run one at a time, in the order readyRead() then
+/// connectionClosed(), and hold a reference to the socket.
+void MythSocket::QueueCallbacks(bool readyRead, bool closed)
+{
+    {
+        QMutexLocker locker(&m_callbackLock);
+        m_readyReadQueued |= readyRead;
+        m_closeQueued |= closed;
+        if (m_callbacksStarted)
+            return;
+        m_callbacksStarted = true;
+    }
+
+    IncrRef();
+    MythSocketReactor::StartCallbacks(this);
+}
+
+void MythSocket::RunCallbacks(void)
+{
+    while (true)
+    {
+        bool readyRead = false;
+        bool closed = false;
+        {
+            QMutexLocker locker(&m_callbackLock);
+            std::swap(readyRead, m_readyReadQueued);
+            std::swap(closed, m_closeQueued);
+            if (!readyRead && !closed)
+            {
+                m_callbacksStarted = false;
+                break;
+            }
+        }
+
+        if (readyRead && m_callback)
+        {
+            LOG(VB_SOCKET, LOG_DEBUG, LOC() + "calling m_callback->readyRead()");
+            m_callback->readyRead(this);
+        }
+        if (closed)
+            DisconnectHandler();
+    }
+
+    DecrRef();
+}
+
+/// Returns true if a whole message is buffered, or something that is
+/// not a message and needs the reader to reset the socket.
+/// m_readLock must be held.
+bool MythSocket::HasMessage(void) const
+{
+    int avail = m_readBuffer.size() - m_readPos;
+    if (avail < 8)
+        return false;
+
+    bool ok = false;
+    int size = QByteArray(m_readBuffer.constData() + m_readPos, 8)
+        .trimmed().toInt(&ok);
+    return !ok || (size < 1) || (avail - 8 >= size);
+}
+
+/// Lets the buffer grow past kReactorMaxBuffer until it holds size
+/// bytes, for a reader waiting on a message larger than that.
+/// m_readLock must be held.
+void MythSocket::WantRead(int size)
+{
+    m_readWanted = size;
+    if (m_readPaused && !m_readClosed &&
+        (m_readBuffer.size() - m_readPos < std::max(kReactorMaxBuffer, size)))
+    {
+        m_readPaused = false;
+        m_reactor->SetReading(this, m_reactorFd, true);
+    }
+}
+
+/// Drops size bytes from the front of the read buffer and resumes
+/// reading if it had been paused. m_readLock must be held.
+/// \return true if readyRead() should be called for the next message.
+bool MythSocket::ConsumeRead(int size)
+{
+    m_readPos += size;
+    m_readWanted = 0;
+    if (m_readPos >= m_readBuffer.size())
+    {
+        m_readBuffer.resize(0);
+        m_readPos = 0;
+    }
+    else if (m_readPos > m_readBuffer.size() / 2)
+    {
+        m_readBuffer.remove(0, m_readPos);
+        m_readPos = 0;
+    }
+
+    if (m_readPaused && !m_readClosed &&
+        (m_readBuffer.size() - m_readPos < kReactorMaxBuffer / 2))
+    {
+        m_readPaused = false;
+        m_reactor->SetReading(this, m_reactorFd, true);
+    }
+
+    m_readyReadPending = m_callback &&
+        m_disableReadyReadCallback.testAndSetOrdered(0,0) && HasMessage();
+    return m_readyReadPending;
+}
+
+bool MythSocket::ReadStringListReactor(
+    QStringList &list, std::chrono::milliseconds timeoutMS)
+{
+    list.clear();
+
+    QMutexLocker locker(&m_readLock);
+
+    MythTimer timer;
+    timer.start();
+    while (m_readBuffer.size() - m_readPos < 8)
+    {
+        if (m_readClosed)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC() + "ReadStringList: Connection died.");
+            return false;
+        }
+
+        std::chrono::milliseconds left = timeoutMS - timer.elapsed();
+        if (left <= 0ms)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC() + "ReadStringList: " +
+                QString("Error, timed out after %1 ms.").arg(timeoutMS.count()));
+            shutdown(m_reactorFd, SHUT_RDWR);
+            return false;
+        }
+
+        m_readWait.wait(&m_readLock, static_cast<unsigned long>(left.count()));
+    }
+
+    QByteArray sizestr(m_readBuffer.constData() + m_readPos, 8);
+    bool ok { false };
+    int btr = QString(sizestr).trimmed().toInt(&ok);
+
+    if (btr < 1)
+    {
+        int pending = m_readBuffer.size() - m_readPos - 8;
+        LOG(VB_GENERAL, LOG_ERR, LOC() +
+            QString("Protocol error: %1'%2' is not a valid size "
+                    "prefix. %3 bytes pending.")
+                .arg(ok ? "" : "(parse failed) ",
+                     sizestr.data(), QString::number(pending)));
+        locker.unlock();
+        ResetReactor();
+        return false;
+    }
+
+    int have = m_readBuffer.size() - m_readPos - 8;
+    if (have < btr)
+        WantRead(8 + btr);
+
+    std::chrono::milliseconds errmsgtime { 0ms };
+    timer.start();
+    while (have < btr)
+    {
+        if (m_readClosed)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC() + "ReadStringList: Connection died.");
+            m_readWanted = 0;
+            return false;
+        }
+
+        std::chrono::milliseconds elapsed = timer.elapsed();
+        if ((elapsed > 10s) && ((elapsed - errmsgtime) > 10s))
+        {
+            errmsgtime = elapsed;
+            LOG(VB_GENERAL, LOG_ERR, LOC() +
+                QString("ReadStringList: Waiting for data: %1 %2")
+                    .arg(have).arg(btr - have));
+        }
+
+        if (elapsed > 100s)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC() +
+                "Error, ReadStringList timeout (readBlock)");
+            m_readWanted = 0;
+            return false;
+        }
+
+        m_readWait.wait(&m_readLock, 1000);
+
+        int now = m_readBuffer.size() - m_readPos - 8;
+        if (now > have)
+        {
+            have = now;
+            errmsgtime = 0ms;
+            timer.start();
+        }
+    }
+
+    QByteArray utf8(m_readBuffer.constData() + m_readPos + 8, btr);
+    bool notify = ConsumeRead(8 + btr);
+    locker.unlock();
+
+    list = DecodeStringList(utf8);
+
+    if (notify)
+        QueueCallbacks(true, false);
+
+    return true;
+}
+
+bool MythSocket::WriteStringListReactor(const QStringList &list)
+{
+    if (list.empty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC() +
+            "WriteStringList: Error, invalid string list.");
+        return false;
+    }
+
+    if (!IsConnected())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC() +
+            "WriteStringList: Error, called with unconnected socket.");
+        return false;
+    }
+
+    QByteArray payload;
+    if (!BuildPayload(list, payload))
+        return false;
+
+    if (WriteReactor(payload.constData(), payload.size()) != payload.size())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC() + "WriteStringList: Error, " +
+            QString("failed to write %1 bytes").arg(payload.size()) +
+            QString("\n\t\t\tstarts with: %1").arg(to_sample(payload)));
+        return false;
+    }
+
+    return true;
+}
+
+/// Writes all of the data, waiting for the peer to catch up if the
+/// socket buffer is full. Returns size, or -1 on error.
+int MythSocket::WriteReactor(const char *data, int size)
+{
+    QMutexLocker locker(&m_writeLock);
+
+    int written = 0;
+    while (written < size)
+    {
+        ssize_t sent = send(m_reactorFd, data + written,
+                            static_cast<size_t>(size - written), MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            written += static_cast<int>(sent);
+            continue;
+        }
+
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            struct pollfd pfd {m_reactorFd, POLLOUT, 0};
+            if (poll(&pfd, 1, static_cast<int>(kLongTimeout.count())) > 0)
+                continue;
+            LOG(VB_GENERAL, LOG_ERR, LOC() + "Write(): Timed out writing");
+            return -1;
+        }
+
+        LOG(VB_SOCKET, LOG_INFO, LOC() + "Write(): send() failed" + ENO);
+        return -1;
+    }
+
+    return written;
+}
+
+int MythSocket::ReadReactor(
+    char *data, int size, std::chrono::milliseconds max_wait)
+{
+    MythTimer t; t.start();
+
+    QMutexLocker locker(&m_readLock);
+    if (m_readBuffer.size() - m_readPos < size)
+        WantRead(size);
+    while (!m_readClosed && (m_readBuffer.size() - m_readPos < size))
+    {
+        std::chrono::milliseconds left = max_wait - t.elapsed();
+        if (left <= 0ms)
+            break;
+        m_readWait.wait(&m_readLock, static_cast<unsigned long>(left.count()));
+    }
+
+    int avail = m_readBuffer.size() - m_readPos;
+    if (m_readClosed && avail == 0)
+        return -1;
+
+    int ret = std::min(size, avail);
+    memcpy(data, m_readBuffer.constData() + m_readPos, ret);
+    bool notify = ConsumeRead(ret);
+    locker.unlock();
+
+    if (t.elapsed() > 50ms)
+    {
+        LOG(VB_NETWORK, LOG_INFO,
+            QString("ReadReal(?, %1, %2) -> %3 took %4 ms")
+            .arg(size).arg(max_wait.count()).arg(ret)
+            .arg(t.elapsed().count()));
+    }
+
+    if (notify)
+        QueueCallbacks(true, false);
+
+    return ret;
+}
+
+void MythSocket::ResetReactor(void)
+{
+    QMutexLocker locker(&m_readLock);
+
+    m_readWait.wait(&m_readLock, 30);
+    do
+    {
+        int avail = m_readBuffer.size() - m_readPos;
+        ConsumeRead(avail);
+
+        LOG(VB_NETWORK, LOG_INFO, LOC() + "Reset() " +
+            QString("%1 bytes available").arg(avail));
+
+        if (!m_readClosed)
+            m_readWait.wait(&m_readLock, 30);
+    }
+    while (m_readBuffer.size() > m_readPos);
+}
+#endif // __linux__
@@ -6,6 +6,7 @@
 #include <QStringList>
 #include <QAtomicInt>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QHash>
 
 #include "referencecounter.h"
@@ -14,6 +15,7 @@
 #include "mthread.h"
 
 class QTcpSocket;
+class MythSocketReactor;
 
 /** \brief Class for communcating between myth backends and frontends
  *
@@ -21,12 +23,17 @@ class QTcpSocket;
  *  serialized (i.e. the MythSocket must only be available to one
  *  thread at a time).
  *
+ *  Sockets accepted by a server on Linux are served by MythSocketReactor
+ *  instead of a QTcpSocket on a thread of their own. Their methods read
+ *  and write the socket directly from the calling thread.
  */
 class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
 {
     Q_OBJECT
 
     friend class MythSocketManager;
+    friend class MythSocketReactor;
+    friend class MythSocketCallbackRunnable;
 
   public:
     explicit MythSocket(qintptr socket = -1, MythSocketCBs *cb = nullptr,
@@ -64,6 +71,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
 
     // RemoteFile stuff
     int Write(const char *data, int size);
+    int SendFile(int fd, long long offset, int size);
     int Read(char *data, int size,  std::chrono::milliseconds max_wait);
     void Reset(void);
 
@@ -95,11 +103,31 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     void DisconnectFromHostReal(void);
 
     void WriteReal(const char *data, int size, int *ret);
+    void FlushReal(bool *ret);
     void ReadReal(char *data, int size, std::chrono::milliseconds max_wait_ms, int *ret);
     void ResetReal(void);
 
     void IsDataAvailableReal(bool *ret) const;
 
+  private:
+    bool BuildPayload(const QStringList &list, QByteArray &payload);
+    QStringList DecodeStringList(const QByteArray &utf8);
+
+    // MythSocketReactor versions of the *Real methods
+    bool InitReactor(qintptr socket);
+    bool ReactorRead(bool hangup);
+    bool TryIncrRef(void);
+    void QueueCallbacks(bool readyRead, bool closed);
+    void RunCallbacks(void);
+    bool HasMessage(void) const;
+    bool ConsumeRead(int size);
+    void WantRead(int size);
+    bool ReadStringListReactor(QStringList &list, std::chrono::milliseconds timeoutMS);
+    bool WriteStringListReactor(const QStringList &list);
+    int  WriteReactor(const char *data, int size);
+    int  ReadReactor(char *data, int size, std::chrono::milliseconds max_wait);
+    void ResetReactor(void);
+
   protected:
     ~MythSocket() override; // force reference counting
 
@@ -120,7 +148,25 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     bool            m_isAnnounced      {false}; // only set in thread using MythSocket
     QStringList     m_announce; // only set in thread using MythSocket
 
+    // Used instead of m_tcpSocket and m_thread when served by a reactor
+    MythSocketReactor *m_reactor       {nullptr}; // only set in ctor
+    int             m_reactorFd        {-1};      // only set in ctor
+    QMutex          m_readLock;
+    QWaitCondition  m_readWait;
+    QByteArray      m_readBuffer;                 // protected by m_readLock
+    int             m_readPos          {0};       // protected by m_readLock
+    bool            m_readClosed       {false};   // protected by m_readLock
+    bool            m_readPaused       {false};   // protected by m_readLock
+    int             m_readWanted       {0};       // protected by m_readLock
+    bool            m_readyReadPending {false};   // protected by m_readLock
+    QMutex          m_writeLock;
+    QMutex          m_callbackLock;
+    bool            m_callbacksStarted {false};   // protected by m_callbackLock
+    bool            m_readyReadQueued  {false};   // protected by m_callbackLock
+    bool            m_closeQueued      {false};   // protected by m_callbackLock
+
     static const int kSocketReceiveBufferSize;
+    static const int kReactorMaxBuffer;
 
     static QMutex s_loopbackCacheLock;
     static QHash<QString, QHostAddress::SpecialAddress> s_loopbackCache;
@@ -0,0 +1,255 @@
+// C++ headers
+#include <algorithm>
+#include <array>
+#include <utility>
+
+// POSIX headers
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Qt headers
+#include <QRunnable>
+#include <QThread>
+
+// MythTV headers
+#include "mthreadpool.h"
+#include "mythlogging.h"
+#include "mythsocket.h"
+#include "mythsocketreactor.h"
+
+#define LOC QString("SocketReactor: ")
+
+QMutex MythSocketReactor::s_lock;
+std::vector<MythSocketReactor*> MythSocketReactor::s_reactors;
+MThreadPool *MythSocketReactor::s_callbackPool = nullptr;
+
+class MythSocketCallbackRunnable : public QRunnable
+{
+  public:
+    explicit MythSocketCallbackRunnable(MythSocket *socket) :
+        m_socket(socket) {}
+
+    void run(void) override // QRunnable
+    {
+        m_socket->RunCallbacks();
+    }
+
+  private:
+    MythSocket *m_socket;
+};
+
+bool MythSocketReactor::IsEnabled(void)
+{
+    static const bool kEnabled =
+        !qEnvironmentVariableIsSet("MYTHTV_NOSOCKETREACTOR");
+    return kEnabled;
+}
+
+MythSocketReactor::MythSocketReactor(int index) :
+    MThread(QString("SocketReactor%1").arg(index))
+{
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_epollFd < 0 || m_wakeFd < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to create epoll instance" + ENO);
+        return;
+    }
+
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+}
+
+MythSocketReactor::~MythSocketReactor()
+{
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+    if (m_epollFd >= 0)
+        close(m_epollFd);
+}
+
+MythSocketReactor *MythSocketReactor::Add(MythSocket *socket, int fd)
+{
+    MythSocketReactor *reactor = nullptr;
+    {
+        QMutexLocker locker(&s_lock);
+
+        if (!s_callbackPool)
+            s_callbackPool = new MThreadPool("SocketCallbacks");
+
+        if (s_reactors.empty())
+        {
+            int count = std::clamp(QThread::idealThreadCount() / 2, 1, 4);
+            for (int i = 0; i < count; i++)
+            {
+                auto *r = new MythSocketReactor(i);
+                if (r->m_epollFd < 0 || r->m_wakeFd < 0)
+                {
+                    delete r;
+                    break;
+                }
+                r->start();
+                s_reactors.push_back(r);
+            }
+            if (s_reactors.empty())
+                return nullptr;
+        }
+
+        reactor = *std::min_element(
+            s_reactors.cbegin(), s_reactors.cend(),
+            [](const MythSocketReactor *a, const MythSocketReactor *b)
+            { return a->m_count < b->m_count; });
+        reactor->m_count++;
+    }
+
+    // s_lock is never taken before m_lock, a callback holding m_lock
+    // may delete a socket and so take s_lock in Remove().
+    {
+        QMutexLocker locker(&reactor->m_lock);
+        reactor->m_sockets.insert(socket);
+
+        struct epoll_event ev {};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = socket;
+        if (epoll_ctl(reactor->m_epollFd, EPOLL_CTL_ADD, fd, &ev) == 0)
+            return reactor;
+
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to add socket" + ENO);
+        reactor->m_sockets.remove(socket);
+    }
+
+    Release(reactor);
+    return nullptr;
+}
+
+void MythSocketReactor::Remove(MythSocket *socket, int fd)
+{
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+
+    {
+        QMutexLocker locker(&m_lock);
+        m_sockets.remove(socket);
+    }
+
+    Release(this);
+}
+
+void MythSocketReactor::SetReading(MythSocket *socket, int fd, bool enable)
+{
+    // EPOLLHUP and EPOLLERR are always reported. A hangup on a paused
+    // socket makes the reader drain what is left, so it does not wake
+    // us in a loop.
+    struct epoll_event ev {};
+    ev.events = enable ? (EPOLLIN | EPOLLRDHUP) : EPOLLRDHUP;
+    ev.data.ptr = socket;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0)
+        LOG(VB_SOCKET, LOG_INFO, LOC + "Failed to change socket events" + ENO);
+}
+
+void MythSocketReactor::StartCallbacks(MythSocket *socket)
+{
+    MThreadPool *pool = nullptr;
+    {
+        QMutexLocker locker(&s_lock);
+        pool = s_callbackPool;
+    }
+
+    // Reserved threads are started at once rather than queued, like the
+    // thread per socket they replace.
+    pool->startReserved(new MythSocketCallbackRunnable(socket),
+                        "SocketCallback", 0ms);
+}
+
+/// Drops a socket from the count of the reactor, stopping all reactor
+/// threads when no sockets are left.
+void MythSocketReactor::Release(MythSocketReactor *reactor)
+{
+    QMutexLocker locker(&s_lock);
+    reactor->m_count--;
+    if (std::any_of(s_reactors.cbegin(), s_reactors.cend(),
+                    [](const MythSocketReactor *r) { return r->m_count > 0; }))
+        return;
+
+    if (std::any_of(s_reactors.cbegin(), s_reactors.cend(),
+                    [](MythSocketReactor *r)
+                    { return QThread::currentThread() == r->qthread(); }))
+    {
+        LOG(VB_SOCKET, LOG_INFO, LOC +
+            "Last socket deleted in a callback, leaving reactor running");
+        return;
+    }
+
+    StopAll();
+}
+
+/// Stops and deletes all reactor threads, s_lock must be held.
+void MythSocketReactor::StopAll(void)
+{
+    for (auto *reactor : s_reactors)
+    {
+        reactor->m_stop = true;
+        uint64_t one = 1;
+        if (write(reactor->m_wakeFd, &one, sizeof(one)) < 0)
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to wake reactor" + ENO);
+        reactor->wait();
+        delete reactor;
+    }
+    s_reactors.clear();
+}
+
+void MythSocketReactor::run(void)
+{
+    RunProlog();
+
+    std::array<struct epoll_event,64> events {};
+    std::vector<std::pair<MythSocket*,uint32_t>> ready;
+    while (true)
+    {
+        int count = epoll_wait(m_epollFd, events.data(),
+                               static_cast<int>(events.size()), -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            LOG(VB_GENERAL, LOG_ERR, LOC + "epoll_wait failed" + ENO);
+            break;
+        }
+
+        if (m_stop)
+            break;
+
+        // Hold a reference to each socket while it is read, rather than
+        // m_lock. Another thread may delete a socket, and so wait for
+        // m_lock in Remove(), while holding locks a callback needs.
+        ready.clear();
+        {
+            QMutexLocker locker(&m_lock);
+            for (int i = 0; i < count; i++)
+            {
+                auto *socket = static_cast<MythSocket*>(events[i].data.ptr);
+                if (socket && m_sockets.contains(socket) &&
+                    socket->TryIncrRef())
+                {
+                    ready.emplace_back(socket, events[i].events);
+                }
+            }
+        }
+
+        for (auto [socket, flags] : ready)
+        {
+            bool hangup = (flags & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+            if (!socket->ReactorRead(hangup))
+            {
+                epoll_ctl(m_epollFd, EPOLL_CTL_DEL,
+                          socket->m_reactorFd, nullptr);
+                socket->QueueCallbacks(false, true);
+            }
+            socket->DecrRef();
+        }
+    }
+
+    RunEpilog();
+}
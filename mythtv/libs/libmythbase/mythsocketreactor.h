@@ -0,0 +1,75 @@
+/** -*- Mode: c++ -*- */
+#ifndef MYTH_SOCKET_REACTOR_H
+#define MYTH_SOCKET_REACTOR_H
+
+#include <atomic>
+#include <vector>
+
+#include <QMutex>
+#include <QSet>
+
+#include "mthread.h"
+
+class MThreadPool;
+class MythSocket;
+
+/** \brief Waits for data on accepted MythSockets with a few epoll threads.
+ *
+ *  A MythSocket handed to the reactor has no QTcpSocket and no thread of
+ *  its own. The reactor thread it is assigned to reads whatever arrives
+ *  into the socket's buffer and queues the readyRead() callback once a
+ *  whole message is buffered. The threads handling the requests then
+ *  read and write the socket directly, instead of going through queued
+ *  calls to a socket thread for every read and write.
+ *
+ *  The reactor threads only do I/O. The readyRead() and
+ *  connectionClosed() callbacks of a socket run one at a time on a
+ *  thread pool, so a callback that blocks holds up only its own socket.
+ */
+class MythSocketReactor : public MThread
+{
+  public:
+    /// Returns true if accepted sockets should use the reactor
+    static bool IsEnabled(void);
+
+    /// Assigns the socket to the least busy reactor thread, starting
+    /// the reactor threads if this is the first socket.
+    static MythSocketReactor *Add(MythSocket *socket, int fd);
+
+    /// Stops watching the socket, called when it is deleted. The reactor
+    /// holds a reference while it handles an event for a socket, so none
+    /// is being handled by then. The reactor threads are stopped with
+    /// the last socket.
+    void Remove(MythSocket *socket, int fd);
+
+    /// Starts or stops watching the socket for data, so that a reader
+    /// that falls behind does not make its buffer grow without bounds.
+    /// A paused socket is still watched for the connection closing.
+    void SetReading(MythSocket *socket, int fd, bool enable);
+
+    /// Runs the queued callbacks of the socket on the callback pool.
+    static void StartCallbacks(MythSocket *socket);
+
+  protected:
+    void run(void) override; // MThread
+
+  private:
+    explicit MythSocketReactor(int index);
+    ~MythSocketReactor() override;
+
+    static void Release(MythSocketReactor *reactor);
+    static void StopAll(void);
+
+    int               m_epollFd {-1};
+    int               m_wakeFd  {-1};    ///< eventfd used to stop run()
+    QMutex            m_lock;            ///< protects m_sockets
+    QSet<MythSocket*> m_sockets;         ///< protected by m_lock
+    std::atomic<bool> m_stop    {false};
+    int               m_count   {0};     ///< protected by s_lock
+
+    static QMutex                          s_lock;
+    static std::vector<MythSocketReactor*> s_reactors; // protected by s_lock
+    static MThreadPool                    *s_callbackPool; // protected by s_lock
+};
+
+#endif /* MYTH_SOCKET_REACTOR_H */
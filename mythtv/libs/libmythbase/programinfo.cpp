@@ -7,6 +7,8 @@
 #include <algorithm>
 
 // Qt headers
+#include <QDataStream>
+#include <QHash>
 #include <QMap>
 #include <QUrl>
 #include <QFile>
@@ -23,6 +25,7 @@
 #include "libmythbase/mythscheduler.h"
 #include "libmythbase/mythsorthelper.h"
 #include "libmythbase/remotefile.h"
+#include "libmythbase/seekindexfile.h"
 #include "libmythbase/storagegroup.h"
 #include "libmythbase/stringutil.h"
 
@@ -1445,6 +1448,179 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
     return true;
 }
 
+static inline qint64 DateTimeToStreamInt(const QDateTime& x)
+{
+    if (x.isValid())
+        return x.toSecsSinceEpoch();
+    return kInvalidDateTime;
+}
+
+static inline QDateTime DateTimeFromStreamInt(qint64 secs)
+{
+    if (secs == kInvalidDateTime)
+        return {};
+    return MythDate::fromSecsSinceEpoch(secs);
+}
+
+/** \fn ProgramInfo::ToDataStream(QDataStream&) const
+ *  \brief Serializes ProgramInfo in binary form, with the same fields
+ *         in the same order as ToStringList().
+ *  \sa FromDataStream(QDataStream&), ProgramListWriter
+ */
+void ProgramInfo::ToDataStream(QDataStream &stream) const
+{
+    stream << m_title << m_subtitle << m_description
+           << quint32(m_season) << quint32(m_episode)
+           << quint32(m_totalEpisodes) << m_syndicatedEpisode
+           << m_category << quint32(m_chanId) << m_chanStr << m_chanSign
+           << m_chanName << m_pathname << quint64(m_fileSize);
+
+    stream << DateTimeToStreamInt(m_startTs) << DateTimeToStreamInt(m_endTs)
+           << quint32(m_findId) << m_hostname << quint32(m_sourceId)
+           << quint32(m_inputId) << qint32(m_recPriority)
+           << qint8(m_recStatus) << quint32(m_recordId);
+
+    stream << quint8(m_recType) << quint8(m_dupIn) << quint8(m_dupMethod)
+           << DateTimeToStreamInt(m_recStartTs)
+           << DateTimeToStreamInt(m_recEndTs) << quint32(m_programFlags)
+           << (!m_recGroup.isEmpty() ? m_recGroup : "Default")
+           << m_chanPlaybackFilters << m_seriesId << m_programId << m_inetRef;
+
+    stream << DateTimeToStreamInt(m_lastModified) << m_stars
+           << m_originalAirDate
+           << (!m_playGroup.isEmpty() ? m_playGroup : "Default")
+           << qint32(m_recPriority2) << quint32(m_parentId)
+           << (!m_storageGroup.isEmpty() ? m_storageGroup : "Default")
+           << quint32(m_audioProperties) << quint32(m_videoProperties)
+           << quint32(m_subtitleProperties);
+
+    stream << quint16(m_year) << quint16(m_partNumber) << quint16(m_partTotal)
+           << qint32(m_catType);
+
+    stream << quint32(m_recordedId) << m_inputName
+           << DateTimeToStreamInt(m_bookmarkUpdate);
+}
+
+/** \fn ProgramInfo::FromDataStream(QDataStream&)
+ *  \brief Initializes this ProgramInfo from the output of ToDataStream().
+ *  \return true if it succeeds, false if the stream ended or is corrupt.
+ */
+bool ProgramInfo::FromDataStream(QDataStream &stream)
+{
+    uint      origChanid     = m_chanId;
+    QDateTime origRecstartts = m_recStartTs;
+
+    quint32 season {0};
+    quint32 episode {0};
+    quint32 totalEpisodes {0};
+    quint32 chanId {0};
+    quint64 fileSize {0};
+    qint64  startTs {0};
+    qint64  endTs {0};
+    quint32 findId {0};
+    quint32 sourceId {0};
+    quint32 inputId {0};
+    qint32  recPriority {0};
+    qint8   recStatus {0};
+    quint32 recordId {0};
+    quint8  recType {0};
+    quint8  dupIn {0};
+    quint8  dupMethod {0};
+    qint64  recStartTs {0};
+    qint64  recEndTs {0};
+    quint32 programFlags {0};
+    qint64  lastModified {0};
+    qint32  recPriority2 {0};
+    quint32 parentId {0};
+    quint32 audioProperties {0};
+    quint32 videoProperties {0};
+    quint32 subtitleProperties {0};
+    quint16 year {0};
+    quint16 partNumber {0};
+    quint16 partTotal {0};
+    qint32  catType {0};
+    quint32 recordedId {0};
+    qint64  bookmarkUpdate {0};
+
+    stream >> m_title >> m_subtitle >> m_description
+           >> season >> episode >> totalEpisodes >> m_syndicatedEpisode
+           >> m_category >> chanId >> m_chanStr >> m_chanSign
+           >> m_chanName >> m_pathname >> fileSize;
+
+    stream >> startTs >> endTs >> findId >> m_hostname >> sourceId
+           >> inputId >> recPriority >> recStatus >> recordId;
+
+    stream >> recType >> dupIn >> dupMethod >> recStartTs >> recEndTs
+           >> programFlags >> m_recGroup >> m_chanPlaybackFilters
+           >> m_seriesId >> m_programId >> m_inetRef;
+
+    stream >> lastModified >> m_stars >> m_originalAirDate >> m_playGroup
+           >> recPriority2 >> parentId >> m_storageGroup
+           >> audioProperties >> videoProperties >> subtitleProperties;
+
+    stream >> year >> partNumber >> partTotal >> catType;
+
+    stream >> recordedId >> m_inputName >> bookmarkUpdate;
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "FromDataStream, corrupt stream.");
+        clear();
+        return false;
+    }
+
+    m_season = season;
+    m_episode = episode;
+    m_totalEpisodes = totalEpisodes;
+    m_chanId = chanId;
+    m_fileSize = fileSize;
+
+    m_startTs = DateTimeFromStreamInt(startTs);
+    m_endTs = DateTimeFromStreamInt(endTs);
+    m_findId = findId;
+    m_sourceId = sourceId;
+    m_inputId = inputId;
+    m_recPriority = recPriority;
+    m_recStatus = (RecStatus::Type)recStatus;
+    m_recordId = recordId;
+
+    m_recType = (RecordingType)recType;
+    m_dupIn = (RecordingDupInType)dupIn;
+    m_dupMethod = (RecordingDupMethodType)dupMethod;
+    m_recStartTs = DateTimeFromStreamInt(recStartTs);
+    m_recEndTs = DateTimeFromStreamInt(recEndTs);
+    m_programFlags = programFlags;
+
+    m_lastModified = DateTimeFromStreamInt(lastModified);
+    m_recPriority2 = recPriority2;
+    m_parentId = parentId;
+    m_audioProperties = audioProperties;
+    m_videoProperties = videoProperties;
+    m_subtitleProperties = subtitleProperties;
+
+    m_year = year;
+    m_partNumber = partNumber;
+    m_partTotal = partTotal;
+    m_catType = (CategoryType)catType;
+
+    m_recordedId = recordedId;
+    m_bookmarkUpdate = DateTimeFromStreamInt(bookmarkUpdate);
+
+    if (!origChanid || !origRecstartts.isValid() ||
+        (origChanid != m_chanId) || (origRecstartts != m_recStartTs))
+    {
+        m_availableStatus = asAvailable;
+        m_spread = -1;
+        m_startCol = -1;
+        m_inUseForWhat = QString();
+        m_positionMapDBReplacement = nullptr;
+    }
+
+    ensureSortFields();
+
+    return true;
+}
+
 template <typename T>
 QString propsValueToString (const QString& name, QMap<T,QString> propNames,
                             T props)
@@ -3771,6 +3947,10 @@ void ProgramInfo::QueryPositionMap(
         return;
     }
 
+    QString seekIndex = GetSeekIndexFilename();
+    if (!seekIndex.isEmpty() && SeekIndexFile(seekIndex).Read(type, posMap))
+        return;
+
     posMap.clear();
     MSqlQuery query(MSqlQuery::InitCon());
 
@@ -3815,6 +3995,12 @@ void ProgramInfo::ClearPositionMap(MarkTypes type) const
         return;
     }
 
+    // Clear both, the seek table may still be in the database if the
+    // recording was made before seek index files were enabled.
+    QString seekIndex = GetSeekIndexFilename();
+    if (!seekIndex.isEmpty())
+        SeekIndexFile(seekIndex).Clear(type);
+
     MSqlQuery query(MSqlQuery::InitCon());
 
     if (IsVideo())
@@ -3890,6 +4076,13 @@ void ProgramInfo::SavePositionMap(
         return;
     }
 
+    QString seekIndex = GetSeekIndexFilename();
+    if (!seekIndex.isEmpty() &&
+        SeekIndexFile(seekIndex).Replace(type, posMap, min_frame, max_frame))
+    {
+        return;
+    }
+
     MSqlQuery query(MSqlQuery::InitCon());
     QString comp;
 
@@ -4004,6 +4197,10 @@ void ProgramInfo::SavePositionMapDelta(
         return;
     }
 
+    QString seekIndex = GetSeekIndexFilename();
+    if (!seekIndex.isEmpty() && SeekIndexFile(seekIndex).Append(type, posMap))
+        return;
+
     // Use the multi-value insert syntax to reduce database I/O
     QStringList q("INSERT INTO ");
     QString qfields;
@@ -4055,6 +4252,114 @@ void ProgramInfo::SavePositionMapDelta(
     }
 }
 
+/** \brief Returns the path of the seek index file for this recording,
+ *         or an empty string if seek index files are not enabled.
+ *
+ *  Recordings that are not available locally get a myth:// URL, their
+ *  index can be read through the backend but not modified, so position
+ *  map updates for them go to the database.
+ *  \sa SeekIndexFile
+ */
+QString ProgramInfo::GetSeekIndexFilename(void) const
+{
+    if (!IsRecording() || !gCoreContext->GetBoolSetting("SeekIndexFiles", false))
+        return {};
+
+    QString path = m_pathname;
+    if (!path.startsWith('/'))
+    {
+        // The keyframe queries call this for every seek, remember where
+        // FindFile() found the recording rather than searching again.
+        static QMutex s_pathLock;
+        static QHash<QString, std::pair<QString, std::chrono::seconds>> s_paths;
+        static constexpr std::chrono::seconds kRecheckMissing { 60s };
+
+        QString key = m_storageGroup + '/' + GetBasename();
+        auto now = nowAsDuration<std::chrono::seconds>();
+        QMutexLocker locker(&s_pathLock);
+        auto it = s_paths.constFind(key);
+        if (it != s_paths.constEnd() &&
+            (!it->first.isEmpty() || now - it->second < kRecheckMissing))
+        {
+            path = it->first;
+        }
+        else
+        {
+            StorageGroup sgroup(m_storageGroup);
+            path = sgroup.FindFile(GetBasename());
+            if (s_paths.size() > 1000)
+                s_paths.clear();
+            s_paths.insert(key, { path, now });
+        }
+
+        if (path.isEmpty())
+        {
+            if (m_pathname.startsWith("myth://"))
+                return m_pathname + SeekIndexFile::Extension();
+            return MythCoreContext::GenMythURL(
+                m_hostname, 0, GetBasename() + SeekIndexFile::Extension(),
+                m_storageGroup);
+        }
+    }
+
+    return path + SeekIndexFile::Extension();
+}
+
+/** \brief Moves the seek table of this recording from the recordedseek
+ *         table into its seek index file.
+ */
+bool ProgramInfo::MigratePositionMapToSeekIndex(void) const
+{
+    QString filename = GetSeekIndexFilename();
+    if (filename.isEmpty())
+        return false;
+
+    SeekIndexFile seekIndex(filename);
+    if (!seekIndex.IsLocal())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "Seek index files can only be created for local recordings");
+        return false;
+    }
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT type, mark, `offset` FROM recordedseek"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME ;");
+    query.bindValue(":CHANID", m_chanId);
+    query.bindValue(":STARTTIME", m_recStartTs);
+    if (!query.exec())
+    {
+        MythDB::DBError("MigratePositionMapToSeekIndex", query);
+        return false;
+    }
+
+    seek_index_map_t maps;
+    while (query.next())
+    {
+        maps[query.value(0).toInt()][query.value(1).toLongLong()] =
+            query.value(2).toLongLong();
+    }
+    if (maps.isEmpty())
+        return true;
+
+    if (!seekIndex.Write(maps))
+        return false;
+
+    query.prepare("DELETE FROM recordedseek"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME ;");
+    query.bindValue(":CHANID", m_chanId);
+    query.bindValue(":STARTTIME", m_recStartTs);
+    if (!query.exec())
+    {
+        MythDB::DBError("MigratePositionMapToSeekIndex delete", query);
+        return false;
+    }
+
+    return true;
+}
+
 static const char *from_filemarkup_offset_asc =
     "SELECT mark, `offset` FROM filemarkup"
     " WHERE filename = :PATH"
@@ -4112,11 +4417,22 @@ bool ProgramInfo::QueryKeyFrameInfo(uint64_t * result,
                                     uint64_t position_or_keyframe,
                                     bool backwards,
                                     MarkTypes type,
+                                    bool by_offset,
                                     const char *from_filemarkup_asc,
                                     const char *from_filemarkup_desc,
                                     const char *from_recordedseek_asc,
                                     const char *from_recordedseek_desc) const
 {
+    QString seekIndex = GetSeekIndexFilename();
+    bool found = false;
+    if (!seekIndex.isEmpty() &&
+        SeekIndexFile(seekIndex).Find(
+            type, by_offset ? SeekIndexFile::kByOffset : SeekIndexFile::kByFrame,
+            position_or_keyframe, backwards, found, *result))
+    {
+        return found;
+    }
+
     MSqlQuery query(MSqlQuery::InitCon());
 
     if (IsVideo())
@@ -4191,6 +4507,7 @@ bool ProgramInfo::QueryPositionKeyFrame(uint64_t *keyframe, uint64_t position,
                                         bool backwards) const
 {
    return QueryKeyFrameInfo(keyframe, position, backwards, MARK_GOP_BYFRAME,
+                            true,
                             from_filemarkup_mark_asc,
                             from_filemarkup_mark_desc,
                             from_recordedseek_mark_asc,
@@ -4200,6 +4517,7 @@ bool ProgramInfo::QueryKeyFramePosition(uint64_t *position, uint64_t keyframe,
                                         bool backwards) const
 {
    return QueryKeyFrameInfo(position, keyframe, backwards, MARK_GOP_BYFRAME,
+                            false,
                             from_filemarkup_offset_asc,
                             from_filemarkup_offset_desc,
                             from_recordedseek_offset_asc,
@@ -4209,6 +4527,7 @@ bool ProgramInfo::QueryDurationKeyFrame(uint64_t *keyframe, uint64_t duration,
                                         bool backwards) const
 {
    return QueryKeyFrameInfo(keyframe, duration, backwards, MARK_DURATION_MS,
+                            true,
                             from_filemarkup_mark_asc,
                             from_filemarkup_mark_desc,
                             from_recordedseek_mark_asc,
@@ -4218,6 +4537,7 @@ bool ProgramInfo::QueryKeyFrameDuration(uint64_t *duration, uint64_t keyframe,
                                         bool backwards) const
 {
    return QueryKeyFrameInfo(duration, keyframe, backwards, MARK_DURATION_MS,
+                            false,
                             from_filemarkup_offset_asc,
                             from_filemarkup_offset_desc,
                             from_recordedseek_offset_asc,
@@ -5528,6 +5848,7 @@ QStringList ProgramInfo::LoadFromScheduler(
         (tmptable.isEmpty()) ?
         QString("QUERY_GETALLPENDING") :
         QString("QUERY_GETALLPENDING %1 %2").arg(tmptable).arg(recordid));
+    slist.push_back(kProgramListBinary);
 
     if (!gCoreContext->SendReceiveStringList(slist) || slist.size() < 2)
     {
@@ -6246,6 +6567,93 @@ bool LoadFromRecorded(
     return true;
 }
 
+ProgramListWriter::ProgramListWriter(QStringList &list, bool binary) :
+    m_list(list), m_binary(binary)
+{
+    if (m_binary)
+        m_list << kProgramListBinary;
+}
+
+ProgramListWriter::~ProgramListWriter()
+{
+    Flush();
+}
+
+void ProgramListWriter::Add(const ProgramInfo &pginfo)
+{
+    if (!m_binary)
+    {
+        pginfo.ToStringList(m_list);
+        return;
+    }
+
+    if (!m_stream)
+    {
+        m_stream = new QDataStream(&m_chunk, QIODevice::WriteOnly);
+        m_stream->setVersion(QDataStream::Qt_5_12);
+    }
+    pginfo.ToDataStream(*m_stream);
+
+    if (++m_count >= kChunkSize)
+        Flush();
+}
+
+/// Compresses the programs added since the last call into one list item.
+/// Each chunk can be decoded on its own, so the reader never needs to
+/// hold more than one uncompressed chunk in memory.
+void ProgramListWriter::Flush(void)
+{
+    if (!m_stream)
+        return;
+
+    delete m_stream;
+    m_stream = nullptr;
+    m_list << QString::fromLatin1(qCompress(m_chunk, 1).toBase64());
+    m_chunk.clear();
+    m_count = 0;
+}
+
+bool IsBinaryProgramList(const QStringList &list, int offset, uint count)
+{
+    uint chunks = (count + ProgramListWriter::kChunkSize - 1) /
+        ProgramListWriter::kChunkSize;
+    return (list.size() == offset + 1 + static_cast<int>(chunks)) &&
+        (list[offset] == kProgramListBinary);
+}
+
+bool LoadFromBinaryProgramList(
+    std::vector<ProgramInfo*> &destination,
+    const QStringList &list, int offset, uint count)
+{
+    bool ok = true;
+    size_t start = destination.size();
+    for (int i = offset + 1; ok && i < list.size(); i++)
+    {
+        QByteArray chunk = qUncompress(
+            QByteArray::fromBase64(list[i].toLatin1()));
+        QDataStream stream(chunk);
+        stream.setVersion(QDataStream::Qt_5_12);
+        while (ok && !stream.atEnd())
+        {
+            auto *pginfo = new ProgramInfo(stream);
+            ok = (stream.status() == QDataStream::Ok);
+            if (ok)
+                destination.push_back(pginfo);
+            else
+                delete pginfo;
+        }
+    }
+
+    if (!ok || destination.size() - start != count)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("LoadFromBinaryProgramList(): Expected %1 programs, "
+                    "got a corrupt list").arg(count));
+        return false;
+    }
+    return true;
+}
+
 bool GetNextRecordingList(QDateTime &nextRecordingStart,
                           bool *hasConflicts,
                           std::vector<ProgramInfo> *list)
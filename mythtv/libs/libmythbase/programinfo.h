@@ -5,6 +5,7 @@
 
 // ANSI C
 #include <cstdint> // for [u]int[32,64]_t
+#include <type_traits>
 #include <utility>
 #include <vector> // for GetNextRecordingList
 
@@ -27,6 +28,13 @@
 */
 static constexpr int8_t NUMPROGRAMLINES { 52 };
 
+/// Clients that can read the binary program list format written by
+/// ProgramListWriter add this as the second item of a QUERY_RECORDINGS,
+/// QUERY_GETALLPENDING, QUERY_GETALLSCHEDULED or QUERY_GETEXPIRING request.
+/// Backends that do not know it ignore it and reply with the text format.
+static constexpr const char *kProgramListBinary { "PROGRAMLIST_BINARY" };
+
+class QDataStream;
 class ProgramInfo;
 using ProgramList = AutoDeleteDeque<ProgramInfo*>;
 
@@ -295,6 +303,11 @@ class MBASE_PUBLIC ProgramInfo
         if (!FromStringList(it, list.end()))
             ProgramInfo::clear();
     }
+    explicit ProgramInfo(QDataStream &stream)
+    {
+        if (!FromDataStream(stream))
+            ProgramInfo::clear();
+    }
 
     bool operator==(const ProgramInfo& rhs);
     ProgramInfo &operator=(const ProgramInfo &other);
@@ -309,6 +322,7 @@ class MBASE_PUBLIC ProgramInfo
 
     // Serializers
     void ToStringList(QStringList &list) const;
+    void ToDataStream(QDataStream &stream) const;
     virtual void ToMap(InfoMap &progMap,
                        bool showrerecord = false,
                        uint star_range = 10,
@@ -671,11 +685,13 @@ class MBASE_PUBLIC ProgramInfo
     void SavePositionMap(frm_pos_map_t &posMap, MarkTypes type,
                          int64_t min_frame = -1, int64_t max_frame = -1) const;
     void SavePositionMapDelta(frm_pos_map_t &posMap, MarkTypes type) const;
+    QString GetSeekIndexFilename(void) const;
+    bool MigratePositionMapToSeekIndex(void) const;
 
     // Get position/duration for keyframe and vice versa
     bool QueryKeyFrameInfo(uint64_t *result, uint64_t position_or_keyframe,
-                           bool backwards,
-                           MarkTypes type, const char *from_filemarkup_asc,
+                           bool backwards, MarkTypes type, bool by_offset,
+                           const char *from_filemarkup_asc,
                            const char *from_filemarkup_desc,
                            const char *from_recordedseek_asc,
                            const char *from_recordedseek_desc) const;
@@ -749,6 +765,7 @@ class MBASE_PUBLIC ProgramInfo
 
     bool FromStringList(QStringList::const_iterator &it,
                         const QStringList::const_iterator&  end);
+    bool FromDataStream(QDataStream &stream);
 
     static void QueryMarkupMap(
         const QString &video_pathname,
@@ -908,6 +925,46 @@ MBASE_PUBLIC bool LoadFromRecorded(
     bool                ignoreLiveTV = false,
     bool                ignoreDeleted = false);
 
+/** \brief Writes the programs of a protocol reply, either with
+ *         ProgramInfo::ToStringList() or in the binary program list format.
+ *
+ *  The binary format starts with kProgramListBinary, followed by one item
+ *  for every kChunkSize programs. Each of those holds the programs written
+ *  with ProgramInfo::ToDataStream(), zlib compressed and base64 encoded.
+ *  The last chunk is written by Flush() or when the writer is destroyed.
+ */
+class MBASE_PUBLIC ProgramListWriter
+{
+  public:
+    static constexpr uint kChunkSize { 500 };
+
+    ProgramListWriter(QStringList &list, bool binary);
+    ~ProgramListWriter();
+
+    void Add(const ProgramInfo &pginfo);
+    void Flush(void);
+
+  private:
+    Q_DISABLE_COPY(ProgramListWriter)
+
+    QStringList &m_list;
+    bool         m_binary;
+    QByteArray   m_chunk;
+    QDataStream *m_stream {nullptr};
+    uint         m_count  {0};
+};
+
+/// Returns true if the count programs starting at list[offset] are in the
+/// binary program list format.
+MBASE_PUBLIC bool IsBinaryProgramList(
+    const QStringList &list, int offset, uint count);
+
+/// Reads a binary program list starting at list[offset] into destination.
+/// Returns false if the list is corrupt or does not hold count programs.
+MBASE_PUBLIC bool LoadFromBinaryProgramList(
+    std::vector<ProgramInfo*> &destination,
+    const QStringList &list, int offset, uint count);
+
 template<typename TYPE>
 bool LoadFromScheduler(
     AutoDeleteDeque<TYPE*> &destination,
@@ -924,6 +981,29 @@ bool LoadFromScheduler(
 
     hasConflicts = slist[0].toInt();
 
+    uint count = slist[1].toUInt();
+    if (IsBinaryProgramList(slist, 2, count))
+    {
+        std::vector<ProgramInfo*> progs;
+        bool ok = LoadFromBinaryProgramList(progs, slist, 2, count);
+        for (auto *pginfo : progs)
+        {
+            ok = ok && (pginfo->HasPathname() || pginfo->GetChanID());
+            if constexpr (std::is_same_v<TYPE,ProgramInfo>)
+            {
+                destination.push_back(pginfo);
+            }
+            else
+            {
+                destination.push_back(new TYPE(*pginfo));
+                delete pginfo;
+            }
+        }
+        if (!ok)
+            destination.clear();
+        return ok;
+    }
+
     QStringList::const_iterator sit = slist.cbegin()+2;
     while (sit != slist.cend())
     {
@@ -938,7 +1018,7 @@ bool LoadFromScheduler(
         }
     }
 
-    if (destination.size() != slist[1].toUInt())
+    if (destination.size() != count)
     {
         destination.clear();
         return false;
@@ -27,6 +27,7 @@ std::vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
         str += "Unsorted";
 
     QStringList strlist(str);
+    strlist << kProgramListBinary;
 
     auto *info = new std::vector<ProgramInfo *>;
 
@@ -165,12 +166,14 @@ bool RemoteUndeleteRecording(uint recordingID)
 void RemoteGetAllScheduledRecordings(std::vector<ProgramInfo *> &scheduledlist)
 {
     QStringList strList(QString("QUERY_GETALLSCHEDULED"));
+    strList << kProgramListBinary;
     RemoteGetRecordingList(scheduledlist, strList);
 }
 
 void RemoteGetAllExpiringRecordings(std::vector<ProgramInfo *> &expiringlist)
 {
     QStringList strList(QString("QUERY_GETEXPIRING"));
+    strList << kProgramListBinary;
     RemoteGetRecordingList(expiringlist, strList);
 }
 
@@ -184,6 +187,22 @@ uint RemoteGetRecordingList(
     if (numrecordings <= 0)
         return 0;
 
+    if (IsBinaryProgramList(strList, 1, numrecordings))
+    {
+        uint reclist_initial_size = (uint) reclist.size();
+        if (!LoadFromBinaryProgramList(reclist, strList, 1, numrecordings))
+        {
+            // Don't hand back part of a corrupt list.
+            for (auto it = reclist.begin() + reclist_initial_size;
+                 it != reclist.end(); ++it)
+                delete *it;
+            reclist.erase(reclist.begin() + reclist_initial_size,
+                          reclist.end());
+            return 0;
+        }
+        return ((uint) reclist.size()) - reclist_initial_size;
+    }
+
     if (numrecordings * NUMPROGRAMLINES + 1 > strList.size())
     {
         LOG(VB_GENERAL, LOG_ERR,
@@ -533,6 +552,7 @@ std::vector<ProgramInfo *> *RemoteGetCurrentlyRecordingList(void)
     QString str = "QUERY_RECORDINGS ";
     str += "Recording";
     QStringList strlist( str );
+    strlist << kProgramListBinary;
 
     auto *reclist = new std::vector<ProgramInfo *>;
     auto *info = new std::vector<ProgramInfo *>;
@@ -0,0 +1,646 @@
+// C++ headers
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Qt headers
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QMutex>
+#include <QRandomGenerator>
+#include <QSaveFile>
+
+// zlib
+#include <zlib.h>
+
+// MythTV headers
+#include "mythchrono.h"
+#include "mythlogging.h"
+#include "remotefile.h"
+#include "seekindexfile.h"
+
+#define LOC QString("SeekIndex(%1): ").arg(m_filename)
+
+static constexpr std::array<char,8> kSeekIndexMagic
+    { 'M', 'Y', 'T', 'H', 'S', 'I', 'D', 'X' };
+static constexpr uint8_t  kSeekIndexVersion       { 2 };
+static constexpr qint64   kSeekIndexHeaderSize    { 16 };
+static constexpr qint64   kSeekIndexGenerationPos { 12 };
+static constexpr qint64   kChunkHeaderSize        { 8 };
+static constexpr uint32_t kMaxChunkSize           { 64 * 1024 * 1024 };
+static constexpr int      kMaxCachedIndexes       { 8 };
+static constexpr std::chrono::milliseconds kLockTimeout   { 10s };
+static constexpr std::chrono::milliseconds kRemoteRecheck { 5s };
+
+using sorted_index_t = std::vector<std::pair<int64_t,int64_t>>;
+
+/// Decoded contents of one seek index file, see SeekIndexFile::Load().
+struct SeekIndexFile::CachedIndex
+{
+    bool             m_valid      { false };
+    bool             m_decoded    { false }; ///< m_maps holds the entries
+    uint32_t         m_generation { 0 };
+    qint64           m_end        { 0 };     ///< end of the last good chunk
+    quint64          m_used       { 0 };
+    std::chrono::milliseconds m_checked { 0ms };
+    seek_index_map_t          m_maps;
+    QMap<int, sorted_index_t> m_sorted;      ///< built on demand by Find()
+};
+
+static QMutex  s_cacheLock;
+static quint64 s_cacheClock { 0 }; // protected by s_cacheLock
+
+QHash<QString, SeekIndexFile::CachedIndex> &SeekIndexFile::Cache(void)
+{
+    static QHash<QString, CachedIndex> s_cache; // protected by s_cacheLock
+    return s_cache;
+}
+
+static void put_le32(QByteArray &buf, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i, value >>= 8)
+        buf.append(static_cast<char>(value & 0xff));
+}
+
+static uint32_t get_le32(const unsigned char *data)
+{
+    return static_cast<uint32_t>(data[0])        |
+           (static_cast<uint32_t>(data[1]) << 8)  |
+           (static_cast<uint32_t>(data[2]) << 16) |
+           (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static void put_varint(QByteArray &buf, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buf.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buf.append(static_cast<char>(value));
+}
+
+static void put_svarint(QByteArray &buf, int64_t value)
+{
+    put_varint(buf, (static_cast<uint64_t>(value) << 1) ^
+                    static_cast<uint64_t>(value >> 63));
+}
+
+static bool get_varint(const unsigned char *&pos, const unsigned char *end,
+                       uint64_t &value)
+{
+    value = 0;
+    for (uint shift = 0; pos < end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static bool get_svarint(const unsigned char *&pos, const unsigned char *end,
+                        int64_t &value)
+{
+    uint64_t raw = 0;
+    if (!get_varint(pos, end, raw))
+        return false;
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+static uint32_t chunk_crc(const unsigned char *data, uint32_t size)
+{
+    return crc32(crc32(0L, Z_NULL, 0), data, size);
+}
+
+/// Returns a new file header with a random generation number.
+static QByteArray header(void)
+{
+    QByteArray buf(kSeekIndexMagic.data(), kSeekIndexMagic.size());
+    buf.append(static_cast<char>(kSeekIndexVersion));
+    buf.append(kSeekIndexGenerationPos - buf.size(), '\0');
+    put_le32(buf, QRandomGenerator::global()->generate());
+    return buf;
+}
+
+static void encode_chunk(QByteArray &buf, int type, const frm_pos_map_t &posMap)
+{
+    if (posMap.isEmpty())
+        return;
+
+    QByteArray payload;
+    payload.append(static_cast<char>(type));
+    put_varint(payload, posMap.size());
+
+    auto it = posMap.cbegin();
+    int64_t frame  = it.key();
+    int64_t offset = *it;
+    put_varint(payload, frame);
+    put_varint(payload, offset);
+    for (++it; it != posMap.cend(); ++it)
+    {
+        put_svarint(payload, it.key() - frame);
+        put_svarint(payload, *it - offset);
+        frame  = it.key();
+        offset = *it;
+    }
+
+    put_le32(buf, payload.size());
+    put_le32(buf, chunk_crc(reinterpret_cast<const unsigned char*>(
+                                payload.constData()), payload.size()));
+    buf.append(payload);
+}
+
+static bool decode_chunk(const unsigned char *pos, const unsigned char *end,
+                         int &type, frm_pos_map_t &posMap)
+{
+    if (pos >= end)
+        return false;
+
+    type = *pos++;
+    uint64_t count  = 0;
+    uint64_t frame  = 0;
+    uint64_t offset = 0;
+    if (!get_varint(pos, end, count) || !count ||
+        !get_varint(pos, end, frame) || !get_varint(pos, end, offset))
+    {
+        return false;
+    }
+
+    auto f = static_cast<int64_t>(frame);
+    auto o = static_cast<int64_t>(offset);
+    posMap.insert(f, o);
+    for (uint64_t i = 1; i < count; ++i)
+    {
+        int64_t df = 0;
+        int64_t dof = 0;
+        if (!get_svarint(pos, end, df) || !get_svarint(pos, end, dof))
+            return false;
+        f += df;
+        o += dof;
+        posMap.insert(f, o);
+    }
+
+    return pos == end;
+}
+
+bool SeekIndexFile::Exists(void) const
+{
+    if (!IsLocal())
+        return RemoteFile::Exists(m_filename);
+    return QFileInfo::exists(m_filename);
+}
+
+/** \brief Checks the chunks in \a data and, if \a decode is set, merges
+ *         their entries into \a index.
+ *  \return The number of bytes up to the first short or corrupt chunk.
+ */
+qint64 SeekIndexFile::Decode(const unsigned char *data, qint64 size,
+                             CachedIndex &index, bool decode) const
+{
+    qint64 pos = 0;
+    while (size - pos >= kChunkHeaderSize)
+    {
+        uint32_t length = get_le32(data + pos);
+        uint32_t crc    = get_le32(data + pos + 4);
+        if (length > kMaxChunkSize)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("Corrupt chunk at offset %1").arg(index.m_end + pos));
+            break;
+        }
+        if (size - pos - kChunkHeaderSize < length)
+            break; // Partially written chunk at the end of a growing file.
+
+        const unsigned char *payload = data + pos + kChunkHeaderSize;
+        if (chunk_crc(payload, length) != crc)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("Bad checksum at offset %1").arg(index.m_end + pos));
+            break;
+        }
+
+        if (decode)
+        {
+            int type = -1;
+            frm_pos_map_t entries;
+            if (!decode_chunk(payload, payload + length, type, entries))
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    QString("Undecodable chunk at offset %1")
+                    .arg(index.m_end + pos));
+                break;
+            }
+
+            frm_pos_map_t &dst = index.m_maps[type];
+            if (dst.isEmpty())
+                dst = entries;
+            else
+            {
+                for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+                    dst.insert(it.key(), *it);
+            }
+            index.m_sorted.remove(type);
+        }
+
+        pos += kChunkHeaderSize + length;
+    }
+
+    return pos;
+}
+
+/** \brief Brings \a index up to date with the file, decoding only the
+ *         chunks appended since it was last refreshed.
+ *  \return false if there is no usable seek index file.
+ */
+bool SeekIndexFile::Refresh(CachedIndex &index, bool decode) const
+{
+    auto now = nowAsDuration<std::chrono::milliseconds>();
+    if (!IsLocal() && (now - index.m_checked < kRemoteRecheck) &&
+        (!index.m_valid || index.m_decoded || !decode))
+    {
+        return index.m_valid;
+    }
+    index.m_checked = now;
+    index.m_valid = false;
+
+    QFile file(m_filename);
+    std::unique_ptr<RemoteFile> remote;
+    QByteArray head;
+    qint64 size = 0;
+    if (IsLocal())
+    {
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+        size = file.size();
+        head = file.read(kSeekIndexHeaderSize);
+    }
+    else
+    {
+        remote = std::make_unique<RemoteFile>(m_filename, false, false);
+        if (!remote->isOpen())
+            return false;
+        size = remote->GetFileSize();
+        head.resize(kSeekIndexHeaderSize);
+        if (remote->Read(head.data(), head.size()) != head.size())
+            return false;
+    }
+
+    const auto *hdr = reinterpret_cast<const unsigned char*>(head.constData());
+    if (head.size() < kSeekIndexHeaderSize ||
+        memcmp(hdr, kSeekIndexMagic.data(), kSeekIndexMagic.size()) != 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Not a seek index file");
+        return false;
+    }
+    if (hdr[kSeekIndexMagic.size()] != kSeekIndexVersion)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unsupported version %1")
+            .arg(static_cast<int>(hdr[kSeekIndexMagic.size()])));
+        return false;
+    }
+
+    // Start over if the file was rewritten or truncated since last time.
+    uint32_t generation = get_le32(hdr + kSeekIndexGenerationPos);
+    if (index.m_generation != generation || index.m_end == 0 ||
+        index.m_end > size || (decode && !index.m_decoded))
+    {
+        index.m_generation = generation;
+        index.m_end = kSeekIndexHeaderSize;
+        index.m_decoded = decode;
+        index.m_maps.clear();
+        index.m_sorted.clear();
+    }
+    index.m_valid = true;
+
+    if (size == index.m_end)
+        return true;
+
+    QByteArray buf;
+    const unsigned char *data = nullptr;
+    qint64 length = size - index.m_end;
+    if (IsLocal())
+    {
+        data = file.map(index.m_end, length);
+        if (!data && file.seek(index.m_end))
+        {
+            buf = file.read(length);
+            length = buf.size();
+            data = reinterpret_cast<const unsigned char*>(buf.constData());
+        }
+    }
+    else if (remote->Seek(index.m_end, SEEK_SET) == index.m_end)
+    {
+        buf.resize(static_cast<int>(length));
+        int got = remote->Read(buf.data(), buf.size());
+        length = std::max(got, 0);
+        data = reinterpret_cast<const unsigned char*>(buf.constData());
+    }
+
+    if (data)
+        index.m_end += Decode(data, length, index, index.m_decoded);
+    return true;
+}
+
+/** \brief Returns the cached index of this file, refreshed from disk.
+ *  \param decode  Whether the position maps are needed or only the
+ *                 extent of the valid chunks.
+ *  \note s_cacheLock must be held.
+ */
+SeekIndexFile::CachedIndex *SeekIndexFile::Load(bool decode) const
+{
+    QHash<QString, CachedIndex> &cache = Cache();
+    auto it = cache.find(m_filename);
+    if (it == cache.end())
+    {
+        if (cache.size() >= kMaxCachedIndexes)
+        {
+            auto oldest = std::min_element(cache.begin(), cache.end(),
+                [](const CachedIndex &a, const CachedIndex &b)
+                { return a.m_used < b.m_used; });
+            cache.erase(oldest);
+        }
+        it = cache.insert(m_filename, CachedIndex());
+    }
+    it->m_used = ++s_cacheClock;
+
+    if (Refresh(*it, decode))
+        return &*it;
+
+    // Remember failures for remote files so they are not retried on
+    // every lookup.
+    if (IsLocal())
+        cache.erase(it);
+    return nullptr;
+}
+
+void SeekIndexFile::Forget(void) const
+{
+    QMutexLocker locker(&s_cacheLock);
+    Cache().remove(m_filename);
+}
+
+/// \brief Takes the lock serialising writers across processes.
+bool SeekIndexFile::Lock(QLockFile &lock) const
+{
+    if (lock.tryLock(static_cast<int>(kLockTimeout.count())))
+        return true;
+    LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to lock: " +
+        QString::number(lock.error()));
+    return false;
+}
+
+bool SeekIndexFile::ReadAll(seek_index_map_t &maps) const
+{
+    maps.clear();
+
+    QMutexLocker locker(&s_cacheLock);
+    CachedIndex *index = Load(true);
+    if (!index)
+        return false;
+    maps = index->m_maps;
+    return true;
+}
+
+/** \brief Loads the position map of the given type.
+ *  \return false if there is no usable seek index file, in which case
+ *          the caller should fall back to the database.
+ */
+bool SeekIndexFile::Read(int type, frm_pos_map_t &posMap) const
+{
+    posMap.clear();
+
+    QMutexLocker locker(&s_cacheLock);
+    CachedIndex *index = Load(true);
+    if (!index)
+        return false;
+    posMap = index->m_maps.value(type);
+    return true;
+}
+
+/** \brief Binary searches the position map of the given type, like the
+ *         keyframe queries of ProgramInfo do on the recordedseek table.
+ *
+ *  Looks for the first entry at or after \a value, or the last entry at
+ *  or before it if \a backwards is set, falling back to the entry at the
+ *  other end of the map if there is none.  Searching by offset assumes
+ *  offsets grow with the frame number, as they do in all position maps.
+ *
+ *  \param found   Set if the map has any entries.
+ *  \param result  The offset of the entry, or its frame number when
+ *                 searching by offset.
+ *  \return false if there is no usable seek index file.
+ */
+bool SeekIndexFile::Find(int type, FindBy by, uint64_t value, bool backwards,
+                         bool &found, uint64_t &result) const
+{
+    found = false;
+
+    QMutexLocker locker(&s_cacheLock);
+    CachedIndex *index = Load(true);
+    if (!index)
+        return false;
+
+    auto sorted = index->m_sorted.find(type);
+    if (sorted == index->m_sorted.end())
+    {
+        const frm_pos_map_t posMap = index->m_maps.value(type);
+        sorted_index_t entries;
+        entries.reserve(posMap.size());
+        for (auto it = posMap.cbegin(); it != posMap.cend(); ++it)
+            entries.emplace_back(it.key(), *it);
+        sorted = index->m_sorted.insert(type, entries);
+    }
+
+    const sorted_index_t &entries = *sorted;
+    if (entries.empty())
+        return true;
+
+    auto key = [by](const std::pair<int64_t,int64_t> &e)
+        { return by == kByOffset ? e.second : e.first; };
+    auto target = static_cast<int64_t>(value);
+    sorted_index_t::const_iterator it;
+    if (backwards)
+    {
+        it = std::upper_bound(entries.cbegin(), entries.cend(), target,
+            [&key](int64_t v, const auto &e) { return v < key(e); });
+        if (it != entries.cbegin())
+            --it;
+    }
+    else
+    {
+        it = std::lower_bound(entries.cbegin(), entries.cend(), target,
+            [&key](const auto &e, int64_t v) { return key(e) < v; });
+        if (it == entries.cend())
+            --it;
+    }
+
+    found = true;
+    result = (by == kByOffset) ? it->first : it->second;
+    return true;
+}
+
+/** \brief Appends the entries of \a posMap, as done while recording.
+ *
+ *  A short or corrupt chunk left by a writer that died part way through
+ *  is truncated first.
+ */
+bool SeekIndexFile::Append(int type, const frm_pos_map_t &posMap) const
+{
+    if (posMap.isEmpty())
+        return true;
+    if (!IsLocal())
+        return false;
+
+    QLockFile lock(m_filename + ".lock");
+    if (!Lock(lock))
+        return false;
+
+    QMutexLocker locker(&s_cacheLock);
+    CachedIndex *index = Load(false);
+
+    QFile file(m_filename);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to open for append: " +
+            file.errorString());
+        return false;
+    }
+
+    QByteArray buf;
+    qint64 end = 0;
+    if (index)
+        end = index->m_end;
+    else
+        buf = header();
+
+    if (file.size() > end)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Truncating from %1 to %2 bytes")
+            .arg(file.size()).arg(end));
+        if (!file.resize(end))
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to truncate: " +
+                file.errorString());
+            return false;
+        }
+    }
+
+    encode_chunk(buf, type, posMap);
+    if (!file.seek(end) || file.write(buf) != buf.size() || !file.flush())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to append: " +
+            file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/// \brief Rewrites the whole file, one chunk per mark type.
+bool SeekIndexFile::Write(const seek_index_map_t &maps) const
+{
+    if (!IsLocal())
+        return false;
+
+    QLockFile lock(m_filename + ".lock");
+    return Lock(lock) && WriteFile(maps);
+}
+
+/// \brief Writes \a maps to a temporary file and renames it into place.
+bool SeekIndexFile::WriteFile(const seek_index_map_t &maps) const
+{
+    QByteArray buf = header();
+    for (auto it = maps.cbegin(); it != maps.cend(); ++it)
+        encode_chunk(buf, it.key(), *it);
+
+    QSaveFile file(m_filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(buf) != buf.size() ||
+        !file.commit())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to write: " +
+            file.errorString());
+        return false;
+    }
+
+    Forget();
+    return true;
+}
+
+/** \brief Replaces the entries of one type between \a min_frame and
+ *         \a max_frame, or all of them if both are negative, with
+ *         the matching entries in \a posMap.
+ */
+bool SeekIndexFile::Replace(int type, const frm_pos_map_t &posMap,
+                            int64_t min_frame, int64_t max_frame) const
+{
+    if (!IsLocal())
+        return false;
+
+    QLockFile lock(m_filename + ".lock");
+    if (!Lock(lock))
+        return false;
+
+    seek_index_map_t maps;
+    if (Exists())
+        ReadAll(maps);
+
+    auto in_range = [min_frame, max_frame](int64_t frame)
+    {
+        return ((min_frame < 0) || (frame >= min_frame)) &&
+               ((max_frame < 0) || (frame <= max_frame));
+    };
+
+    frm_pos_map_t &dst = maps[type];
+    for (auto it = dst.begin(); it != dst.end(); )
+        it = in_range(it.key()) ? dst.erase(it) : ++it;
+    for (auto it = posMap.cbegin(); it != posMap.cend(); ++it)
+        if (in_range(it.key()))
+            dst.insert(it.key(), *it);
+
+    return WriteFile(maps);
+}
+
+bool SeekIndexFile::Clear(int type) const
+{
+    if (!IsLocal())
+        return false;
+
+    QLockFile lock(m_filename + ".lock");
+    if (!Lock(lock))
+        return false;
+
+    if (!Exists())
+        return true;
+
+    seek_index_map_t maps;
+    ReadAll(maps);
+    if (!maps.contains(type))
+        return true;
+    maps.remove(type);
+    if (!maps.isEmpty())
+        return WriteFile(maps);
+
+    Forget();
+    return QFile::remove(m_filename);
+}
+
+bool SeekIndexFile::Remove(void) const
+{
+    if (!IsLocal())
+        return false;
+
+    QLockFile lock(m_filename + ".lock");
+    if (!Lock(lock))
+        return false;
+
+    Forget();
+    return !Exists() || QFile::remove(m_filename);
+}
@@ -0,0 +1,91 @@
+#ifndef SEEKINDEXFILE_H
+#define SEEKINDEXFILE_H
+
+#include <cstdint>
+#include <utility>
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+
+class QLockFile;
+
+#include "mythbaseexp.h"
+#include "programtypes.h"
+
+using seek_index_map_t = QMap<int, frm_pos_map_t>;
+
+/** \class SeekIndexFile
+ *  \brief Compact binary sidecar file holding the position maps
+ *         (seek table) of a recording.
+ *
+ *  The file lives next to the recording as "<recording>.seekidx" and
+ *  is an alternative to one recordedseek row per keyframe.  It starts
+ *  with a 16 byte header (magic, version and a generation number that
+ *  changes whenever the file is rewritten) followed by any number of
+ *  chunks, each of which holds the entries saved by one call to Append():
+ *
+ *    uint32 payload length, uint32 CRC-32 of the payload  (little endian)
+ *    uint8  mark type
+ *    varint entry count
+ *    varint first frame, varint first offset
+ *    zigzag varint frame delta, zigzag varint offset delta  (repeated)
+ *
+ *  Chunks are self contained so the recorder can append to the file
+ *  without knowing what was written before.  Readers stop at the first
+ *  short or corrupt chunk, which is how a chunk that is still being
+ *  written looks, and the next Append() truncates the file there.
+ *
+ *  Writers serialise on a lock file so several processes can update
+ *  the same index, and every rewrite goes to a temporary file that is
+ *  renamed into place.  Readers do not take the lock.
+ *
+ *  Decoded indexes of recently used files are cached per process and
+ *  only the chunks appended since the last lookup are decoded again.
+ *
+ *  A "myth://" URL may be used to read the index of a recording that
+ *  is not stored locally, such files can not be modified.
+ */
+class MBASE_PUBLIC SeekIndexFile
+{
+  public:
+    /// Column of the position map Find() searches.
+    enum FindBy : std::uint8_t
+    {
+        kByFrame,       ///< search on frame number, return the offset
+        kByOffset,      ///< search on offset, return the frame number
+    };
+
+    explicit SeekIndexFile(QString filename) : m_filename(std::move(filename)) {}
+
+    static QString Extension(void) { return ".seekidx"; }
+
+    bool IsLocal(void) const { return !m_filename.startsWith("myth://"); }
+    bool Exists(void) const;
+    bool Read(int type, frm_pos_map_t &posMap) const;
+    bool ReadAll(seek_index_map_t &maps) const;
+    bool Find(int type, FindBy by, uint64_t value, bool backwards,
+              bool &found, uint64_t &result) const;
+    bool Append(int type, const frm_pos_map_t &posMap) const;
+    bool Write(const seek_index_map_t &maps) const;
+    bool Replace(int type, const frm_pos_map_t &posMap,
+                 int64_t min_frame = -1, int64_t max_frame = -1) const;
+    bool Clear(int type) const;
+    bool Remove(void) const;
+
+  private:
+    struct CachedIndex;
+    static QHash<QString, CachedIndex> &Cache(void);
+
+    CachedIndex *Load(bool decode) const;
+    bool Refresh(CachedIndex &index, bool decode) const;
+    qint64 Decode(const unsigned char *data, qint64 size,
+                  CachedIndex &index, bool decode) const;
+    bool Lock(QLockFile &lock) const;
+    bool WriteFile(const seek_index_map_t &maps) const;
+    void Forget(void) const;
+
+    QString m_filename;
+};
+
+#endif // SEEKINDEXFILE_H
@@ -337,4 +337,21 @@ void TestLogging::test_logPropagateCalc (void)
     QCOMPARE(logPropagateArgs.trimmed(), expectedArgs);
 }
 
+void TestLogging::test_itemPool (void)
+{
+    LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__, __LINE__,
+                                            LOG_INFO, kMessage);
+    item->setMessage("first");
+    item->DecrRef();
+
+    // The released item is handed out again, without its old contents.
+    LoggingItem *reused = LoggingItem::create(__FILE__, __FUNCTION__, 42,
+                                              LOG_ERR, kMessage);
+    QCOMPARE(reused, item);
+    QVERIFY(reused->message().isEmpty());
+    QCOMPARE(reused->line(), 42);
+    QCOMPARE(reused->level(), static_cast<int>(LOG_ERR));
+    reused->DecrRef();
+}
+
 QTEST_APPLESS_MAIN(TestLogging)
@@ -48,4 +48,5 @@ private slots:
     static void test_verboseArgParse_level(void);
     static void test_logPropagateCalc_data(void);
     static void test_logPropagateCalc(void);
+    static void test_itemPool(void);
 };
@@ -0,0 +1,221 @@
+/*
+ *  Class TestMythSocketReactor
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <array>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "test_mythsocketreactor.h"
+
+#include "libmythbase/mythcorecontext.h"
+
+void TestSocketCBs::readyRead(MythSocket *socket)
+{
+    QStringList list;
+    if (!socket->ReadStringList(list))
+        return;
+    QMutexLocker locker(&m_lock);
+    m_messages += list;
+}
+
+QStringList TestSocketCBs::Messages(void)
+{
+    QMutexLocker locker(&m_lock);
+    return m_messages;
+}
+
+/// Returns a connected pair of descriptors, the first one to be used as
+/// the accepted socket and the second one as the peer.
+static std::array<int,2> socket_pair(void)
+{
+    std::array<int,2> fds {-1, -1};
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()) < 0)
+        return {-1, -1};
+    return fds;
+}
+
+static bool write_message(int fd, const QByteArray &utf8)
+{
+    QByteArray payload = QByteArray::number(utf8.size()).leftJustified(8, ' ');
+    payload += utf8;
+    return write(fd, payload.constData(), payload.size()) == payload.size();
+}
+
+/// Waits for the accepted end to be closed, which happens once the
+/// socket is deleted and no callback for it can run any more.
+static bool wait_for_eof(int fd)
+{
+    std::array<char,4096> buf {};
+    while (true)
+    {
+        struct pollfd pfd {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 5000) <= 0)
+            return false;
+        ssize_t got = read(fd, buf.data(), buf.size());
+        if (got == 0)
+            return true;
+        if (got < 0 && errno != EINTR && errno != EAGAIN)
+            return false;
+    }
+}
+
+void TestMythSocketReactor::initTestCase(void)
+{
+#ifndef __linux__
+    QSKIP("MythSocketReactor is only used on Linux");
+#endif
+    if (qEnvironmentVariableIsSet("MYTHTV_NOSOCKETREACTOR"))
+        QSKIP("MYTHTV_NOSOCKETREACTOR is set");
+
+    gCoreContext = new MythCoreContext("bin_version", nullptr);
+    QMap<QString,int> overrides { {"AllowConnFromAll", 1} };
+    gCoreContext->setTestIntSettings(overrides);
+}
+
+void TestMythSocketReactor::ConnectAndRead(void)
+{
+    auto fds = socket_pair();
+    QVERIFY(fds[0] >= 0);
+
+    TestSocketCBs cbs;
+    auto *socket = new MythSocket(fds[0], &cbs);
+    QVERIFY(socket->IsConnected());
+    QCOMPARE(cbs.m_connected.loadAcquire(), 1);
+
+    QVERIFY(write_message(fds[1], "QUERY_LOAD"));
+    QVERIFY(write_message(fds[1], "QUERY_UPTIME[]:[]1"));
+    QTRY_COMPARE_WITH_TIMEOUT(cbs.Messages().size(), 3, 5000);
+    QCOMPARE(cbs.Messages(), QStringList({"QUERY_LOAD", "QUERY_UPTIME", "1"}));
+
+    socket->DecrRef();
+    QVERIFY(wait_for_eof(fds[1]));
+    close(fds[1]);
+}
+
+void TestMythSocketReactor::WriteReply(void)
+{
+    auto fds = socket_pair();
+    QVERIFY(fds[0] >= 0);
+
+    auto *socket = new MythSocket(fds[0], nullptr);
+    QVERIFY(socket->WriteStringList({"OK", "42"}));
+
+    QByteArray expected("9       OK[]:[]42");
+    QByteArray got(expected.size(), '\0');
+    QCOMPARE(read(fds[1], got.data(), got.size()), ssize_t(expected.size()));
+    QCOMPARE(got, expected);
+
+    socket->DecrRef();
+    QVERIFY(wait_for_eof(fds[1]));
+    close(fds[1]);
+}
+
+void TestMythSocketReactor::PeerClose(void)
+{
+    auto fds = socket_pair();
+    QVERIFY(fds[0] >= 0);
+
+    TestSocketCBs cbs;
+    auto *socket = new MythSocket(fds[0], &cbs);
+
+    close(fds[1]);
+    QTRY_COMPARE_WITH_TIMEOUT(cbs.m_closed.loadAcquire(), 1, 5000);
+    QVERIFY(!socket->IsConnected());
+
+    QStringList list;
+    QVERIFY(!socket->ReadStringList(list, 100ms));
+
+    socket->DecrRef();
+}
+
+void TestMythSocketReactor::PausedPeerClose(void)
+{
+    auto fds = socket_pair();
+    QVERIFY(fds[0] >= 0);
+
+    TestSocketCBs cbs;
+    auto *socket = new MythSocket(fds[0], &cbs);
+    socket->SetReadyReadCallbackEnabled(false);
+
+    // Nobody reads, fill the socket until the reactor stops reading it.
+    int flags = fcntl(fds[1], F_GETFL);
+    QVERIFY(fcntl(fds[1], F_SETFL, flags | O_NONBLOCK) == 0);
+    QByteArray chunk(64 * 1024, 'x');
+    qint64 total = 0;
+    QElapsedTimer blocked;
+    while (total < 64LL * 1024 * 1024)
+    {
+        ssize_t sent = write(fds[1], chunk.constData(), chunk.size());
+        if (sent > 0)
+        {
+            total += sent;
+            blocked.invalidate();
+            continue;
+        }
+        QVERIFY(errno == EAGAIN || errno == EWOULDBLOCK);
+        if (!blocked.isValid())
+            blocked.start();
+        else if (blocked.elapsed() > 500)
+            break;
+        QTest::qWait(10);
+    }
+    QVERIFY(total > 4LL * 1024 * 1024);
+    QVERIFY(total < 64LL * 1024 * 1024);
+
+    // The reactor must still see the connection close.
+    close(fds[1]);
+    QTRY_COMPARE_WITH_TIMEOUT(cbs.m_closed.loadAcquire(), 1, 5000);
+
+    socket->DecrRef();
+}
+
+void TestMythSocketReactor::Teardown(void)
+{
+    std::array<std::array<int,2>,8> pairs {};
+    std::array<MythSocket*,8> sockets {};
+    TestSocketCBs cbs;
+
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        pairs[i] = socket_pair();
+        QVERIFY(pairs[i][0] >= 0);
+        sockets[i] = new MythSocket(pairs[i][0], &cbs);
+    }
+
+    // A message on the way while the sockets are deleted, the last one
+    // deleted stops the reactor threads.
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        QVERIFY(write_message(pairs[i][1], "QUERY_LOAD"));
+        sockets[i]->DecrRef();
+    }
+
+    for (auto fds : pairs)
+    {
+        QVERIFY(wait_for_eof(fds[1]));
+        close(fds[1]);
+    }
+
+    // A socket created afterwards starts the reactor again.
+    ConnectAndRead();
+}
+
+QTEST_GUILESS_MAIN(TestMythSocketReactor)
@@ -0,0 +1,57 @@
+/*
+ *  Class TestMythSocketReactor
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QMutex>
+
+#include "libmythbase/mythsocket.h"
+#include "libmythbase/mythsocket_cb.h"
+
+/// Records the callbacks of an accepted socket, reading each message
+/// from the readyRead() callback the way MainServer does.
+class TestSocketCBs : public MythSocketCBs
+{
+  public:
+    void connected(MythSocket */*socket*/) override { m_connected++; }
+    void readyRead(MythSocket *socket) override;
+    void connectionFailed(MythSocket */*socket*/) override {}
+    void connectionClosed(MythSocket */*socket*/) override { m_closed++; }
+
+    QStringList Messages(void);
+
+    QAtomicInt  m_connected {0};
+    QAtomicInt  m_closed    {0};
+
+  private:
+    QMutex      m_lock;
+    QStringList m_messages;
+};
+
+class TestMythSocketReactor: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    static void initTestCase(void);
+
+    static void ConnectAndRead(void);
+    static void WriteReply(void);
+    static void PeerClose(void);
+    static void PausedPeerClose(void);
+    static void Teardown(void);
+};
@@ -474,6 +474,60 @@ class TestProgramInfo : public QObject
         QVERIFY(m_supergirl23 == lrigrepus23c);
     }
 
+    void programBinaryList_test(void)
+    {
+        QStringList text_list;
+        {
+            ProgramListWriter writer(text_list, false);
+            writer.Add(m_dracula);
+        }
+        QVERIFY(text_list.join('|') == m_draculaList);
+        QVERIFY(!IsBinaryProgramList(text_list, 0, 1));
+
+        // Enough programs to fill more than one chunk
+        uint count = ProgramListWriter::kChunkSize + 2;
+        QStringList binary_list;
+        {
+            ProgramListWriter writer(binary_list, true);
+            for (uint i = 0; i < count; i++)
+            {
+                writer.Add(m_dracula);
+                writer.Add(m_flash34);
+            }
+            writer.Add(m_supergirl23);
+        }
+        count = (count * 2) + 1;
+        QCOMPARE(binary_list.size(), 4);
+        QVERIFY(IsBinaryProgramList(binary_list, 0, count));
+        QVERIFY(!IsBinaryProgramList(binary_list, 0, count + 500));
+
+        std::vector<ProgramInfo*> programs;
+        QVERIFY(LoadFromBinaryProgramList(programs, binary_list, 0, count));
+        QCOMPARE(programs.size(), static_cast<size_t>(count));
+
+        QStringList program_list;
+        programs[0]->ToStringList(program_list);
+        QVERIFY(program_list.join('|') == m_draculaList);
+        QVERIFY(m_dracula == *programs[0]);
+        program_list.clear();
+        programs[count - 2]->ToStringList(program_list);
+        QVERIFY(program_list.join('|') == m_flash34List);
+        program_list.clear();
+        programs[count - 1]->ToStringList(program_list);
+        QVERIFY(program_list.join('|') == m_supergirl23List);
+        QCOMPARE(programs[count - 1]->GetSortTitle(),
+                 m_supergirl23.GetSortTitle());
+        for (auto *pginfo : programs)
+            delete pginfo;
+        programs.clear();
+
+        // A damaged chunk must not be mistaken for a shorter list
+        binary_list[2] = binary_list[2].left(binary_list[2].size() / 2);
+        QVERIFY(!LoadFromBinaryProgramList(programs, binary_list, 0, count));
+        for (auto *pginfo : programs)
+            delete pginfo;
+    }
+
     void printList (const QStringList& list)
     {
         Q_UNUSED(list);
@@ -0,0 +1,257 @@
+/*
+ *  Class TestSeekIndexFile
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_seekindexfile.h"
+
+#include "libmythbase/seekindexfile.h"
+
+static frm_pos_map_t make_map(long long first, long long count)
+{
+    frm_pos_map_t posMap;
+    for (long long i = first; i < first + count; ++i)
+        posMap[i * 12] = i * 188 * 4000 + (i % 7) * 188;
+    return posMap;
+}
+
+void TestSeekIndexFile::initTestCase(void)
+{
+    QVERIFY(m_dir.isValid());
+}
+
+QString TestSeekIndexFile::Filename(const QString &name) const
+{
+    return m_dir.filePath(name + SeekIndexFile::Extension());
+}
+
+void TestSeekIndexFile::MissingFile(void)
+{
+    SeekIndexFile idx(Filename("missing"));
+    frm_pos_map_t posMap;
+    QVERIFY(!idx.Exists());
+    QVERIFY(!idx.Read(MARK_GOP_BYFRAME, posMap));
+    QVERIFY(posMap.isEmpty());
+}
+
+void TestSeekIndexFile::AppendAndRead(void)
+{
+    SeekIndexFile idx(Filename("append"));
+    frm_pos_map_t gops1 = make_map(0, 1000);
+    frm_pos_map_t gops2 = make_map(1000, 500);
+    frm_pos_map_t durations;
+    durations[0] = 0;
+    durations[12] = 480;
+    durations[24] = 960;
+
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, gops1));
+    QVERIFY(idx.Append(MARK_DURATION_MS, durations));
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, gops2));
+
+    frm_pos_map_t expected = gops1;
+    for (auto it = gops2.cbegin(); it != gops2.cend(); ++it)
+        expected[it.key()] = *it;
+
+    frm_pos_map_t posMap;
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QCOMPARE(posMap, expected);
+    QVERIFY(idx.Read(MARK_DURATION_MS, posMap));
+    QCOMPARE(posMap, durations);
+    QVERIFY(idx.Read(MARK_KEYFRAME, posMap));
+    QVERIFY(posMap.isEmpty());
+
+    // Much smaller than a row per keyframe.
+    QVERIFY(QFileInfo(Filename("append")).size() < 1500 * 8);
+}
+
+void TestSeekIndexFile::ReplaceRange(void)
+{
+    SeekIndexFile idx(Filename("replace"));
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(0, 100)));
+
+    frm_pos_map_t update;
+    update[120] = 1;
+    update[132] = 2;
+    update[2000] = 3; // outside of range, ignored
+    QVERIFY(idx.Replace(MARK_GOP_BYFRAME, update, 120, 240));
+
+    frm_pos_map_t posMap;
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QCOMPARE(posMap.size(), 100 - 11 + 2);
+    QCOMPARE(posMap.value(120), 1LL);
+    QCOMPARE(posMap.value(132), 2LL);
+    QVERIFY(!posMap.contains(144));
+    QVERIFY(!posMap.contains(2000));
+    QCOMPARE(posMap.value(252), make_map(21, 1).value(252));
+}
+
+void TestSeekIndexFile::ClearType(void)
+{
+    SeekIndexFile idx(Filename("clear"));
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(0, 10)));
+    QVERIFY(idx.Append(MARK_KEYFRAME, make_map(0, 10)));
+
+    QVERIFY(idx.Clear(MARK_GOP_BYFRAME));
+    frm_pos_map_t posMap;
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QVERIFY(posMap.isEmpty());
+    QVERIFY(idx.Read(MARK_KEYFRAME, posMap));
+    QCOMPARE(posMap.size(), 10);
+
+    QVERIFY(idx.Clear(MARK_KEYFRAME));
+    QVERIFY(!idx.Exists());
+}
+
+void TestSeekIndexFile::TruncatedChunk(void)
+{
+    QString name = Filename("truncated");
+    SeekIndexFile idx(name);
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(0, 50)));
+    qint64 size = QFileInfo(name).size();
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(50, 50)));
+
+    // Simulate a reader racing a recorder that is part way through
+    // appending the second chunk.
+    QVERIFY(QFile::resize(name, size + 10));
+
+    frm_pos_map_t posMap;
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QCOMPARE(posMap, make_map(0, 50));
+
+    // The next append replaces the partial chunk.
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(100, 50)));
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    frm_pos_map_t expected = make_map(0, 50);
+    frm_pos_map_t more = make_map(100, 50);
+    for (auto it = more.cbegin(); it != more.cend(); ++it)
+        expected[it.key()] = *it;
+    QCOMPARE(posMap, expected);
+}
+
+void TestSeekIndexFile::CorruptChunk(void)
+{
+    QString name = Filename("corrupt");
+    SeekIndexFile idx(name);
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(0, 50)));
+    qint64 size = QFileInfo(name).size();
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(50, 50)));
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(100, 50)));
+
+    // Flip a byte in the middle of the second chunk.
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(size + 20));
+    char byte = 0;
+    QVERIFY(file.getChar(&byte));
+    QVERIFY(file.seek(size + 20));
+    QVERIFY(file.putChar(static_cast<char>(byte ^ 0x55)));
+    file.close();
+
+    frm_pos_map_t posMap;
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QCOMPARE(posMap, make_map(0, 50));
+
+    // Appending truncates the file at the bad chunk.
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(200, 10)));
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    frm_pos_map_t expected = make_map(0, 50);
+    frm_pos_map_t more = make_map(200, 10);
+    for (auto it = more.cbegin(); it != more.cend(); ++it)
+        expected[it.key()] = *it;
+    QCOMPARE(posMap, expected);
+}
+
+void TestSeekIndexFile::Rewritten(void)
+{
+    QString name = Filename("rewritten");
+    SeekIndexFile idx(name);
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, make_map(0, 50)));
+
+    frm_pos_map_t posMap;
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QCOMPARE(posMap.size(), 50);
+
+    // A larger file written by another process must not be mistaken
+    // for the old one with more chunks appended.
+    QString other = Filename("rewritten_other");
+    seek_index_map_t maps;
+    maps[MARK_GOP_BYFRAME] = make_map(1000, 200);
+    QVERIFY(SeekIndexFile(other).Write(maps));
+    QVERIFY(QFile::remove(name));
+    QVERIFY(QFile::copy(other, name));
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QCOMPARE(posMap, maps[MARK_GOP_BYFRAME]);
+
+    // Chunks appended after the last read are picked up.
+    QVERIFY(SeekIndexFile(name).Append(MARK_GOP_BYFRAME, make_map(1200, 10)));
+    QVERIFY(idx.Read(MARK_GOP_BYFRAME, posMap));
+    QCOMPARE(posMap.size(), 210);
+    QVERIFY(!QFile::exists(name + ".lock"));
+}
+
+void TestSeekIndexFile::FindEntries(void)
+{
+    SeekIndexFile idx(Filename("find"));
+    frm_pos_map_t gops;
+    gops[0]  = 0;
+    gops[12] = 1000;
+    gops[24] = 2000;
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, gops));
+
+    bool found = false;
+    uint64_t result = 0;
+
+    // Frame to offset.
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByFrame, 12, false,
+                     found, result));
+    QVERIFY(found);
+    QCOMPARE(result, static_cast<uint64_t>(1000));
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByFrame, 13, false,
+                     found, result));
+    QCOMPARE(result, static_cast<uint64_t>(2000));
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByFrame, 13, true,
+                     found, result));
+    QCOMPARE(result, static_cast<uint64_t>(1000));
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByFrame, 30, false,
+                     found, result));
+    QCOMPARE(result, static_cast<uint64_t>(2000));
+
+    // Offset to frame.
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByOffset, 1500, false,
+                     found, result));
+    QCOMPARE(result, static_cast<uint64_t>(24));
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByOffset, 1500, true,
+                     found, result));
+    QCOMPARE(result, static_cast<uint64_t>(12));
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByOffset, 2000, true,
+                     found, result));
+    QCOMPARE(result, static_cast<uint64_t>(24));
+
+    // Entries appended later are searched too.
+    frm_pos_map_t more;
+    more[36] = 3000;
+    QVERIFY(idx.Append(MARK_GOP_BYFRAME, more));
+    QVERIFY(idx.Find(MARK_GOP_BYFRAME, SeekIndexFile::kByFrame, 30, false,
+                     found, result));
+    QCOMPARE(result, static_cast<uint64_t>(3000));
+
+    // A type without entries is found in the file but has no match.
+    QVERIFY(idx.Find(MARK_DURATION_MS, SeekIndexFile::kByFrame, 0, false,
+                     found, result));
+    QVERIFY(!found);
+}
+
+QTEST_APPLESS_MAIN(TestSeekIndexFile)
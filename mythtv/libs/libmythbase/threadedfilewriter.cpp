@@ -1,4 +1,6 @@
 // C++ headers
+#include <algorithm>
+#include <array>
 #include <cerrno>
 #include <csignal>
 #include <cstdio>
@@ -7,7 +9,11 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
 #include <unistd.h>
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
 
 // Qt headers
 #include <QString>
@@ -23,6 +29,33 @@
 
 #define LOC QString("TFW(%1:%2): ").arg(m_filename).arg(m_fd)
 
+/// \brief Message for the write errors that end writing to a file.
+static QString fatal_write_error(int err)
+{
+    switch (err)
+    {
+        case EFBIG:
+            return
+                "Maximum file size exceeded by '%1'"
+                "\n\t\t\t"
+                "You must either change the process ulimits, configure"
+                "\n\t\t\t"
+                "your operating system with \"Large File\" support, "
+                "or use"
+                "\n\t\t\t"
+                "a filesystem which supports 64-bit or 128-bit files."
+                "\n\t\t\t"
+                "HINT: FAT32 is a 32-bit filesystem.";
+        case ENOSPC:
+            return
+                "No space left on the device for file '%1'"
+                "\n\t\t\t"
+                "file will be truncated, no further writing "
+                "will be done.";
+    }
+    return {};
+}
+
 /// \brief Runs ThreadedFileWriter::DiskLoop(void)
 void TFWWriteThread::run(void)
 {
@@ -42,6 +75,10 @@ void TFWSyncThread::run(void)
 const uint ThreadedFileWriter::kMaxBufferSize   = 8 * 1024 * 1024;
 const uint ThreadedFileWriter::kMinWriteSize    = 64 * 1024;
 const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
+const uint ThreadedFileWriter::kRingSize        = 16 * 1024 * 1024;
+const uint ThreadedFileWriter::kMaxRingWrite    = 4 * 1024 * 1024;
+const uint ThreadedFileWriter::kDirectAlign     = 4 * 1024;
+const uint ThreadedFileWriter::kCacheKeep       = 8 * 1024 * 1024;
 
 /** \class ThreadedFileWriter
  *  \brief This class supports the writing of recordings to disk.
@@ -52,6 +89,13 @@ const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
  *   using another thread. The goal here so to block as little as
  *   possible when the classes using this class want to add data
  *   to the stream.
+ *
+ *   By default data is copied into a list of heap buffers. When the
+ *   "RecordingWriteMode" setting selects a ring mode, a preallocated
+ *   aligned ring is used instead. Write() and the disk thread then
+ *   only exchange head and tail counters, and the disk thread hands
+ *   everything pending to a single writev(). The ring can optionally
+ *   bypass the page cache with O_DIRECT, or drop synced data from it.
  */
 
 /** \fn ThreadedFileWriter::ReOpen(QString)
@@ -62,6 +106,8 @@ const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
  */
 bool ThreadedFileWriter::ReOpen(const QString& newFilename)
 {
+    QWriteLocker producers(&m_ringWriteLock);
+
     Flush();
 
     m_bufLock.lock();
@@ -91,6 +137,14 @@ bool ThreadedFileWriter::ReOpen(const QString& newFilename)
  */
 bool ThreadedFileWriter::Open(void)
 {
+    {
+        // Writes abandoned when writes started being ignored never
+        // publish the space they reserved, forget about it.
+        QMutexLocker locker(&m_bufLock);
+        m_ringReserve = m_ringHead.load();
+        m_ringLate.clear();
+        m_ringLateCount = 0;
+    }
     m_ignoreWrites = false;
 
     if (m_filename == "-")
@@ -116,6 +170,21 @@ bool ThreadedFileWriter::Open(void)
 #ifdef _WIN32
     _setmode(m_fd, _O_BINARY);
 #endif
+
+    if (m_ring)
+    {
+        // The new descriptor starts out without O_DIRECT.
+        m_directActive = false;
+        RingSetOffset(lseek(m_fd, 0, SEEK_CUR));
+    }
+    else if (!m_writeThread && m_filename != "-")
+    {
+        auto mode = static_cast<WriteMode>(gCoreContext->GetNumSetting(
+            "RecordingWriteMode", kWriteModeBufferList));
+        if (mode != kWriteModeBufferList)
+            OpenRing(mode);
+    }
+
     if (!m_writeThread)
     {
         m_writeThread = new TFWWriteThread(this);
@@ -164,6 +233,9 @@ ThreadedFileWriter::~ThreadedFileWriter()
         m_emptyBuffers.pop_front();
     }
 
+    free(m_ring);
+    m_ring = nullptr;
+
     if (m_syncThread)
     {
         m_syncThread->wait();
@@ -192,6 +264,9 @@ int ThreadedFileWriter::Write(const void *data, uint count)
     if (count == 0)
         return 0;
 
+    if (m_ring)
+        return RingWrite(static_cast<const char *>(data), count);
+
     QMutexLocker locker(&m_bufLock);
 
     if (m_ignoreWrites)
@@ -296,6 +371,17 @@ int ThreadedFileWriter::Write(const void *data, uint count)
  */
 long long ThreadedFileWriter::Seek(long long pos, int whence)
 {
+    if (m_ring)
+    {
+        QWriteLocker producers(&m_ringWriteLock);
+        QMutexLocker locker(&m_bufLock);
+        RingFlush();
+        long long ret = lseek(m_fd, pos, whence);
+        if (ret >= 0)
+            RingSetOffset(ret);
+        return ret;
+    }
+
     QMutexLocker locker(&m_bufLock);
     m_flush = true;
     while (!m_writeBuffers.empty())
@@ -318,6 +404,11 @@ long long ThreadedFileWriter::Seek(long long pos, int whence)
 void ThreadedFileWriter::Flush(void)
 {
     QMutexLocker locker(&m_bufLock);
+    if (m_ring)
+    {
+        RingFlush();
+        return;
+    }
     m_flush = true;
     while (!m_writeBuffers.empty())
     {
@@ -389,7 +480,10 @@ void ThreadedFileWriter::SyncLoop(void)
     {
         locker.unlock();
 
+        long long synced = m_fileOffset;
         Sync();
+        if (m_dropCache)
+            DropCache(synced);
 
         locker.relock();
 
@@ -413,6 +507,12 @@ void ThreadedFileWriter::DiskLoop(void)
     signal(SIGXFSZ, SIG_IGN);
 #endif
 
+    if (m_ring)
+    {
+        RingDiskLoop();
+        return;
+    }
+
     QMutexLocker locker(&m_bufLock);
 
     // Even if the bytes buffered is less than the minimum write
@@ -552,32 +652,8 @@ void ThreadedFileWriter::DiskLoop(void)
 
         if (!write_ok && ((EFBIG == errno) || (ENOSPC == errno)))
         {
-            QString msg;
-            switch (errno)
-            {
-                case EFBIG:
-                    msg =
-                        "Maximum file size exceeded by '%1'"
-                        "\n\t\t\t"
-                        "You must either change the process ulimits, configure"
-                        "\n\t\t\t"
-                        "your operating system with \"Large File\" support, "
-                        "or use"
-                        "\n\t\t\t"
-                        "a filesystem which supports 64-bit or 128-bit files."
-                        "\n\t\t\t"
-                        "HINT: FAT32 is a 32-bit filesystem.";
-                    break;
-                case ENOSPC:
-                    msg =
-                        "No space left on the device for file '%1'"
-                        "\n\t\t\t"
-                        "file will be truncated, no further writing "
-                        "will be done.";
-                    break;
-            }
-
-            LOG(VB_GENERAL, LOG_ERR, LOC + msg.arg(m_filename));
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                fatal_write_error(errno).arg(m_filename));
             m_ignoreWrites = true;
         }
     }
@@ -616,3 +692,471 @@ bool ThreadedFileWriter::SetBlocking(bool block)
     m_blocking = block;
     return old;
 }
+
+/** \fn ThreadedFileWriter::OpenRing(WriteMode)
+ *  \brief Allocates the ring buffer, must be called before the
+ *         disk thread is started.
+ *  \return true if the ring is used, false to keep the buffer lists.
+ */
+bool ThreadedFileWriter::OpenRing([[maybe_unused]] WriteMode mode)
+{
+#ifdef _WIN32
+    LOG(VB_GENERAL, LOG_WARNING, LOC +
+        "Ring buffer writes are not supported, using buffer lists.");
+    return false;
+#else
+    void *ring = nullptr;
+    if (posix_memalign(&ring, kDirectAlign, kRingSize) != 0)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            "Unable to allocate ring buffer, using buffer lists.");
+        return false;
+    }
+
+    m_ring      = static_cast<char *>(ring);
+    m_ringSize  = kRingSize;
+    m_dropCache = (mode == kWriteModeRingNoCache);
+#ifdef O_DIRECT
+    m_directWanted = (mode == kWriteModeRingDirect);
+#else
+    if (mode == kWriteModeRingDirect)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            "O_DIRECT is not supported, using buffered writes.");
+    }
+#endif
+    RingSetOffset(lseek(m_fd, 0, SEEK_CUR));
+
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Using %1 MB ring buffer, mode %2")
+        .arg(kRingSize >> 20).arg(static_cast<int>(mode)));
+    return true;
+#endif
+}
+
+/** \fn ThreadedFileWriter::RingSetOffset(long long)
+ *  \brief Records the file offset the next byte in the ring will be
+ *         written to.
+ *
+ *   The ring is shifted so that ring positions and file offsets are
+ *   congruent modulo kDirectAlign, which lets the disk thread issue
+ *   O_DIRECT writes straight out of the ring. Only call this while
+ *   the ring is empty.
+ */
+void ThreadedFileWriter::RingSetOffset(long long offset)
+{
+    offset = std::max(offset, 0LL);
+    m_fileOffset = offset;
+    uint64_t tail = m_ringTail;
+    m_ringShift = (kDirectAlign + (offset % kDirectAlign) -
+                   (tail % kDirectAlign)) % kDirectAlign;
+}
+
+/** \fn ThreadedFileWriter::RingWrite(const char*, uint)
+ *  \brief Copies data into the ring buffer, see Write(const void*, uint)
+ *
+ *   Each call reserves room for all of its data at once, so concurrent
+ *   callers copy into disjoint parts of the ring at the same time and
+ *   the data of one call is never interleaved with that of another.
+ *   The copied data is handed to the disk thread in reservation order,
+ *   see RingPublish().
+ *
+ *   The disk thread is only woken once enough data is waiting for it,
+ *   so in the common case no lock is shared with it.
+ */
+int ThreadedFileWriter::RingWrite(const char *data, uint count)
+{
+    // Only Seek() and ReOpen() take this exclusively.
+    QReadLocker producer(&m_ringWriteLock);
+
+    if (m_ignoreWrites)
+        return -1;
+
+    uint64_t pos = m_ringReserve.fetch_add(count);
+    uint written = 0;
+    while (written < count)
+    {
+        uint64_t tail = m_ringTail.load();
+
+        if (pos - tail >= m_ringSize)
+        {
+            if (!m_blocking)
+            {
+                if (!m_ignoreWrites.exchange(true))
+                {
+                    LOG(VB_GENERAL, LOG_ERR, LOC +
+                        "Maximum buffer size exceeded."
+                        "\n\t\t\tfile will be truncated, no further writing "
+                        "will be done."
+                        "\n\t\t\tThis generally indicates your disk performance "
+                        "\n\t\t\tis insufficient to deal with the number of on-going "
+                        "\n\t\t\trecordings, or you have a disk failure.");
+                }
+                return -1;
+            }
+            if (!m_warned.exchange(true))
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "Maximum buffer size exceeded."
+                    "\n\t\t\tThis generally indicates your disk performance "
+                    "\n\t\t\tis insufficient or you have a disk failure.");
+            }
+            // wait until some was written to disk, and try again
+            QMutexLocker locker(&m_bufLock);
+            m_writerWaiting++;
+            if ((pos - m_ringTail.load()) >= m_ringSize && !m_ignoreWrites)
+            {
+                m_bufferHasData.wakeAll();
+                if (!m_bufferWasFreed.wait(locker.mutex(), 1000))
+                {
+                    LOG(VB_GENERAL, LOG_DEBUG, LOC +
+                        QString("Taking a long time waiting to write.. "
+                                "buffer size %1 (needing %2)")
+                        .arg(m_ringSize).arg(count - written));
+                }
+            }
+            m_writerWaiting--;
+            if (m_ignoreWrites)
+                return -1;
+            continue;
+        }
+
+        uint64_t chunk = std::min<uint64_t>(m_ringSize - (pos - tail),
+                                            count - written);
+        uint64_t off   = (pos + m_ringShift) % m_ringSize;
+        uint64_t first = std::min(chunk, m_ringSize - off);
+        memcpy(m_ring + off, data + written, first);
+        if (chunk > first)
+            memcpy(m_ring, data + written + first, chunk - first);
+
+        RingPublish(pos, pos + chunk);
+        pos     += chunk;
+        written += chunk;
+
+        if (m_diskWaiting.load() &&
+            (m_ringHead.load() - m_ringTail.load()) >= m_tfwMinWriteSize)
+        {
+            QMutexLocker locker(&m_bufLock);
+            m_bufferHasData.wakeAll();
+        }
+    }
+
+    LOG(VB_FILE, LOG_DEBUG, LOC + QString("Write(*, %1) total %2")
+        .arg(count,4).arg(m_ringHead.load() - m_ringTail.load()));
+
+    return count;
+}
+
+/** \fn ThreadedFileWriter::RingPublish(uint64_t, uint64_t)
+ *  \brief Hands the data Write() copied to ring positions [start, end)
+ *         to the disk thread.
+ *
+ *   If a write that reserved space before this one is still copying,
+ *   the range is left in m_ringLate and that write publishes it along
+ *   with its own, so Write() never waits for another Write().
+ */
+void ThreadedFileWriter::RingPublish(uint64_t start, uint64_t end)
+{
+    uint64_t expected = start;
+    bool published = m_ringHead.compare_exchange_strong(expected, end);
+    if (published && m_ringLateCount.load() == 0)
+        return;
+
+    QMutexLocker locker(&m_bufLock);
+    if (!published)
+    {
+        m_ringLate.insert(start, end);
+        m_ringLateCount++;
+        // Check again, the earlier write may have published in between
+        // and not seen the count yet.
+        expected = start;
+        if (!m_ringHead.compare_exchange_strong(expected, end))
+            return;
+        m_ringLate.remove(start);
+        m_ringLateCount--;
+    }
+
+    // Publish the later writes that finished before us.
+    auto it = m_ringLate.find(m_ringHead.load());
+    while (it != m_ringLate.end())
+    {
+        m_ringHead.store(*it);
+        m_ringLate.erase(it);
+        m_ringLateCount--;
+        it = m_ringLate.find(m_ringHead.load());
+    }
+}
+
+/** \fn ThreadedFileWriter::RingFlush(void)
+ *  \brief Waits until the disk thread has emptied the ring buffer.
+ *         The caller must hold m_bufLock.
+ */
+void ThreadedFileWriter::RingFlush(void)
+{
+    m_flush = true;
+    while (m_ringHead.load() != m_ringTail.load() && !m_ignoreWrites)
+    {
+        m_bufferHasData.wakeAll();
+        if (!m_bufferEmpty.wait(&m_bufLock, 2000))
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("Taking a long time to flush.. buffer size %1")
+                    .arg(m_ringHead.load() - m_ringTail.load()));
+        }
+    }
+    m_flush = false;
+}
+
+/** \fn ThreadedFileWriter::RingDiskLoop(void)
+ *  \brief DiskLoop(void) for the ring buffer.
+ */
+void ThreadedFileWriter::RingDiskLoop(void)
+{
+    QMutexLocker locker(&m_bufLock);
+
+    MythTimer minWriteTimer;
+    MythTimer lastRegisterTimer;
+    minWriteTimer.start();
+    lastRegisterTimer.start();
+
+    uint64_t total_written = 0LL;
+
+    // Sleep until Write() has handed over enough to be worth writing,
+    // Flush() is called, or the timeout expires.
+    auto waitForData = [&](std::chrono::milliseconds timeout)
+    {
+        m_diskWaiting = true;
+        if ((m_ringHead.load() - m_ringTail.load()) < m_tfwMinWriteSize)
+            m_bufferHasData.wait(locker.mutex(), timeout.count());
+        m_diskWaiting = false;
+    };
+
+    while (!m_inDtor)
+    {
+        uint64_t pending = m_ringHead.load() - m_ringTail.load();
+
+        if (m_ignoreWrites)
+        {
+            m_ringTail.store(m_ringTail.load() + pending);
+            m_bufferEmpty.wakeAll();
+            m_bufferWasFreed.wakeAll();
+            m_bufferHasData.wait(locker.mutex(), 1000);
+            continue;
+        }
+
+        if (pending == 0)
+        {
+            m_bufferEmpty.wakeAll();
+            waitForData(1000ms);
+            continue;
+        }
+
+        auto mwte = minWriteTimer.elapsed();
+        if (!m_flush && (mwte < 250ms) && (pending < m_tfwMinWriteSize))
+        {
+            waitForData(250ms - mwte);
+            continue;
+        }
+
+        if (m_fd == -1)
+        {
+            m_bufferHasData.wait(locker.mutex(), 200);
+            continue;
+        }
+
+        minWriteTimer.start();
+
+        uint64_t sz = std::min<uint64_t>(pending, kMaxRingWrite);
+
+        LOG(VB_FILE, LOG_DEBUG, LOC + QString("writev(%1) total %2")
+                .arg(sz).arg(pending));
+
+        MythTimer writeTimer;
+        writeTimer.start();
+
+        locker.unlock();
+        int err = RingWriteSpan(sz, total_written);
+        locker.relock();
+
+        if (lastRegisterTimer.elapsed() >= 10s)
+        {
+            gCoreContext->RegisterFileForWrite(m_filename, total_written);
+            m_registered = true;
+            lastRegisterTimer.restart();
+        }
+
+        if (writeTimer.elapsed() > 1s)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("writev(%1) total %2 -- took a long time, %3 ms")
+                    .arg(sz).arg(pending).arg(writeTimer.elapsed().count()));
+        }
+
+        if ((EFBIG == err) || (ENOSPC == err))
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                fatal_write_error(err).arg(m_filename));
+            m_ignoreWrites = true;
+        }
+    }
+}
+
+/** \fn ThreadedFileWriter::RingWriteSpan(uint64_t, uint64_t&)
+ *  \brief Writes up to len bytes from the tail of the ring buffer.
+ *
+ *   The span is handed to writev() as one or, when it wraps around
+ *   the end of the ring, two pieces. In O_DIRECT mode only whole
+ *   kDirectAlign blocks are written directly. Short writes that
+ *   bring the file back into alignment, and the final partial block
+ *   of a flush, go through the page cache.
+ *
+ *  \return 0 on success, otherwise the errno that made us give up
+ *          on the span.
+ */
+int ThreadedFileWriter::RingWriteSpan(uint64_t len, uint64_t &total_written)
+{
+#ifdef _WIN32
+    // Never used, see OpenRing()
+    (void)len;
+    (void)total_written;
+    return EINVAL;
+#else
+    uint64_t tail = m_ringTail.load();
+    uint64_t pos  = (tail + m_ringShift) % m_ringSize;
+
+    bool direct = false;
+    if (m_directWanted)
+    {
+        uint64_t misalign = pos % kDirectAlign;
+        if (misalign)
+            len = std::min<uint64_t>(len, kDirectAlign - misalign);
+        else if (len >= kDirectAlign)
+        {
+            len -= len % kDirectAlign;
+            direct = true;
+        }
+    }
+    SetDirect(direct);
+
+    uint64_t done   = 0;
+    uint     errcnt = 0;
+    while (done < len)
+    {
+        uint64_t p     = (pos + done) % m_ringSize;
+        uint64_t left  = len - done;
+        uint64_t first = std::min(left, m_ringSize - p);
+
+        std::array<iovec,2> iov {};
+        iov[0].iov_base = m_ring + p;
+        iov[0].iov_len  = first;
+        iov[1].iov_base = m_ring;
+        iov[1].iov_len  = left - first;
+
+        ssize_t ret = writev(m_fd, iov.data(), (left > first) ? 2 : 1);
+        if (ret < 0)
+        {
+            int err = errno;
+            if (err == EINVAL && m_directActive)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "O_DIRECT write rejected, using buffered writes." + ENO);
+                m_directWanted = false;
+                SetDirect(false);
+                continue;
+            }
+
+            if (err == EAGAIN)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC + "Got EAGAIN.");
+            }
+            else
+            {
+                errcnt++;
+                LOG(VB_GENERAL, LOG_ERR, LOC + "File I/O " +
+                    QString(" errcnt: %1").arg(errcnt) + ENO);
+            }
+
+            if ((errcnt >= 3) || (ENOSPC == err) || (EFBIG == err))
+            {
+                // Give up on this span, as the buffer lists do.
+                m_ringTail.store(tail + len);
+                if (m_writerWaiting.load())
+                {
+                    QMutexLocker locker(&m_bufLock);
+                    m_bufferWasFreed.wakeAll();
+                }
+                return err;
+            }
+
+            std::this_thread::sleep_for(50ms);
+            continue;
+        }
+
+        done          += ret;
+        total_written += ret;
+        m_fileOffset  += ret;
+        m_ringTail.store(tail + done);
+
+        if (m_writerWaiting.load())
+        {
+            QMutexLocker locker(&m_bufLock);
+            m_bufferWasFreed.wakeAll();
+        }
+
+        LOG(VB_FILE, LOG_DEBUG, LOC +
+            QString("total written so far: %1 bytes").arg(total_written));
+
+        // A short direct write leaves us unaligned, realign next time.
+        if (direct && (done % kDirectAlign))
+            break;
+    }
+
+    return 0;
+#endif
+}
+
+/** \fn ThreadedFileWriter::SetDirect(bool)
+ *  \brief Turns O_DIRECT on or off for the open file.
+ */
+void ThreadedFileWriter::SetDirect([[maybe_unused]] bool direct)
+{
+#ifdef O_DIRECT
+    if (direct == m_directActive)
+        return;
+
+    int flags = fcntl(m_fd, F_GETFL);
+    if (flags >= 0)
+        flags = direct ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+    if (flags < 0 || fcntl(m_fd, F_SETFL, flags) < 0)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            "Unable to change O_DIRECT, using buffered writes." + ENO);
+        m_directWanted = false;
+        return;
+    }
+    m_directActive = direct;
+#endif
+}
+
+/** \fn ThreadedFileWriter::DropCache(long long)
+ *  \brief Tells the kernel that synced data is not needed again soon.
+ *
+ *   The most recent kCacheKeep bytes are left alone, since a LiveTV
+ *   player is usually reading right behind the recorder.
+ *
+ *  \param synced file offset up to which data was synced to disk
+ */
+void ThreadedFileWriter::DropCache([[maybe_unused]] long long synced)
+{
+#ifdef POSIX_FADV_DONTNEED
+    if (synced < m_droppedOffset)
+        m_droppedOffset = 0; // reopened or seeked backwards
+
+    long long upto = synced - kCacheKeep;
+    if (upto - m_droppedOffset < kMaxBlockSize)
+        return;
+
+    posix_fadvise(m_fd, m_droppedOffset, upto - m_droppedOffset,
+                  POSIX_FADV_DONTNEED);
+    m_droppedOffset = upto;
+#endif
+}
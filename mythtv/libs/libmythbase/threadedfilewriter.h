@@ -2,6 +2,7 @@
 #ifndef TFW_H_
 #define TFW_H_
 
+#include <atomic>
 #include <cstdint>
 #include <fcntl.h>
 #include <utility>
@@ -10,8 +11,10 @@
 // Qt headers
 #include <QWaitCondition>
 #include <QDateTime>
+#include <QMap>
 #include <QString>
 #include <QMutex>
+#include <QReadWriteLock>
 
 // MythTV headers
 #include "mythbaseexp.h"
@@ -44,6 +47,15 @@ class MBASE_PUBLIC ThreadedFileWriter
     friend class TFWWriteThread;
     friend class TFWSyncThread;
   public:
+    /// How buffered data is held until it is written, selected by the
+    /// "RecordingWriteMode" setting when the file is opened.
+    enum WriteMode : std::uint8_t {
+        kWriteModeBufferList   = 0, ///< list of heap buffers (default)
+        kWriteModeRing         = 1, ///< preallocated ring, batched writev()
+        kWriteModeRingNoCache  = 2, ///< ring, drop synced data from the page cache
+        kWriteModeRingDirect   = 3, ///< ring, bypass the page cache with O_DIRECT
+    };
+
     /** \fn ThreadedFileWriter::ThreadedFileWriter(const QString&,int,mode_t)
      *  \brief Creates a threaded file writer.
      */
@@ -69,6 +81,16 @@ class MBASE_PUBLIC ThreadedFileWriter
     void SyncLoop(void);
     void TrimEmptyBuffers(void);
 
+    bool OpenRing(WriteMode mode);
+    int  RingWrite(const char *data, uint count);
+    void RingPublish(uint64_t start, uint64_t end);
+    void RingFlush(void);
+    void RingDiskLoop(void);
+    int  RingWriteSpan(uint64_t len, uint64_t &total_written);
+    void RingSetOffset(long long offset);
+    void SetDirect(bool direct);
+    void DropCache(long long synced);
+
   private:
     // file info
     QString         m_filename;
@@ -79,8 +101,8 @@ class MBASE_PUBLIC ThreadedFileWriter
     // state
     bool            m_flush              {false};         // protected by buflock
     bool            m_inDtor             {false};         // protected by buflock
-    bool            m_ignoreWrites       {false};         // protected by buflock
-    uint            m_tfwMinWriteSize    {kMinWriteSize}; // protected by buflock
+    std::atomic<bool> m_ignoreWrites     {false};
+    std::atomic<uint> m_tfwMinWriteSize  {kMinWriteSize};
     uint            m_totalBufferUse     {0};             // protected by buflock
 
     // buffers
@@ -94,6 +116,29 @@ class MBASE_PUBLIC ThreadedFileWriter
     QList<TFWBuffer*> m_writeBuffers;     // protected by buflock
     QList<TFWBuffer*> m_emptyBuffers;     // protected by buflock
 
+    // ring buffer, used instead of the buffer lists when m_ring is set.
+    // Write() reserves space by advancing m_ringReserve, copies into it
+    // without a lock and publishes it, in reservation order, by advancing
+    // m_ringHead.  DiskLoop() only advances m_ringTail.  m_bufLock is only
+    // taken to sleep and wake, and when writes finish out of order.
+    char             *m_ring             {nullptr};
+    uint64_t          m_ringSize         {0};
+    uint64_t          m_ringShift        {0};  // changed only while empty
+    std::atomic<uint64_t> m_ringReserve  {0};
+    std::atomic<uint64_t> m_ringHead     {0};
+    std::atomic<uint64_t> m_ringTail     {0};
+    QMap<uint64_t,uint64_t> m_ringLate;   // protected by buflock
+    std::atomic<int>  m_ringLateCount    {0};  // entries in m_ringLate
+    std::atomic<bool> m_diskWaiting      {false};
+    std::atomic<int>  m_writerWaiting    {0};  // Write() callers waiting
+    QReadWriteLock    m_ringWriteLock;    // shared by Write() callers,
+                                          // exclusive in Seek() and ReOpen()
+    std::atomic<long long> m_fileOffset  {0};
+    long long         m_droppedOffset    {0};  // used by SyncLoop() only
+    bool              m_dropCache        {false};
+    bool              m_directWanted     {false};
+    bool              m_directActive     {false};
+
     // threads
     TFWWriteThread *m_writeThread        {nullptr};
     TFWSyncThread  *m_syncThread         {nullptr};
@@ -110,8 +155,16 @@ class MBASE_PUBLIC ThreadedFileWriter
     static const uint kMinWriteSize;
     /// Maximum block size to write at a time
     static const uint kMaxBlockSize;
-
-    bool m_warned                        {false};
+    /// Size of the ring buffer
+    static const uint kRingSize;
+    /// Maximum number of bytes handed to a single writev() from the ring
+    static const uint kMaxRingWrite;
+    /// Memory and file offset alignment required by O_DIRECT
+    static const uint kDirectAlign;
+    /// Recently written data left in the page cache for live readers
+    static const uint kCacheKeep;
+
+    std::atomic<bool> m_warned           {false};
     bool m_blocking                      {false};
     bool m_registered                    {false};
 };
@@ -2,12 +2,16 @@
 #include "videoscan.h"
 
 #include <QApplication>
+#include <QHash>
 #include <QImageReader>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QUrl>
 #include <utility>
 
 // mythtv
 #include "libmyth/mythcontext.h"
+#include "libmythbase/mthreadpool.h"
 #include "libmythbase/mythdate.h"
 #include "libmythbase/mythevent.h"
 #include "libmythbase/mythlogging.h"
@@ -69,6 +73,27 @@ namespace
         image_ext    m_imageExt;
         DirListType &m_videoFiles;
     };
+
+    /// Runs one step of a scan on a pool thread
+    class ScanTask : public QRunnable
+    {
+      public:
+        ScanTask(std::function<void()> task, QSemaphore &done) :
+            m_task(std::move(task)), m_done(done) {}
+
+        void run() override // QRunnable
+        {
+            m_task();
+            m_done.release();
+        }
+
+      private:
+        std::function<void()> m_task;
+        QSemaphore           &m_done;
+    };
+
+    // Most of the time is spent waiting on NFS or the backends, not the CPU
+    constexpr int kScanThreads { 8 };
 }
 
 class VideoMetadataListManager;
@@ -176,9 +201,35 @@ void VideoScannerThread::run()
     if (m_hasGUI)
         SendProgressEvent(counter, (uint)m_directories.size(),
                           tr("Searching for video files"));
-    for (const auto & dir : qAsConst(m_directories))
+
+    FileAssociations::ext_ignore_list ext_list;
+    FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
+
+    // Scan all directories at once, each into a list of its own
+    std::vector<FileCheckList> dir_files(m_directories.size());
+    std::vector<uint8_t> dir_ok(m_directories.size(), 0);
+    std::vector<std::function<void()> > tasks;
+    for (int i = 0; i < m_directories.size(); i++)
     {
-        if (!buildFileList(dir, imageExtensions, fs_files))
+        tasks.emplace_back([this, i, dir = m_directories.at(i),
+                            &imageExtensions, &ext_list, &dir_files, &dir_ok]()
+        {
+            dir_ok[i] = static_cast<uint8_t>(
+                buildFileList(dir, imageExtensions, ext_list, dir_files[i]));
+        });
+    }
+    runParallel(tasks, counter);
+
+    // Merge them in order, so that later directories still win when
+    // a file is found on more than one host
+    for (int i = 0; i < m_directories.size(); i++)
+    {
+        for (const auto & file : dir_files[i])
+            fs_files[file.first] = file.second;
+        dir_files[i].clear();
+
+        const QString &dir = m_directories.at(i);
+        if (!dir_ok[i])
         {
             if (dir.startsWith("myth://"))
             {
@@ -191,8 +242,6 @@ void VideoScannerThread::run()
                     QString("Failed to scan :%1:").arg(dir));
             }
         }
-        if (m_hasGUI)
-            SendProgressEvent(++counter);
     }
 
     PurgeList db_remove;
@@ -307,60 +356,90 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
         SendProgressEvent(counter, (uint)(add.size() + remove.size()),
                           tr("Updating video database"));
 
+    // Hash the files not already in the DB, reading them is slow
+    std::vector<FileCheckList::const_iterator> new_files;
     for (auto p = add.cbegin(); p != add.cend(); ++p)
     {
-        // add files not already in the DB
         if (!p->second.check)
+            new_files.push_back(p);
+    }
+    counter += add.size() - new_files.size();
+
+    std::vector<QString> hashes(new_files.size());
+    std::vector<std::function<void()> > tasks;
+    for (size_t i = 0; i < new_files.size(); i++)
+    {
+        tasks.emplace_back([p = new_files[i], &hashes, i]()
         {
-            int id = -1;
+            hashes[i] = VideoMetadata::VideoFileHash(p->first, p->second.host);
+        });
+    }
+    runParallel(tasks, counter);
 
-            // Are we sure this needs adding?  Let's check our Hash list.
-            QString hash = VideoMetadata::VideoFileHash(p->first, p->second.host);
-            if (hash != "NULL" && !hash.isEmpty())
-            {
-                id = VideoMetadata::UpdateHashedDBRecord(hash, p->first, p->second.host);
-                if (id != -1)
-                {
-                    // Whew, that was close.  Let's remove that thing from
-                    // our purge list, too.
-                    LOG(VB_GENERAL, LOG_ERR,
-                        QString("Hash %1 already exists in the "
-                                "database, updating record %2 "
-                                "with new filename %3")
-                            .arg(hash).arg(id).arg(p->first));
-                    m_movList.append(id);
-                }
-            }
-            if (id == -1)
+    // Look the hashes up in the list we already have, only moved files
+    // need a trip to the DB to find their record.
+    QHash<QString, int> known_hashes;
+    for (const auto & file : m_dbMetadata->getList())
+    {
+        const QString &hash = file->GetHash();
+        if (hash != "NULL" && !hash.isEmpty() && !known_hashes.contains(hash))
+            known_hashes.insert(hash, file->GetID());
+    }
+
+    for (size_t i = 0; i < new_files.size(); i++)
+    {
+        // add files not already in the DB
+        auto p = new_files[i];
+        int id = -1;
+
+        // Are we sure this needs adding?  Let's check our Hash list.
+        const QString &hash = hashes[i];
+        if (hash != "NULL" && !hash.isEmpty() &&
+            known_hashes.contains(hash))
+        {
+            id = VideoMetadata::UpdateHashedDBRecord(hash, p->first, p->second.host);
+            if (id != -1)
             {
-                VideoMetadata newFile(
-                    p->first, QString(), hash,
-                    VIDEO_TRAILER_DEFAULT,
-                    VIDEO_COVERFILE_DEFAULT,
-                    VIDEO_SCREENSHOT_DEFAULT,
-                    VIDEO_BANNER_DEFAULT,
-                    VIDEO_FANART_DEFAULT,
-                    QString(), QString(), QString(), QString(),
-                    QString(),
-                    VIDEO_YEAR_DEFAULT,
-                    QDate::fromString("0000-00-00","YYYY-MM-DD"),
-                    VIDEO_INETREF_DEFAULT, 0, QString(),
-                    VIDEO_DIRECTOR_DEFAULT, QString(), VIDEO_PLOT_DEFAULT,
-                    0.0, VIDEO_RATING_DEFAULT, 0, 0,
-                    0, 0,
-                    MythDate::current().date(),
-                    0, ParentalLevel::plLowest);
-
-                LOG(VB_GENERAL, LOG_INFO, QString("Adding : %1 : %2 : %3")
-                    .arg(newFile.GetHost(), newFile.GetFilename(), hash));
-                newFile.SetHost(p->second.host);
-                newFile.SaveToDatabase();
-                m_addList << newFile.GetID();
+                // Whew, that was close.  Let's remove that thing from
+                // our purge list, too.
+                LOG(VB_GENERAL, LOG_ERR,
+                    QString("Hash %1 already exists in the "
+                            "database, updating record %2 "
+                            "with new filename %3")
+                        .arg(hash).arg(id).arg(p->first));
+                m_movList.append(id);
             }
-            ret += 1;
         }
-        if (m_hasGUI)
-            SendProgressEvent(++counter);
+        if (id == -1)
+        {
+            VideoMetadata newFile(
+                p->first, QString(), hash,
+                VIDEO_TRAILER_DEFAULT,
+                VIDEO_COVERFILE_DEFAULT,
+                VIDEO_SCREENSHOT_DEFAULT,
+                VIDEO_BANNER_DEFAULT,
+                VIDEO_FANART_DEFAULT,
+                QString(), QString(), QString(), QString(),
+                QString(),
+                VIDEO_YEAR_DEFAULT,
+                QDate::fromString("0000-00-00","YYYY-MM-DD"),
+                VIDEO_INETREF_DEFAULT, 0, QString(),
+                VIDEO_DIRECTOR_DEFAULT, QString(), VIDEO_PLOT_DEFAULT,
+                0.0, VIDEO_RATING_DEFAULT, 0, 0,
+                0, 0,
+                MythDate::current().date(),
+                0, ParentalLevel::plLowest);
+
+            LOG(VB_GENERAL, LOG_INFO, QString("Adding : %1 : %2 : %3")
+                .arg(newFile.GetHost(), newFile.GetFilename(), hash));
+            newFile.SetHost(p->second.host);
+            newFile.SaveToDatabase();
+            m_addList << newFile.GetID();
+            if (hash != "NULL" && !hash.isEmpty() &&
+                !known_hashes.contains(hash))
+                known_hashes.insert(hash, newFile.GetID());
+        }
+        ret += 1;
     }
 
     // When prompting is restored, account for the answer here.
@@ -381,6 +460,7 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
 
 bool VideoScannerThread::buildFileList(const QString &directory,
                                        const QStringList &imageExtensions,
+                                       const FileAssociations::ext_ignore_list &ext_list,
                                        FileCheckList &filelist) const
 {
     // TODO: FileCheckList is a std::map, keyed off the filename. In the event
@@ -391,13 +471,32 @@ bool VideoScannerThread::buildFileList(const QString &directory,
 
     LOG(VB_GENERAL,LOG_INFO, QString("buildFileList directory = %1")
                                  .arg(directory));
-    FileAssociations::ext_ignore_list ext_list;
-    FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
     return ScanVideoDirectory(directory, &dh, ext_list, m_listUnknown);
 }
 
+/// Runs \a tasks on a pool of threads and waits for all of them,
+/// advancing the progress dialog as each one finishes
+void VideoScannerThread::runParallel(
+    const std::vector<std::function<void()> > &tasks, uint &counter)
+{
+    MThreadPool pool("VideoScanPool");
+    pool.setMaxThreadCount(kScanThreads);
+
+    QSemaphore done;
+    for (const auto & task : tasks)
+        pool.start(new ScanTask(task, done), "VideoScanTask");
+
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        done.acquire();
+        if (m_hasGUI)
+            SendProgressEvent(++counter);
+    }
+    pool.waitForDone();
+}
+
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
                                            QString messsage)
 {
@@ -1,6 +1,7 @@
 #ifndef VIDEO_SCANNER_H
 #define VIDEO_SCANNER_H
 
+#include <functional>
 #include <map>
 #include <set>
 #include <utility>
@@ -14,6 +15,7 @@
 
 // MythTV headers
 #include "libmythbase/mthread.h"
+#include "libmythmetadata/dbaccess.h"
 #include "libmythmetadata/mythmetaexp.h"
 #include "libmythui/mythprogressdialog.h"
 
@@ -90,8 +92,11 @@ class META_PUBLIC VideoScannerThread : public MThread
     void verifyFiles(FileCheckList &files, PurgeList &remove);
     bool updateDB(const FileCheckList &add, const PurgeList &remove);
     bool buildFileList(const QString &directory,
-                                        const QStringList &imageExtensions,
-                                        FileCheckList &filelist) const;
+                       const QStringList &imageExtensions,
+                       const FileAssociations::ext_ignore_list &ext_list,
+                       FileCheckList &filelist) const;
+    void runParallel(const std::vector<std::function<void()> > &tasks,
+                     uint &counter);
 
     void SendProgressEvent(uint progress, uint total = 0,
             QString messsage = QString());
@@ -2,6 +2,11 @@
 #include <QMutexLocker>
 #include <utility>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "libmythbase/mythcorecontext.h"
+#include "libmythbase/mythdate.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/mythsocket.h"
 #include "libmythbase/programinfo.h"
@@ -17,6 +22,22 @@ FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
 {
     m_pginfo = new ProgramInfo(filename);
     m_pginfo->MarkAsInUse(true, kFileTransferInUseID);
+
+    // A local file that is no longer being written can be sent straight
+    // from the page cache, anything else is read through the ringbuffer.
+    QFileInfo info(filename);
+    if (m_rbuffer && m_rbuffer->IsOpen() &&
+        m_rbuffer->GetType() == kMythBufferFile && info.isFile() &&
+        !gCoreContext->IsRegisteredFileForWrite(filename) &&
+        MythDate::secsInPast(info.lastModified().toUTC()) > 60s)
+    {
+        m_sendfd = open(QFile::encodeName(filename).constData(), O_RDONLY);
+        if (m_sendfd >= 0)
+        {
+            LOG(VB_FILE, LOG_INFO,
+                QString("Sending %1 with sendfile").arg(filename));
+        }
+    }
 }
 
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
@@ -45,6 +66,9 @@ FileTransfer::~FileTransfer()
         m_rbuffer = nullptr;
     }
 
+    if (m_sendfd >= 0)
+        close(m_sendfd);
+
     if (m_pginfo)
     {
         m_pginfo->MarkAsInUse(false, kFileTransferInUseID);
@@ -123,6 +147,21 @@ int FileTransfer::RequestBlock(int size)
     while (m_readsLocked)
         m_readsUnlockedCond.wait(&m_lock, 100 /*ms*/);
 
+    if (m_sendfd >= 0)
+    {
+        if (!m_readthreadlive)
+            return -1;
+
+        tot = GetSocket()->SendFile(m_sendfd, m_sendpos, std::max(size,0));
+        if (tot > 0)
+            m_sendpos += tot;
+
+        if (m_pginfo)
+            m_pginfo->UpdateInUseMark();
+
+        return tot;
+    }
+
     m_requestBuffer.resize(std::max((size_t)std::max(size,0) + 128, m_requestBuffer.size()));
     char *buf = (m_requestBuffer).data();
     while (tot < size && !m_rbuffer->GetStopReads() && m_readthreadlive)
@@ -224,6 +263,24 @@ long long FileTransfer::Seek(long long curpos, long long pos, int whence)
 
     m_ateof = false;
 
+    if (m_sendfd >= 0)
+    {
+        QMutexLocker locker(&m_lock);
+
+        if (whence == SEEK_CUR)
+            pos += curpos;
+        else if (whence == SEEK_END)
+            pos += m_rbuffer->GetRealFileSize();
+        else if (whence != SEEK_SET)
+            return -1;
+
+        if (pos < 0)
+            return -1;
+
+        m_sendpos = pos;
+        return pos;
+    }
+
     Pause();
 
     if (whence == SEEK_CUR)
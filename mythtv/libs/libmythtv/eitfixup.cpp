@@ -4,8 +4,11 @@
 
 // Qt Headers
 #include <QRegularExpression>
+#include <QRunnable>
+#include <QSemaphore>
 
 // MythTV headers
+#include "libmythbase/mthreadpool.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/programinfo.h" // for CategoryType, subtitle types and audio and video properties
 
@@ -25,6 +28,19 @@ static const QRegularExpression kDotAtEnd { "\\.$" };
 #define capturedView capturedRef
 #endif
 
+/*
+ * Most of the regular expressions only match text that contains some
+ * literal, and most event text contains none of them. Looking for the
+ * literal first is much cheaper than a run of the regex engine.
+ */
+static void remove_if_contains(QString &str, const QRegularExpression &re,
+                               QLatin1String literal,
+                               Qt::CaseSensitivity cs = Qt::CaseSensitive)
+{
+    if (str.contains(literal, cs))
+        str.remove(re);
+}
+
 static const QMap<QChar,quint16> r2v = {
     {'I' ,   1}, {'V' ,   5}, {'X' ,   10}, {'L' , 50},
     {'C' , 100}, {'D' , 500}, {'M' , 1000},
@@ -47,6 +63,91 @@ int EITFixUp::parseRoman (QString roman)
 }
 
 
+/// The fixups in the order they are applied, each one runs when any
+/// of the bits of its mask are set in the event's fixup value.
+const std::vector<EITFixUp::FixUpRule> EITFixUp::kRules
+{
+    { kFixHTML,            FixStripHTML },
+    { kFixHDTV,            [](DBEventEIT &event)
+                               { event.m_videoProps |= VID_HDTV; } },
+    { kFixBell,            FixBellExpressVu },
+    { kFixDish,            FixBellExpressVu },
+    { kFixUK,              FixUK },
+    { kFixPBS,             FixPBS },
+    { kFixComHem,          [](DBEventEIT &event)
+                               { FixComHem(event, (kFixSubtitle & event.m_fixup) != 0U); } },
+    { kFixAUStar,          FixAUStar },
+    { kFixAUDescription,   FixAUDescription },
+    { kFixAUFreeview,      FixAUFreeview },
+    { kFixAUNine,          FixAUNine },
+    { kFixAUSeven,         FixAUSeven },
+    { kFixMCA,             FixMCA },
+    { kFixRTL,             FixRTL },
+    { kFixP7S1,            FixPRO7 },
+    { kFixATV,             FixATV },
+    { kFixDisneyChannel,   FixDisneyChannel },
+    { kFixFI,              FixFI },
+    { kFixPremiere,        FixPremiere },
+    { kFixNL,              FixNL },
+    { kFixNO,              FixNO },
+    { kFixNRK_DVBT,        FixNRK_DVBT },
+    { kFixDK,              FixDK },
+    { kFixCategory,        FixCategory },
+    { kFixGreekSubtitle,   FixGreekSubtitle },
+    { kFixGreekEIT,        FixGreekEIT },
+    { kFixGreekCategories, FixGreekCategories },
+    { kFixUnitymedia,      FixUnitymedia },
+};
+
+namespace
+{
+    /// Fixes up a slice of a batch of events on a pool thread
+    class FixUpTask : public QRunnable
+    {
+      public:
+        FixUpTask(DBEventEIT * const *events, size_t count, QSemaphore &done) :
+            m_events(events), m_count(count), m_done(done) {}
+
+        void run() override // QRunnable
+        {
+            for (size_t i = 0; i < m_count; ++i)
+                EITFixUp::Fix(*m_events[i]);
+            m_done.release();
+        }
+
+      private:
+        DBEventEIT * const *m_events;
+        size_t              m_count;
+        QSemaphore         &m_done;
+    };
+}
+
+/** \brief Fixes up a batch of events.
+ *
+ *  The fixups of different events don't depend on each other, so larger
+ *  batches are shared out between the threads of the global thread pool.
+ */
+void EITFixUp::Fix(const std::vector<DBEventEIT*> &events)
+{
+    if (events.size() < 2 * kEventsPerTask)
+    {
+        for (auto *event : events)
+            Fix(*event);
+        return;
+    }
+
+    QSemaphore done;
+    int tasks = 0;
+    for (size_t first = 0; first < events.size(); first += kEventsPerTask)
+    {
+        size_t count = std::min(kEventsPerTask, events.size() - first);
+        MThreadPool::globalInstance()->start(
+            new FixUpTask(&events[first], count, done), "EITFixUp");
+        tasks++;
+    }
+    done.acquire(tasks);
+}
+
 void EITFixUp::Fix(DBEventEIT &event)
 {
     if (event.m_fixup)
@@ -61,89 +162,11 @@ void EITFixUp::Fix(DBEventEIT &event)
         }
     }
 
-    if (kFixHTML & event.m_fixup)
-        FixStripHTML(event);
-
-    if (kFixHDTV & event.m_fixup)
-        event.m_videoProps |= VID_HDTV;
-
-    if (kFixBell & event.m_fixup)
-        FixBellExpressVu(event);
-
-    if (kFixDish & event.m_fixup)
-        FixBellExpressVu(event);
-
-    if (kFixUK & event.m_fixup)
-        FixUK(event);
-
-    if (kFixPBS & event.m_fixup)
-        FixPBS(event);
-
-    if (kFixComHem & event.m_fixup)
-        FixComHem(event, (kFixSubtitle & event.m_fixup) != 0U);
-
-    if (kFixAUStar & event.m_fixup)
-        FixAUStar(event);
-
-    if (kFixAUDescription & event.m_fixup)
-        FixAUDescription(event);
-
-    if (kFixAUFreeview & event.m_fixup)
-        FixAUFreeview(event);
-
-    if (kFixAUNine & event.m_fixup)
-        FixAUNine(event);
-
-    if (kFixAUSeven & event.m_fixup)
-        FixAUSeven(event);
-
-    if (kFixMCA & event.m_fixup)
-        FixMCA(event);
-
-    if (kFixRTL & event.m_fixup)
-        FixRTL(event);
-
-    if (kFixP7S1 & event.m_fixup)
-        FixPRO7(event);
-
-    if (kFixATV & event.m_fixup)
-        FixATV(event);
-
-    if (kFixDisneyChannel & event.m_fixup)
-        FixDisneyChannel(event);
-
-    if (kFixFI & event.m_fixup)
-        FixFI(event);
-
-    if (kFixPremiere & event.m_fixup)
-        FixPremiere(event);
-
-    if (kFixNL & event.m_fixup)
-        FixNL(event);
-
-    if (kFixNO & event.m_fixup)
-        FixNO(event);
-
-    if (kFixNRK_DVBT & event.m_fixup)
-        FixNRK_DVBT(event);
-
-    if (kFixDK & event.m_fixup)
-        FixDK(event);
-
-    if (kFixCategory & event.m_fixup)
-        FixCategory(event);
-
-    if (kFixGreekSubtitle & event.m_fixup)
-        FixGreekSubtitle(event);
-
-    if (kFixGreekEIT & event.m_fixup)
-        FixGreekEIT(event);
-
-    if (kFixGreekCategories & event.m_fixup)
-        FixGreekCategories(event);
-
-    if (kFixUnitymedia & event.m_fixup)
-        FixUnitymedia(event);
+    for (const auto & rule : kRules)
+    {
+        if (rule.m_fixup & event.m_fixup)
+            rule.m_fix(event);
+    }
 
     // Clean up text strings after all fixups have been applied.
     if (event.m_fixup)
@@ -151,21 +174,22 @@ void EITFixUp::Fix(DBEventEIT &event)
         static const QRegularExpression emptyParens { R"(\(\s*\))" };
         if (!event.m_title.isEmpty())
         {
-            event.m_title.remove(QChar('\0')).remove(emptyParens);
+            event.m_title.remove(QChar('\0'));
+            remove_if_contains(event.m_title, emptyParens, QLatin1String("("));
             event.m_title = event.m_title.simplified();
         }
 
         if (!event.m_subtitle.isEmpty())
         {
             event.m_subtitle.remove(QChar('\0'));
-            event.m_subtitle.remove(emptyParens);
+            remove_if_contains(event.m_subtitle, emptyParens, QLatin1String("("));
             event.m_subtitle = event.m_subtitle.simplified();
         }
 
         if (!event.m_description.isEmpty())
         {
             event.m_description.remove(QChar('\0'));
-            event.m_description.remove(emptyParens);
+            remove_if_contains(event.m_description, emptyParens, QLatin1String("("));
             event.m_description = event.m_description.simplified();
         }
     }
@@ -352,7 +376,8 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event)
     }
 
     // Check for (Stereo) in the decription and set the <audio> tags
-    auto match = kStereo.match(event.m_description);
+    auto match = event.m_description.contains(QLatin1String("tereo"))
+        ? kStereo.match(event.m_description) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         event.m_audioProps |= AUD_STEREO;
@@ -671,37 +696,45 @@ void EITFixUp::FixUK(DBEventEIT &event)
         QRegularExpression::CaseInsensitiveOption };
     static const QRegularExpression ukNewTitle { R"(^(Brand New|New:)\s*)",
         QRegularExpression::CaseInsensitiveOption };
-    event.m_description = event.m_description.remove(ukThen);
-    event.m_description = event.m_description.remove(ukNew);
-    event.m_title = event.m_title.remove(ukNewTitle);
+    remove_if_contains(event.m_description, ukThen,
+                       QLatin1String("60 Seconds."), Qt::CaseInsensitive);
+    remove_if_contains(event.m_description, ukNew,
+                       QLatin1String("New"), Qt::CaseInsensitive);
+    remove_if_contains(event.m_title, ukNewTitle,
+                       QLatin1String("New"), Qt::CaseInsensitive);
 
     // Removal of Class TV, CBBC and CBeebies etc..
     static const QRegularExpression ukTitleRemove { "^(?:[tT]4:|Schools\\s*?:)" };
     static const QRegularExpression ukDescriptionRemove { R"(^(?:CBBC\s*?\.|CBeebies\s*?\.|Class TV\s*?:|BBC Switch\.))" };
-    event.m_title = event.m_title.remove(ukTitleRemove);
-    event.m_description = event.m_description.remove(ukDescriptionRemove);
+    remove_if_contains(event.m_title, ukTitleRemove, QLatin1String(":"));
+    event.m_description.remove(ukDescriptionRemove);
 
     // Removal of BBC FOUR and BBC THREE
     static const QRegularExpression ukBBC34 { R"(BBC (?:THREE|FOUR) on BBC (?:ONE|TWO)\.)",
         QRegularExpression::CaseInsensitiveOption };
-    event.m_description = event.m_description.remove(ukBBC34);
+    remove_if_contains(event.m_description, ukBBC34,
+                       QLatin1String("BBC"), Qt::CaseInsensitive);
 
     // BBC 7 [Rpt of ...] case.
     static const QRegularExpression ukBBC7rpt { R"(\[Rptd?[^]]+?\d{1,2}\.\d{1,2}[ap]m\]\.)" };
-    event.m_description = event.m_description.remove(ukBBC7rpt);
+    remove_if_contains(event.m_description, ukBBC7rpt, QLatin1String("[Rpt"));
 
     // "All New To 4Music!
     static const QRegularExpression ukAllNew { R"(All New To 4Music!\s?)" };
-    event.m_description = event.m_description.remove(ukAllNew);
+    remove_if_contains(event.m_description, ukAllNew,
+                       QLatin1String("All New To 4Music!"));
 
     // Removal of 'Also in HD' text
     static const QRegularExpression ukAlsoInHD { R"(\s*Also in HD\.)",
         QRegularExpression::CaseInsensitiveOption };
-    event.m_description = event.m_description.remove(ukAlsoInHD);
+    remove_if_contains(event.m_description, ukAlsoInHD,
+                       QLatin1String("Also in HD."), Qt::CaseInsensitive);
 
     // Remove [AD,S] etc.
     static const QRegularExpression ukCC { R"(\[(?:(AD|SL|S|W|HD),?)+\])" };
-    auto match = ukCC.match(event.m_description);
+    QRegularExpressionMatch match;
+    if (event.m_description.contains('['))
+        match = ukCC.match(event.m_description);
     while (match.hasMatch())
     {
         QStringList tmpCCitems = match.captured(0).remove("[").remove("]").split(",");
@@ -871,7 +904,10 @@ void EITFixUp::FixUK(DBEventEIT &event)
     }
 
     static const QRegularExpression ukStarring { R"((?:Western\s)?[Ss]tarring ([\w\s\-']+?)[Aa]nd\s([\w\s\-']+?)[\.|,]\s*(\d{4})?(?:\.\s)?)" };
-    match = ukStarring.match(event.m_description);
+    if (event.m_description.contains(QLatin1String("tarring")))
+        match = ukStarring.match(event.m_description);
+    else
+        match = QRegularExpressionMatch();
     if (match.hasMatch())
     {
         // if we match this we've captured 2 actors and an (optional) airdate
@@ -995,7 +1031,10 @@ void EITFixUp::FixUK(DBEventEIT &event)
 
     // Work out the year (if any)
     static const QRegularExpression ukYear { R"([\[\(]([\d]{4})[\)\]])" };
-    match = ukYear.match(event.m_description);
+    if (event.m_description.contains('(') || event.m_description.contains('['))
+        match = ukYear.match(event.m_description);
+    else
+        match = QRegularExpressionMatch();
     if (match.hasMatch())
     {
         event.m_description.remove(match.capturedStart(0),
@@ -1875,7 +1914,8 @@ void EITFixUp::FixFI(DBEventEIT &event)
     }
 
     // Check for (Stereo) in the decription and set the <audio> tags
-    match = kStereo.match(event.m_description);
+    match = event.m_description.contains(QLatin1String("tereo"))
+        ? kStereo.match(event.m_description) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         event.m_audioProps |= AUD_STEREO;
@@ -2023,7 +2063,8 @@ void EITFixUp::FixNL(DBEventEIT &event)
         event.m_categoryType = ProgramInfo::kCategorySeries;
 
     // Get stereo info
-    auto match = kStereo.match(fullinfo);
+    auto match = fullinfo.contains(QLatin1String("tereo"))
+        ? kStereo.match(fullinfo) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         event.m_audioProps |= AUD_STEREO;
@@ -2031,27 +2072,20 @@ void EITFixUp::FixNL(DBEventEIT &event)
     }
 
     //Get widescreen info
-    static const QRegularExpression nlWide { "breedbeeld" };
-    match = nlWide.match(fullinfo);
-    if (match.hasMatch())
+    if (fullinfo.contains(QLatin1String("breedbeeld")))
     {
         event.m_videoProps |= VID_WIDESCREEN;
-        fullinfo = fullinfo.replace("breedbeeld", ".");
+        fullinfo.replace(QLatin1String("breedbeeld"), QLatin1String("."));
     }
 
     // Get repeat info
-    static const QRegularExpression nlRepeat { "herh." };
-    match = nlRepeat.match(fullinfo);
-    if (match.hasMatch())
-        fullinfo = fullinfo.replace("herh.", ".");
+    fullinfo.replace(QLatin1String("herh."), QLatin1String("."));
 
     // Get teletext subtitle info
-    static const QRegularExpression nlTxt { "txt" };
-    match = nlTxt.match(fullinfo);
-    if (match.hasMatch())
+    if (fullinfo.contains(QLatin1String("txt")))
     {
         event.m_subtitleType |= SUB_NORMAL;
-        fullinfo = fullinfo.replace("txt", ".");
+        fullinfo.replace(QLatin1String("txt"), QLatin1String("."));
     }
 
     // Get HDTV information
@@ -2065,7 +2099,8 @@ void EITFixUp::FixNL(DBEventEIT &event)
 
     // Try to make subtitle from Afl.:
     static const QRegularExpression nlSub { R"(\sAfl\.:\s([^\.]+)\.)" };
-    match = nlSub.match(fullinfo);
+    match = fullinfo.contains(QLatin1String("Afl.:"))
+        ? nlSub.match(fullinfo) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         QString tmpSubString = match.captured(0);
@@ -2101,7 +2136,8 @@ void EITFixUp::FixNL(DBEventEIT &event)
     // Get the actors
     static const QRegularExpression nlActors { R"(\sMet:\s.+e\.a\.)" };
     static const QRegularExpression nlPersSeparator { R"((, |\sen\s))" };
-    match = nlActors.match(fullinfo);
+    match = fullinfo.contains(QLatin1String("Met:"))
+        ? nlActors.match(fullinfo) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         QString tmpActorsString = match.captured(0);
@@ -2123,7 +2159,8 @@ void EITFixUp::FixNL(DBEventEIT &event)
 
     // Try to find presenter
     static const QRegularExpression nlPres { R"(\sPresentatie:\s([^\.]+)\.)" };
-    match = nlPres.match(fullinfo);
+    match = fullinfo.contains(QLatin1String("Presentatie:"))
+        ? nlPres.match(fullinfo) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         QString tmpPresString = match.captured(0);
@@ -2171,7 +2208,7 @@ void EITFixUp::FixNL(DBEventEIT &event)
 
     // Strip leftovers
     static const QRegularExpression nlRub { R"(\s?\(\W+\)\s?)" };
-    fullinfo.remove(nlRub);
+    remove_if_contains(fullinfo, nlRub, QLatin1String("("));
 
     // Strip category info from description
     static const QRegularExpression nlCat { "^(Amusement|Muziek|Informatief|Nieuws/actualiteiten|Jeugd|Animatie|Sport|Serie/soap|Kunst/Cultuur|Documentaire|Film|Natuur|Erotiek|Comedy|Misdaad|Religieus)\\.\\s" };
@@ -5,6 +5,8 @@
 #ifndef EITFIXUP_H
 #define EITFIXUP_H
 
+#include <vector>
+
 #include "programdata.h"
 
 /// EIT Fix Up Functions
@@ -73,6 +75,7 @@ class MTV_PUBLIC EITFixUp
     EITFixUp() = default;
 
     static void Fix(DBEventEIT &event);
+    static void Fix(const std::vector<DBEventEIT*> &events);
 
     static int parseRoman (QString roman);
 
@@ -90,6 +93,17 @@ class MTV_PUBLIC EITFixUp
     }
 
   private:
+    using FixUpFunc = void (*)(DBEventEIT &event);
+    struct FixUpRule
+    {
+        FixupValue m_fixup;
+        FixUpFunc  m_fix;
+    };
+    static const std::vector<FixUpRule> kRules;
+
+    // smallest share of a batch of events that is worth a pool thread
+    static constexpr size_t kEventsPerTask { 25 };
+
     static void FixBellExpressVu(DBEventEIT &event);// Canada DVB-S
     static void SetUKSubtitle(DBEventEIT &event);
     static void FixUK(DBEventEIT &event);           // UK DVB-T
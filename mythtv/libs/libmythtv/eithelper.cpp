@@ -2,6 +2,8 @@
 
 // Std C++ headers
 #include <algorithm>
+#include <thread>
+#include <vector>
 
 // MythTV includes
 #include "libmythbase/compat.h"  // for gmtime_r on windows.
@@ -21,8 +23,9 @@
 #include "programdata.h"
 #include "scheduledrecording.h"  // for ScheduledRecording
 
-const uint EITHelper::kChunkSize =   20;
+const uint EITHelper::kChunkSize =  200;
 const uint EITHelper::kMaxSize   = 1000;
+const uint EITHelper::kMaxBatchAttempts = 3;
 
 EITCache *EITHelper::s_eitCache = new EITCache();
 
@@ -67,7 +70,9 @@ bool EITHelper::EventQueueFull(void) const
  *  \brief Get events from queue and insert into DB after processing.
  *
  * Process a maximum of kChunkSize events at a time
- * to avoid clogging the machine.
+ * to avoid clogging the machine. The fixups of the chunk run
+ * in parallel, see EITFixUp::Fix(), and the events are written
+ * as one batch, see DBEventEITBatch.
  *
  *  \return Returns number of events inserted into DB.
  */
@@ -79,20 +84,35 @@ uint EITHelper::ProcessEvents(void)
     if (m_dbEvents.empty())
         return 0;
 
-    MSqlQuery query(MSqlQuery::InitCon());
+    std::vector<DBEventEIT*> events;
     for (uint i = 0; (i < kChunkSize) && (!m_dbEvents.empty()); i++)
-    {
-        DBEventEIT *event = m_dbEvents.dequeue();
-        m_eitListLock.unlock();
+        events.push_back(m_dbEvents.dequeue());
+
+    m_eitListLock.unlock();
 
-        EITFixUp::Fix(*event);
+    EITFixUp::Fix(events);
 
-        insertCount += event->UpdateDB(query, 1000);
+    DBEventEITBatch batch(1000);
+    for (auto *event : events)
+    {
         m_maxStarttime = std::max (m_maxStarttime, event->m_starttime);
+        batch.Add(event);
+    }
 
-        delete event;
-        m_eitListLock.lock();
+    // A failed batch is rolled back as a whole, so it can be written again.
+    MSqlQuery query(MSqlQuery::InitCon());
+    for (uint attempt = 1; !batch.UpdateDB(query, insertCount); ++attempt)
+    {
+        if (attempt >= kMaxBatchAttempts)
+        {
+            LOG(VB_EIT, LOG_ERR, LOC_ID +
+                QString("Dropping %1 events, they could not be written")
+                    .arg(events.size()));
+            break;
+        }
+        std::this_thread::sleep_for(attempt * 100ms);
     }
+    m_eitListLock.lock();
 
     if (!insertCount)
         return 0;
@@ -161,6 +161,7 @@ class EITHelper
 
     static const uint kChunkSize;   // Maximum number of DB inserts per ProcessEvents call
     static const uint kMaxSize;     // Maximum number of events waiting to be processed
+    static const uint kMaxBatchAttempts; // Maximum number of times a failed batch is written
 };
 
 #endif // EIT_HELPER_H
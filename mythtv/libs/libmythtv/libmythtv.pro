@@ -226,6 +226,7 @@ HEADERS += mpeg/iso6937tables.h
 HEADERS += mpeg/tsstats.h           mpeg/streamlisteners.h
 HEADERS += mpeg/H2645Parser.h mpeg/AVCParser.h mpeg/HEVCParser.h
 HEADERS += mpeg/tablestatus.h
+HEADERS += mpeg/mpegcrc.h
 HEADERS += mpeg/tsstreamdata.h
 
 SOURCES += mpeg/tspacket.cpp        mpeg/pespacket.cpp
@@ -243,6 +244,7 @@ SOURCES += mpeg/freesat_huffman.cpp
 SOURCES += mpeg/iso6937tables.cpp
 SOURCES += mpeg/H2645Parser.cpp mpeg/AVCParser.cpp mpeg/HEVCParser.cpp
 SOURCES += mpeg/tablestatus.cpp
+SOURCES += mpeg/mpegcrc.cpp
 SOURCES += mpeg/tsstreamdata.cpp
 
 # Channels, and the multiplexes that transmit them
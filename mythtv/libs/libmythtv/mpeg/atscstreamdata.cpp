@@ -218,7 +218,7 @@ bool ATSCStreamData::HandleTables(uint pid, const PSIPTable &psip)
     {
         case TableID::MGT:
         {
-            SetVersionMGT(version);
+            SetVersionMGT(pid, version);
             if (m_cacheTables)
             {
                 auto *mgt = new MasterGuideTable(psip);
@@ -235,7 +235,7 @@ bool ATSCStreamData::HandleTables(uint pid, const PSIPTable &psip)
         case TableID::TVCT:
         {
             uint tsid = psip.TableIDExtension();
-            SetVersionTVCT(tsid, version);
+            SetVersionTVCT(pid, tsid, version);
             if (m_cacheTables)
             {
                 auto *vct = new TerrestrialVirtualChannelTable(psip);
@@ -252,7 +252,7 @@ bool ATSCStreamData::HandleTables(uint pid, const PSIPTable &psip)
         case TableID::CVCT:
         {
             uint tsid = psip.TableIDExtension();
-            SetVersionCVCT(tsid, version);
+            SetVersionCVCT(pid, tsid, version);
             if (m_cacheTables)
             {
                 auto *vct = new CableVirtualChannelTable(psip);
@@ -269,7 +269,7 @@ bool ATSCStreamData::HandleTables(uint pid, const PSIPTable &psip)
         case TableID::RRT:
         {
             uint region = psip.TableIDExtension();
-            SetVersionRRT(region, version);
+            SetVersionRRT(pid, region, version);
             RatingRegionTable rrt(psip);
             QMutexLocker locker(&m_listenerLock);
             for (auto & listener : m_atscAuxListeners)
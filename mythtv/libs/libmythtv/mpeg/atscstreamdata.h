@@ -54,14 +54,15 @@ class MTV_PUBLIC ATSCStreamData : virtual public MPEGStreamData
                           uint_vec_t &del_pids) const override; // MPEGStreamData
 
     // Table versions
-    void SetVersionMGT(int version)
-        {    m_mgtVersion     = version; }
-    void SetVersionTVCT(uint tsid, int version)
-        { m_tvctVersion[tsid] = version; }
-    void SetVersionCVCT(uint tsid, int version)
-        { m_cvctVersion[tsid] = version; }
-    void SetVersionRRT(uint region, int version)
-        { m_rrtVersion[region&0xff] = version; }
+    // pid is the PID carrying the table, only its repeats are forgotten
+    void SetVersionMGT(uint pid, int version)
+        {    m_mgtVersion     = version; ForgetRepeatedSections(pid); }
+    void SetVersionTVCT(uint pid, uint tsid, int version)
+        { m_tvctVersion[tsid] = version; ForgetRepeatedSections(pid); }
+    void SetVersionCVCT(uint pid, uint tsid, int version)
+        { m_cvctVersion[tsid] = version; ForgetRepeatedSections(pid); }
+    void SetVersionRRT(uint pid, uint region, int version)
+        { m_rrtVersion[region&0xff] = version; ForgetRepeatedSections(pid); }
 
     int VersionMGT() const { return m_mgtVersion; }
     inline int VersionTVCT(uint tsid) const;
@@ -68,11 +68,13 @@ class MTV_PUBLIC DVBStreamData : virtual public MPEGStreamData
     void SetVersionSDT(uint tsid, int version, uint last_section)
     {
         m_sdtStatus.SetVersion(tsid, version, last_section);
+        ForgetRepeatedSections();
     }
 
     void SetVersionSDTo(uint tsid, int version, uint last_section)
     {
         m_sdtoStatus.SetVersion(tsid, version, last_section);
+        ForgetRepeatedSections();
     }
 
     // Sections seen
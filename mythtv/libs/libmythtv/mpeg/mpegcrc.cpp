@@ -0,0 +1,219 @@
+// -*- Mode: c++ -*-
+// C++ headers
+#include <array>
+#include <cstring>
+
+// Qt headers
+#include <QtGlobal>
+
+#include "mpegcrc.h"
+
+#if defined(Q_PROCESSOR_X86_64) && defined(__GNUC__)
+#   include <immintrin.h>
+#   define MPEG_CRC_PCLMUL 1 // NOLINT(cppcoreguidelines-macro-usage)
+#elif defined(__aarch64__) && \
+    (defined(__ARM_FEATURE_CRC32) || (defined(__GNUC__) && !defined(__clang__)))
+#   include <arm_acle.h>
+#   ifdef __linux__
+#       include <asm/hwcap.h>
+#       include <sys/auxv.h>
+#   endif
+#   define MPEG_CRC_ARMV8 1 // NOLINT(cppcoreguidelines-macro-usage)
+#endif
+
+static constexpr uint32_t kPolynomial { 0x04C11DB7 };
+
+using crc_tables_t = std::array<std::array<uint32_t,256>,8>;
+
+/*
+ * tables[k][i] is the CRC of byte i followed by k zero bytes, so that
+ * eight bytes can be folded into the CRC with eight independent lookups.
+ */
+static constexpr crc_tables_t make_tables(void)
+{
+    crc_tables_t tables {};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i << 24;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc << 1) ^ (((crc & 0x80000000) != 0U) ? kPolynomial : 0);
+        tables[0][i] = crc;
+    }
+    for (size_t k = 1; k < tables.size(); k++)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = tables[k-1][i];
+            tables[k][i] = (crc << 8) ^ tables[0][crc >> 24];
+        }
+    }
+    return tables;
+}
+
+static constexpr crc_tables_t kTables { make_tables() };
+
+static inline uint32_t load_be32(const unsigned char *data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) |
+           (uint32_t(data[2]) <<  8) |  uint32_t(data[3]);
+}
+
+uint32_t mpeg_crc32_sw(const unsigned char *data, size_t size, uint32_t crc)
+{
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        uint32_t one = crc ^ load_be32(data);
+        uint32_t two = load_be32(data + 4);
+        crc = kTables[7][one >> 24]         ^ kTables[6][(one >> 16) & 0xff] ^
+              kTables[5][(one >> 8) & 0xff] ^ kTables[4][one & 0xff]         ^
+              kTables[3][two >> 24]         ^ kTables[2][(two >> 16) & 0xff] ^
+              kTables[1][(two >> 8) & 0xff] ^ kTables[0][two & 0xff];
+    }
+    for (; size > 0; data++, size--)
+        crc = (crc << 8) ^ kTables[0][(crc >> 24) ^ *data];
+    return crc;
+}
+
+#if MPEG_CRC_PCLMUL
+/*
+ * Carry-less multiplication folding, after Intel's "Fast CRC Computation
+ * for Generic Polynomials Using PCLMULQDQ Instruction". The data is
+ * loaded byte reversed, so that bit 127 of a register holds the first
+ * bit of a block as it is the highest power of x. A block is moved D
+ * bits further down the data by multiplying its two halves with
+ * x^(D+64) and x^D mod P and the result added to the block there. What
+ * is left in the end has the same remainder as all the data before it,
+ * so the table code can take it from there.
+ */
+static constexpr uint64_t xpow_mod(uint n)
+{
+    uint32_t rem = 1;
+    for (uint i = 0; i < n; i++)
+        rem = (rem << 1) ^ (((rem & 0x80000000) != 0U) ? kPolynomial : 0);
+    return rem;
+}
+
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i load_block(const unsigned char *data)
+{
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), reverse);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i fold_block(__m128i block, __m128i keys, __m128i next)
+{
+    return _mm_xor_si128(
+        _mm_xor_si128(_mm_clmulepi64_si128(block, keys, 0x11),
+                      _mm_clmulepi64_si128(block, keys, 0x00)), next);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static uint32_t crc32_pclmul(const unsigned char *data, size_t size,
+                             uint32_t crc)
+{
+    if (size < 64)
+        return mpeg_crc32_sw(data, size, crc);
+
+    const __m128i keys4 = _mm_set_epi64x(xpow_mod(576), xpow_mod(512));
+    const __m128i keys1 = _mm_set_epi64x(xpow_mod(192), xpow_mod(128));
+
+    // The CRC so far adds to the first 32 bits of the data.
+    __m128i x0 = _mm_xor_si128(load_block(data),
+                               _mm_set_epi32(static_cast<int>(crc), 0, 0, 0));
+    __m128i x1 = load_block(data + 16);
+    __m128i x2 = load_block(data + 32);
+    __m128i x3 = load_block(data + 48);
+    data += 64;
+    size -= 64;
+
+    for (; size >= 64; data += 64, size -= 64)
+    {
+        x0 = fold_block(x0, keys4, load_block(data));
+        x1 = fold_block(x1, keys4, load_block(data + 16));
+        x2 = fold_block(x2, keys4, load_block(data + 32));
+        x3 = fold_block(x3, keys4, load_block(data + 48));
+    }
+
+    x0 = fold_block(x0, keys1, x1);
+    x0 = fold_block(x0, keys1, x2);
+    x0 = fold_block(x0, keys1, x3);
+    for (; size >= 16; data += 16, size -= 16)
+        x0 = fold_block(x0, keys1, load_block(data));
+
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15);
+    std::array<unsigned char,16> rest {};
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rest.data()),
+                     _mm_shuffle_epi8(x0, reverse));
+    crc = mpeg_crc32_sw(rest.data(), rest.size(), 0);
+    return mpeg_crc32_sw(data, size, crc);
+}
+
+static const char *s_hwName =
+    (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3"))
+    ? "PCLMULQDQ" : nullptr;
+#endif // MPEG_CRC_PCLMUL
+
+#if MPEG_CRC_ARMV8
+/*
+ * The ARMv8 CRC32 instructions compute the bit reflected CRC-32 with
+ * the same polynomial, which is the MPEG-2 CRC with the bits of every
+ * data byte and of the CRC itself in the opposite order.
+ */
+#   ifndef __ARM_FEATURE_CRC32
+__attribute__((target("+crc")))
+#   endif
+static uint32_t crc32_armv8(const unsigned char *data, size_t size,
+                            uint32_t crc)
+{
+    crc = __rbit(crc);
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        uint64_t word = 0;
+        memcpy(&word, data, sizeof(word));
+        // __rbitll() also reverses the byte order, __revll() undoes that.
+        crc = __crc32d(crc, __rbitll(__revll(word)));
+    }
+    for (; size > 0; data++, size--)
+        crc = __crc32b(crc, __rbit(*data) >> 24);
+    return __rbit(crc);
+}
+
+#   if defined(__ARM_FEATURE_CRC32)
+static const char *s_hwName = "ARMv8 CRC32";
+#   elif defined(__linux__)
+static const char *s_hwName =
+    ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0U) ? "ARMv8 CRC32" : nullptr;
+#   else
+static const char *s_hwName = nullptr;
+#   endif
+#endif // MPEG_CRC_ARMV8
+
+#if !MPEG_CRC_PCLMUL && !MPEG_CRC_ARMV8
+static const char *s_hwName = nullptr;
+#endif
+
+const char *mpeg_crc32_hw_name(void)
+{
+    return s_hwName;
+}
+
+uint32_t mpeg_crc32_hw(const unsigned char *data, size_t size, uint32_t crc)
+{
+#if MPEG_CRC_PCLMUL
+    if (s_hwName)
+        return crc32_pclmul(data, size, crc);
+#elif MPEG_CRC_ARMV8
+    if (s_hwName)
+        return crc32_armv8(data, size, crc);
+#endif
+    return mpeg_crc32_sw(data, size, crc);
+}
+
+uint32_t mpeg_crc32(const unsigned char *data, size_t size, uint32_t crc)
+{
+    return mpeg_crc32_hw(data, size, crc);
+}
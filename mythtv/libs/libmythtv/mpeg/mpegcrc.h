@@ -0,0 +1,34 @@
+// -*- Mode: c++ -*-
+#ifndef MPEG_CRC_H
+#define MPEG_CRC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libmythtv/mythtvexp.h"
+
+/*
+  CRC-32/MPEG-2 as used by PSIP sections, see ISO/IEC 13818-1 Annex A:
+  polynomial 0x04C11DB7, most significant bit first, no final xor.
+  The result is the value stored in the CRC_32 field of a section, and
+  running it over a section including that field yields 0.
+*/
+
+/// Computes the CRC, using the fastest implementation this CPU supports
+MTV_PUBLIC uint32_t mpeg_crc32(const unsigned char *data, size_t size,
+                               uint32_t crc = UINT32_MAX);
+
+/// Portable slice-by-8 table implementation of mpeg_crc32()
+MTV_PUBLIC uint32_t mpeg_crc32_sw(const unsigned char *data, size_t size,
+                                  uint32_t crc = UINT32_MAX);
+
+/// Carry-less multiply (x86) or CRC instruction (ARMv8) implementation of
+/// mpeg_crc32(), or mpeg_crc32_sw() if mpeg_crc32_hw_name() is nullptr
+MTV_PUBLIC uint32_t mpeg_crc32_hw(const unsigned char *data, size_t size,
+                                  uint32_t crc = UINT32_MAX);
+
+/// Name of the instructions used by mpeg_crc32_hw(), or nullptr if
+/// this CPU has none of them
+MTV_PUBLIC const char *mpeg_crc32_hw_name(void);
+
+#endif // MPEG_CRC_H
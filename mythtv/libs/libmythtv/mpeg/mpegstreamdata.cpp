@@ -42,6 +42,8 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, int cardnum,
       // Single program stuff
       m_desiredProgram(desiredProgram)
 {
+    m_psipPidState.resize(kPIDMask + 1);
+
     MPEGStreamData::AddListeningPID(PID::MPEG_PAT_PID);
     MPEGStreamData::AddListeningPID(PID::MPEG_CAT_PID);
 }
@@ -129,10 +131,12 @@ void MPEGStreamData::Reset(int desiredProgram)
     SetPATSingleProgram(nullptr);
     SetPMTSingleProgram(nullptr);
 
-    pid_psip_map_t old = m_partialPsipPacketCache;
-    for (auto it = old.begin(); it != old.end(); ++it)
-        DeletePartialPSIP(it.key());
-    m_partialPsipPacketCache.clear();
+    for (auto & state : m_psipPidState)
+    {
+        delete state.m_partial;
+        state.m_partial = nullptr;
+        state.m_redundant.reset();
+    }
 
     m_pidsListening.clear();
     m_pidsNotListening.clear();
@@ -170,13 +174,9 @@ void MPEGStreamData::Reset(int desiredProgram)
 
 void MPEGStreamData::DeletePartialPSIP(uint pid)
 {
-    pid_psip_map_t::iterator it = m_partialPsipPacketCache.find(pid);
-    if (it != m_partialPsipPacketCache.end())
-    {
-        PSIPTable *pkt = *it;
-        m_partialPsipPacketCache.erase(it);
-        delete pkt;
-    }
+    PSIPTable *&partial = m_psipPidState[pid & kPIDMask].m_partial;
+    delete partial;
+    partial = nullptr;
 }
 
 /**
@@ -854,99 +854,248 @@ void MPEGStreamData::UpdateTimeOffset(uint64_t _si_utc_time)
 
 }
 
-// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
-#define DONE_WITH_PSIP_PACKET() { delete psip; \
-    if (morePSIPTables) goto HAS_ANOTHER_PSIP; else return; }
-
 /** \fn MPEGStreamData::HandleTSTables(const TSPacket*)
  *  \brief Assembles PSIP packets and processes them.
  */
 void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
 {
+    uint table_id = 0;
+    if (IsRepeatedSection(*tspacket, table_id))
+    {
+        HandleRedundantTable(tspacket->PID(), table_id);
+        return;
+    }
+
     bool morePSIPTables = false;
-  HAS_ANOTHER_PSIP:
-    // Assemble PSIP
-    PSIPTable *psip = AssemblePSIP(tspacket, morePSIPTables);
-    if (!psip)
-       return;
+    do
+    {
+        // Assemble PSIP
+        PSIPTable *psip = AssemblePSIP(tspacket, morePSIPTables);
+        if (!psip)
+           return;
+
+        HandleAssembledTable(tspacket->PID(), *psip, tspacket->Scrambled());
+        delete psip;
+    } while (morePSIPTables);
+}
+
+MPEGStreamData::section_header_t MPEGStreamData::SectionHeader(
+    const unsigned char *section, uint size)
+{
+    section_header_t header {};
+    std::copy(section, section + std::min<uint>(size, header.size()),
+              header.begin());
+    return header;
+}
+
+static uint section_slot(uint table_id, uint table_id_ext, uint section)
+{
+    return (((table_id_ext * 31) + table_id) * 31 + section) & 0xff;
+}
+
+/** \brief Returns true if the packet starts a section that is identical
+ *         in its first kSectionHeaderSize bytes to one already found
+ *         to be redundant on this PID.
+ *
+ *   This lets a repeated section be dropped before it is assembled
+ *   and its CRC computed. The header covers the table id, table id
+ *   extension, version, current/next indicator, section number and
+ *   the first bytes of the table body, i.e. everything IsRedundant()
+ *   looks at, so such a section would be dropped by
+ *   HandleAssembledTable() as well. The caller must still emit the
+ *   PAT/PMT "heartbeat" with HandleRedundantTable() for \a table_id.
+ *   Continuation packets of a skipped section are ignored by
+ *   AssemblePSIP() as there is no partial section for them.
+ */
+bool MPEGStreamData::IsRepeatedSection(const TSPacket &tspacket,
+                                       uint &table_id) const
+{
+    const uint pid = tspacket.PID();
+    const PSIPPIDState &state = m_psipPidState[pid & kPIDMask];
+    if (!state.m_redundant || state.m_partial ||
+        !tspacket.PayloadStart() || tspacket.Scrambled())
+        return false;
+
+    const uint offset = tspacket.AFCOffset() + tspacket.StartOfFieldPointer() + 1;
+    if (offset + 3 > TSPacket::kSize)
+        return false;
+
+    const unsigned char *section = tspacket.data() + offset;
+    const uint available = TSPacket::kSize - offset;
+    const uint length = 3 + (((section[1] & 0x0f) << 8) | section[2]);
+    if (!(section[1] & 0x80) || length < 8)
+        return false;
+
+    const uint size = std::min<uint>(length, kSectionHeaderSize);
+    if (size > available)
+        return false;
+
+    // Another section starts in this packet, assemble it normally.
+    if (length < available && section[length] != 0xff)
+        return false;
+
+    const section_header_t &seen = (*state.m_redundant)[
+        section_slot(section[0], (section[3] << 8) | section[4], section[6])];
+    if (SectionHeader(section, size) != seen)
+        return false;
+
+    table_id = section[0];
+    return true;
+}
+
+/// Remembers a section HandleAssembledTable() found to be redundant
+void MPEGStreamData::RememberRedundantSection(uint pid, const PSIPTable &psip)
+{
+    if (!psip.SectionSyntaxIndicator() || psip.SectionLength() < 8)
+        return;
+
+    std::unique_ptr<section_headers_t> &redundant =
+        m_psipPidState[pid & kPIDMask].m_redundant;
+    if (!redundant)
+        redundant = std::make_unique<section_headers_t>();
+
+    (*redundant)[section_slot(psip.TableID(), psip.TableIDExtension(),
+                              psip.Section())] =
+        SectionHeader(psip.pesdata(), psip.SectionLength());
+}
+
+/// Forgets the redundant sections of the table \a psip belongs to
+void MPEGStreamData::ForgetSections(uint pid, const PSIPTable &psip)
+{
+    std::unique_ptr<section_headers_t> &redundant =
+        m_psipPidState[pid & kPIDMask].m_redundant;
+    if (!redundant)
+        return;
+
+    const section_header_t key = SectionHeader(psip.pesdata(), 5);
+    for (auto & header : *redundant)
+    {
+        if (header[0] == key[0] && header[3] == key[3] && header[4] == key[4])
+            header.fill(0);
+    }
+}
+
+/// Forgets all redundant sections, so that they are processed again
+void MPEGStreamData::ForgetRepeatedSections(void)
+{
+    for (auto & state : m_psipPidState)
+    {
+        // Cleared in place, this may be called from a signal monitor.
+        if (state.m_redundant)
+            state.m_redundant->fill(section_header_t {});
+    }
+}
 
+/// Forgets the redundant sections seen on \a pid
+void MPEGStreamData::ForgetRepeatedSections(uint pid)
+{
+    PSIPPIDState &state = m_psipPidState[pid & kPIDMask];
+    if (state.m_redundant)
+        state.m_redundant->fill(section_header_t {});
+}
+
+/// Emits the PAT/PMT "heartbeat" for a redundant table
+void MPEGStreamData::HandleRedundantTable(uint pid, uint table_id)
+{
+    if (TableID::PAT == table_id)
+    {
+        QMutexLocker locker(&m_listenerLock);
+        ProgramAssociationTable *pat_sp = PATSingleProgram();
+        for (auto & listener : m_mpegSpListeners)
+            listener->HandleSingleProgramPAT(pat_sp, false);
+    }
+    if (TableID::PMT == table_id &&
+        pid == m_pidPmtSingleProgram)
+    {
+        QMutexLocker locker(&m_listenerLock);
+        ProgramMapTable *pmt_sp = PMTSingleProgram();
+        for (auto & listener : m_mpegSpListeners)
+            listener->HandleSingleProgramPMT(pmt_sp, false);
+    }
+}
+
+/** \fn MPEGStreamData::HandleAssembledTable(uint,const PSIPTable&,bool)
+ *  \brief Validates an assembled PSIP section and processes it.
+ *
+ *   This is split out of HandleTSTables() so that a StreamHandler
+ *   feeding several MPEGStreamData instances from one multiplex can
+ *   assemble each section only once and hand the result to every
+ *   listener that is only interested in the tables on that PID.
+ */
+void MPEGStreamData::HandleAssembledTable(uint pid, const PSIPTable &psip,
+                                          bool scrambled)
+{
     // drop stuffing packets
-    if ((TableID::ST       == psip->TableID()) ||
-        (TableID::STUFFING == psip->TableID()))
+    if ((TableID::ST       == psip.TableID()) ||
+        (TableID::STUFFING == psip.TableID()))
     {
         LOG(VB_RECORD, LOG_DEBUG, LOC + "Dropping Stuffing table");
-        DONE_WITH_PSIP_PACKET();
+        return;
     }
 
     // Don't do validation on tables without CRC
-    if (!psip->HasCRC())
+    if (!psip.HasCRC())
     {
-        HandleTables(tspacket->PID(), *psip);
-        DONE_WITH_PSIP_PACKET();
+        HandleTables(pid, psip);
+        return;
     }
 
     // Validate PSIP
     // but don't validate PMT/PAT if our driver has the PMT/PAT CRC bug.
     bool buggy = m_haveCrcBug &&
-        ((TableID::PMT == psip->TableID()) ||
-         (TableID::PAT == psip->TableID()));
-    if (!buggy && !psip->IsGood())
+        ((TableID::PMT == psip.TableID()) ||
+         (TableID::PAT == psip.TableID()));
+    if (!buggy && !psip.IsGood())
     {
         LOG(VB_RECORD, LOG_ERR, LOC +
             QString("PSIP packet failed CRC check. pid(0x%1) type(0x%2)")
-                .arg(tspacket->PID(),0,16).arg(psip->TableID(),0,16));
-        DONE_WITH_PSIP_PACKET();
+                .arg(pid,0,16).arg(psip.TableID(),0,16));
+        return;
     }
 
-    if (TableID::MGT <= psip->TableID() && psip->TableID() <= TableID::STT &&
-        !psip->IsCurrent())
+    if (TableID::MGT <= psip.TableID() && psip.TableID() <= TableID::STT &&
+        !psip.IsCurrent())
     { // we don't cache the next table, for now
         LOG(VB_RECORD, LOG_DEBUG, LOC + QString("Table not current 0x%1")
-            .arg(psip->TableID(),2,16,QChar('0')));
-        DONE_WITH_PSIP_PACKET();
+            .arg(psip.TableID(),2,16,QChar('0')));
+        return;
     }
 
-    if (tspacket->Scrambled())
+    if (scrambled)
     { // scrambled! ATSC, DVB require tables not to be scrambled
         LOG(VB_RECORD, LOG_ERR, LOC +
             "PSIP packet is scrambled, not ATSC/DVB compliant");
-        DONE_WITH_PSIP_PACKET();
+        return;
     }
 
-    if (!psip->VerifyPSIP(!m_haveCrcBug))
+    // The CRC was already checked via IsGood() above, which is computed
+    // when the section is assembled, so only verify the structure here.
+    if (!psip.VerifyPSIP(false))
     {
         LOG(VB_RECORD, LOG_ERR, LOC + QString("PSIP table 0x%1 is invalid")
-            .arg(psip->TableID(),2,16,QChar('0')));
-        DONE_WITH_PSIP_PACKET();
+            .arg(psip.TableID(),2,16,QChar('0')));
+        return;
     }
 
+    // DVBStreamData may rewrite a NIT before it checks for redundancy,
+    // so leave those to HandleTables().
+    bool remember = (TableID::NIT != psip.TableID()) &&
+                    (TableID::NITo != psip.TableID());
+
     // Don't decode redundant packets,
     // but if it is a desired PAT or PMT emit a "heartbeat" signal.
-    if (MPEGStreamData::IsRedundant(tspacket->PID(), *psip))
+    if (remember && IsRedundant(pid, psip))
     {
-        if (TableID::PAT == psip->TableID())
-        {
-            QMutexLocker locker(&m_listenerLock);
-            ProgramAssociationTable *pat_sp = PATSingleProgram();
-            for (auto & listener : m_mpegSpListeners)
-                listener->HandleSingleProgramPAT(pat_sp, false);
-        }
-        if (TableID::PMT == psip->TableID() &&
-            tspacket->PID() == m_pidPmtSingleProgram)
-        {
-            QMutexLocker locker(&m_listenerLock);
-            ProgramMapTable *pmt_sp = PMTSingleProgram();
-            for (auto & listener : m_mpegSpListeners)
-                listener->HandleSingleProgramPMT(pmt_sp, false);
-        }
-        DONE_WITH_PSIP_PACKET(); // already parsed this table, toss it.
+        RememberRedundantSection(pid, psip);
+        HandleRedundantTable(pid, psip.TableID());
+        return; // already parsed this table, toss it.
     }
 
-    HandleTables(tspacket->PID(), *psip);
+    // A new version, older repeats are no longer redundant.
+    ForgetSections(pid, psip);
 
-    DONE_WITH_PSIP_PACKET();
+    HandleTables(pid, psip);
 }
-#undef DONE_WITH_PSIP_PACKET
 
 int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
 {
@@ -1013,22 +1162,8 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
     if (tspacket.Scrambled())
         return true;
 
-    // Discard broken packets with invalid adaptation field length
-    // See ISO/IEC 13818-1 : 2000 (E). 2.4.3.5 Semantic definition of fields in adaptation field
-    if (tspacket.HasAdaptationField())
-    {
-        size_t afsize = tspacket.AdaptationFieldSize();
-        bool validsize = (tspacket.HasPayload())
-            ? afsize <= 182
-            : afsize == 183;
-        if (!validsize)
-        {
-            LOG(VB_RECORD, LOG_DEBUG, QString("Invalid adaptation field, type %3, size %4")
-                .arg(tspacket.AdaptationFieldControl()).arg(afsize) + "\n" +
-                tspacket.toString());
-            return false;
-        }
-    }
+    if (!HasValidAdaptationField(tspacket))
+        return false;
 
     if (VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
     {
@@ -1079,6 +1214,26 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
     return true;
 }
 
+/// Discard broken packets with invalid adaptation field length
+/// See ISO/IEC 13818-1 : 2000 (E). 2.4.3.5 Semantic definition of fields in adaptation field
+bool MPEGStreamData::HasValidAdaptationField(const TSPacket& tspacket)
+{
+    if (!tspacket.HasAdaptationField())
+        return true;
+
+    size_t afsize = tspacket.AdaptationFieldSize();
+    bool validsize = (tspacket.HasPayload())
+        ? afsize <= 182
+        : afsize == 183;
+    if (!validsize)
+    {
+        LOG(VB_RECORD, LOG_DEBUG, QString("Invalid adaptation field, type %3, size %4")
+            .arg(tspacket.AdaptationFieldControl()).arg(afsize) + "\n" +
+            tspacket.toString());
+    }
+    return validsize;
+}
+
 int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
                                  int len)
 {
@@ -1099,6 +1254,26 @@ int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
     return pos;
 }
 
+/** \brief Returns true if ProcessTSPacket() would do anything with
+ *         packets on this PID.
+ */
+bool MPEGStreamData::WantsTSPacket(uint pid) const
+{
+    return IsVideoPID(pid) || IsAudioPID(pid) || IsWritingPID(pid) ||
+        IsListeningPID(pid) || IsEncryptionTestPID(pid);
+}
+
+/** \brief Returns true if packets on this PID are only used to assemble
+ *         PSIP tables, so that the sections may be assembled once by a
+ *         shared demultiplexer and passed to HandleAssembledTable().
+ */
+bool MPEGStreamData::IsTableOnlyPID(uint pid) const
+{
+    return IsListeningPID(pid) && !IsConditionalAccessPID(pid) &&
+        !IsVideoPID(pid) && !IsAudioPID(pid) && !IsWritingPID(pid) &&
+        !IsEncryptionTestPID(pid);
+}
+
 bool MPEGStreamData::IsConditionalAccessPID(uint pid) const
 {
     pid_map_t::const_iterator it = m_pidsConditionalAccess.find(pid);
@@ -1174,16 +1349,10 @@ PIDPriority MPEGStreamData::GetPIDPriority(uint pid) const
 
 void MPEGStreamData::SavePartialPSIP(uint pid, PSIPTable* packet)
 {
-    pid_psip_map_t::iterator it = m_partialPsipPacketCache.find(pid);
-    if (it == m_partialPsipPacketCache.end())
-        m_partialPsipPacketCache[pid] = packet;
-    else
-    {
-        PSIPTable *old = *it;
-        m_partialPsipPacketCache.remove(pid);
-        m_partialPsipPacketCache.insert(pid, packet);
-        delete old;
-    }
+    PSIPTable *&partial = m_psipPidState[pid & kPIDMask].m_partial;
+    if (partial != packet)
+        delete partial;
+    partial = packet;
 }
 
 bool MPEGStreamData::HasAllPATSections(uint tsid) const
@@ -4,7 +4,9 @@
 #define MPEGSTREAMDATA_H_
 
 // C++
+#include <array>
 #include <cstdint>  // uint64_t
+#include <memory>
 #include <vector>
 
 // Qt
@@ -23,7 +25,6 @@ class PSIPTable;
 
 using uint_vec_t = std::vector<uint>;
 
-using pid_psip_map_t    = QMap<unsigned int, PSIPTable*>;
 using psip_refcnt_map_t = QMap<const PSIPTable*, int>;
 
 using pat_ptr_t         = ProgramAssociationTable *;
@@ -109,9 +110,13 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
 
     // Table processing
     void SetIgnoreCRC(bool haveCRCbug) { m_haveCrcBug = haveCRCbug; }
+    bool HasCRCBug(void) const { return m_haveCrcBug; }
     virtual bool IsRedundant(uint pid, const PSIPTable &psip) const;
     virtual bool HandleTables(uint pid, const PSIPTable &psip);
     virtual void HandleTSTables(const TSPacket* tspacket);
+    void HandleAssembledTable(uint pid, const PSIPTable &psip, bool scrambled);
+    bool IsRepeatedSection(const TSPacket &tspacket, uint &table_id) const;
+    void HandleRedundantTable(uint pid, uint table_id);
     virtual bool ProcessTSPacket(const TSPacket& tspacket);
     virtual int  ProcessData(const unsigned char *buffer, int len);
     inline  void HandleAdaptationFieldControl(const TSPacket* tspacket);
@@ -145,6 +150,9 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
         { return m_pidVideoSingleProgram == pid; }
     virtual bool IsAudioPID(uint pid) const;
     virtual bool IsConditionalAccessPID(uint pid) const;
+    virtual bool WantsTSPacket(uint pid) const;
+    virtual bool IsTableOnlyPID(uint pid) const;
+    bool HasPSListeners(void) const { return !m_psListeners.empty(); }
 
     const pid_map_t& ListeningPIDs(void) const
         { return m_pidsListening; }
@@ -162,11 +170,15 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     void SetVersionPAT(uint tsid, int version, uint last_section)
     {
         m_patStatus.SetVersion(tsid, version, last_section);
+        ForgetRepeatedSections();
     }
     void SetVersionPMT(uint pnum, int version, uint last_section)
     {
         m_pmtStatus.SetVersion(pnum, version, last_section);
+        ForgetRepeatedSections();
     }
+    void ForgetRepeatedSections(void);
+    void ForgetRepeatedSections(uint pid);
 
     // Sections seen
     bool HasAllPATSections(uint tsid) const;
@@ -284,16 +296,19 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     bool AssemblePSIP(PSIPTable& psip, TSPacket* tspacket);
     void SavePartialPSIP(uint pid, PSIPTable* packet);
     PSIPTable* GetPartialPSIP(uint pid)
-        { return m_partialPsipPacketCache[pid]; }
+        { return m_psipPidState[pid & kPIDMask].m_partial; }
     void ClearPartialPSIP(uint pid)
-        { m_partialPsipPacketCache.remove(pid); }
+        { m_psipPidState[pid & kPIDMask].m_partial = nullptr; }
     void DeletePartialPSIP(uint pid);
+    void RememberRedundantSection(uint pid, const PSIPTable &psip);
+    void ForgetSections(uint pid, const PSIPTable &psip);
     void ProcessPAT(const ProgramAssociationTable *pat);
     void ProcessCAT(const ConditionalAccessTable *cat);
     void ProcessPMT(const ProgramMapTable *pmt);
     void ProcessEncryptedPacket(const TSPacket &tspacket);
 
     static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
+    static bool HasValidAdaptationField(const TSPacket& tspacket);
 
     void UpdateTimeOffset(uint64_t si_utc_time);
 
@@ -356,7 +371,24 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     TableStatusMap            m_pmtStatus;
 
     // PSIP construction
-    pid_psip_map_t            m_partialPsipPacketCache;
+    static constexpr uint kPIDMask            { 0x1fff };
+    /// Bytes of a section that identify a repeat of it, see IsRepeatedSection
+    static constexpr uint kSectionHeaderSize  { 16 };
+    static constexpr uint kRepeatedSections   { 256 };
+    using section_header_t = std::array<unsigned char, kSectionHeaderSize>;
+    using section_headers_t = std::array<section_header_t, kRepeatedSections>;
+    struct PSIPPIDState
+    {
+        /// The section being assembled
+        PSIPTable                          *m_partial {nullptr};
+        /// Headers of the sections found to be redundant, by
+        /// table id, table id extension and section number
+        std::unique_ptr<section_headers_t>  m_redundant;
+    };
+    /// Section assembly state for each of the 8192 PIDs
+    std::vector<PSIPPIDState>  m_psipPidState;
+    static section_header_t SectionHeader(const unsigned char *section,
+                                          uint size);
 
     // Caching
     bool                             m_cacheTables;
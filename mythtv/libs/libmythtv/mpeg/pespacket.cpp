@@ -3,18 +3,22 @@
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/sizetliteral.h"
 #include "pespacket.h"
+#include "mpegcrc.h"
 #include "mpegtables.h"
 
 extern "C" {
 #include "libmythbase/mythconfig.h"
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
-#include "libavutil/crc.h"
-#include "libavutil/bswap.h"
 }
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
 #include <vector>
-#include <map>
+
+#include <QMutex>
 
 // return true if complete or broken
 bool PESPacket::AddTSPacket(const TSPacket* packet, int cardid, bool &broken)
@@ -162,8 +166,7 @@ uint PESPacket::CalcCRC(void) const
 {
     if (Length() < 1)
         return kTheMagicNoCRCCRC;
-    return av_bswap32(av_crc(av_crc_get_table(AV_CRC_32_IEEE), UINT32_MAX,
-                             m_pesData, Length() - 1));
+    return mpeg_crc32(m_pesData, Length() - 1);
 }
 
 bool PESPacket::VerifyCRC(void) const
@@ -241,140 +244,353 @@ float SequenceHeader::aspect(bool mpeg1) const
 // Memory allocator to avoid malloc global lock and waste less memory. //
 /////////////////////////////////////////////////////////////////////////
 
-#ifndef USING_VALGRIND
-static std::vector<unsigned char*> mem188;
-static std::vector<unsigned char*> free188;
-static std::map<unsigned char*, bool> alloc188;
+/*
+ * Every block carries a small header in front of the returned pointer
+ * recording its size class, the slab it was carved from and the thread
+ * cache that handed it out, so pes_free() needs no lookup table.  Each
+ * thread keeps a "magazine" of free blocks per size class and only goes
+ * to the depot to exchange a whole batch of blocks, so tuner threads,
+ * the EIT scanner and the signal monitors no longer contend on a single
+ * mutex for every block.  The depot has a lock per size class, and
+ * hands slabs back to the system once they are entirely free.
+ */
 
-static std::vector<unsigned char*> mem4096;
-static std::vector<unsigned char*> free4096;
-static std::map<unsigned char*, bool> alloc4096;
+namespace {
 
-static constexpr size_t BLOCKS188 { 512 };
-static unsigned char* get_188_block()
+enum PESSizeClass : uint16_t
 {
-    if (free188.empty())
-    {
-        mem188.push_back((unsigned char*) malloc(188_UZ * BLOCKS188));
-        free188.reserve(BLOCKS188);
-        unsigned char* block_start = mem188.back();
-        for (size_t i = 0; i < BLOCKS188; ++i)
-            free188.push_back(i * 188_UZ + block_start);
-    }
+    kPES188   = 0,
+    kPES4096  = 1,
+    kPESLarge = 2,
+};
 
-    unsigned char *ptr = free188.back();
-    free188.pop_back();
-    alloc188[ptr] = true;
-    return ptr;
-}
+struct alignas(16) PESBlockHeader
+{
+    uint32_t m_owner;      ///< id of the thread cache that allocated it
+    uint16_t m_sizeClass;  ///< PESSizeClass
+    uint16_t m_magic;
+    uint32_t m_slab;       ///< index of the depot slab holding it
+};
+static_assert(sizeof(PESBlockHeader) == 16);
 
-static bool is_188_block(unsigned char* ptr)
+constexpr uint16_t kPESMagic       { 0x7e5a };
+constexpr size_t   kMagazineSize   { 64 };
+/// Fully free slabs kept in reserve before returning them to the system.
+constexpr size_t   kSpareSlabs     { 1 };
+
+constexpr std::array<size_t,2> kBlockSize   { 188, 4096 };
+constexpr std::array<size_t,2> kBlocksPerSlab { 512, 128 };
+
+constexpr size_t stride(uint sc)
 {
-    return alloc188.find(ptr) != alloc188.end();
+    return (sizeof(PESBlockHeader) + kBlockSize[sc] + 15) & ~size_t(15);
 }
 
-static void return_188_block(unsigned char* ptr)
+std::array<std::atomic<int64_t>,3> s_inUse      {};
+std::array<std::atomic<int64_t>,3> s_highWater  {};
+std::atomic<uint64_t>              s_crossFrees {0};
+std::atomic<uint32_t>              s_nextOwner  {1};
+
+void count_alloc(uint sc)
 {
-    alloc188.erase(ptr);
-    free188.push_back(ptr);
-    // free the allocator only if more than 1 block was used
-    if (alloc188.empty() && mem188.size() > 1)
+    int64_t now = ++s_inUse[sc];
+    int64_t high = s_highWater[sc].load(std::memory_order_relaxed);
+    while (now > high &&
+           !s_highWater[sc].compare_exchange_weak(high, now,
+                                                  std::memory_order_relaxed))
     {
-        std::vector<unsigned char*>::iterator it;
-        for (it = mem188.begin(); it != mem188.end(); ++it)
-            free(*it);
-        mem188.clear();
-        free188.clear();
-#if 0
-        LOG(VB_GENERAL, LOG_DEBUG, "freeing all 188 blocks");
-#endif
     }
 }
 
-static constexpr size_t BLOCKS4096 { 128 };
-static unsigned char* get_4096_block()
+/// Free blocks of one size class, only touched a magazine at a time.
+class PESDepot
 {
-    if (free4096.empty())
+  public:
+    explicit PESDepot(uint sc) : m_sc(sc) {}
+
+    void Get(std::vector<PESBlockHeader*> &mag, size_t count)
+    {
+        QMutexLocker locker(&m_lock);
+        while (m_free.size() < count)
+            AddSlab();
+        for (auto it = m_free.end() - count; it != m_free.end(); ++it)
+            Take(*it);
+        mag.insert(mag.end(), m_free.end() - count, m_free.end());
+        m_free.resize(m_free.size() - count);
+    }
+
+    void Put(std::vector<PESBlockHeader*> &mag, size_t count)
+    {
+        QMutexLocker locker(&m_lock);
+        for (auto it = mag.end() - count; it != mag.end(); ++it)
+            Return(*it);
+        m_free.insert(m_free.end(), mag.end() - count, mag.end());
+        mag.resize(mag.size() - count);
+        if (m_emptySlabs > kSpareSlabs)
+            Trim();
+    }
+
+  private:
+    struct Slab
+    {
+        unsigned char *m_mem  { nullptr };
+        size_t         m_free { 0 };
+    };
+
+    void Take(PESBlockHeader *hdr)
+    {
+        Slab &slab = m_slabs[hdr->m_slab];
+        if (slab.m_free-- == kBlocksPerSlab[m_sc])
+            --m_emptySlabs;
+    }
+
+    void Return(PESBlockHeader *hdr)
     {
-        mem4096.push_back((unsigned char*) malloc(4096_UZ * BLOCKS4096));
-        free4096.reserve(BLOCKS4096);
-        unsigned char* block_start = mem4096.back();
-        for (size_t i = 0; i < BLOCKS4096; ++i)
-            free4096.push_back(i * 4096_UZ + block_start);
+        Slab &slab = m_slabs[hdr->m_slab];
+        if (++slab.m_free == kBlocksPerSlab[m_sc])
+            ++m_emptySlabs;
     }
 
-    unsigned char *ptr = free4096.back();
-    free4096.pop_back();
-    alloc4096[ptr] = true;
-    return ptr;
+    void AddSlab(void)
+    {
+        size_t blocks = kBlocksPerSlab[m_sc];
+        auto *mem = static_cast<unsigned char*>(
+            aligned_alloc(16, stride(m_sc) * blocks));
+
+        auto index = static_cast<uint32_t>(m_slabs.size());
+        if (m_unusedSlabs.empty())
+        {
+            m_slabs.emplace_back();
+        }
+        else
+        {
+            index = m_unusedSlabs.back();
+            m_unusedSlabs.pop_back();
+        }
+        m_slabs[index] = { mem, blocks };
+        ++m_emptySlabs;
+
+        m_free.reserve(m_free.size() + blocks);
+        for (size_t i = 0; i < blocks; ++i)
+        {
+            auto *hdr = reinterpret_cast<PESBlockHeader*>(mem + i * stride(m_sc));
+            hdr->m_sizeClass = m_sc;
+            hdr->m_magic     = kPESMagic;
+            hdr->m_slab      = index;
+            m_free.push_back(hdr);
+        }
+    }
+
+    /// Releases fully free slabs beyond the spare ones.
+    void Trim(void)
+    {
+        std::vector<bool> release(m_slabs.size(), false);
+        size_t keep = kSpareSlabs;
+        for (size_t i = 0; i < m_slabs.size(); ++i)
+        {
+            if (!m_slabs[i].m_mem || m_slabs[i].m_free != kBlocksPerSlab[m_sc])
+                continue;
+            if (keep)
+                --keep;
+            else
+                release[i] = true;
+        }
+
+        m_free.erase(std::remove_if(m_free.begin(), m_free.end(),
+                                    [&release](PESBlockHeader *hdr)
+                                    { return release[hdr->m_slab]; }),
+                     m_free.end());
+
+        for (size_t i = 0; i < m_slabs.size(); ++i)
+        {
+            if (!release[i])
+                continue;
+            free(m_slabs[i].m_mem);
+            m_slabs[i] = {};
+            m_unusedSlabs.push_back(static_cast<uint32_t>(i));
+            --m_emptySlabs;
+        }
+    }
+
+    const uint                   m_sc;
+    QMutex                       m_lock;
+    std::vector<PESBlockHeader*> m_free;
+    std::vector<Slab>            m_slabs;
+    std::vector<uint32_t>        m_unusedSlabs;
+    size_t                       m_emptySlabs { 0 };
+};
+
+PESDepot &pes_depot(uint sc)
+{
+    // Intentionally leaked, blocks may be freed by threads that exit
+    // after static destruction has begun.
+    static auto *s_depots = new std::array<PESDepot,2> {
+        PESDepot(kPES188), PESDepot(kPES4096) };
+    return (*s_depots)[sc];
 }
 
-static bool is_4096_block(unsigned char* ptr)
+/// Per thread magazines of free blocks.
+class PESThreadCache
 {
-    return alloc4096.find(ptr) != alloc4096.end();
+  public:
+    PESThreadCache()
+    {
+        for (auto & mag : m_mags)
+            mag.reserve(kMagazineSize * 2);
+    }
+
+    void Flush(void)
+    {
+        for (uint sc = kPES188; sc <= kPES4096; ++sc)
+            if (!m_mags[sc].empty())
+                pes_depot(sc).Put(m_mags[sc], m_mags[sc].size());
+    }
+
+    unsigned char *Alloc(uint sc)
+    {
+        std::vector<PESBlockHeader*> &mag = m_mags[sc];
+        if (mag.empty())
+            pes_depot(sc).Get(mag, kMagazineSize);
+        PESBlockHeader *hdr = mag.back();
+        mag.pop_back();
+        hdr->m_owner = m_id;
+        count_alloc(sc);
+        return reinterpret_cast<unsigned char*>(hdr + 1);
+    }
+
+    void Free(PESBlockHeader *hdr)
+    {
+        uint sc = hdr->m_sizeClass;
+        if (hdr->m_owner != m_id)
+            s_crossFrees.fetch_add(1, std::memory_order_relaxed);
+        --s_inUse[sc];
+        std::vector<PESBlockHeader*> &mag = m_mags[sc];
+        mag.push_back(hdr);
+        if (mag.size() >= kMagazineSize * 2)
+            pes_depot(sc).Put(mag, kMagazineSize);
+    }
+
+  private:
+    uint32_t m_id { s_nextOwner++ };
+    std::array<std::vector<PESBlockHeader*>,2> m_mags;
+};
+
+// The cache pointer and flag are trivially destructible so they stay
+// usable while the thread's other thread_local objects, or the static
+// objects of the main thread, are being destroyed.  Once the guard has
+// flushed the cache, blocks go straight to and from the depot.
+thread_local PESThreadCache *t_pesCache     { nullptr };
+thread_local bool            t_pesCacheGone { false };
+
+/// Flushes the calling thread's magazines back to the depot at exit.
+class PESThreadCacheGuard
+{
+  public:
+    ~PESThreadCacheGuard()
+    {
+        if (t_pesCache)
+            t_pesCache->Flush();
+        delete t_pesCache;
+        t_pesCache     = nullptr;
+        t_pesCacheGone = true;
+    }
+
+    bool m_armed { false };
+};
+
+thread_local PESThreadCacheGuard t_pesCacheGuard;
+
+/// Returns the calling thread's cache, or nullptr if the thread is exiting.
+PESThreadCache *pes_cache(void)
+{
+    if (t_pesCache || t_pesCacheGone)
+        return t_pesCache;
+    t_pesCacheGuard.m_armed = true;
+    t_pesCache = new PESThreadCache;
+    return t_pesCache;
 }
 
-static void return_4096_block(unsigned char* ptr)
+unsigned char *pes_alloc_block(uint sc)
 {
-    alloc4096.erase(ptr);
-    free4096.push_back(ptr);
-
-#if 0 // enable this to debug memory leaks
-        LOG(VB_GENERAL, LOG_DEBUG, QString("%1 4096 blocks remain")
-            .arg(alloc4096.size()));
-        map<unsigned char*, bool>::iterator it;
-        for (it = alloc4096.begin(); it != alloc4096.end(); ++it)
-        {
-            TSPacket *ts = (TSPacket*) it->first;
-            LGO(VB_GENERAL, LOG_DEBUG, QString("PES Packet: pid(0x%1)")
-                .arg(ts->PID(),0,16));
-            if (ts->PID() == 0x1ffb)
-            {
-                LOG(VB_GENERAL, LOG_DEBUG, QString(" tid(0x%1) ext(0x%2)")
-                    .arg(PSIPTable(*ts).TableID(),0,16)
-                    .arg(PSIPTable(*ts).TableIDExtension(),0,16));
-            }
-        }
-#endif
+    PESThreadCache *cache = pes_cache();
+    if (cache)
+        return cache->Alloc(sc);
+
+    std::vector<PESBlockHeader*> mag;
+    pes_depot(sc).Get(mag, 1);
+    mag.back()->m_owner = 0;
+    count_alloc(sc);
+    return reinterpret_cast<unsigned char*>(mag.back() + 1);
+}
 
-    // free the allocator only if more than 1 block was used
-    if (alloc4096.empty() && mem4096.size() > 1)
+void pes_free_block(PESBlockHeader *hdr)
+{
+    PESThreadCache *cache = pes_cache();
+    if (cache)
     {
-        std::vector<unsigned char*>::iterator it;
-        for (it = mem4096.begin(); it != mem4096.end(); ++it)
-            free(*it);
-        mem4096.clear();
-        free4096.clear();
-#if 0
-        LOG(VB_GENERAL, LOG_DEBUG, "freeing all 4096 blocks");
-#endif
+        cache->Free(hdr);
+        return;
     }
+
+    s_crossFrees.fetch_add(1, std::memory_order_relaxed);
+    --s_inUse[hdr->m_sizeClass];
+    std::vector<PESBlockHeader*> mag { hdr };
+    pes_depot(hdr->m_sizeClass).Put(mag, 1);
 }
-#endif
 
-static QMutex pes_alloc_mutex;
+} // namespace
 
 unsigned char *pes_alloc(uint size)
 {
-    QMutexLocker locker(&pes_alloc_mutex);
 #ifndef USING_VALGRIND
     if (size <= 188)
-        return get_188_block();
+        return pes_alloc_block(kPES188);
     if (size <= 4096)
-        return get_4096_block();
-#endif // USING_VALGRIND
+        return pes_alloc_block(kPES4096);
+    auto *hdr = static_cast<PESBlockHeader*>(
+        malloc(sizeof(PESBlockHeader) + size));
+    hdr->m_owner     = 0;
+    hdr->m_sizeClass = kPESLarge;
+    hdr->m_magic     = kPESMagic;
+    hdr->m_slab      = 0;
+    count_alloc(kPESLarge);
+    return reinterpret_cast<unsigned char*>(hdr + 1);
+#else
     return (unsigned char*) malloc(size);
+#endif // USING_VALGRIND
 }
 
 void pes_free(unsigned char *ptr)
 {
-    QMutexLocker locker(&pes_alloc_mutex);
 #ifndef USING_VALGRIND
-    if (is_188_block(ptr))
-        return_188_block(ptr);
-    else if (is_4096_block(ptr))
-        return_4096_block(ptr);
-    else
+    if (!ptr)
+        return;
+    auto *hdr = reinterpret_cast<PESBlockHeader*>(ptr) - 1;
+    if (hdr->m_magic != kPESMagic)
+    {
+        LOG(VB_GENERAL, LOG_ERR, "pes_free: not a pes_alloc() block");
+        return;
+    }
+    if (hdr->m_sizeClass == kPESLarge)
+    {
+        --s_inUse[kPESLarge];
+        free(hdr);
+        return;
+    }
+    pes_free_block(hdr);
+#else
+    free(ptr);
 #endif // USING_VALGRIND
-        free(ptr);
+}
+
+PESAllocStats pes_alloc_stats(void)
+{
+    PESAllocStats stats;
+    for (uint sc = kPES188; sc <= kPESLarge; ++sc)
+    {
+        stats.m_inUse[sc]     = s_inUse[sc].load(std::memory_order_relaxed);
+        stats.m_highWater[sc] = s_highWater[sc].load(std::memory_order_relaxed);
+    }
+    stats.m_crossThreadFrees = s_crossFrees.load(std::memory_order_relaxed);
+    return stats;
 }
@@ -8,6 +8,8 @@
   max length of private_section = 4096 bytes
 */
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
 using AspectArray = std::array<float,16>;
@@ -19,6 +21,16 @@ using AspectArray = std::array<float,16>;
 MTV_PUBLIC unsigned char *pes_alloc(uint size);
 MTV_PUBLIC void pes_free(unsigned char *ptr);
 
+/// Counters for the pes_alloc() block allocator, indexed by size class
+/// (188 byte, 4096 byte and larger blocks).
+struct PESAllocStats
+{
+    std::array<int64_t,3> m_inUse            {};
+    std::array<int64_t,3> m_highWater        {};
+    uint64_t              m_crossThreadFrees {0};
+};
+MTV_PUBLIC PESAllocStats pes_alloc_stats(void);
+
 /** \class PESPacket
  *  \brief Allows us to transform TS packets to PES packets, which
  *         are used to hold multimedia streams and very similar to PSIP tables.
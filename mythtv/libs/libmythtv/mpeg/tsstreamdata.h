@@ -15,6 +15,10 @@ class MTV_PUBLIC TSStreamData : public MPEGStreamData
     ~TSStreamData() override { ; }
 
     bool ProcessTSPacket(const TSPacket& tspacket) override; // MPEGStreamData
+    bool WantsTSPacket(uint /* pid */) const override // MPEGStreamData
+        { return true; }
+    bool IsTableOnlyPID(uint /* pid */) const override // MPEGStreamData
+        { return false; }
 
     using MPEGStreamData::Reset;
     void Reset(int /* desiredProgram */) override { ; } // MPEGStreamData
@@ -22,6 +22,7 @@ extern "C" {
 #include "libavcodec/avcodec.h"
 #include "libavutil/imgutils.h"
 #include "libavformat/avformat.h"
+#include "libswscale/swscale.h"
 }
 
 AVPixelFormat MythAVUtil::FrameTypeToPixelFormat(VideoFrameType Type)
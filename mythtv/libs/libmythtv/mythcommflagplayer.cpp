@@ -4,6 +4,7 @@
 // MythTV
 #include "libmythbase/mthreadpool.h"
 #include "libmythbase/mythlogging.h"
+#include "io/mythmediabuffer.h"
 #include "mythcommflagplayer.h"
 
 // Std
@@ -252,3 +253,65 @@ MythVideoFrame* MythCommFlagPlayer::GetRawVideoFrame(long long FrameNumber)
     return m_videoOutput->GetLastShownFrame();
 }
 
+/*! \brief Open a second, independent player on the same recording.
+ *
+ * Used to decode different parts of a finished recording in parallel. The
+ * returned context owns the new player; delete it when done.
+ */
+PlayerContext* MythCommFlagPlayer::CreateSibling(void)
+{
+    QString filename = m_playerCtx->m_buffer ? m_playerCtx->m_buffer->GetFilename() : QString();
+    MythMediaBuffer* buffer = MythMediaBuffer::Create(filename, false);
+    if (!buffer)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to create RingBuffer for %1").arg(filename));
+        return nullptr;
+    }
+
+    auto* context = new PlayerContext(kFlaggerInUseID);
+    auto* player = new MythCommFlagPlayer(context, m_playerFlags);
+    m_playerCtx->LockPlayingInfo(__FILE__, __LINE__);
+    context->SetPlayingInfo(m_playerCtx->m_playingInfo);
+    m_playerCtx->UnlockPlayingInfo(__FILE__, __LINE__);
+    context->SetRingBuffer(buffer);
+    context->SetPlayer(player);
+    return context;
+}
+
+/*! \brief Split the recording into roughly equal parts that start on a GOP.
+ *
+ * Returns the first frame of each part, starting with 0. Fewer parts are
+ * returned if there are not enough GOPs, and none if the length of the
+ * recording is unknown.
+ */
+std::vector<uint64_t> MythCommFlagPlayer::GetChunkStarts(uint Chunks)
+{
+    std::vector<uint64_t> result;
+    uint64_t total = GetTotalFrameCount();
+    if (!total || !Chunks)
+        return result;
+
+    frm_pos_map_t gops;
+    m_playerCtx->LockPlayingInfo(__FILE__, __LINE__);
+    if (m_playerCtx->m_playingInfo)
+        m_playerCtx->m_playingInfo->QueryPositionMap(gops, MARK_GOP_BYFRAME);
+    m_playerCtx->UnlockPlayingInfo(__FILE__, __LINE__);
+
+    result.push_back(0);
+    for (uint i = 1; i < Chunks; i++)
+    {
+        auto start = total * i / Chunks;
+        if (!gops.isEmpty())
+        {
+            auto gop = gops.lowerBound(static_cast<long long>(start));
+            if (gop == gops.end())
+                break;
+            start = static_cast<uint64_t>(gop.key());
+        }
+        if (start >= total)
+            break;
+        if (start > result.back())
+            result.push_back(start);
+    }
+    return result;
+}
@@ -1,6 +1,9 @@
 #ifndef MYTHCOMMFLAGPLAYER_H
 #define MYTHCOMMFLAGPLAYER_H
 
+// Std
+#include <vector>
+
 // MythTV
 #include "mythplayer.h"
 
@@ -28,6 +31,8 @@ class MTV_PUBLIC MythCommFlagPlayer : public MythPlayer
     explicit MythCommFlagPlayer(PlayerContext* Context, PlayerFlags Flags = kNoFlags);
     bool RebuildSeekTable(bool ShowPercentage = true, StatusCallback Callback = nullptr, void* Opaque = nullptr);
     MythVideoFrame* GetRawVideoFrame(long long FrameNumber = -1);
+    PlayerContext*  CreateSibling(void);
+    std::vector<uint64_t> GetChunkStarts(uint Chunks);
 };
 
 #endif
@@ -35,10 +35,13 @@ static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_NEON;
  * quality and using single or double frame rate.
  *
  * The following deinterlacers are used:
- * Basic - onefield/bob using libswcale
+ * Basic - onefield/bob by line doubling
  * Medium - linearblend with custom code (SSE2 and Neon assisted where available)
  * High - libavfilter's yadif (with multithreading)
  *
+ * Basic and Medium work in place on the frame. For double rate, only the
+ * lines of the second field are cached when the first is shown.
+ *
  * \note libavfilter frame doubling filters expect frames to be presented
  * in the correct order and will break if they do not receive a frame followed
  * by the retrieval of 2 'fields'.
@@ -111,7 +114,7 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
     }
 
     // libavfilter will not deinterlace NV12 frames. Allow shaders in this case.
-    // libswscale (for bob/onefield) is fine, as is our linearblend.
+    // Our onefield and linearblend are fine.
     if ((deinterlacer == DEINT_HIGH) && MythVideoFrame::FormatIsNV12(Frame->m_type))
     {
         Cleanup();
@@ -272,22 +275,21 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
 
 void MythDeinterlacer::Cleanup()
 {
-    if (m_graph || m_swsContext)
+    if (m_deintType != DEINT_NONE)
         LOG(VB_PLAYBACK, LOG_INFO, LOC + "Removing CPU deinterlacer");
 
     avfilter_graph_free(&m_graph);
-    sws_freeContext(m_swsContext);
-    m_swsContext = nullptr;
     m_discontinuityCounter = 0;
     m_autoFieldOrder = false;
     m_lastFieldChange = 0;
 
-    if (m_bobFrame)
+    if (m_fieldCache)
     {
-        LOG(VB_PLAYBACK, LOG_INFO, LOC + "Removing 'bob' cache frame");
-        delete m_bobFrame;
-        m_bobFrame = nullptr;
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + "Removing field cache");
+        av_freep(&m_fieldCache);
+        m_fieldCacheSize = 0;
     }
+    m_cachedFrame = nullptr;
 
     m_deintType = DEINT_NONE;
 }
@@ -317,14 +319,6 @@ bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterla
         m_deintType  = Deinterlacer;
         m_doubleRate = DoubleRate;
         m_topFirst   = TopFieldFirst;
-        if (Deinterlacer == DEINT_BASIC)
-        {
-            m_swsContext = sws_getCachedContext(m_swsContext, m_width, m_height >> 1, m_inputFmt,
-                                                m_width, m_height, m_inputFmt, SWS_FAST_BILINEAR,
-                                                nullptr, nullptr, nullptr);
-            if (m_swsContext == nullptr)
-                return false;
-        }
         LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using deinterlacer '%1'").arg(name));
         return true;
     }
@@ -385,310 +379,166 @@ bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterla
     return false;
 }
 
-bool MythDeinterlacer::SetUpCache(MythVideoFrame *Frame)
-{
-    if (!Frame)
-        return false;
-
-    if (m_bobFrame && !((m_bobFrame->m_bufferSize == Frame->m_bufferSize)) && (m_bobFrame->m_width == Frame->m_width) &&
-                        (m_bobFrame->m_height == Frame->m_height) && (m_bobFrame->m_type == Frame->m_type))
-    {
-        delete m_bobFrame;
-        m_bobFrame = nullptr;
-    }
-
-    if (!m_bobFrame)
-    {
-        m_bobFrame = new MythVideoFrame(Frame->m_type, MythVideoFrame::GetAlignedBuffer(Frame->m_bufferSize),
-                                        Frame->m_bufferSize, Frame->m_width, Frame->m_height);
-        LOG(VB_PLAYBACK, LOG_INFO, "Created new 'bob' cache frame");
-    }
-
-    return m_bobFrame && m_bobFrame->m_buffer != nullptr;
-}
-
-void MythDeinterlacer::OneField(MythVideoFrame *Frame, FrameScanType Scan)
+/*! \brief Copy the lines of one field to, or back from, the field cache
+ *
+ * Double rate needs the lines of the second field after the first field
+ * has been shown, which replaces them. Only those lines are kept, so
+ * this copies half a frame rather than all of it.
+*/
+bool MythDeinterlacer::CacheField(MythVideoFrame *Frame, bool Top, bool Restore)
 {
-    if (!m_swsContext)
-        return;
-
-    // we need a frame for caching - both to preserve the second field if
-    // needed and ensure we are not filtering in place (i.e. from src to src).
-    if (!SetUpCache(Frame))
-        return;
-
-    // copy/cache on first pass
-    if (kScan_Interlaced == Scan)
-        memcpy(m_bobFrame->m_buffer, Frame->m_buffer, m_bobFrame->m_bufferSize);
-
-    // Convert VideoFrame to AVFrame - no copy
-    AVFrame dstframe;
-    if ((MythAVUtil::FillAVFrame(m_frame, m_bobFrame, m_inputFmt) < 1) ||
-        (MythAVUtil::FillAVFrame(&dstframe, Frame, m_inputFmt) < 1))
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "Error converting frame");
-        return;
-    }
-
-    bool topfield   = Scan == kScan_Interlaced ? m_topFirst : !m_topFirst;
-    dstframe.width  = Frame->m_width;
-    dstframe.height = Frame->m_height;
-    dstframe.format = Frame->m_pixFmt;
-
-    m_frame->width  = m_bobFrame->m_width;
-    m_frame->format = m_bobFrame->m_pixFmt;
-
-    // Fake the frame height and stride to simulate a single field
-    m_frame->height = Frame->m_height >> 1;
-    m_frame->interlaced_frame = 0;
-    uint nbplanes = MythVideoFrame::GetNumPlanes(m_inputType);
-    for (uint i = 0; i < nbplanes; i++)
+    uint count = MythVideoFrame::GetNumPlanes(Frame->m_type);
+    size_t size = 0;
+    for (uint plane = 0; plane < count; plane++)
     {
-        if (!topfield)
-            m_frame->data[i] = m_frame->data[i] + m_frame->linesize[i];
-        m_frame->linesize[i] = m_frame->linesize[i] << 1;
+        int width  = MythVideoFrame::GetPitchForPlane(Frame->m_type, Frame->m_width, plane);
+        int height = MythVideoFrame::GetHeightForPlane(Frame->m_type, Frame->m_height, plane);
+        size += static_cast<size_t>(width) * static_cast<size_t>((height + 1) >> 1);
     }
 
-    // and scale to full height
-    int result = sws_scale(m_swsContext, m_frame->data, m_frame->linesize, 0, m_frame->height,
-                           dstframe.data, dstframe.linesize);
-
-    if (result != Frame->m_height)
+    if (size > m_fieldCacheSize)
     {
-        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Error scaling frame: height %1 expected %2")
-            .arg(result).arg(Frame->m_height));
+        if (Restore)
+            return false;
+        av_freep(&m_fieldCache);
+        m_fieldCache = MythVideoFrame::GetAlignedBuffer(size);
+        m_fieldCacheSize = m_fieldCache ? size : 0;
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + "Created new field cache");
     }
-    Frame->m_alreadyDeinterlaced = true;
-}
 
-inline static uint32_t avg(uint32_t A, uint32_t B)
-{
-    return (((A ^ B) & 0xFEFEFEFEUL) >> 1) + (A & B);
-}
+    if (!m_fieldCache)
+        return false;
 
-// Optimised version with 4x4 alignment
-static inline void BlendC4x4(unsigned char *Src, int Width, int FirstRow, int LastRow, int Pitch,
-                             unsigned char *Dst, int DstPitch, bool Second)
-{
-    int srcpitch = Pitch << 1;
-    int dstpitch = DstPitch << 1;
-    int maxrows  = LastRow - 3;
-
-    unsigned char *above   = Src + ((FirstRow - 1) * static_cast<ptrdiff_t>(Pitch));
-    unsigned char *dest1   = Dst + (FirstRow * static_cast<ptrdiff_t>(DstPitch));
-    unsigned char *middle  = above + srcpitch;
-    unsigned char *dest2   = dest1 + dstpitch;
-    unsigned char *below   = middle + srcpitch;
-    unsigned char *dstcpy1 = Dst + ((FirstRow - 1) * static_cast<ptrdiff_t>(DstPitch));
-    unsigned char *dstcpy2 = dstcpy1 + dstpitch;
-
-    srcpitch <<= 1;
-    dstpitch <<= 1;
-
-    // 4 rows per pass
-    for (int row = FirstRow; row < maxrows; row += 4)
+    uint8_t* cache = m_fieldCache;
+    for (uint plane = 0; plane < count; plane++)
     {
-        if (Second)
+        int width  = MythVideoFrame::GetPitchForPlane(Frame->m_type, Frame->m_width, plane);
+        int height = MythVideoFrame::GetHeightForPlane(Frame->m_type, Frame->m_height, plane);
+        int pitch  = Frame->m_pitches[plane];
+        uint8_t* line = Frame->m_buffer + Frame->m_offsets[plane] + (Top ? 0 : pitch);
+        for (int row = Top ? 0 : 1; row < height; row += 2)
         {
-            // On second pass, copy over the original, current field
-            memcpy(dstcpy1, above,  static_cast<size_t>(DstPitch));
-            memcpy(dstcpy2, middle, static_cast<size_t>(DstPitch));
-            dstcpy1 += dstpitch;
-            dstcpy2 += dstpitch;
-        }
-        for (int col = 0; col < Width; col += 4)
-        {
-            *reinterpret_cast<uint32_t*>(&dest1[col]) =
-                    avg(*reinterpret_cast<uint32_t*>(&above[col]), *reinterpret_cast<uint32_t*>(&middle[col]));
-            *reinterpret_cast<uint32_t*>(&dest2[col]) =
-                    avg(*reinterpret_cast<uint32_t*>(&middle[col]), *reinterpret_cast<uint32_t*>(&below[col]));
+            if (Restore)
+                memcpy(line, cache, static_cast<size_t>(width));
+            else
+                memcpy(cache, line, static_cast<size_t>(width));
+            line  += static_cast<ptrdiff_t>(pitch) << 1;
+            cache += width;
         }
-        above  += srcpitch;
-        middle += srcpitch;
-        below  += srcpitch;
-        dest1  += dstpitch;
-        dest2  += dstpitch;
     }
+    return true;
 }
 
-#if defined(Q_PROCESSOR_X86_64) || HAVE_INTRINSICS_NEON
-// SIMD optimised version with 16x4 alignment
-static inline void BlendSIMD16x4(unsigned char *Src, int Width, int FirstRow, int LastRow, int Pitch,
-                                 unsigned char *Dst, int DstPitch, bool Second)
+static inline void AverageLine8(uint8_t* Dst, const uint8_t* Above, const uint8_t* Below, int Width)
 {
-    int srcpitch = Pitch << 1;
-    int dstpitch = DstPitch << 1;
-    int maxrows  = LastRow - 3;
-
-    unsigned char *above   = Src + ((FirstRow - 1) * static_cast<ptrdiff_t>(Pitch));
-    unsigned char *dest1   = Dst + (FirstRow * static_cast<ptrdiff_t>(DstPitch));
-    unsigned char *middle  = above + srcpitch;
-    unsigned char *dest2   = dest1 + dstpitch;
-    unsigned char *below   = middle + srcpitch;
-    unsigned char *dstcpy1 = Dst + ((FirstRow - 1) * static_cast<ptrdiff_t>(DstPitch));
-    unsigned char *dstcpy2 = dstcpy1 + dstpitch;
-
-    srcpitch <<= 1;
-    dstpitch <<= 1;
-
-    // 4 rows per pass
-    for (int row = FirstRow; row < maxrows; row += 4)
-    {
-        if (Second)
-        {
-            // On second pass, copy over the original, current field
-            memcpy(dstcpy1, above,  static_cast<size_t>(DstPitch));
-            memcpy(dstcpy2, middle, static_cast<size_t>(DstPitch));
-            dstcpy1 += dstpitch;
-            dstcpy2 += dstpitch;
-        }
-        for (int col = 0; col < Width; col += 16)
-        {
+    int col = 0;
 #if defined(Q_PROCESSOR_X86_64)
-            __m128i mid = *reinterpret_cast<__m128i*>(&middle[col]);
-            *reinterpret_cast<__m128i*>(&dest1[col]) =
-                    _mm_avg_epu8(*reinterpret_cast<__m128i*>(&above[col]), mid);
-            *reinterpret_cast<__m128i*>(&dest2[col]) =
-                    _mm_avg_epu8(*reinterpret_cast<__m128i*>(&below[col]), mid);
-#endif
-#if HAVE_INTRINSICS_NEON
-            uint8x16_t mid = *reinterpret_cast<uint8x16_t*>(&middle[col]);
-            *reinterpret_cast<uint8x16_t*>(&dest1[col]) =
-                    vrhaddq_u8(*reinterpret_cast<uint8x16_t*>(&above[col]), mid);
-            *reinterpret_cast<uint8x16_t*>(&dest2[col]) =
-                    vrhaddq_u8(*reinterpret_cast<uint8x16_t*>(&below[col]), mid);
-#endif
-        }
-        above  += srcpitch;
-        middle += srcpitch;
-        below  += srcpitch;
-        dest1  += dstpitch;
-        dest2  += dstpitch;
+    for ( ; col + 16 <= Width; col += 16)
+    {
+        __m128i above = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Above + col));
+        __m128i below = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Below + col));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + col), _mm_avg_epu8(above, below));
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+        for ( ; col + 16 <= Width; col += 16)
+            vst1q_u8(Dst + col, vrhaddq_u8(vld1q_u8(Above + col), vld1q_u8(Below + col)));
+#endif
+    for ( ; col < Width; col++)
+        Dst[col] = static_cast<uint8_t>((Above[col] + Below[col] + 1) >> 1);
 }
 
-// SIMD optimised version with 16x4 alignment for 10/12/16bit video
-static inline void BlendSIMD8x4(unsigned char *Src, int Width, int FirstRow, int LastRow, int Pitch,
-                                 unsigned char *Dst, int DstPitch, bool Second)
+// For 10/12/16bit video, Width is in samples
+static inline void AverageLine16(uint16_t* Dst, const uint16_t* Above, const uint16_t* Below, int Width)
 {
-    int srcpitch = Pitch << 1;
-    int dstpitch = DstPitch << 1;
-    int maxrows  = LastRow - 3;
-
-    unsigned char *above   = Src + ((FirstRow - 1) * static_cast<ptrdiff_t>(Pitch));
-    unsigned char *dest1   = Dst + (FirstRow * static_cast<ptrdiff_t>(DstPitch));
-    unsigned char *middle  = above + srcpitch;
-    unsigned char *dest2   = dest1 + dstpitch;
-    unsigned char *below   = middle + srcpitch;
-    unsigned char *dstcpy1 = Dst + ((FirstRow - 1) * static_cast<ptrdiff_t>(DstPitch));
-    unsigned char *dstcpy2 = dstcpy1 + dstpitch;
-
-    srcpitch <<= 1;
-    dstpitch <<= 1;
-
-    // 4 rows per pass
-    for (int row = FirstRow; row < maxrows; row += 4)
-    {
-        if (Second)
-        {
-            // On second pass, copy over the original, current field
-            memcpy(dstcpy1, above,  static_cast<size_t>(DstPitch));
-            memcpy(dstcpy2, middle, static_cast<size_t>(DstPitch));
-            dstcpy1 += dstpitch;
-            dstcpy2 += dstpitch;
-        }
-        for (int col = 0; col < Width; col += 16)
-        {
+    int col = 0;
 #if defined(Q_PROCESSOR_X86_64)
-            __m128i mid = *reinterpret_cast<__m128i*>(&middle[col]);
-            *reinterpret_cast<__m128i*>(&dest1[col]) =
-                    _mm_avg_epu16(*reinterpret_cast<__m128i*>(&above[col]), mid);
-            *reinterpret_cast<__m128i*>(&dest2[col]) =
-                    _mm_avg_epu16(*reinterpret_cast<__m128i*>(&below[col]), mid);
-#endif
-#if HAVE_INTRINSICS_NEON
-            uint16x8_t mid = *reinterpret_cast<uint16x8_t*>(&middle[col]);
-            *reinterpret_cast<uint16x8_t*>(&dest1[col]) =
-                    vrhaddq_u16(*reinterpret_cast<uint16x8_t*>(&above[col]), mid);
-            *reinterpret_cast<uint16x8_t*>(&dest2[col]) =
-                    vrhaddq_u16(*reinterpret_cast<uint16x8_t*>(&below[col]), mid);
-#endif
-        }
-        above  += srcpitch;
-        middle += srcpitch;
-        below  += srcpitch;
-        dest1  += dstpitch;
-        dest2  += dstpitch;
+    for ( ; col + 8 <= Width; col += 8)
+    {
+        __m128i above = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Above + col));
+        __m128i below = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Below + col));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + col), _mm_avg_epu16(above, below));
     }
-}
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+        for ( ; col + 8 <= Width; col += 8)
+            vst1q_u16(Dst + col, vrhaddq_u16(vld1q_u16(Above + col), vld1q_u16(Below + col)));
 #endif
+    for ( ; col < Width; col++)
+        Dst[col] = static_cast<uint16_t>((Above[col] + Below[col] + 1) >> 1);
+}
 
-void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
+/*! \brief Replace the lines of one field with those of the other, in place
+ *
+ * The missing lines are either copies of the line above (below for the
+ * bottom field) or, if Interpolate is set, the average of the lines
+ * either side of them.
+*/
+void MythDeinterlacer::FillField(MythVideoFrame *Frame, FrameScanType Scan, bool Interpolate)
 {
-    if (Frame->m_height < 16 || Frame->m_width < 16)
+    if (!Frame->m_buffer)
         return;
 
-    bool second = false;
-    MythVideoFrame *src = Frame;
+    bool second = m_doubleRate && (kScan_Interlaced != Scan);
+    bool top = second ? !m_topFirst : m_topFirst;
 
     if (m_doubleRate)
     {
-        if (!SetUpCache(Frame))
-            return;
-        // copy/cache on first pass.
-        if (kScan_Interlaced == Scan)
-            memcpy(m_bobFrame->m_buffer, Frame->m_buffer, m_bobFrame->m_bufferSize);
-        else
-            second = true;
-        src = m_bobFrame;
+        if (!second)
+        {
+            // the lines of the second field are about to be replaced
+            m_cachedFrame   = CacheField(Frame, !top, false) ? Frame : nullptr;
+            m_cachedCounter = Frame->m_frameCounter;
+        }
+        else if ((m_cachedFrame == Frame) && (m_cachedCounter == Frame->m_frameCounter))
+        {
+            CacheField(Frame, top, true);
+            m_cachedFrame = nullptr;
+        }
+        // otherwise the first field was not shown and the frame is untouched
     }
 
-    bool hidepth = MythVideoFrame::ColorDepth(src->m_type) > 8;
-    bool top = second ? !m_topFirst : m_topFirst;
-    uint count = MythVideoFrame::GetNumPlanes(src->m_type);
+    bool hidepth = MythVideoFrame::ColorDepth(Frame->m_type) > 8;
+    uint count = MythVideoFrame::GetNumPlanes(Frame->m_type);
     for (uint plane = 0; plane < count; plane++)
     {
-        int  height  = MythVideoFrame::GetHeightForPlane(src->m_type, src->m_height, plane);
-        int firstrow = top ? 1 : 2;
-        bool height4 = (height % 4) == 0;
-        bool width4  = (src->m_pitches[plane] % 4) == 0;
-        // N.B. all frames allocated by MythTV should have 16 byte alignment
-        // for all planes
-#if defined(Q_PROCESSOR_X86_64) || HAVE_INTRINSICS_NEON
-        bool width16 = (src->m_pitches[plane] % 16) == 0;
-        // profiling SSE2 suggests it is usually 4x faster - as expected
-        if (s_haveSIMD && height4 && width16)
+        int width  = MythVideoFrame::GetPitchForPlane(Frame->m_type, Frame->m_width, plane);
+        int height = MythVideoFrame::GetHeightForPlane(Frame->m_type, Frame->m_height, plane);
+        if (height < 2)
+            continue;
+
+        auto pitch = static_cast<ptrdiff_t>(Frame->m_pitches[plane]);
+        uint8_t* buffer = Frame->m_buffer + Frame->m_offsets[plane];
+        for (int row = top ? 1 : 0; row < height; row += 2)
         {
-            if (hidepth)
+            uint8_t* line = buffer + (row * pitch);
+            const uint8_t* above = (row > 0) ? line - pitch : line + pitch;
+            const uint8_t* below = (row + 1 < height) ? line + pitch : line - pitch;
+            if (!Interpolate || (above == below))
+            {
+                memcpy(line, top ? above : below, static_cast<size_t>(width));
+            }
+            else if (hidepth)
             {
-                BlendSIMD8x4(src->m_buffer + src->m_offsets[plane],
-                             MythVideoFrame::GetPitchForPlane(src->m_type, src->m_width, plane),
-                             firstrow, height, src->m_pitches[plane],
-                             Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                             second);
+                AverageLine16(reinterpret_cast<uint16_t*>(line),
+                              reinterpret_cast<const uint16_t*>(above),
+                              reinterpret_cast<const uint16_t*>(below), width >> 1);
             }
             else
             {
-                BlendSIMD16x4(src->m_buffer + src->m_offsets[plane],
-                              MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
-                              firstrow, height, src->m_pitches[plane],
-                              Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                              second);
+                AverageLine8(line, above, below, width);
             }
         }
-        else
-#endif
-        // N.B. There is no 10bit support here - but it shouldn't be necessary
-        // as everything should be 16byte aligned and 10/12bit interlaced video
-        // is virtually unheard of.
-        if (width4 && height4 && !hidepth)
-        {
-            BlendC4x4(src->m_buffer + src->m_offsets[plane],
-                      MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
-                      firstrow, height, src->m_pitches[plane],
-                      Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                      second);
-        }
     }
     Frame->m_alreadyDeinterlaced = true;
 }
+
+void MythDeinterlacer::OneField(MythVideoFrame *Frame, FrameScanType Scan)
+{
+    FillField(Frame, Scan, false);
+}
+
+void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
+{
+    FillField(Frame, Scan, true);
+}
@@ -7,7 +7,6 @@
 
 extern "C" {
 #include "libavfilter/avfilter.h"
-#include "libswscale/swscale.h"
 }
 
 class MythVideoProfile;
@@ -29,7 +28,8 @@ class MythDeinterlacer
     inline void      Cleanup      ();
     void             OneField     (MythVideoFrame *Frame, FrameScanType Scan);
     void             Blend        (MythVideoFrame *Frame, FrameScanType Scan);
-    bool             SetUpCache   (MythVideoFrame *Frame);
+    void             FillField    (MythVideoFrame *Frame, FrameScanType Scan, bool Interpolate);
+    bool             CacheField   (MythVideoFrame *Frame, bool Top, bool Restore);
 
     VideoFrameType   m_inputType  { FMT_NONE };
     AVPixelFormat    m_inputFmt   { AV_PIX_FMT_NONE };
@@ -42,8 +42,10 @@ class MythDeinterlacer
     AVFilterGraph*   m_graph      { nullptr };
     AVFilterContext* m_source     { nullptr };
     AVFilterContext* m_sink       { nullptr };
-    MythVideoFrame*  m_bobFrame   { nullptr };
-    SwsContext*      m_swsContext { nullptr };
+    uint8_t*         m_fieldCache     { nullptr };
+    size_t           m_fieldCacheSize { 0 };
+    const MythVideoFrame* m_cachedFrame   { nullptr };
+    uint64_t         m_cachedCounter  { 0 };
     uint64_t         m_discontinuityCounter { 0 };
     bool             m_autoFieldOrder  { false };
     uint64_t         m_lastFieldChange { 0 };
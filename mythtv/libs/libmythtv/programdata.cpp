@@ -2,13 +2,24 @@
 
 // C++ includes
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <climits>
+#include <functional>
+#include <list>
+#include <map>
+#include <thread>
 #include <utility>
 
 // Qt includes
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QtGlobal> // for qAbs
 
 // MythTV headers
+#include "libmythbase/mthreadpool.h"
+#include "libmythbase/mythchrono.h"
 #include "libmythbase/mythdb.h"
 #include "libmythbase/mythlogging.h"
 
@@ -31,14 +42,25 @@ static QString denullify(const QString &str)
     return str.isNull() ? "" : str;
 }
 
+/// True if the last statement failed because it conflicted with another
+/// transaction, trying the transaction again may succeed.
+static bool is_lock_conflict(const MSqlQuery &query)
+{
+    // MySQL: Error number: 1205; Symbol: ER_LOCK_WAIT_TIMEOUT
+    // MySQL: Error number: 1213; Symbol: ER_LOCK_DEADLOCK
+    static const QStringList kLockConflictCodes = { "1205", "1213" };
+    return kLockConflictCodes.contains(query.lastError().nativeErrorCode());
+}
+
 static QVariant denullify(const QDateTime &dt)
 {
     return dt.isNull() ? QVariant("0000-00-00 00:00:00") : QVariant(dt);
 }
 
-static void add_genres(MSqlQuery &query, const QStringList &genres,
+static bool add_genres(MSqlQuery &query, const QStringList &genres,
                 uint chanid, const QDateTime &starttime)
 {
+    bool ok = true;
     QString relevance = QString("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");
     for (auto it = genres.constBegin(); (it != genres.constEnd()) &&
              ((it - genres.constBegin()) < relevance.size()); ++it)
@@ -53,8 +75,12 @@ static void add_genres(MSqlQuery &query, const QStringList &genres,
         query.bindValue(":relevance", relevance.at(it - genres.constBegin()));
 
         if (!query.exec())
+        {
             MythDB::DBError("programgenres insert", query);
+            ok = false;
+        }
     }
+    return ok;
 }
 
 DBPerson::DBPerson(const DBPerson &other)
@@ -403,6 +429,56 @@ uint DBEvent::UpdateDB(
     return UpdateDB(query, chanid, programs, -1);
 }
 
+static const QString kProgramColumns =
+    "title,          subtitle,      description, "
+    "category,       category_type, "
+    "starttime,      endtime, "
+    "subtitletypes+0,audioprop+0,   videoprop+0, "
+    "seriesid,       programid, "
+    "partnumber,     parttotal, "
+    "syndicatedepisodenumber, "
+    "airdate,        originalairdate, "
+    "previouslyshown,listingsource, "
+    "stars+0, "
+    "season,         episode,       totalepisodes, "
+    "inetref ";
+
+// Read a program selected with kProgramColumns.
+static DBEvent program_from_query(const MSqlQuery &query)
+{
+    ProgramInfo::CategoryType category_type =
+        string_to_myth_category_type(query.value(4).toString());
+
+    DBEvent prog(
+        query.value(0).toString(),
+        query.value(1).toString(),
+        query.value(2).toString(),
+        query.value(3).toString(),
+        category_type,
+        MythDate::as_utc(query.value(5).toDateTime()),
+        MythDate::as_utc(query.value(6).toDateTime()),
+        query.value(7).toUInt(),
+        query.value(8).toUInt(),
+        query.value(9).toUInt(),
+        query.value(19).toDouble(),
+        query.value(10).toString(),
+        query.value(11).toString(),
+        query.value(18).toUInt(),
+        query.value(20).toUInt(),  // Season
+        query.value(21).toUInt(),  // Episode
+        query.value(22).toUInt()); // Total Episodes
+
+    prog.m_inetref    = query.value(23).toString();
+    prog.m_partnumber = query.value(12).toUInt();
+    prog.m_parttotal  = query.value(13).toUInt();
+    prog.m_syndicatedepisodenumber = query.value(14).toString();
+    prog.m_airdate    = query.value(15).toUInt();
+    prog.m_originalairdate  = query.value(16).toDate();
+    prog.m_previouslyshown  = query.value(17).toBool();
+
+    return prog;
+}
+
 // Get all programs in the database that overlap with our new program.
 // We check for three ways in which we can have an overlap:
 // (1)   Start of old program is inside our new program:
@@ -430,25 +506,15 @@ uint DBEvent::GetOverlappingPrograms(
     MSqlQuery &query, uint chanid, std::vector<DBEvent> &programs) const
 {
     uint count = 0;
-    query.prepare(
-        "SELECT title,          subtitle,      description, "
-        "       category,       category_type, "
-        "       starttime,      endtime, "
-        "       subtitletypes+0,audioprop+0,   videoprop+0, "
-        "       seriesid,       programid, "
-        "       partnumber,     parttotal, "
-        "       syndicatedepisodenumber, "
-        "       airdate,        originalairdate, "
-        "       previouslyshown,listingsource, "
-        "       stars+0, "
-        "       season,         episode,       totalepisodes, "
-        "       inetref "
+    query.prepare(QString(
+        "SELECT %1"
         "FROM program "
         "WHERE chanid   = :CHANID AND "
         "      manualid = 0       AND "
         "      ( ( starttime >= :STIME1 AND starttime <  :ETIME1 ) OR "
         "        ( endtime   >  :STIME2 AND endtime   <= :ETIME2 ) OR "
-        "        ( starttime <  :STIME3 AND endtime   >  :ETIME3 ) )");
+        "        ( starttime <  :STIME3 AND endtime   >  :ETIME3 ) )")
+        .arg(kProgramColumns));
     query.bindValue(":CHANID", chanid);
     query.bindValue(":STIME1", m_starttime);
     query.bindValue(":ETIME1", m_endtime);
@@ -465,37 +531,7 @@ uint DBEvent::GetOverlappingPrograms(
 
     while (query.next())
     {
-        ProgramInfo::CategoryType category_type =
-            string_to_myth_category_type(query.value(4).toString());
-
-        DBEvent prog(
-            query.value(0).toString(),
-            query.value(1).toString(),
-            query.value(2).toString(),
-            query.value(3).toString(),
-            category_type,
-            MythDate::as_utc(query.value(5).toDateTime()),
-            MythDate::as_utc(query.value(6).toDateTime()),
-            query.value(7).toUInt(),
-            query.value(8).toUInt(),
-            query.value(9).toUInt(),
-            query.value(19).toDouble(),
-            query.value(10).toString(),
-            query.value(11).toString(),
-            query.value(18).toUInt(),
-            query.value(20).toUInt(),  // Season
-            query.value(21).toUInt(),  // Episode
-            query.value(22).toUInt()); // Total Episodes
-
-        prog.m_inetref    = query.value(23).toString();
-        prog.m_partnumber = query.value(12).toUInt();
-        prog.m_parttotal  = query.value(13).toUInt();
-        prog.m_syndicatedepisodenumber = query.value(14).toString();
-        prog.m_airdate    = query.value(15).toUInt();
-        prog.m_originalairdate  = query.value(16).toDate();
-        prog.m_previouslyshown  = query.value(17).toBool();
-
-        programs.push_back(prog);
+        programs.push_back(program_from_query(query));
         count++;
     }
 
@@ -746,102 +782,116 @@ static int change_record(MSqlQuery &query, uint chanid,
     return rows;
 }
 
-// Update matched item with current data.
+// The matched item as it is after updating it with current data.
 //
-uint DBEvent::UpdateDB(
-    MSqlQuery &query, uint chanid, const DBEvent &match)  const
+DBEvent DBEvent::Merge(const DBEvent &match) const
 {
-    QString  ltitle           = m_title;
-    QString  lsubtitle        = m_subtitle;
-    QString  ldesc            = m_description;
-    QString  lcategory        = m_category;
-    uint16_t lairdate         = m_airdate;
-    QString  lprogramId       = m_programId;
-    QString  lseriesId        = m_seriesId;
-    QString  linetref         = m_inetref;
-    QDate    loriginalairdate = m_originalairdate;
-
-    // Update starttime also in database table record so that
-    // tables program and record remain consistent.
-    if (m_starttime != match.m_starttime)
-    {
-        QDateTime const &old_starttime = match.m_starttime;
-        QDateTime const &new_starttime = m_starttime;
-        change_record(query, chanid, old_starttime, new_starttime);
+    DBEvent merged(m_listingsource | match.m_listingsource);
 
-        LOG(VB_EIT, LOG_DEBUG,
-            QString("EIT: (U) change starttime from %1 to %2 for chanid:%3 program '%4' ")
-                    .arg(old_starttime.toString(Qt::ISODate),
-                         new_starttime.toString(Qt::ISODate),
-                         QString::number(chanid),
-                         m_title.left(35)));
-    }
+    merged.m_title           = m_title;
+    merged.m_subtitle        = m_subtitle;
+    merged.m_description     = m_description;
+    merged.m_category        = m_category;
+    merged.m_starttime       = m_starttime;
+    merged.m_endtime         = m_endtime;
+    merged.m_airdate         = m_airdate;
+    merged.m_originalairdate = m_originalairdate;
+    merged.m_programId       = m_programId;
+    merged.m_seriesId        = m_seriesId;
+    merged.m_inetref         = m_inetref;
+    merged.m_stars           = match.m_stars;
 
-    if (ltitle.isEmpty() && !match.m_title.isEmpty())
-        ltitle = match.m_title;
+    if (merged.m_title.isEmpty() && !match.m_title.isEmpty())
+        merged.m_title = match.m_title;
 
-    if (lsubtitle.isEmpty() && !match.m_subtitle.isEmpty())
-        lsubtitle = match.m_subtitle;
+    if (merged.m_subtitle.isEmpty() && !match.m_subtitle.isEmpty())
+        merged.m_subtitle = match.m_subtitle;
 
-    if (ldesc.isEmpty() && !match.m_description.isEmpty())
-        ldesc = match.m_description;
+    if (merged.m_description.isEmpty() && !match.m_description.isEmpty())
+        merged.m_description = match.m_description;
 
-    if (lcategory.isEmpty() && !match.m_category.isEmpty())
-        lcategory = match.m_category;
+    if (merged.m_category.isEmpty() && !match.m_category.isEmpty())
+        merged.m_category = match.m_category;
 
-    if (!lairdate && match.m_airdate)
-        lairdate = match.m_airdate;
+    if (!merged.m_airdate && match.m_airdate)
+        merged.m_airdate = match.m_airdate;
 
-    if (!loriginalairdate.isValid() && match.m_originalairdate.isValid())
-        loriginalairdate = match.m_originalairdate;
+    if (!merged.m_originalairdate.isValid() && match.m_originalairdate.isValid())
+        merged.m_originalairdate = match.m_originalairdate;
 
-    if (lprogramId.isEmpty() && !match.m_programId.isEmpty())
-        lprogramId = match.m_programId;
+    if (merged.m_programId.isEmpty() && !match.m_programId.isEmpty())
+        merged.m_programId = match.m_programId;
 
-    if (lseriesId.isEmpty() && !match.m_seriesId.isEmpty())
-        lseriesId = match.m_seriesId;
+    if (merged.m_seriesId.isEmpty() && !match.m_seriesId.isEmpty())
+        merged.m_seriesId = match.m_seriesId;
 
-    if (linetref.isEmpty() && !match.m_inetref.isEmpty())
-        linetref= match.m_inetref;
+    if (merged.m_inetref.isEmpty() && !match.m_inetref.isEmpty())
+        merged.m_inetref = match.m_inetref;
 
-    ProgramInfo::CategoryType tmp = m_categoryType;
+    merged.m_categoryType = m_categoryType;
     if (!m_categoryType && match.m_categoryType)
-        tmp = match.m_categoryType;
+        merged.m_categoryType = match.m_categoryType;
 
-    QString lcattype = myth_category_type_to_string(tmp);
+    merged.m_subtitleType = m_subtitleType | match.m_subtitleType;
+    merged.m_audioProps   = m_audioProps   | match.m_audioProps;
+    merged.m_videoProps   = m_videoProps   | match.m_videoProps;
 
-    unsigned char lsubtype = m_subtitleType | match.m_subtitleType;
-    unsigned char laudio   = m_audioProps   | match.m_audioProps;
-    unsigned char lvideo   = m_videoProps   | match.m_videoProps;
-
-    uint lseason = match.m_season;
-    uint lepisode = match.m_episode;
-    uint lepisodeTotal = match.m_totalepisodes;
+    merged.m_season        = match.m_season;
+    merged.m_episode       = match.m_episode;
+    merged.m_totalepisodes = match.m_totalepisodes;
 
     if (m_season || m_episode || m_totalepisodes)
     {
-        lseason = m_season;
-        lepisode = m_episode;
-        lepisodeTotal = m_totalepisodes;
+        merged.m_season        = m_season;
+        merged.m_episode       = m_episode;
+        merged.m_totalepisodes = m_totalepisodes;
     }
 
-    uint lpartnumber = match.m_partnumber;
-    uint lparttotal = match.m_parttotal;
+    merged.m_partnumber = match.m_partnumber;
+    merged.m_parttotal  = match.m_parttotal;
 
     if (m_partnumber || m_parttotal)
     {
-        lpartnumber = m_partnumber;
-        lparttotal  = m_parttotal;
+        merged.m_partnumber = m_partnumber;
+        merged.m_parttotal  = m_parttotal;
     }
 
-    bool lpreviouslyshown = m_previouslyshown || match.m_previouslyshown;
-
-    uint32_t llistingsource = m_listingsource | match.m_listingsource;
+    merged.m_previouslyshown = m_previouslyshown || match.m_previouslyshown;
 
-    QString lsyndicatedepisodenumber = m_syndicatedepisodenumber;
-    if (lsyndicatedepisodenumber.isEmpty() &&
+    merged.m_syndicatedepisodenumber = m_syndicatedepisodenumber;
+    if (merged.m_syndicatedepisodenumber.isEmpty() &&
         !match.m_syndicatedepisodenumber.isEmpty())
-        lsyndicatedepisodenumber = match.m_syndicatedepisodenumber;
+        merged.m_syndicatedepisodenumber = match.m_syndicatedepisodenumber;
+
+    return merged;
+}
+
+// Update matched item with current data.
+//
+uint DBEvent::UpdateDB(
+    MSqlQuery &query, uint chanid, const DBEvent &match)  const
+{
+    // Update starttime also in database table record so that
+    // tables program and record remain consistent.
+    if (m_starttime != match.m_starttime)
+    {
+        QDateTime const &old_starttime = match.m_starttime;
+        QDateTime const &new_starttime = m_starttime;
+        change_record(query, chanid, old_starttime, new_starttime);
+
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: (U) change starttime from %1 to %2 for chanid:%3 program '%4' ")
+                    .arg(old_starttime.toString(Qt::ISODate),
+                         new_starttime.toString(Qt::ISODate),
+                         QString::number(chanid),
+                         m_title.left(35)));
+    }
+
+    DBEvent merged = Merge(match);
+    QString lcattype = myth_category_type_to_string(merged.m_categoryType);
+    unsigned char lsubtype = merged.m_subtitleType;
+    unsigned char laudio   = merged.m_audioProps;
+    unsigned char lvideo   = merged.m_videoProps;
 
     query.prepare(
         "UPDATE program "
@@ -866,10 +916,10 @@ uint DBEvent::UpdateDB(
 
     query.bindValue(":CHANID",      chanid);
     query.bindValue(":OLDSTART",    match.m_starttime);
-    query.bindValue(":TITLE",       denullify(ltitle));
-    query.bindValue(":SUBTITLE",    denullify(lsubtitle));
-    query.bindValue(":DESC",        denullify(ldesc));
-    query.bindValue(":CATEGORY",    denullify(lcategory));
+    query.bindValue(":TITLE",       denullify(merged.m_title));
+    query.bindValue(":SUBTITLE",    denullify(merged.m_subtitle));
+    query.bindValue(":DESC",        denullify(merged.m_description));
+    query.bindValue(":CATEGORY",    denullify(merged.m_category));
     query.bindValue(":CATTYPE",     lcattype);
     query.bindValue(":STARTTIME",   m_starttime);
     query.bindValue(":ENDTIME",     m_endtime);
@@ -880,19 +930,19 @@ uint DBEvent::UpdateDB(
     query.bindValue(":SUBTYPE",     lsubtype);
     query.bindValue(":AUDIOPROP",   laudio);
     query.bindValue(":VIDEOPROP",   lvideo);
-    query.bindValue(":SEASON",      lseason);
-    query.bindValue(":EPISODE",     lepisode);
-    query.bindValue(":TOTALEPS",    lepisodeTotal);
-    query.bindValue(":PARTNO",      lpartnumber);
-    query.bindValue(":PARTTOTAL",   lparttotal);
-    query.bindValue(":SYNDICATENO", denullify(lsyndicatedepisodenumber));
-    query.bindValue(":AIRDATE",     lairdate ? QString::number(lairdate) : "0000");
-    query.bindValue(":ORIGAIRDATE", loriginalairdate);
-    query.bindValue(":LSOURCE",     llistingsource);
-    query.bindValue(":SERIESID",    denullify(lseriesId));
-    query.bindValue(":PROGRAMID",   denullify(lprogramId));
-    query.bindValue(":PREVSHOWN",   lpreviouslyshown);
-    query.bindValue(":INETREF",     linetref);
+    query.bindValue(":SEASON",      merged.m_season);
+    query.bindValue(":EPISODE",     merged.m_episode);
+    query.bindValue(":TOTALEPS",    merged.m_totalepisodes);
+    query.bindValue(":PARTNO",      merged.m_partnumber);
+    query.bindValue(":PARTTOTAL",   merged.m_parttotal);
+    query.bindValue(":SYNDICATENO", denullify(merged.m_syndicatedepisodenumber));
+    query.bindValue(":AIRDATE",     merged.m_airdate ? QString::number(merged.m_airdate) : "0000");
+    query.bindValue(":ORIGAIRDATE", merged.m_originalairdate);
+    query.bindValue(":LSOURCE",     merged.m_listingsource);
+    query.bindValue(":SERIESID",    denullify(merged.m_seriesId));
+    query.bindValue(":PROGRAMID",   denullify(merged.m_programId));
+    query.bindValue(":PREVSHOWN",   merged.m_previouslyshown);
+    query.bindValue(":INETREF",     merged.m_inetref);
 
     if (!query.exec())
     {
@@ -1139,6 +1189,85 @@ bool DBEvent::MoveOutOfTheWayDB(
     return true;
 }
 
+static const QString kInsertColumns =
+    "  chanid,         title,          subtitle,        description, "
+    "  category,       category_type, "
+    "  starttime,      endtime, "
+    "  closecaptioned, stereo,         hdtv,            subtitled, "
+    "  subtitletypes,  audioprop,      videoprop, "
+    "  stars,          partnumber,     parttotal, "
+    "  syndicatedepisodenumber, "
+    "  airdate,        originalairdate,listingsource, "
+    "  seriesid,       programid,      previouslyshown, "
+    "  season,         episode,        totalepisodes, "
+    "  inetref ";
+
+/// kInsertColumns with the columns only XMLTV has
+static const QString kXMLTVInsertColumns =
+    kInsertColumns + ", title_pronounce, showtype, colorcode ";
+
+// The placeholders of one row of kInsertColumns, or kXMLTVInsertColumns,
+// named with the suffix so that several rows can be inserted with one
+// statement.
+static QString insert_values(const QString &suffix, bool xmltv = false)
+{
+    QString extra;
+    if (xmltv)
+        extra = QString(", :TITLEPRON%1, :SHOWTYPE%1, :COLORCODE%1 ").arg(suffix);
+
+    return QString(
+        "("
+        " :CHANID%1,        :TITLE%1,         :SUBTITLE%1,       :DESCRIPTION%1, "
+        " :CATEGORY%1,      :CATTYPE%1, "
+        " :STARTTIME%1,     :ENDTIME%1, "
+        " :CC%1,            :STEREO%1,        :HDTV%1,           :HASSUBTITLES%1, "
+        " :SUBTYPES%1,      :AUDIOPROP%1,     :VIDEOPROP%1, "
+        " :STARS%1,         :PARTNUMBER%1,    :PARTTOTAL%1, "
+        " :SYNDICATENO%1, "
+        " :AIRDATE%1,       :ORIGAIRDATE%1,   :LSOURCE%1, "
+        " :SERIESID%1,      :PROGRAMID%1,     :PREVSHOWN%1, "
+        " :SEASON%1,        :EPISODE%1,       :TOTALEPISODES%1, "
+        " :INETREF%1 %2) ").arg(suffix, extra);
+}
+
+static void bind_insert_values(MSqlQuery &query, const QString &suffix,
+                               uint chanid, const DBEvent &event)
+{
+    auto bind = [&query, &suffix](const char *name, const QVariant &val)
+        { query.bindValue(QString(name) + suffix, val); };
+
+    QString cattype = myth_category_type_to_string(event.m_categoryType);
+    bind(":CHANID",      chanid);
+    bind(":TITLE",       denullify(event.m_title));
+    bind(":SUBTITLE",    denullify(event.m_subtitle));
+    bind(":DESCRIPTION", denullify(event.m_description));
+    bind(":CATEGORY",    denullify(event.m_category));
+    bind(":CATTYPE",     cattype);
+    bind(":STARTTIME",   event.m_starttime);
+    bind(":ENDTIME",     event.m_endtime);
+    bind(":CC",          (event.m_subtitleType & SUB_HARDHEAR) != 0);
+    bind(":STEREO",      (event.m_audioProps   & AUD_STEREO) != 0);
+    bind(":HDTV",        (event.m_videoProps   & VID_HDTV) != 0);
+    bind(":HASSUBTITLES",(event.m_subtitleType & SUB_NORMAL) != 0);
+    bind(":SUBTYPES",    event.m_subtitleType);
+    bind(":AUDIOPROP",   event.m_audioProps);
+    bind(":VIDEOPROP",   event.m_videoProps);
+    bind(":STARS",       event.m_stars);
+    bind(":PARTNUMBER",  event.m_partnumber);
+    bind(":PARTTOTAL",   event.m_parttotal);
+    bind(":SYNDICATENO", denullify(event.m_syndicatedepisodenumber));
+    bind(":AIRDATE",     event.m_airdate ? QString::number(event.m_airdate) : "0000");
+    bind(":ORIGAIRDATE", event.m_originalairdate);
+    bind(":LSOURCE",     event.m_listingsource);
+    bind(":SERIESID",    denullify(event.m_seriesId));
+    bind(":PROGRAMID",   denullify(event.m_programId));
+    bind(":PREVSHOWN",   event.m_previouslyshown);
+    bind(":SEASON",      event.m_season);
+    bind(":EPISODE",     event.m_episode);
+    bind(":TOTALEPISODES", event.m_totalepisodes);
+    bind(":INETREF",     event.m_inetref);
+}
+
 /**
  *  \brief Insert Callback function when Allow Re-record is pressed in Watch Recordings
  */
@@ -1147,62 +1276,9 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid,
 {
     QString table = recording ? "recordedprogram" : "program";
 
-    query.prepare(QString(
-        "REPLACE INTO %1 ("
-        "  chanid,         title,          subtitle,        description, "
-        "  category,       category_type, "
-        "  starttime,      endtime, "
-        "  closecaptioned, stereo,         hdtv,            subtitled, "
-        "  subtitletypes,  audioprop,      videoprop, "
-        "  stars,          partnumber,     parttotal, "
-        "  syndicatedepisodenumber, "
-        "  airdate,        originalairdate,listingsource, "
-        "  seriesid,       programid,      previouslyshown, "
-        "  season,         episode,        totalepisodes, "
-        "  inetref ) "
-        "VALUES ("
-        " :CHANID,        :TITLE,         :SUBTITLE,       :DESCRIPTION, "
-        " :CATEGORY,      :CATTYPE, "
-        " :STARTTIME,     :ENDTIME, "
-        " :CC,            :STEREO,        :HDTV,           :HASSUBTITLES, "
-        " :SUBTYPES,      :AUDIOPROP,     :VIDEOPROP, "
-        " :STARS,         :PARTNUMBER,    :PARTTOTAL, "
-        " :SYNDICATENO, "
-        " :AIRDATE,       :ORIGAIRDATE,   :LSOURCE, "
-        " :SERIESID,      :PROGRAMID,     :PREVSHOWN, "
-        " :SEASON,        :EPISODE,       :TOTALEPISODES, "
-        " :INETREF ) ").arg(table));
-
-    QString cattype = myth_category_type_to_string(m_categoryType);
-    query.bindValue(":CHANID",      chanid);
-    query.bindValue(":TITLE",       denullify(m_title));
-    query.bindValue(":SUBTITLE",    denullify(m_subtitle));
-    query.bindValue(":DESCRIPTION", denullify(m_description));
-    query.bindValue(":CATEGORY",    denullify(m_category));
-    query.bindValue(":CATTYPE",     cattype);
-    query.bindValue(":STARTTIME",   m_starttime);
-    query.bindValue(":ENDTIME",     m_endtime);
-    query.bindValue(":CC",          (m_subtitleType & SUB_HARDHEAR) != 0);
-    query.bindValue(":STEREO",      (m_audioProps   & AUD_STEREO) != 0);
-    query.bindValue(":HDTV",        (m_videoProps   & VID_HDTV) != 0);
-    query.bindValue(":HASSUBTITLES",(m_subtitleType & SUB_NORMAL) != 0);
-    query.bindValue(":SUBTYPES",    m_subtitleType);
-    query.bindValue(":AUDIOPROP",   m_audioProps);
-    query.bindValue(":VIDEOPROP",   m_videoProps);
-    query.bindValue(":STARS",       m_stars);
-    query.bindValue(":PARTNUMBER",  m_partnumber);
-    query.bindValue(":PARTTOTAL",   m_parttotal);
-    query.bindValue(":SYNDICATENO", denullify(m_syndicatedepisodenumber));
-    query.bindValue(":AIRDATE",     m_airdate ? QString::number(m_airdate) : "0000");
-    query.bindValue(":ORIGAIRDATE", m_originalairdate);
-    query.bindValue(":LSOURCE",     m_listingsource);
-    query.bindValue(":SERIESID",    denullify(m_seriesId));
-    query.bindValue(":PROGRAMID",   denullify(m_programId));
-    query.bindValue(":PREVSHOWN",   m_previouslyshown);
-    query.bindValue(":SEASON",      m_season);
-    query.bindValue(":EPISODE",     m_episode);
-    query.bindValue(":TOTALEPISODES", m_totalepisodes);
-    query.bindValue(":INETREF",     m_inetref);
+    query.prepare(QString("REPLACE INTO %1 (%2) VALUES %3")
+                  .arg(table, kInsertColumns, insert_values(QString())));
+    bind_insert_values(query, QString(), chanid, *this);
 
     if (!query.exec())
     {
@@ -1237,6 +1313,560 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid,
     return 1;
 }
 
+/// The most rows DBEventEITBatch and ProgramData::HandlePrograms()
+/// write with one statement.
+static constexpr size_t kMaxBatchRows = 100;
+
+/// The programs of one channel in the time window of its events,
+/// as they are after the events handled so far.
+struct DBEventEITBatch::Channel
+{
+    explicit Channel(uint chanid) : m_chanid(chanid) {}
+
+    /// Same as program_exists()
+    bool Exists(const QDateTime &starttime) const
+    {
+        return (m_programs.find(starttime) != m_programs.end()) ||
+               (m_manual.find(starttime) != m_manual.end());
+    }
+
+    uint                          m_chanid;
+    std::map<QDateTime, DBEvent>  m_programs; ///< manualid = 0, by starttime
+    std::set<QDateTime>           m_manual;   ///< starttimes of manual programs
+};
+
+// A copy of an event as it is stored in the program table, without the
+// credits, so that it can safely be copied around.
+static DBEvent program_row(const DBEvent &event)
+{
+    DBEvent row(event.m_listingsource);
+    row = event;
+    delete row.m_credits;
+    row.m_credits = nullptr;
+    return row;
+}
+
+// Same test as the one in DBEvent::GetOverlappingPrograms().
+static bool overlaps(const DBEvent &prog, const DBEvent &event)
+{
+    return (prog.m_starttime >= event.m_starttime &&
+            prog.m_starttime <  event.m_endtime) ||
+           (prog.m_endtime   >  event.m_starttime &&
+            prog.m_endtime   <= event.m_endtime) ||
+           (prog.m_starttime <  event.m_starttime &&
+            prog.m_endtime   >  event.m_endtime);
+}
+
+// True when DBEvent::UpdateDB() would write "b" over "a" unchanged.
+static bool same_program(const DBEvent &a, const DBEvent &b)
+{
+    return a.m_title           == b.m_title           &&
+           a.m_subtitle        == b.m_subtitle        &&
+           a.m_description     == b.m_description     &&
+           a.m_category        == b.m_category        &&
+           a.m_categoryType    == b.m_categoryType    &&
+           a.m_starttime       == b.m_starttime       &&
+           a.m_endtime         == b.m_endtime         &&
+           a.m_subtitleType    == b.m_subtitleType    &&
+           a.m_audioProps      == b.m_audioProps      &&
+           a.m_videoProps      == b.m_videoProps      &&
+           a.m_season          == b.m_season          &&
+           a.m_episode         == b.m_episode         &&
+           a.m_totalepisodes   == b.m_totalepisodes   &&
+           a.m_partnumber      == b.m_partnumber      &&
+           a.m_parttotal       == b.m_parttotal       &&
+           a.m_syndicatedepisodenumber == b.m_syndicatedepisodenumber &&
+           a.m_airdate         == b.m_airdate         &&
+           a.m_originalairdate == b.m_originalairdate &&
+           a.m_listingsource   == b.m_listingsource   &&
+           a.m_seriesId        == b.m_seriesId        &&
+           a.m_programId       == b.m_programId       &&
+           a.m_previouslyshown == b.m_previouslyshown &&
+           a.m_inetref         == b.m_inetref;
+}
+
+DBEventEITBatch::~DBEventEITBatch()
+{
+    for (auto & events : m_events)
+    {
+        for (auto *event : events)
+            delete event;
+    }
+}
+
+void DBEventEITBatch::Add(DBEventEIT *event)
+{
+    m_events[event->m_chanid].push_back(event);
+}
+
+bool DBEventEITBatch::UpdateDB(MSqlQuery &query, uint &count)
+{
+    count = 0;
+    if (m_events.empty())
+        return true;
+
+    m_failed = !query.exec("START TRANSACTION");
+    if (m_failed)
+        MythDB::DBError("EIT batch start", query);
+
+    for (auto it = m_events.cbegin(); !m_failed && it != m_events.cend(); ++it)
+    {
+        Channel chan(it.key());
+        m_failed = !LoadPrograms(query, chan, *it);
+        for (auto eit = it->cbegin(); !m_failed && eit != it->cend(); ++eit)
+            count += UpdateEvent(query, chan, **eit);
+    }
+
+    if (!m_failed)
+        FlushDeletes(query);
+    if (!m_failed)
+        FlushInserts(query);
+
+    if (!m_failed && !query.exec("COMMIT"))
+    {
+        MythDB::DBError("EIT batch commit", query);
+        m_failed = true;
+    }
+
+    if (m_failed)
+    {
+        LOG(VB_EIT, LOG_ERR, "EIT: batch update failed, rolling back");
+        if (!query.exec("ROLLBACK"))
+            MythDB::DBError("EIT batch rollback", query);
+        m_inserts.clear();
+        m_insertKeys.clear();
+        m_deletes.clear();
+        m_deleteKeys.clear();
+        count = 0;
+        return false;
+    }
+
+    for (auto & events : m_events)
+    {
+        for (auto *event : events)
+            delete event;
+    }
+    m_events.clear();
+
+    return true;
+}
+
+// Get all programs in the database that overlap with any of the events,
+// or that start when one of them ends.
+bool DBEventEITBatch::LoadPrograms(MSqlQuery &query, Channel &chan,
+                                   const std::vector<DBEventEIT*> &events)
+{
+    QDateTime start = events.front()->m_starttime;
+    QDateTime end   = events.front()->m_endtime;
+    for (const auto *event : events)
+    {
+        start = std::min(start, event->m_starttime);
+        end   = std::max(end,   event->m_endtime);
+    }
+
+    query.prepare(QString(
+        "SELECT %1, manualid "
+        "FROM program "
+        "WHERE chanid   = :CHANID AND "
+        "      ( ( starttime >= :STIME1 AND starttime <= :ETIME1 ) OR "
+        "        ( endtime   >  :STIME2 AND endtime   <= :ETIME2 ) OR "
+        "        ( starttime <  :STIME3 AND endtime   >  :ETIME3 ) )")
+        .arg(kProgramColumns));
+    query.bindValue(":CHANID", chan.m_chanid);
+    query.bindValue(":STIME1", start);
+    query.bindValue(":ETIME1", end);
+    query.bindValue(":STIME2", start);
+    query.bindValue(":ETIME2", end);
+    query.bindValue(":STIME3", start);
+    query.bindValue(":ETIME3", end);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("EIT batch load", query);
+        return false;
+    }
+
+    while (query.next())
+    {
+        DBEvent prog = program_from_query(query);
+        if (query.value(24).toUInt())
+            chan.m_manual.insert(prog.m_starttime);
+        else
+            chan.m_programs.insert_or_assign(prog.m_starttime, prog);
+    }
+    return true;
+}
+
+// Same as DBEvent::UpdateDB(query, chanid, match_threshold)
+uint DBEventEITBatch::UpdateEvent(MSqlQuery &query, Channel &chan,
+                                  const DBEvent &event)
+{
+    LOG(VB_EIT, LOG_DEBUG,
+        QString("EIT: new program: %1 %2 '%3' chanid %4")
+                .arg(event.m_starttime.toString(Qt::ISODate),
+                     event.m_endtime.toString(Qt::ISODate),
+                     event.m_title.left(35),
+                     QString::number(chan.m_chanid)));
+
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    if (event.m_endtime < now)
+    {
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: skip '%1' endtime is in the past")
+                    .arg(event.m_title.left(35)));
+        return 0;
+    }
+
+    // The programs are sorted by starttime, so the ones that start
+    // after our new program ends can't overlap with it.
+    std::vector<DBEvent> programs;
+    for (auto it = chan.m_programs.cbegin();
+         (it != chan.m_programs.cend()) && (it->first <= event.m_endtime); ++it)
+    {
+        if (overlaps(it->second, event))
+            programs.push_back(it->second);
+    }
+
+    if (programs.empty())
+        return InsertProgram(query, chan, event);
+
+    int i = -1;
+    int match = event.GetMatch(programs, i);
+
+    if (match >= m_matchThreshold)
+    {
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: accept match[%1]: %2 '%3' vs. '%4'")
+                .arg(i).arg(match)
+                .arg(event.m_title.left(35), programs[i].m_title.left(35)));
+        return UpdateEvent(query, chan, event, programs, i);
+    }
+
+    return UpdateEvent(query, chan, event, programs, -1);
+}
+
+// Same as DBEvent::UpdateDB(q, chanid, p, match)
+uint DBEventEITBatch::UpdateEvent(MSqlQuery &query, Channel &chan,
+                                  const DBEvent &event,
+                                  const std::vector<DBEvent> &p, int match)
+{
+    bool ok = true;
+    for (size_t i = 0; i < p.size(); ++i)
+    {
+        if (i != (uint)match)
+            ok &= MoveOutOfTheWay(query, chan, event, p[i]);
+    }
+
+    if (!ok)
+    {
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: cannot insert '%1' MoveOutOfTheWayDB failed")
+                    .arg(event.m_title.left(35)));
+        return 0;
+    }
+
+    if ((match < 0) || ((uint)match >= p.size()))
+        return InsertProgram(query, chan, event);
+
+    if (event.m_starttime != p[match].m_starttime)
+    {
+        QDateTime now = QDateTime::currentDateTimeUtc();
+        if (event.m_starttime < now && event.m_endtime <= p[match].m_endtime)
+        {
+            LOG(VB_EIT, LOG_DEBUG,
+                QString("EIT:  skip '%1' starttime is in the past")
+                        .arg(event.m_title.left(35)));
+            return 0;
+        }
+    }
+
+    return UpdateMatch(query, chan, event, p[match]);
+}
+
+uint DBEventEITBatch::UpdateMatch(MSqlQuery &query, Channel &chan,
+                                  const DBEvent &event, const DBEvent &match)
+{
+    DBEvent merged = event.Merge(match);
+
+    // Most events are repeats of ones we already have;
+    // don't write them again when nothing changes.
+    if ((event.m_starttime == match.m_starttime) && !event.HasCredits() &&
+        event.m_ratings.isEmpty() && event.m_genres.isEmpty() &&
+        same_program(merged, match))
+    {
+        return 1;
+    }
+
+    LOG(VB_EIT, LOG_DEBUG,
+         QString("EIT: update '%1' with '%2'")
+                 .arg(match.m_title.left(35), event.m_title.left(35)));
+
+    Touch(query, chan.m_chanid, match.m_starttime);
+    Touch(query, chan.m_chanid, event.m_starttime);
+    if (!event.UpdateDB(query, chan.m_chanid, match))
+    {
+        m_failed = true;
+        return 0;
+    }
+
+    chan.m_programs.erase(match.m_starttime);
+    chan.m_programs.insert_or_assign(event.m_starttime, merged);
+    if (chan.m_manual.erase(match.m_starttime))
+        chan.m_manual.insert(event.m_starttime);
+
+    return 1;
+}
+
+// Same as DBEvent::MoveOutOfTheWayDB()
+bool DBEventEITBatch::MoveOutOfTheWay(MSqlQuery &query, Channel &chan,
+                                      const DBEvent &event,
+                                      const DBEvent &prog)
+{
+    if (prog.m_starttime >= event.m_starttime &&
+        prog.m_endtime <= event.m_endtime)
+    {
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: delete '%1' %2 - %3")
+                    .arg(prog.m_title.left(35),
+                         prog.m_starttime.toString(Qt::ISODate),
+                         prog.m_endtime.toString(Qt::ISODate)));
+        DeleteProgram(query, chan, prog.m_starttime);
+        return true;
+    }
+    if (prog.m_starttime < event.m_starttime &&
+        prog.m_endtime > event.m_starttime)
+    {
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: change '%1' endtime to %2")
+                    .arg(prog.m_title.left(35),
+                         event.m_starttime.toString(Qt::ISODate)));
+        Touch(query, chan.m_chanid, prog.m_starttime);
+        if (!change_program(query, chan.m_chanid, prog.m_starttime,
+                            prog.m_starttime, event.m_starttime))
+        {
+            m_failed = true;
+            return false;
+        }
+
+        auto it = chan.m_programs.find(prog.m_starttime);
+        if (it != chan.m_programs.end())
+            it->second.m_endtime = event.m_starttime;
+        return true;
+    }
+    if (prog.m_starttime < event.m_endtime && prog.m_endtime > event.m_endtime)
+    {
+        if (chan.Exists(event.m_endtime))
+        {
+            LOG(VB_EIT, LOG_DEBUG,
+                QString("EIT: delete '%1' %2 - %3")
+                        .arg(prog.m_title.left(35),
+                             prog.m_starttime.toString(Qt::ISODate),
+                             prog.m_endtime.toString(Qt::ISODate)));
+            DeleteProgram(query, chan, prog.m_starttime);
+            return true;
+        }
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: (M) change starttime from %1 to %2 for chanid:%3 program '%4' ")
+                    .arg(prog.m_starttime.toString(Qt::ISODate),
+                         event.m_endtime.toString(Qt::ISODate),
+                         QString::number(chan.m_chanid),
+                         prog.m_title.left(35)));
+
+        change_record(query, chan.m_chanid, prog.m_starttime, event.m_endtime);
+        Touch(query, chan.m_chanid, prog.m_starttime);
+        Touch(query, chan.m_chanid, event.m_endtime);
+        if (!change_program(query, chan.m_chanid, prog.m_starttime,
+                            event.m_endtime, prog.m_endtime))
+        {
+            m_failed = true;
+            return false;
+        }
+
+        auto node = chan.m_programs.extract(prog.m_starttime);
+        if (!node.empty())
+        {
+            node.key() = event.m_endtime;
+            node.mapped().m_starttime = event.m_endtime;
+            chan.m_programs.insert(std::move(node));
+        }
+        if (chan.m_manual.erase(prog.m_starttime))
+            chan.m_manual.insert(event.m_endtime);
+        return true;
+    }
+    return true;
+}
+
+uint DBEventEITBatch::InsertProgram(MSqlQuery &query, Channel &chan,
+                                    const DBEvent &event)
+{
+    LOG(VB_EIT, LOG_DEBUG,
+        QString("EIT: insert '%1'").arg(event.m_title.left(35)));
+
+    ProgramKey key { chan.m_chanid, event.m_starttime };
+    if (m_deleteKeys.find(key) != m_deleteKeys.end())
+        FlushDeletes(query);
+
+    m_inserts.emplace_back(chan.m_chanid, &event);
+    m_insertKeys.insert(key);
+    chan.m_programs.insert_or_assign(event.m_starttime, program_row(event));
+
+    return 1;
+}
+
+void DBEventEITBatch::DeleteProgram(MSqlQuery &query, Channel &chan,
+                                    const QDateTime &starttime)
+{
+    ProgramKey key { chan.m_chanid, starttime };
+    if (m_insertKeys.find(key) != m_insertKeys.end())
+        FlushInserts(query);
+
+    if (m_deleteKeys.insert(key).second)
+        m_deletes.push_back(key);
+    chan.m_programs.erase(starttime);
+    chan.m_manual.erase(starttime);
+}
+
+// The queued inserts and deletes are written out of order, so write them
+// before a statement that works on the same program.
+void DBEventEITBatch::Touch(MSqlQuery &query, uint chanid,
+                            const QDateTime &starttime)
+{
+    ProgramKey key { chanid, starttime };
+    if (m_deleteKeys.find(key) != m_deleteKeys.end())
+        FlushDeletes(query);
+    if (m_insertKeys.find(key) != m_insertKeys.end())
+        FlushInserts(query);
+}
+
+// Same as DBEvent::InsertDB() for each of the queued events
+void DBEventEITBatch::FlushInserts(MSqlQuery &query)
+{
+    for (size_t first = 0; first < m_inserts.size(); first += kMaxBatchRows)
+    {
+        size_t last = std::min(first + kMaxBatchRows, m_inserts.size());
+
+        QStringList values;
+        for (size_t i = first; i < last; ++i)
+            values << insert_values(QString("_%1").arg(i - first));
+        query.prepare(QString("REPLACE INTO program (%1) VALUES %2")
+                      .arg(kInsertColumns, values.join(",")));
+        for (size_t i = first; i < last; ++i)
+        {
+            bind_insert_values(query, QString("_%1").arg(i - first),
+                               m_inserts[i].first, *m_inserts[i].second);
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("EIT batch insert", query);
+            m_failed = true;
+            break;
+        }
+
+        int ratings = 0;
+        for (size_t i = first; i < last; ++i)
+            ratings += m_inserts[i].second->m_ratings.size();
+        values.clear();
+        for (int row = 0; row < ratings; ++row)
+        {
+            values << QString("(:CHANID_%1, :START_%1, :SYS_%1, :RATING_%1)")
+                      .arg(row);
+        }
+        if (!values.isEmpty())
+        {
+            query.prepare(
+                "INSERT IGNORE INTO programrating "
+                "       ( chanid, starttime, `system`, rating) "
+                "VALUES " + values.join(","));
+            int row = 0;
+            for (size_t i = first; i < last; ++i)
+            {
+                const auto & [chanid, event] = m_inserts[i];
+                for (const auto & rating : qAsConst(event->m_ratings))
+                {
+                    QString suffix = QString("_%1").arg(row++);
+                    query.bindValue(":CHANID" + suffix, chanid);
+                    query.bindValue(":START"  + suffix, event->m_starttime);
+                    query.bindValue(":SYS"    + suffix, rating.m_system);
+                    query.bindValue(":RATING" + suffix, rating.m_rating);
+                }
+            }
+            if (!query.exec())
+            {
+                MythDB::DBError("programrating insert", query);
+                m_failed = true;
+                break;
+            }
+        }
+
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto & [chanid, event] = m_inserts[i];
+            if (event->m_credits)
+            {
+                for (auto & credit : *event->m_credits)
+                {
+                    // A person that can not be found is skipped, as
+                    // before, only a failed statement fails the batch.
+                    if (!credit.InsertDB(query, chanid, event->m_starttime) &&
+                        query.lastError().isValid())
+                        m_failed = true;
+                }
+            }
+            if (!add_genres(query, event->m_genres, chanid,
+                            event->m_starttime))
+                m_failed = true;
+        }
+        if (m_failed)
+            break;
+    }
+
+    m_inserts.clear();
+    m_insertKeys.clear();
+}
+
+// Same as delete_program() for each of the queued programs
+void DBEventEITBatch::FlushDeletes(MSqlQuery &query)
+{
+    static const std::array<const char *,4> kTables
+        { "program", "credits", "programrating", "programgenres" };
+
+    for (size_t first = 0; first < m_deletes.size(); first += kMaxBatchRows)
+    {
+        size_t last = std::min(first + kMaxBatchRows, m_deletes.size());
+
+        QStringList where;
+        for (size_t i = first; i < last; ++i)
+        {
+            where << QString("(chanid = :CHANID_%1 AND starttime = :START_%1)")
+                     .arg(i - first);
+        }
+
+        for (const auto *table : kTables)
+        {
+            query.prepare(QString("DELETE FROM %1 WHERE %2")
+                          .arg(QString(table), where.join(" OR ")));
+            for (size_t i = first; i < last; ++i)
+            {
+                QString suffix = QString("_%1").arg(i - first);
+                query.bindValue(":CHANID" + suffix, m_deletes[i].first);
+                query.bindValue(":START"  + suffix, m_deletes[i].second);
+            }
+            if (!query.exec())
+            {
+                MythDB::DBError("EIT batch delete", query);
+                m_failed = true;
+                break;
+            }
+        }
+        if (m_failed)
+            break;
+    }
+
+    m_deletes.clear();
+    m_deleteKeys.clear();
+}
+
 ProgInfo::ProgInfo(const ProgInfo &other) :
     DBEvent(other.m_listingsource)
 {
@@ -1545,10 +2175,45 @@ void ProgramData::FixProgramList(QList<ProgInfo*> &fixlist)
     }
 }
 
+namespace
+{
+    /// Runs the programs of one xmltvid on a pool thread
+    class HandleProgramsTask : public QRunnable
+    {
+      public:
+        HandleProgramsTask(std::function<void()> task, QSemaphore &done) :
+            m_task(std::move(task)), m_done(done) {}
+
+        void run() override // QRunnable
+        {
+            m_task();
+            m_done.release();
+        }
+
+      private:
+        std::function<void()> m_task;
+        QSemaphore           &m_done;
+    };
+
+    // Each writer has its own DB connection, more of them mostly
+    // contend for the same program table.
+    constexpr int kMaxProgramWriters { 4 };
+
+    // Times a channel's transaction is tried when it hits a lock conflict
+    constexpr uint kMaxWriteAttempts { 3 };
+
+    // Serialises the transactions of the program writers
+    QMutex s_programWriteLock;
+}
+
 /**
  *  \brief Called from mythfilldatabase to bulk insert data into the
  *  program database.
  *
+ *  The channels are shared out between a few threads, each of which
+ *  reads and compares its channels with its own DB connection. Their
+ *  write transactions take turns.
+ *
  *  \param sourceid The data source identifier
  *  \param proglist A map of all program information keyed by channel
  *                  identifier
@@ -1556,37 +2221,44 @@ void ProgramData::FixProgramList(QList<ProgInfo*> &fixlist)
 void ProgramData::HandlePrograms(
     uint sourceid, QMap<QString, QList<ProgInfo> > &proglist)
 {
-    uint unchanged = 0;
-    uint updated = 0;
-
     MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(
+        "SELECT xmltvid, chanid "
+        "FROM channel "
+        "WHERE deleted  IS NULL AND "
+        "      sourceid = :ID");
+    query.bindValue(":ID", sourceid);
 
-    QMap<QString, QList<ProgInfo> >::const_iterator mapiter;
-    for (mapiter = proglist.cbegin(); mapiter != proglist.cend(); ++mapiter)
+    if (!query.exec())
     {
-        if (mapiter.key().isEmpty())
-            continue;
+        MythDB::DBError("ProgramData::HandlePrograms", query);
+        return;
+    }
 
-        query.prepare(
-            "SELECT chanid "
-            "FROM channel "
-            "WHERE deleted  IS NULL AND "
-            "      sourceid = :ID AND "
-            "      xmltvid  = :XMLTVID");
-        query.bindValue(":ID",      sourceid);
-        query.bindValue(":XMLTVID", mapiter.key());
+    // Keyed on the lower case xmltvid, the query this replaces matched
+    // it case insensitively.
+    QMap<QString, std::vector<uint> > chanids;
+    while (query.next())
+    {
+        chanids[query.value(0).toString().toLower()]
+            .push_back(query.value(1).toUInt());
+    }
 
-        if (!query.exec())
-        {
-            MythDB::DBError("ProgramData::HandlePrograms", query);
-            continue;
-        }
+    std::atomic<uint> unchanged { 0 };
+    std::atomic<uint> updated { 0 };
 
-        std::vector<uint> chanids;
-        while (query.next())
-            chanids.push_back(query.value(0).toUInt());
+    MThreadPool pool("ProgramDataPool");
+    pool.setMaxThreadCount(kMaxProgramWriters);
+    QSemaphore done;
+    int tasks = 0;
+
+    for (auto mapiter = proglist.begin(); mapiter != proglist.end(); ++mapiter)
+    {
+        if (mapiter.key().isEmpty())
+            continue;
 
-        if (chanids.empty())
+        auto chanit = chanids.constFind(mapiter.key().toLower());
+        if (chanit == chanids.constEnd())
         {
             LOG(VB_GENERAL, LOG_NOTICE,
                 QString("Unknown xmltv channel identifier: %1"
@@ -1594,27 +2266,80 @@ void ProgramData::HandlePrograms(
             continue;
         }
 
-        QList<ProgInfo> &list = proglist[mapiter.key()];
-        QList<ProgInfo*> sortlist;
-        // NOLINTNEXTLINE(modernize-loop-convert)
-        for (auto it = list.begin(); it != list.end(); ++it)
-            sortlist.push_back(&(*it));
+        QList<ProgInfo> *list = &(*mapiter);
+        const std::vector<uint> *channels = &(*chanit);
+        auto task = [list, channels, &unchanged, &updated]()
+        {
+            QList<ProgInfo*> sortlist;
+            // NOLINTNEXTLINE(modernize-loop-convert)
+            for (auto it = list->begin(); it != list->end(); ++it)
+                sortlist.push_back(&(*it));
 
-        FixProgramList(sortlist);
+            FixProgramList(sortlist);
 
-        for (uint chanid : chanids)
-            HandlePrograms(query, chanid, sortlist, unchanged, updated);
+            MSqlQuery taskquery(MSqlQuery::InitCon());
+            uint taskunchanged = 0;
+            uint taskupdated = 0;
+            for (uint chanid : *channels)
+            {
+                HandlePrograms(taskquery, chanid, sortlist,
+                               taskunchanged, taskupdated);
+            }
+            unchanged += taskunchanged;
+            updated += taskupdated;
+        };
+        pool.start(new HandleProgramsTask(task, done), "HandlePrograms");
+        tasks++;
     }
 
+    done.acquire(tasks);
+    pool.waitForDone();
+
     LOG(VB_GENERAL, LOG_INFO,
         QString("Updated programs: %1 Unchanged programs: %2")
-                .arg(updated) .arg(unchanged));
+                .arg(updated.load()) .arg(unchanged.load()));
+}
+
+// The XMLTV columns ProgramData::HandlePrograms() compares with, the same
+// ones it used to match with a query for each program.
+static bool same_xmltv_program(const ProgInfo &a, const ProgInfo &b)
+{
+    return a.m_starttime       == b.m_starttime       &&
+           a.m_endtime         == b.m_endtime         &&
+           a.m_title           == b.m_title           &&
+           a.m_subtitle        == b.m_subtitle        &&
+           a.m_description     == b.m_description     &&
+           a.m_category        == b.m_category        &&
+           a.m_categoryType    == b.m_categoryType    &&
+           a.m_airdate         == b.m_airdate         &&
+           qAbs(a.m_stars - b.m_stars) <= 0.001F      &&
+           a.m_previouslyshown == b.m_previouslyshown &&
+           a.m_title_pronounce == b.m_title_pronounce &&
+           a.m_audioProps      == b.m_audioProps      &&
+           a.m_videoProps      == b.m_videoProps      &&
+           a.m_subtitleType    == b.m_subtitleType    &&
+           a.m_partnumber      == b.m_partnumber      &&
+           a.m_parttotal       == b.m_parttotal       &&
+           a.m_seriesId        == b.m_seriesId        &&
+           a.m_showtype        == b.m_showtype        &&
+           a.m_colorcode       == b.m_colorcode       &&
+           a.m_syndicatedepisodenumber == b.m_syndicatedepisodenumber &&
+           a.m_programId       == b.m_programId       &&
+           a.m_season          == b.m_season          &&
+           a.m_episode         == b.m_episode         &&
+           a.m_totalepisodes   == b.m_totalepisodes   &&
+           a.m_inetref         == b.m_inetref;
 }
 
 /**
  *  \brief Called from HandlePrograms to bulk insert data into the
  *  program database.
  *
+ *  The existing programs in the time span of the list are read with one
+ *  query and compared with in memory. The programs that changed replace
+ *  the ones they overlap with, which is written as a few multi-row
+ *  statements in one transaction.
+ *
  *  \param query A mysql query related to all channel ids for
  *               a given source
  *  \param chanid The specific channel id to process
@@ -1628,19 +2353,272 @@ void ProgramData::HandlePrograms(MSqlQuery             &query,
                                  uint &unchanged,
                                  uint &updated)
 {
-    for (auto *pinfo : qAsConst(sortlist))
+    if (sortlist.isEmpty())
+        return;
+
+    QDateTime first = sortlist.front()->m_starttime;
+    QDateTime last  = first;
+    for (const auto *pinfo : qAsConst(sortlist))
+    {
+        first = std::min(first, pinfo->m_starttime);
+        last  = std::max(last,  pinfo->m_starttime);
+        if (pinfo->m_endtime.isValid())
+            last = std::max(last, pinfo->m_endtime);
+    }
+
+    // Everything any of the programs can match or delete.
+    query.prepare(QString(
+        "SELECT %1, title_pronounce, showtype, colorcode "
+        "FROM program "
+        "WHERE chanid     = :CHANID AND "
+        "      starttime >= :START  AND "
+        "      starttime <= :END").arg(kProgramColumns));
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":START",  first);
+    query.bindValue(":END",    last);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::HandlePrograms load", query);
+        return;
+    }
+
+    std::list<ProgInfo> rows;
+    std::multimap<QDateTime, const ProgInfo*> programs;
+    while (query.next())
+    {
+        rows.emplace_back();
+        ProgInfo &row = rows.back();
+        static_cast<DBEvent&>(row) = program_from_query(query);
+        row.m_title_pronounce = query.value(24).toString();
+        row.m_showtype        = query.value(25).toString();
+        row.m_colorcode       = query.value(26).toString();
+        programs.emplace(row.m_starttime, &row);
+    }
+
+    std::vector<const ProgInfo*> inserts;
+    std::vector<std::pair<QDateTime,QDateTime> > deletes;
+
+    for (const auto *pinfo : qAsConst(sortlist))
     {
-        if (IsUnchanged(query, chanid, *pinfo))
+        // A program without an end time never matches.
+        if (pinfo->m_endtime.isValid())
         {
-            unchanged++;
-            continue;
+            auto range = programs.equal_range(pinfo->m_starttime);
+            auto match = std::find_if(range.first, range.second,
+                [pinfo](const auto &prog)
+                    { return same_xmltv_program(*prog.second, *pinfo); });
+            if (match != range.second)
+            {
+                unchanged++;
+                continue;
+            }
         }
 
-        if (!DeleteOverlaps(query, chanid, *pinfo))
-            continue;
+        // Delete everything that starts while this program is on,
+        // including programs from this list that were not written yet.
+        if (pinfo->m_starttime < pinfo->m_endtime)
+        {
+            auto lo = programs.lower_bound(pinfo->m_starttime);
+            auto hi = programs.lower_bound(pinfo->m_endtime);
+            for (auto it = lo; it != hi; ++it)
+            {
+                LOG(VB_XMLTV, LOG_DEBUG,
+                    QString("Removing existing program: %1 - %2 %3 %4")
+                    .arg(it->second->m_starttime.toString(Qt::ISODate),
+                         it->second->m_endtime.toString(Qt::ISODate),
+                         pinfo->m_channel,
+                         it->second->m_title));
+            }
+            programs.erase(lo, hi);
+            inserts.erase(
+                std::remove_if(inserts.begin(), inserts.end(),
+                    [pinfo](const ProgInfo *prog)
+                        { return prog->m_starttime >= pinfo->m_starttime &&
+                                 prog->m_starttime <  pinfo->m_endtime; }),
+                inserts.end());
+
+            if (!deletes.empty() &&
+                deletes.back().second >= pinfo->m_starttime)
+            {
+                deletes.back().second =
+                    std::max(deletes.back().second, pinfo->m_endtime);
+            }
+            else
+            {
+                deletes.emplace_back(pinfo->m_starttime, pinfo->m_endtime);
+            }
+        }
+
+        programs.emplace(pinfo->m_starttime, pinfo);
+        inserts.push_back(pinfo);
+    }
+
+    if (inserts.empty() && deletes.empty())
+        return;
+
+    // Only one writer at a time, the range deletes and inserts of
+    // different channels can deadlock on InnoDB gap locks otherwise.
+    // Other processes writing the program table still can, so a lock
+    // conflict is retried.
+    QMutexLocker locker(&s_programWriteLock);
+    for (uint attempt = 1; ; ++attempt)
+    {
+        if (!query.exec("START TRANSACTION"))
+            MythDB::DBError("ProgramData::HandlePrograms start", query);
+
+        bool ok = DeletePrograms(query, chanid, deletes) &&
+                  InsertPrograms(query, chanid, inserts);
+        if (ok && !query.exec("COMMIT"))
+        {
+            MythDB::DBError("ProgramData::HandlePrograms commit", query);
+            ok = false;
+        }
+        if (ok)
+        {
+            updated += static_cast<uint>(inserts.size());
+            return;
+        }
+
+        bool retry = is_lock_conflict(query) && attempt < kMaxWriteAttempts;
+        LOG(VB_XMLTV, retry ? LOG_WARNING : LOG_ERR,
+            QString("Program update failed for chanid %1, rolling back%2")
+                .arg(chanid).arg(retry ? " and retrying" : ""));
+        if (!query.exec("ROLLBACK"))
+            MythDB::DBError("ProgramData::HandlePrograms rollback", query);
+        if (!retry)
+            return;
+        std::this_thread::sleep_for(attempt * 100ms);
+    }
+}
+
+/// Same as ClearDataByChannel() without a time offset for each range
+bool ProgramData::DeletePrograms(
+    MSqlQuery &query, uint chanid,
+    const std::vector<std::pair<QDateTime,QDateTime> > &ranges)
+{
+    static const std::array<const char *,4> kTables
+        { "program", "programrating", "credits", "programgenres" };
+
+    for (size_t first = 0; first < ranges.size(); first += kMaxBatchRows)
+    {
+        size_t last = std::min(first + kMaxBatchRows, ranges.size());
+
+        QStringList where;
+        for (size_t i = first; i < last; ++i)
+        {
+            where << QString("(starttime >= :FROM_%1 AND starttime < :TO_%1)")
+                     .arg(i - first);
+        }
+
+        for (const auto *table : kTables)
+        {
+            query.prepare(QString("DELETE FROM %1 "
+                                  "WHERE chanid = :CHANID AND (%2)")
+                          .arg(QString(table), where.join(" OR ")));
+            query.bindValue(":CHANID", chanid);
+            for (size_t i = first; i < last; ++i)
+            {
+                QString suffix = QString("_%1").arg(i - first);
+                query.bindValue(":FROM" + suffix, ranges[i].first);
+                query.bindValue(":TO"   + suffix, ranges[i].second);
+            }
+            if (!query.exec())
+            {
+                MythDB::DBError("XMLTV batch delete", query);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Same as ProgInfo::InsertDB() for each of the programs,
+/// \return false if the programs could not be written.
+bool ProgramData::InsertPrograms(
+    MSqlQuery &query, uint chanid, const std::vector<const ProgInfo*> &progs)
+{
+    for (size_t first = 0; first < progs.size(); first += kMaxBatchRows)
+    {
+        size_t last = std::min(first + kMaxBatchRows, progs.size());
+
+        QStringList values;
+        for (size_t i = first; i < last; ++i)
+        {
+            const ProgInfo *pinfo = progs[i];
+            LOG(VB_XMLTV, LOG_DEBUG,
+                QString("Inserting new program    : %1 - %2 %3")
+                .arg(pinfo->m_starttime.toString(Qt::ISODate),
+                     pinfo->m_endtime.toString(Qt::ISODate),
+                     pinfo->m_channel));
+            values << insert_values(QString("_%1").arg(i - first), true);
+        }
+        query.prepare(QString("REPLACE INTO program (%1) VALUES %2")
+                      .arg(kXMLTVInsertColumns, values.join(",")));
+        for (size_t i = first; i < last; ++i)
+        {
+            QString suffix = QString("_%1").arg(i - first);
+            const ProgInfo *pinfo = progs[i];
+            bind_insert_values(query, suffix, chanid, *pinfo);
+            query.bindValue(":ENDTIME"   + suffix, denullify(pinfo->m_endtime));
+            query.bindValue(":TITLEPRON" + suffix, pinfo->m_title_pronounce);
+            query.bindValue(":SHOWTYPE"  + suffix, pinfo->m_showtype);
+            query.bindValue(":COLORCODE" + suffix, pinfo->m_colorcode);
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("XMLTV batch insert", query);
+            return false;
+        }
+
+        values.clear();
+        for (size_t i = first; i < last; ++i)
+        {
+            for (int j = 0; j < progs[i]->m_ratings.size(); ++j)
+            {
+                values << QString("(:CHANID_%1, :START_%1, :SYS_%1, :RATING_%1)")
+                          .arg(values.size());
+            }
+        }
+        if (!values.isEmpty())
+        {
+            query.prepare(
+                "INSERT IGNORE INTO programrating "
+                "       ( chanid, starttime, `system`, rating) "
+                "VALUES " + values.join(","));
+            int row = 0;
+            for (size_t i = first; i < last; ++i)
+            {
+                for (const auto & rating : qAsConst(progs[i]->m_ratings))
+                {
+                    QString suffix = QString("_%1").arg(row++);
+                    query.bindValue(":CHANID" + suffix, chanid);
+                    query.bindValue(":START"  + suffix, progs[i]->m_starttime);
+                    query.bindValue(":SYS"    + suffix, rating.m_system);
+                    query.bindValue(":RATING" + suffix, rating.m_rating);
+                }
+            }
+            if (!query.exec())
+            {
+                MythDB::DBError("programrating insert", query);
+                if (is_lock_conflict(query))
+                    return false;
+            }
+        }
 
-        updated += pinfo->InsertDB(query, chanid);
+        for (size_t i = first; i < last; ++i)
+        {
+            const ProgInfo *pinfo = progs[i];
+            if (pinfo->m_credits)
+            {
+                for (auto & credit : *pinfo->m_credits)
+                    credit.InsertDB(query, chanid, pinfo->m_starttime);
+            }
+            add_genres(query, pinfo->m_genres, chanid, pinfo->m_starttime);
+        }
     }
+    return true;
 }
 
 int ProgramData::fix_end_times(void)
@@ -1703,121 +2681,3 @@ int ProgramData::fix_end_times(void)
 
     return count;
 }
-
-bool ProgramData::IsUnchanged(
-    MSqlQuery &query, uint chanid, const ProgInfo &pi)
-{
-    query.prepare(
-        "SELECT count(*) "
-        "FROM program "
-        "WHERE chanid          = :CHANID     AND "
-        "      starttime       = :START      AND "
-        "      endtime         = :END        AND "
-        "      title           = :TITLE      AND "
-        "      subtitle        = :SUBTITLE   AND "
-        "      description     = :DESC       AND "
-        "      category        = :CATEGORY   AND "
-        "      category_type   = :CATEGORY_TYPE AND "
-        "      airdate         = :AIRDATE    AND "
-        "      stars >= (:STARS1 - 0.001)    AND "
-        "      stars <= (:STARS2 + 0.001)    AND "
-        "      previouslyshown = :PREVIOUSLYSHOWN AND "
-        "      title_pronounce = :TITLE_PRONOUNCE AND "
-        "      audioprop       = :AUDIOPROP  AND "
-        "      videoprop       = :VIDEOPROP  AND "
-        "      subtitletypes   = :SUBTYPES   AND "
-        "      partnumber      = :PARTNUMBER AND "
-        "      parttotal       = :PARTTOTAL  AND "
-        "      seriesid        = :SERIESID   AND "
-        "      showtype        = :SHOWTYPE   AND "
-        "      colorcode       = :COLORCODE  AND "
-        "      syndicatedepisodenumber = :SYNDICATEDEPISODENUMBER AND "
-        "      programid       = :PROGRAMID  AND "
-        "      season          = :SEASON     AND "
-        "      episode         = :EPISODE    AND "
-        "      totalepisodes   = :TOTALEPISODES AND "
-        "      inetref         = :INETREF");
-
-    QString cattype = myth_category_type_to_string(pi.m_categoryType);
-
-    query.bindValue(":CHANID",     chanid);
-    query.bindValue(":START",      pi.m_starttime);
-    query.bindValue(":END",        pi.m_endtime);
-    query.bindValue(":TITLE",      denullify(pi.m_title));
-    query.bindValue(":SUBTITLE",   denullify(pi.m_subtitle));
-    query.bindValue(":DESC",       denullify(pi.m_description));
-    query.bindValue(":CATEGORY",   denullify(pi.m_category));
-    query.bindValue(":CATEGORY_TYPE", cattype);
-    query.bindValue(":AIRDATE",    pi.m_airdate);
-    query.bindValue(":STARS1",     pi.m_stars);
-    query.bindValue(":STARS2",     pi.m_stars);
-    query.bindValue(":PREVIOUSLYSHOWN", pi.m_previouslyshown);
-    query.bindValue(":TITLE_PRONOUNCE", pi.m_title_pronounce);
-    query.bindValue(":AUDIOPROP",  pi.m_audioProps);
-    query.bindValue(":VIDEOPROP",  pi.m_videoProps);
-    query.bindValue(":SUBTYPES",   pi.m_subtitleType);
-    query.bindValue(":PARTNUMBER", pi.m_partnumber);
-    query.bindValue(":PARTTOTAL",  pi.m_parttotal);
-    query.bindValue(":SERIESID",   denullify(pi.m_seriesId));
-    query.bindValue(":SHOWTYPE",   pi.m_showtype);
-    query.bindValue(":COLORCODE",  pi.m_colorcode);
-    query.bindValue(":SYNDICATEDEPISODENUMBER",
-                    denullify(pi.m_syndicatedepisodenumber));
-    query.bindValue(":PROGRAMID",  denullify(pi.m_programId));
-    query.bindValue(":SEASON",     pi.m_season);
-    query.bindValue(":EPISODE",    pi.m_episode);
-    query.bindValue(":TOTALEPISODES", pi.m_totalepisodes);
-    query.bindValue(":INETREF",    pi.m_inetref);
-
-    if (query.exec() && query.next())
-        return query.value(0).toUInt() > 0;
-
-    return false;
-}
-
-bool ProgramData::DeleteOverlaps(
-    MSqlQuery &query, uint chanid, const ProgInfo &pi)
-{
-    if (VERBOSE_LEVEL_CHECK(VB_XMLTV, LOG_DEBUG))
-    {
-        // Get overlaps..
-        query.prepare(
-            "SELECT title,starttime,endtime "
-            "FROM program "
-            "WHERE chanid     = :CHANID AND "
-            "      starttime >= :START AND "
-            "      starttime <  :END;");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  pi.m_starttime);
-        query.bindValue(":END",    pi.m_endtime);
-
-        if (!query.exec())
-            return false;
-
-        if (!query.next())
-            return true;
-
-        do
-        {
-            LOG(VB_XMLTV, LOG_DEBUG,
-                QString("Removing existing program: %1 - %2 %3 %4")
-                .arg(MythDate::as_utc(query.value(1).toDateTime()).toString(Qt::ISODate),
-                     MythDate::as_utc(query.value(2).toDateTime()).toString(Qt::ISODate),
-                     pi.m_channel,
-                     query.value(0).toString()));
-        } while (query.next());
-    }
-
-    if (!ClearDataByChannel(chanid, pi.m_starttime, pi.m_endtime, false))
-    {
-        LOG(VB_XMLTV, LOG_ERR,
-            QString("Program delete failed    : %1 - %2 %3 %4")
-                .arg(pi.m_starttime.toString(Qt::ISODate),
-                     pi.m_endtime.toString(Qt::ISODate),
-                     pi.m_channel,
-                     pi.m_title));
-        return false;
-    }
-
-    return true;
-}
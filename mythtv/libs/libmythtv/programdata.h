@@ -3,6 +3,7 @@
 
 // C++ headers
 #include <cstdint>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -81,6 +82,7 @@ class MTV_PUBLIC EventRating
 
 class MTV_PUBLIC DBEvent
 {
+    friend class DBEventEITBatch;
   public:
     explicit DBEvent(uint listingsource) :
         m_listingsource(listingsource) {}
@@ -139,6 +141,7 @@ class MTV_PUBLIC DBEvent
         MSqlQuery &query, uint chanid, const DBEvent &match) const;
     bool MoveOutOfTheWayDB(
         MSqlQuery &query, uint chanid, const DBEvent &prog) const;
+    DBEvent Merge(const DBEvent &match) const;
     virtual uint InsertDB(MSqlQuery &query, uint chanid,
                           bool recording = false) const; // DBEvent
 
@@ -223,6 +226,63 @@ class MTV_PUBLIC DBEventEIT : public DBEvent
     QMultiMap<QString,QString> m_items;
 };
 
+/** \brief Writes a batch of EIT events to the program table.
+ *
+ *  The result is the same as calling DBEventEIT::UpdateDB() on every event
+ *  in the order they were added, but the programs the events of a channel
+ *  overlap with are read with a single query, the overlaps are resolved in
+ *  memory, and the changes are written in one transaction with the inserts
+ *  and deletes combined into multi-row statements.
+ */
+class MTV_PUBLIC DBEventEITBatch
+{
+  public:
+    explicit DBEventEITBatch(int match_threshold) :
+        m_matchThreshold(match_threshold) {}
+    ~DBEventEITBatch();
+    DBEventEITBatch(const DBEventEITBatch &) = delete;
+    DBEventEITBatch &operator=(const DBEventEITBatch &) = delete;
+
+    /// Adds an event to the batch, which takes ownership of it.
+    void Add(DBEventEIT *event);
+    bool IsEmpty(void) const { return m_events.empty(); }
+
+    /// Writes and then deletes all events that were added. If any
+    /// statement fails the transaction is rolled back and the events
+    /// are kept, so that UpdateDB() can be called again.
+    /// \param count Set to the number of programs inserted or updated
+    /// \return false if the batch could not be written.
+    bool UpdateDB(MSqlQuery &query, uint &count);
+
+  private:
+    struct Channel;
+    using ProgramKey = std::pair<uint,QDateTime>;
+
+    static bool LoadPrograms(MSqlQuery &query, Channel &chan,
+                             const std::vector<DBEventEIT*> &events);
+    uint UpdateEvent(MSqlQuery &query, Channel &chan, const DBEvent &event);
+    uint UpdateEvent(MSqlQuery &query, Channel &chan, const DBEvent &event,
+                     const std::vector<DBEvent> &p, int match);
+    uint UpdateMatch(MSqlQuery &query, Channel &chan, const DBEvent &event,
+                     const DBEvent &match);
+    bool MoveOutOfTheWay(MSqlQuery &query, Channel &chan,
+                         const DBEvent &event, const DBEvent &prog);
+    uint InsertProgram(MSqlQuery &query, Channel &chan, const DBEvent &event);
+    void DeleteProgram(MSqlQuery &query, Channel &chan,
+                       const QDateTime &starttime);
+    void Touch(MSqlQuery &query, uint chanid, const QDateTime &starttime);
+    void FlushInserts(MSqlQuery &query);
+    void FlushDeletes(MSqlQuery &query);
+
+    int                                       m_matchThreshold;
+    QMap<uint, std::vector<DBEventEIT*> >     m_events;
+    std::vector<std::pair<uint,const DBEvent*> > m_inserts;
+    std::set<ProgramKey>                      m_insertKeys;
+    std::vector<ProgramKey>                   m_deletes;
+    std::set<ProgramKey>                      m_deleteKeys;
+    bool                                      m_failed {false};
+};
+
 class MTV_PUBLIC ProgInfo : public DBEvent
 {
   public:
@@ -274,10 +334,12 @@ class MTV_PUBLIC ProgramData
         MSqlQuery &query, uint chanid,
         const QList<ProgInfo*> &sortlist,
         uint &unchanged, uint &updated);
-    static bool IsUnchanged(
-        MSqlQuery &query, uint chanid, const ProgInfo &pi);
-    static bool DeleteOverlaps(
-        MSqlQuery &query, uint chanid, const ProgInfo &pi);
+    static bool DeletePrograms(
+        MSqlQuery &query, uint chanid,
+        const std::vector<std::pair<QDateTime,QDateTime> > &ranges);
+    static bool InsertPrograms(
+        MSqlQuery &query, uint chanid,
+        const std::vector<const ProgInfo*> &progs);
 };
 
 #endif // PROGRAMDATA_H
@@ -18,6 +18,9 @@
 
 #define LOC QString("DevRdB(%1): ").arg(m_videoDevice)
 
+QMutex                   DeviceReadBuffer::s_instancesLock;
+QList<DeviceReadBuffer*> DeviceReadBuffer::s_instances;
+
 DeviceReadBuffer::DeviceReadBuffer(
     DeviceReaderCB *cb, bool use_poll, bool error_exit_on_poll_timeout)
     : MThread("DeviceReadBuffer"),
@@ -34,10 +37,17 @@ DeviceReadBuffer::DeviceReadBuffer(
         m_usingPoll = false;
     }
 #endif
+
+    QMutexLocker locker(&s_instancesLock);
+    s_instances.push_back(this);
 }
 
 DeviceReadBuffer::~DeviceReadBuffer()
 {
+    {
+        QMutexLocker locker(&s_instancesLock);
+        s_instances.removeAll(this);
+    }
     Stop();
     if (m_buffer)
     {
@@ -68,15 +78,19 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
     m_devBufferCount = deviceBufferCount;
     m_size          = gCoreContext->GetNumSetting(
         "HDRingbufferSize", static_cast<int>(50 * m_readQuanta)) * 1024_UZ;
-    m_used          = 0;
     m_devReadSize = m_readQuanta * (m_usingPoll ? 256 : 48);
     m_devReadSize = (deviceBufferSize) ?
         std::min(m_devReadSize, (size_t)deviceBufferSize) : m_devReadSize;
     m_readThreshold = m_readQuanta * 128;
 
-    m_buffer        = new (std::nothrow) unsigned char[m_size + m_devReadSize];
-    m_readPtr       = m_buffer;
-    m_writePtr      = m_buffer;
+    // The slack past m_endPtr takes device reads that run over the end
+    // of the ring, and lets ReadSpan() present a packet that wraps
+    // around as one contiguous piece.
+    size_t slack    = std::max(m_devReadSize, m_readQuanta);
+    m_buffer        = new (std::nothrow) unsigned char[m_size + slack];
+    m_writePos      = 0;
+    m_readPos       = 0;
+    m_resetPos      = 0;
 
     // Initialize buffer, if it exists
     if (!m_buffer)
@@ -84,18 +98,20 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
         m_endPtr = nullptr;
         LOG(VB_GENERAL, LOG_ERR, LOC +
             QString("Failed to allocate buffer of size %1 = %2 + %3")
-                .arg(m_size+m_devReadSize).arg(m_size).arg(m_devReadSize));
+                .arg(m_size+slack).arg(m_size).arg(slack));
         return false;
     }
     m_endPtr = m_buffer + m_size;
     memset(m_buffer, 0xFF, m_size + m_readQuanta);
 
     // Initialize statistics
-    m_maxUsed        = 0;
-    m_avgUsed        = 0;
-    m_avgBufWriteCnt = 0;
-    m_avgBufReadCnt  = 0;
-    m_avgBufSleepCnt = 0;
+    m_maxUsed         = 0;
+    m_deviceReads     = 0;
+    m_bufferReads     = 0;
+    m_fullCount       = 0;
+    m_driverOverflows = 0;
+    m_discarded       = 0;
+    m_lastReportStats = DeviceReadBufferStats();
     m_lastReport.start();
 
     LOG(VB_RECORD, LOG_INFO, LOC + QString("buffer size %1 KB").arg(m_size/1024));
@@ -139,9 +155,9 @@ void DeviceReadBuffer::Reset(const QString &streamName, int streamfd)
     m_videoDevice   = m_videoDevice.isNull() ? "" : m_videoDevice;
     m_streamFd      = streamfd;
 
-    m_used          = 0;
-    m_readPtr       = m_buffer;
-    m_writePtr      = m_buffer;
+    // Everything written so far is stale, the consumer skips over it
+    // the next time it looks at the ring.
+    m_resetPos      = m_writePos.load();
 
     m_error         = false;
 }
@@ -257,47 +273,78 @@ bool DeviceReadBuffer::IsRunning(void) const
     return isRunning();
 }
 
+/// Free space as seen by the device thread. This deliberately ignores
+/// m_resetPos, space before it is only reusable once the consumer has
+/// stopped looking at it.
 uint DeviceReadBuffer::GetUnused(void) const
 {
-    QMutexLocker locker(&m_lock);
-    return m_size - m_used;
+    return m_size - (m_writePos.load(std::memory_order_relaxed) -
+                     m_readPos.load(std::memory_order_acquire));
 }
 
 uint DeviceReadBuffer::GetUsed(void) const
 {
-    QMutexLocker locker(&m_lock);
-    return m_used;
+    uint64_t wpos = m_writePos.load(std::memory_order_acquire);
+    uint64_t rpos = std::max(m_readPos.load(std::memory_order_acquire),
+                             m_resetPos.load(std::memory_order_acquire));
+    return (wpos > rpos) ? wpos - rpos : 0;
 }
 
 uint DeviceReadBuffer::GetContiguousUnused(void) const
 {
-    QMutexLocker locker(&m_lock);
-    return m_endPtr - m_writePtr;
+    return m_size - (m_writePos.load(std::memory_order_relaxed) % m_size);
 }
 
+/// Called by the device thread to publish len newly read bytes.
 void DeviceReadBuffer::IncrWritePointer(uint len)
 {
-    QMutexLocker locker(&m_lock);
-    m_used     += len;
-    m_writePtr += len;
-    m_writePtr  = (m_writePtr >= m_endPtr) ? m_buffer + (m_writePtr - m_endPtr) : m_writePtr;
-#if REPORT_RING_STATS
-    m_maxUsed = std::max(m_used, m_maxUsed);
-    m_avgUsed = ((m_avgUsed * m_avgBufWriteCnt) + m_used) / (m_avgBufWriteCnt+1);
-    ++m_avgBufWriteCnt;
-#endif
-    m_dataWait.wakeAll();
+    uint64_t wpos = m_writePos.load(std::memory_order_relaxed) + len;
+    m_writePos.store(wpos);
+    m_deviceReads.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t used = wpos - m_readPos.load(std::memory_order_relaxed);
+    if (used > m_maxUsed.load(std::memory_order_relaxed))
+        m_maxUsed.store(used, std::memory_order_relaxed);
+
+    // Pairs with the m_readerWaiting store in WaitForUsed(); only take
+    // the lock when the consumer is actually asleep.
+    if (m_readerWaiting.load())
+    {
+        QMutexLocker locker(&m_lock);
+        m_dataWait.wakeAll();
+    }
 }
 
+/// Called by the consumer to give len bytes back to the device thread.
 void DeviceReadBuffer::IncrReadPointer(uint len)
 {
-    QMutexLocker locker(&m_lock);
-    m_used    -= len;
-    m_readPtr += len;
-    m_readPtr  = (m_readPtr == m_endPtr) ? m_buffer : m_readPtr;
-#if REPORT_RING_STATS
-    ++m_avgBufReadCnt;
-#endif
+    uint64_t rpos = m_readPos.load(std::memory_order_relaxed) + len;
+    m_readPos.store(rpos, std::memory_order_release);
+    m_bufferReads.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// Returns the consumer position, first skipping anything Reset()
+/// discarded. Only the consumer may call this.
+uint64_t DeviceReadBuffer::ReaderPos(void)
+{
+    uint64_t rpos  = m_readPos.load(std::memory_order_relaxed);
+    uint64_t reset = m_resetPos.load(std::memory_order_acquire);
+    if (reset > rpos)
+    {
+        m_discarded.fetch_add(reset - rpos, std::memory_order_relaxed);
+        rpos = reset;
+        m_readPos.store(rpos, std::memory_order_release);
+    }
+    return rpos;
+}
+
+/// Limits avail, as returned by WaitForUsed(), to what was written
+/// after rpos. Reset() may have moved the consumer on to data newer
+/// than WaitForUsed() looked at, which avail does not account for.
+uint DeviceReadBuffer::UsedFrom(uint64_t rpos, uint avail) const
+{
+    uint64_t wpos = m_writePos.load(std::memory_order_acquire);
+    return static_cast<uint>(std::min<uint64_t>(avail, wpos - rpos));
 }
 
 void DeviceReadBuffer::run(void)
@@ -349,18 +396,23 @@ void DeviceReadBuffer::run(void)
             auto unused = static_cast<size_t>(WaitForUnused(m_readQuanta));
             size_t read_size = std::min(m_devReadSize, unused);
 
+            if (unused < m_readQuanta)
+                m_fullCount.fetch_add(1, std::memory_order_relaxed);
+
             // if read_size > 0 do the read...
             if (read_size)
             {
-                read_len = read(m_streamFd, m_writePtr, read_size);
+                unsigned char *wptr = m_buffer +
+                    (m_writePos.load(std::memory_order_relaxed) % m_size);
+                read_len = read(m_streamFd, wptr, read_size);
                 if (!CheckForErrors(read_len, read_size, errcnt))
                     break;
                 errcnt = 0;
 
                 // if we wrote past the official end of the buffer,
                 // copy to start
-                if (m_writePtr + read_len > m_endPtr)
-                    memcpy(m_buffer, m_endPtr, m_writePtr + read_len - m_endPtr);
+                if (wptr + read_len > m_endPtr)
+                    memcpy(m_buffer, m_endPtr, wptr + read_len - m_endPtr);
                 IncrWritePointer(read_len);
                 total += read_len;
             }
@@ -569,6 +621,7 @@ bool DeviceReadBuffer::CheckForErrors(
         }
         if (EOVERFLOW == errno)
         {
+            m_driverOverflows.fetch_add(1, std::memory_order_relaxed);
             LOG(VB_GENERAL, LOG_ERR, LOC + "Driver buffers overflowed");
             return false;
         }
@@ -616,39 +669,82 @@ bool DeviceReadBuffer::CheckForErrors(
 uint DeviceReadBuffer::Read(unsigned char *buf, const uint count)
 {
     uint avail = WaitForUsed(std::min(count, (uint)m_readThreshold), 20ms);
-    size_t cnt = std::min(count, avail);
+    uint64_t rpos = ReaderPos();
+    size_t cnt = std::min(count, UsedFrom(rpos, avail));
 
     if (!cnt)
         return 0;
 
-    if (m_readPtr + cnt > m_endPtr)
+    size_t offset = rpos % m_size;
+    size_t len    = std::min(cnt, m_size - offset);
+
+    // Process as up to two pieces
+    memcpy(buf, m_buffer + offset, len);
+    if (cnt > len)
+        memcpy(buf + len, m_buffer, cnt - len);
+    IncrReadPointer(cnt);
+
+#if REPORT_RING_STATS
+    ReportStats();
+#endif
+
+    return cnt;
+}
+
+/** \fn DeviceReadBuffer::ReadSpan(uint&, uint)
+ *  \brief Returns buffered data in place, without copying it out.
+ *
+ *  The span is contiguous and holds a whole number of read quanta
+ *  (TS packets for most callers). A packet that wraps around the end
+ *  of the ring is returned on its own, reassembled in the slack area.
+ *  The data stays valid until ReleaseSpan() is called, which must
+ *  happen before the next Read() or ReadSpan().
+ *
+ *  \param len     Set to the length of the span, 0 if there is none
+ *  \param max_len Largest span the caller can accept
+ *  \return pointer to the span, or nullptr if no whole packet arrived
+ *          within 20ms
+ */
+const unsigned char *DeviceReadBuffer::ReadSpan(uint &len, uint max_len)
+{
+    len = 0;
+
+    uint avail = WaitForUsed(std::min(max_len, (uint)m_readThreshold), 20ms);
+    uint64_t rpos = ReaderPos();
+    avail = std::min(UsedFrom(rpos, avail), max_len);
+    avail -= avail % m_readQuanta;
+    if (!avail)
+        return nullptr;
+
+    size_t offset = rpos % m_size;
+    size_t contig = m_size - offset;
+
+    if (contig >= m_readQuanta)
     {
-        // Process as two pieces
-        size_t len = m_endPtr - m_readPtr;
-        if (len)
-        {
-            memcpy(buf, m_readPtr, len);
-            buf += len;
-            IncrReadPointer(len);
-        }
-        if (cnt > len)
-        {
-            len = cnt - len;
-            memcpy(buf, m_readPtr, len);
-            IncrReadPointer(len);
-        }
+        len = std::min(static_cast<size_t>(avail),
+                       contig - (contig % m_readQuanta));
     }
     else
     {
-        memcpy(buf, m_readPtr, cnt);
-        IncrReadPointer(cnt);
+        // The device thread has wrapped around to the start, so it is
+        // not touching the slack past m_endPtr.
+        memcpy(m_endPtr, m_buffer, m_readQuanta - contig);
+        len = m_readQuanta;
     }
 
 #if REPORT_RING_STATS
     ReportStats();
 #endif
 
-    return cnt;
+    return m_buffer + offset;
+}
+
+/// Hands the first len bytes of the last ReadSpan() back to the ring.
+/// len may be less than the span length, the rest is returned again.
+void DeviceReadBuffer::ReleaseSpan(uint len)
+{
+    if (len)
+        IncrReadPointer(len);
 }
 
 /** \fn DeviceReadBuffer::WaitForUnused(uint) const
@@ -676,28 +772,68 @@ uint DeviceReadBuffer::WaitForUnused(uint needed) const
     return unused;
 }
 
-/** \fn DeviceReadBuffer::WaitForUsed(uint,uint) const
+/** \fn DeviceReadBuffer::WaitForUsed(uint,uint)
  *  \param needed Number of bytes we want to read
  *  \param max_wait Number of milliseconds to wait for the needed data
  *  \return bytes available for reading
  */
-uint DeviceReadBuffer::WaitForUsed(uint needed, std::chrono::milliseconds max_wait) const
+uint DeviceReadBuffer::WaitForUsed(uint needed, std::chrono::milliseconds max_wait)
 {
+    ReaderPos();
+    size_t avail = GetUsed();
+    if (needed <= avail)
+        return avail;
+
     MythTimer timer;
     timer.start();
 
     QMutexLocker locker(&m_lock);
-    size_t avail = m_used;
+    m_readerWaiting = true;
+    avail = GetUsed();
     while ((needed > avail) && isRunning() &&
            !m_requestPause && !m_error && !m_eof &&
            (timer.elapsed() < max_wait))
     {
         m_dataWait.wait(locker.mutex(), 10);
-        avail = m_used;
+        avail = GetUsed();
     }
+    m_readerWaiting = false;
     return avail;
 }
 
+DeviceReadBufferStats DeviceReadBuffer::GetStats(void) const
+{
+    DeviceReadBufferStats stats;
+    {
+        QMutexLocker locker(&m_lock);
+        stats.m_device = m_videoDevice;
+    }
+    stats.m_size            = m_size;
+    stats.m_used            = GetUsed();
+    stats.m_maxUsed         = m_maxUsed.load(std::memory_order_relaxed);
+    stats.m_bytesIn         = m_writePos.load(std::memory_order_relaxed);
+    stats.m_bytesOut        = m_readPos.load(std::memory_order_relaxed);
+    stats.m_deviceReads     = m_deviceReads.load(std::memory_order_relaxed);
+    stats.m_bufferReads     = m_bufferReads.load(std::memory_order_relaxed);
+    stats.m_fullCount       = m_fullCount.load(std::memory_order_relaxed);
+    stats.m_driverOverflows = m_driverOverflows.load(std::memory_order_relaxed);
+    stats.m_discarded       = m_discarded.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/// Returns the statistics of every DeviceReadBuffer in this process.
+QList<DeviceReadBufferStats> DeviceReadBuffer::GetAllStats(void)
+{
+    QList<DeviceReadBufferStats> list;
+    QMutexLocker locker(&s_instancesLock);
+    for (const auto *drb : qAsConst(s_instances))
+    {
+        if (drb->m_buffer)
+            list.push_back(drb->GetStats());
+    }
+    return list;
+}
+
 void DeviceReadBuffer::ReportStats(void)
 {
 #if REPORT_RING_STATS
@@ -705,19 +841,21 @@ void DeviceReadBuffer::ReportStats(void)
     static constexpr double d1_s = 1.0 / secs.count();
     if (m_lastReport.elapsed() > duration_cast<std::chrono::milliseconds>(secs))
     {
-        QMutexLocker locker(&m_lock);
+        DeviceReadBufferStats now = GetStats();
+        const DeviceReadBufferStats &last = m_lastReportStats;
         double rsize = 100.0 / m_size;
-        QString msg  = QString("fill avg(%1%) ").arg(m_avgUsed*rsize,5,'f',2);
-        msg         += QString("fill max(%1%) ").arg(m_maxUsed*rsize,5,'f',2);
-        msg         += QString("writes/sec(%1) ").arg(m_avgBufWriteCnt*d1_s);
-        msg         += QString("reads/sec(%1) ").arg(m_avgBufReadCnt*d1_s);
-        msg         += QString("sleeps/sec(%1)").arg(m_avgBufSleepCnt*d1_s);
-
-        m_avgUsed        = 0;
-        m_avgBufWriteCnt = 0;
-        m_avgBufReadCnt  = 0;
-        m_avgBufSleepCnt = 0;
-        m_maxUsed        = 0;
+        QString msg  = QString("fill now(%1%) ").arg(now.m_used*rsize,5,'f',2);
+        msg         += QString("fill max(%1%) ").arg(now.m_maxUsed*rsize,5,'f',2);
+        msg         += QString("writes/sec(%1) ")
+            .arg((now.m_deviceReads - last.m_deviceReads)*d1_s);
+        msg         += QString("reads/sec(%1) ")
+            .arg((now.m_bufferReads - last.m_bufferReads)*d1_s);
+        msg         += QString("full/sec(%1) ")
+            .arg((now.m_fullCount - last.m_fullCount)*d1_s);
+        msg         += QString("overflows(%1)")
+            .arg(now.m_driverOverflows - last.m_driverOverflows);
+
+        m_lastReportStats = now;
         m_lastReport.start();
 
         LOG(VB_GENERAL, LOG_INFO, LOC + msg);
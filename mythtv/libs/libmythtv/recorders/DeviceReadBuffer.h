@@ -4,8 +4,11 @@
 #ifndef DEVICEREADBUFFER_H
 #define DEVICEREADBUFFER_H
 
+#include <atomic>
+#include <cstdint>
 #include <unistd.h>
 
+#include <QList>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QString>
@@ -14,6 +17,7 @@
 #include "libmythbase/mythbaseutil.h"
 #include "libmythbase/mythtimer.h"
 
+#include "libmythtv/mythtvexp.h"
 #include "mpeg/tspacket.h"
 
 class DeviceReaderCB
@@ -25,14 +29,37 @@ class DeviceReaderCB
     virtual void PriorityEvent(int fd) = 0;
 };
 
+/// Snapshot of the fill level and counters of one DeviceReadBuffer.
+struct DeviceReadBufferStats
+{
+    QString     m_device;
+    uint64_t    m_size           {0};
+    uint64_t    m_used           {0};
+    uint64_t    m_maxUsed        {0}; ///< High water mark since Setup()
+    uint64_t    m_bytesIn        {0}; ///< Bytes read from the device
+    uint64_t    m_bytesOut       {0}; ///< Bytes handed to the reader
+    uint64_t    m_deviceReads    {0}; ///< Successful read() calls
+    uint64_t    m_bufferReads    {0}; ///< Read()/ReadSpan() calls with data
+    uint64_t    m_fullCount      {0}; ///< Times the ring had no room
+    uint64_t    m_driverOverflows {0}; ///< EOVERFLOW from the driver
+    uint64_t    m_discarded      {0}; ///< Bytes dropped by Reset()
+};
+
 /** \class DeviceReadBuffer
  *  \brief Buffers reads from device files.
  *
  *  This allows us to read the device regularly even in the presence
  *  of long blocking conditions on writing to disk or accessing the
  *  database.
+ *
+ *  The ring has exactly one producer, the device reading thread, and
+ *  one consumer, the thread calling Read() or ReadSpan(). The read and
+ *  write positions are free running byte counters published with
+ *  atomics, so moving data through the ring never takes m_lock; the
+ *  lock only protects the pause/error/eof state and the wakeup of a
+ *  consumer that went to sleep waiting for data.
  */
-class DeviceReadBuffer : protected MThread
+class MTV_PUBLIC DeviceReadBuffer : protected MThread
 {
   public:
     explicit DeviceReadBuffer(DeviceReaderCB *cb,
@@ -60,8 +87,13 @@ class DeviceReadBuffer : protected MThread
     bool IsRunning(void) const;
 
     uint Read(unsigned char *buf, uint count);
+    const unsigned char *ReadSpan(uint &len, uint max_len);
+    void ReleaseSpan(uint len);
     uint GetUsed(void) const;
 
+    DeviceReadBufferStats GetStats(void) const;
+    static QList<DeviceReadBufferStats> GetAllStats(void);
+
   private:
     void run(void) override; // MThread
 
@@ -73,7 +105,9 @@ class DeviceReadBuffer : protected MThread
     bool Poll(void) const;
     void WakePoll(void) const;
     uint WaitForUnused(uint needed) const;
-    uint WaitForUsed  (uint needed, std::chrono::milliseconds max_wait) const;
+    uint WaitForUsed  (uint needed, std::chrono::milliseconds max_wait);
+    uint64_t ReaderPos(void);
+    uint UsedFrom(uint64_t rpos, uint avail) const;
 
     bool IsPauseRequested(void) const;
     bool IsOpen(void) const { return m_streamFd >= 0; }
@@ -103,28 +137,39 @@ class DeviceReadBuffer : protected MThread
     std::chrono::milliseconds m_maxPollWait         {2500ms};
 
     size_t                  m_size                  {0};
-    size_t                  m_used                  {0};
     size_t                  m_readQuanta            {0};
     size_t                  m_devBufferCount        {1};
     size_t                  m_devReadSize           {0};
     size_t                  m_readThreshold         {0};
     unsigned char          *m_buffer                {nullptr};
-    unsigned char          *m_readPtr               {nullptr};
-    unsigned char          *m_writePtr              {nullptr};
     unsigned char          *m_endPtr                {nullptr};
 
-    mutable QWaitCondition  m_dataWait;
+    // Free running positions; the offset into m_buffer is pos % m_size.
+    // m_writePos is only stored by the device thread and m_readPos only
+    // by the consumer. Reset() cannot move m_readPos itself, so it
+    // publishes m_resetPos and the consumer skips ahead to it.
+    std::atomic<uint64_t>   m_writePos              {0};
+    std::atomic<uint64_t>   m_readPos               {0};
+    std::atomic<uint64_t>   m_resetPos              {0};
+    std::atomic<bool>       m_readerWaiting         {false};
+
+    QWaitCondition          m_dataWait;
     QWaitCondition          m_runWait;
     QWaitCondition          m_pauseWait;
     QWaitCondition          m_unpauseWait;
 
-    // statistics
-    size_t                  m_maxUsed               {0};
-    size_t                  m_avgUsed               {0};
-    size_t                  m_avgBufWriteCnt        {0};
-    size_t                  m_avgBufReadCnt         {0};
-    size_t                  m_avgBufSleepCnt        {0};
+    // statistics, readable at any time through GetStats()
+    std::atomic<uint64_t>   m_maxUsed               {0};
+    std::atomic<uint64_t>   m_deviceReads           {0};
+    std::atomic<uint64_t>   m_bufferReads           {0};
+    std::atomic<uint64_t>   m_fullCount             {0};
+    std::atomic<uint64_t>   m_driverOverflows       {0};
+    std::atomic<uint64_t>   m_discarded             {0};
+    DeviceReadBufferStats   m_lastReportStats;
     MythTimer               m_lastReport;
+
+    static QMutex                    s_instancesLock;
+    static QList<DeviceReadBuffer*>  s_instances;
 };
 
 #endif // DEVICEREADBUFFER_H
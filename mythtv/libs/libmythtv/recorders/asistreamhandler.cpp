@@ -157,18 +157,6 @@ void ASIStreamHandler::run(void)
     }
 
     uint buffer_size = m_packetSize * 15000;
-    auto *buffer = new unsigned char[buffer_size];
-    if (!buffer)
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to allocate buffer");
-        delete drb;
-        drb = nullptr;
-        Close();
-        m_bError = true;
-        RunEpilog();
-        return;
-    }
-    memset(buffer, 0, buffer_size);
 
     SetRunning(true, true, false);
 
@@ -179,15 +167,13 @@ void ASIStreamHandler::run(void)
         m_drb = drb;
     }
 
-    int remainder = 0;
     while (m_runningDesired && !m_bError)
     {
         UpdateFiltersFromStreamData();
 
-        ssize_t len = 0;
-
-        len = drb->Read(
-            &(buffer[remainder]), buffer_size - remainder);
+        // Demux straight out of the ring buffer, no copy needed.
+        uint len = 0;
+        const unsigned char *span = drb->ReadSpan(len, buffer_size);
 
         if (!m_runningDesired)
             break;
@@ -205,36 +191,32 @@ void ASIStreamHandler::run(void)
             m_bError = true;
         }
 
-        len += remainder;
-
-        if (len < 10) // 10 bytes = 4 bytes TS header + 6 bytes PES header
-        {
-            remainder = len;
+        if (!len)
             continue;
-        }
 
+        // Leave the data in the ring and try again later
         if (!m_listenerLock.tryLock())
         {
-            remainder = len;
+            drb->ReleaseSpan(0);
             continue;
         }
 
         if (m_streamDataList.empty())
         {
             m_listenerLock.unlock();
+            drb->ReleaseSpan(len);
             continue;
         }
 
-        for (auto sit = m_streamDataList.cbegin();
-             sit != m_streamDataList.cend(); ++sit)
-            remainder = sit.key()->ProcessData(buffer, len);
+        int left = ProcessStreamData(span, len);
 
-        WriteMPTS(buffer, len - remainder);
+        WriteMPTS(span, len - left);
 
         m_listenerLock.unlock();
 
-        if (remainder > 0 && (len > remainder)) // leftover bytes
-            memmove(buffer, &(buffer[len - remainder]), remainder);
+        // Leave a trailing partial packet in the ring, so the next
+        // span starts on a packet boundary.
+        drb->ReleaseSpan((left > 0 && (uint)left < len) ? len - left : len);
     }
     LOG(VB_RECORD, LOG_INFO, LOC + "run(): " + "shutdown");
 
@@ -249,7 +231,6 @@ void ASIStreamHandler::run(void)
         drb->Stop();
 
     delete drb;
-    delete[] buffer;
     Close();
 
     LOG(VB_RECORD, LOG_INFO, LOC + "run(): " + "end");
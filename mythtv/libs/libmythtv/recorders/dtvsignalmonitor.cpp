@@ -461,7 +461,8 @@ void DTVSignalMonitor::HandleTVCT(
         }
         ATSCStreamData *atsc = GetATSCStreamData();
         if (atsc)
-            atsc->SetVersionTVCT(tvct->TransportStreamID(),-1);
+            atsc->SetVersionTVCT(PID::ATSC_PSIP_PID,
+                                 tvct->TransportStreamID(),-1);
         return;
     }
 
@@ -488,7 +489,8 @@ void DTVSignalMonitor::HandleCVCT(uint /*pid*/, const CableVirtualChannelTable*
         }
         ATSCStreamData *atsc = GetATSCStreamData();
         if (atsc)
-            atsc->SetVersionCVCT(cvct->TransportStreamID(),-1);
+            atsc->SetVersionCVCT(PID::ATSC_PSIP_PID,
+                                 cvct->TransportStreamID(),-1);
         return;
     }
 
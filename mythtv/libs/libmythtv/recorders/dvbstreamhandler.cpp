@@ -216,7 +216,9 @@ void DVBStreamHandler::RunTS(void)
 
         if (drb)
         {
-            len = drb->Read(&(buffer[remainder]), buffer_size - remainder);
+            // Demux straight out of the ring buffer, no copy needed.
+            uint span_len = 0;
+            const unsigned char *span = drb->ReadSpan(span_len, buffer_size);
 
             // Check for DRB errors
             if (drb->IsErrored())
@@ -230,27 +232,49 @@ void DVBStreamHandler::RunTS(void)
                 LOG(VB_GENERAL, LOG_ERR, LOC + "Device EOF detected");
                 m_bError = true;
             }
-        }
-        else
-        {
-            // timeout gets reset by select, so we need to create new one
-            struct timeval timeout = { 0, k50Milliseconds };
-            int ret = select(dvr_fd+1, &fd_select_set, nullptr, nullptr, &timeout);
-            if (ret == -1 && errno != EINTR)
-            {
-                LOG(VB_GENERAL, LOG_ERR, LOC + "select() failed" + ENO);
-            }
-            else
-            {
-                len = read(dvr_fd, &(buffer[remainder]),
-                           buffer_size - remainder);
-            }
 
-            if ((0 == len) || (-1 == len))
+            if (!span_len)
+                continue;
+
+            m_listenerLock.lock();
+
+            if (m_streamDataList.empty())
             {
-                std::this_thread::sleep_for(100us);
+                m_listenerLock.unlock();
+                drb->ReleaseSpan(span_len);
                 continue;
             }
+
+            int left = ProcessStreamData(span, span_len);
+
+            WriteMPTS(span, span_len - left);
+
+            m_listenerLock.unlock();
+
+            // Leave a trailing partial packet in the ring, so the next
+            // span starts on a packet boundary.
+            drb->ReleaseSpan((left > 0 && (uint)left < span_len) ?
+                             span_len - left : span_len);
+            continue;
+        }
+
+        // timeout gets reset by select, so we need to create new one
+        struct timeval timeout = { 0, k50Milliseconds };
+        int ret = select(dvr_fd+1, &fd_select_set, nullptr, nullptr, &timeout);
+        if (ret == -1 && errno != EINTR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "select() failed" + ENO);
+        }
+        else
+        {
+            len = read(dvr_fd, &(buffer[remainder]),
+                       buffer_size - remainder);
+        }
+
+        if ((0 == len) || (-1 == len))
+        {
+            std::this_thread::sleep_for(100us);
+            continue;
         }
 
         len += remainder;
@@ -269,8 +293,7 @@ void DVBStreamHandler::RunTS(void)
             continue;
         }
 
-        for (auto sit = m_streamDataList.cbegin(); sit != m_streamDataList.cend(); ++sit)
-            remainder = sit.key()->ProcessData(buffer, len);
+        remainder = ProcessStreamData(buffer, len);
 
         WriteMPTS(buffer, len - remainder);
 
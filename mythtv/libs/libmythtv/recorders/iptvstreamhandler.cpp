@@ -229,11 +229,22 @@ void IPTVStreamHandler::run(void)
                 "Unable to create socket " + ENO);
             continue;
         }
+        // A large receive buffer rides out the time the packets
+        // wait for the write helper and bursts of multicast traffic.
+        static constexpr int kMinRecvBufSize { 8 * 1024 * 1024 };
         int buf_size = 2 * 1024 * std::max(tuning.GetBitrate(i)/1000, 500U);
-        if (!tuning.GetBitrate(i))
-            buf_size = 2 * 1024 * 1024;
-        int err = setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
-                            (char *)&buf_size, sizeof(buf_size));
+        buf_size = std::max(buf_size, kMinRecvBufSize);
+        int err = -1;
+#ifdef __linux__
+        // Try beyond net.core.rmem_max first, this needs CAP_NET_ADMIN
+        err = setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE,
+                         (char *)&buf_size, sizeof(buf_size));
+#endif
+        if (err)
+        {
+            err = setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+                             (char *)&buf_size, sizeof(buf_size));
+        }
         if (err)
         {
             LOG(VB_GENERAL, LOG_INFO, LOC +
@@ -317,6 +328,13 @@ void IPTVStreamHandler::run(void)
             m_readHelpers[i] = nullptr;
         }
     }
+    auto *rtp_buffer = dynamic_cast<RTPPacketBuffer*>(m_buffer);
+    if (rtp_buffer)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC + QString("RTP packets recovered: %1 lost: %2")
+            .arg(rtp_buffer->GetRecoveredPacketCount())
+            .arg(rtp_buffer->GetLostPacketCount()));
+    }
     delete m_buffer;
     m_buffer = nullptr;
     delete m_writeHelper;
@@ -347,55 +365,128 @@ void IPTVStreamHandlerReadHelper::ReadPending(void)
 {
     QHostAddress sender;
     quint16 senderPort = 0;
-    bool sender_null = m_sender.isNull();
+
+    // Qt only re-enables the socket notifier once a datagram has been
+    // read through QUdpSocket, so read the first datagram with it and
+    // whatever else is queued in batches.
+    while (m_socket->hasPendingDatagrams())
+    {
+        UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
+        QByteArray &data = packet.GetDataReference();
+        data.resize(m_socket->pendingDatagramSize());
+        m_socket->readDatagram(data.data(), data.size(),
+                               &sender, &senderPort);
+        m_maxDatagramSize =
+            std::max(m_maxDatagramSize, static_cast<int>(data.size()));
+        PushPacket(packet, sender);
+
+#ifdef __linux__
+        ReadBatches();
+#endif
+    }
+}
+
+void IPTVStreamHandlerReadHelper::PushPacket(
+    const UDPPacket &packet, const QHostAddress &sender)
+{
+    if (!m_sender.isNull() && sender != m_sender)
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC_WH +
+            QString("Received on socket(%1) %2 bytes from non expected "
+                    "sender:%3 (expected:%4) ignoring")
+            .arg(m_stream).arg(packet.GetData().size())
+            .arg(sender.toString(), m_sender.toString()));
+        m_parent->m_buffer->FreePacket(packet);
+        return;
+    }
 
     if (0 == m_stream)
+        m_parent->m_buffer->PushDataPacket(packet);
+    else
+        m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
+}
+
+#ifdef __linux__
+/** \brief Reads the queued datagrams, up to kBatchSize per system call.
+ *
+ *  The datagrams are read straight into packets from the buffer's pool,
+ *  sized for the largest datagram seen so far. A larger datagram is
+ *  dropped, but the next ones will fit.
+ */
+void IPTVStreamHandlerReadHelper::ReadBatches(void)
+{
+    int fd = static_cast<int>(m_socket->socketDescriptor());
+    bool check_sender = !m_sender.isNull();
+
+    while (true)
     {
-        while (m_socket->hasPendingDatagrams())
+        for (size_t i = 0; i < kBatchSize; i++)
         {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
-            {
-                m_parent->m_buffer->PushDataPacket(packet);
-            }
-            else
+            m_batch[i] = m_parent->m_buffer->GetEmptyPacket();
+            QByteArray &data = m_batch[i].GetDataReference();
+            data.resize(m_maxDatagramSize);
+            m_iovecs[i].iov_base = data.data();
+            m_iovecs[i].iov_len  = static_cast<size_t>(data.size());
+
+            msghdr &hdr = m_messages[i].msg_hdr;
+            hdr = {};
+            hdr.msg_iov    = &m_iovecs[i];
+            hdr.msg_iovlen = 1;
+            if (check_sender)
             {
-                LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString(), m_sender.toString()));
+                hdr.msg_name    = &m_addresses[i];
+                hdr.msg_namelen = sizeof(m_addresses[i]);
             }
         }
-    }
-    else
-    {
-        while (m_socket->hasPendingDatagrams())
+
+        // MSG_TRUNC makes msg_len the full size of a truncated datagram
+        int count = recvmmsg(fd, m_messages.data(), kBatchSize,
+                             MSG_DONTWAIT | MSG_TRUNC, nullptr);
+        if (count < 0)
         {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                LOG(VB_RECORD, LOG_ERR, LOC_WH + "recvmmsg failed " + ENO);
+            count = 0;
+        }
+
+        for (size_t i = 0; i < kBatchSize; i++)
+        {
+            if (i >= static_cast<size_t>(count))
             {
-                m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
+                m_parent->m_buffer->FreePacket(m_batch[i]);
+                continue;
             }
-            else
+
+            int size = static_cast<int>(m_messages[i].msg_len);
+            if (m_messages[i].msg_hdr.msg_flags & MSG_TRUNC)
             {
                 LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString(), m_sender.toString()));
+                    QString("Dropped %1 byte datagram on socket(%2), "
+                            "receiving up to %1 bytes from now on")
+                    .arg(size).arg(m_stream));
+                m_maxDatagramSize = std::max(m_maxDatagramSize, size);
+                m_parent->m_buffer->FreePacket(m_batch[i]);
+                continue;
+            }
+
+            m_batch[i].GetDataReference().resize(size);
+            QHostAddress sender;
+            if (check_sender)
+            {
+                sender.setAddress(
+                    reinterpret_cast<const sockaddr*>(&m_addresses[i]));
             }
+            PushPacket(m_batch[i], sender);
         }
+
+        // Drop the references so the packets can be reused in place
+        m_batch.fill(UDPPacket());
+
+        if (count < static_cast<int>(kBatchSize))
+            break;
     }
 }
+#endif
 
 IPTVStreamHandlerWriteHelper::~IPTVStreamHandlerWriteHelper()
 {
@@ -434,13 +525,9 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
         {
             QMutexLocker locker(&m_parent->m_listenerLock);
             QByteArray &data = packet.GetDataReference();
-            for (auto sit = m_parent->m_streamDataList.cbegin();
-                 sit != m_parent->m_streamDataList.cend(); ++sit)
-            {
-                remainder = sit.key()->ProcessData(
-                    reinterpret_cast<const unsigned char*>(data.data()),
-                    data.size());
-            }
+            remainder = m_parent->ProcessStreamData(
+                reinterpret_cast<const unsigned char*>(data.data()),
+                data.size());
         }
 
         if (remainder != 0)
@@ -492,13 +579,8 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
 
             m_parent->m_listenerLock.lock();
 
-            int remainder = 0;
-            for (auto sit = m_parent->m_streamDataList.cbegin();
-                 sit != m_parent->m_streamDataList.cend(); ++sit)
-            {
-                remainder = sit.key()->ProcessData(
-                    ts_packet.GetTSData(), ts_packet.GetTSDataSize());
-            }
+            int remainder = m_parent->ProcessStreamData(
+                ts_packet.GetTSData(), ts_packet.GetTSDataSize());
 
             m_parent->m_listenerLock.unlock();
 
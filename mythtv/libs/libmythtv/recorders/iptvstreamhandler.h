@@ -3,8 +3,14 @@
 #ifndef IPTVSTREAMHANDLER_H
 #define IPTVSTREAMHANDLER_H
 
+#include <array>
 #include <vector>
 
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
 #include <QHostAddress>
 #include <QUdpSocket>
 #include <QString>
@@ -16,6 +22,7 @@
 
 #include "channelutil.h"
 #include "streamhandler.h"
+#include "rtp/udppacket.h"
 
 static constexpr size_t IPTV_SOCKET_COUNT   { 3 };
 static constexpr std::chrono::milliseconds RTCP_TIMER { 10s };
@@ -37,10 +44,26 @@ class IPTVStreamHandlerReadHelper : public QObject
     void ReadPending(void);
 
   private:
+    void PushPacket(const UDPPacket &packet, const QHostAddress &sender);
+#ifdef __linux__
+    void ReadBatches(void);
+
+    /// Most datagrams read with one recvmmsg() call
+    static constexpr size_t kBatchSize { 64 };
+#endif
+
     IPTVStreamHandler *m_parent {nullptr};
     QUdpSocket        *m_socket {nullptr};
     QHostAddress       m_sender;
     uint               m_stream;
+    /// Largest datagram seen so far, sizes the packets handed to recvmmsg()
+    int                m_maxDatagramSize {1500};
+#ifdef __linux__
+    std::array<UDPPacket,kBatchSize>        m_batch;
+    std::array<mmsghdr,kBatchSize>          m_messages {};
+    std::array<iovec,kBatchSize>            m_iovecs {};
+    std::array<sockaddr_storage,kBatchSize> m_addresses {};
+#endif
 };
 
 class IPTVStreamHandlerWriteHelper : QObject
@@ -14,6 +14,17 @@ PacketBuffer::PacketBuffer(unsigned int bitrate) :
     m_bitrate(bitrate),
     m_next_empty_packet_key(static_cast<uint64_t>(MythRandom()) << 32)
 {
+    // Allocate enough packets up front for the reordering window plus
+    // what a 40 Mbit/s stream delivers between two runs of the stream
+    // handler's write timer, so receiving does not allocate memory.
+    static constexpr size_t kPreallocatedPackets { 2048 };
+    m_empty_packets.reserve(kPreallocatedPackets);
+    while (m_empty_packets.size() < kPreallocatedPackets)
+    {
+        UDPPacket packet(m_next_empty_packet_key++);
+        packet.GetDataReference().reserve(kPacketCapacity);
+        m_empty_packets.push_back(packet);
+    }
 }
 
 bool PacketBuffer::HasAvailablePacket(void) const
@@ -34,14 +45,11 @@ UDPPacket PacketBuffer::PopDataPacket(void)
 
 UDPPacket PacketBuffer::GetEmptyPacket(void)
 {
-    QMap<uint64_t, UDPPacket>::iterator it = m_empty_packets.begin();
-    if (it == m_empty_packets.end())
-    {
+    if (m_empty_packets.empty())
         return UDPPacket(m_next_empty_packet_key++);
-    }
 
-    UDPPacket packet(*it);
-    m_empty_packets.erase(it);
+    UDPPacket packet(m_empty_packets.back());
+    m_empty_packets.pop_back();
 
     return packet;
 }
@@ -51,5 +59,5 @@ void PacketBuffer::FreePacket(const UDPPacket &packet)
     static constexpr uint64_t k_mask_upper_32 = ~((UINT64_C(1) << (64 - 32)) - 1);
     uint64_t top = packet.GetKey() & k_mask_upper_32;
     if (top == (m_next_empty_packet_key & k_mask_upper_32))
-        m_empty_packets[packet.GetKey()] = packet;
+        m_empty_packets.push_back(packet);
 }
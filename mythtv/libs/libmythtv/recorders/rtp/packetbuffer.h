@@ -7,8 +7,8 @@
 #ifndef PACKET_BUFFER_H
 #define PACKET_BUFFER_H
 
-#include <QList>
-#include <QMap>
+#include <deque>
+#include <vector>
 
 #include "udppacket.h"
 
@@ -40,6 +40,9 @@ class PacketBuffer
      */
     void FreePacket(const UDPPacket &packet);
 
+    /// Most data a preallocated packet holds without reallocating
+    static constexpr int kPacketCapacity { 2048 };
+
   protected:
     uint m_bitrate;
 
@@ -48,11 +51,11 @@ class PacketBuffer
     */
     uint64_t m_next_empty_packet_key;
     
-    /// Packets ready for reuse
-    QMap<uint64_t, UDPPacket> m_empty_packets;
+    /// Packets ready for reuse, the most recently freed last
+    std::vector<UDPPacket> m_empty_packets;
 
     /// Ordered list of available packets
-    QList<UDPPacket> m_available_packets;
+    std::deque<UDPPacket> m_available_packets;
 };
 
 #endif // PACKET_BUFFER_H
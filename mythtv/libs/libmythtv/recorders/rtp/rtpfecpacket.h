@@ -3,21 +3,79 @@
  * Distributed as part of MythTV under GPL v2 and later.
  */
 
-#include "udppacket.h"
+#include "rtpdatapacket.h"
 
 #ifndef RTP_FEC_PACKET_H
 #define RTP_FEC_PACKET_H
 
 /** \brief RTP FEC Packet
+ *
+ *  SMPTE 2022-1 Forward Error Correction packet. The RTP header is
+ *  followed by a 16 byte FEC header and then the XOR of the payloads
+ *  of the media packets it protects. Those are the GetNA() packets
+ *  starting at sequence number GetSNBase(), GetOffset() sequence
+ *  numbers apart; an offset of 1 protects a row of the FEC matrix
+ *  and an offset of L a column.
  */
-class RTPFECPacket : public UDPPacket
+class RTPFECPacket : public RTPDataPacket
 {
   public:
-    explicit RTPFECPacket(const UDPPacket &o) : UDPPacket(o) { }
-    explicit RTPFECPacket(uint64_t key) : UDPPacket(key) { }
-    RTPFECPacket(void) : UDPPacket(0ULL) { }
+    explicit RTPFECPacket(const UDPPacket &o) : RTPDataPacket(o) { }
+    explicit RTPFECPacket(uint64_t key) : RTPDataPacket(key) { }
+    RTPFECPacket(void) : RTPDataPacket(0ULL) { }
 
-    // TODO
+    static constexpr uint kFECHeaderSize { 16 };
+
+    bool IsValid(void) const override // RTPDataPacket
+    {
+        if (!RTPDataPacket::IsValid())
+            return false;
+
+        // FEC uses a dynamic payload type, this also keeps out the
+        // RTCP packets that share the second socket with RTSP.
+        if (GetPayloadType() < 96)
+            return false;
+
+        if (m_off + kFECHeaderSize > static_cast<uint>(m_data.size()))
+            return false;
+
+        return (GetOffset() > 0) && (GetNA() > 0);
+    }
+
+    uint GetSNBase(void) const
+    {
+        return qFromBigEndian(*reinterpret_cast<const uint16_t*>(m_data.data()+m_off));
+    }
+
+    uint GetLengthRecovery(void) const
+    {
+        return qFromBigEndian(*reinterpret_cast<const uint16_t*>(m_data.data()+m_off+2));
+    }
+
+    uint GetPTRecovery(void) const { return m_data[m_off+4] & 0x7f; }
+
+    uint GetTimeStampRecovery(void) const
+    {
+        return qFromBigEndian(*reinterpret_cast<const uint32_t*>(m_data.data()+m_off+8));
+    }
+
+    /// True for row FEC (D = 1), false for column FEC (D = 0)
+    bool IsRowFEC(void) const { return (m_data[m_off+12] >> 6) & 0x1; }
+
+    uint GetOffset(void) const { return static_cast<uint8_t>(m_data[m_off+13]); }
+
+    uint GetNA(void) const { return static_cast<uint8_t>(m_data[m_off+14]); }
+
+    const unsigned char *GetFECData(void) const
+    {
+        return reinterpret_cast<const unsigned char*>(m_data.data()) +
+            m_off + kFECHeaderSize;
+    }
+
+    uint GetFECDataSize(void) const
+    {
+        return m_data.size() - m_off - kFECHeaderSize;
+    }
 };
 
 #endif // RTP_FEC_PACKET_H
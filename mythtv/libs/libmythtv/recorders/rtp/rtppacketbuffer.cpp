@@ -5,60 +5,83 @@
  */
 
 #include <algorithm>
+#include <cstring>
+
+#include <QtEndian>
+
+#include "libmythbase/mythlogging.h"
 
 #include "rtppacketbuffer.h"
 #include "rtpdatapacket.h"
 #include "rtpfecpacket.h"
 
+/// Size of the RTP header that precedes the data protected by FEC
+static constexpr int kRTPHeaderSize { 12 };
+/// Most FEC packets waiting for the packets they protect
+static constexpr int kMaxFECPackets { 256 };
+
 void RTPPacketBuffer::PushDataPacket(const UDPPacket &udp_packet)
 {
     RTPDataPacket packet(udp_packet);
 
-    uint key = packet.GetSequenceNumber();
+    uint64_t key = ExtendSequenceNumber(packet.GetSequenceNumber());
 
-    bool large_was_seen_recently = m_largeSequenceNumberSeenRecently > 0;
-    m_largeSequenceNumberSeenRecently = 
-        (key > (1U<<15)) ? 500 : m_largeSequenceNumberSeenRecently - 1;
-    m_largeSequenceNumberSeenRecently =
-        std::max(m_largeSequenceNumberSeenRecently, 0);
-
-    if (m_largeSequenceNumberSeenRecently > 0)
+    if (!m_started || (key + kRingSize < m_nextKey))
     {
-        if (key < 500) 
-            key += 1ULL<<16;
+        // First packet, or the sender restarted the stream. Keys start
+        // in the second round of sequence numbers, so that a packet
+        // from before a wrap can be extended backwards and is dropped
+        // as late rather than mistaken for one far ahead.
+        while (m_packetCount > 0)
+            ReleasePacket();
+        key           = (UINT64_C(1) << 16) | (key & 0xFFFF);
+        m_nextKey     = key;
+        m_lastDataKey = key;
+        m_started     = true;
     }
-    else if (large_was_seen_recently)
+    else if (key < m_nextKey)
     {
-        m_currentSequence += 1ULL<<16;
+        // Too late, the packets that follow it have been passed on
+        FreePacket(packet);
+        return;
     }
 
-    key += m_currentSequence;
+    m_lastDataKey = std::max(m_lastDataKey, key);
 
 /*
-    LOG(VB_RECORD, LOG_DEBUG, QString("Pushing %1 as %2 (lr %3)")
-        .arg(packet.GetSequenceNumber()).arg(key)
-        .arg(m_largeSequenceNumberSeenRecently));
+    LOG(VB_RECORD, LOG_DEBUG, QString("Pushing %1 as %2")
+        .arg(packet.GetSequenceNumber()).arg(key));
 */
 
-    m_unorderedPackets[key] = packet;
+    // Make room in the ring for this packet
+    while (key >= m_nextKey + kRingSize)
+    {
+        if (m_packetCount == 0)
+        {
+            uint64_t gap = key - kRingSize + 1 - m_nextKey;
+            if (gap < (1ULL<<15))
+                m_lostPackets += gap;
+            m_nextKey += gap;
+            break;
+        }
+        ReleasePacket();
+    }
+
+    StorePacket(key, packet);
 
     // TODO pushing packets onto the ordered list should be based on
     // the bitrate and the M+N of the FEC.. but for now...
+    // The low water mark must be above the L*D <= 100 packets a
+    // SMPTE 2022-1 FEC matrix spans for recovery to work.
     const int kHighWaterMark = 500;
     const int kLowWaterMark  = 100;
-    if (m_unorderedPackets.size() > kHighWaterMark)
+    if (m_packetCount > kHighWaterMark)
     {
-        while (m_unorderedPackets.size() > kLowWaterMark)
-        {
-            QMap<uint64_t, RTPDataPacket>::iterator it =
-                m_unorderedPackets.begin();
-/*
-            LOG(VB_RECORD, LOG_DEBUG, QString("Popping %1 as %2")
-                .arg((*it).GetSequenceNumber()).arg(it.key()));
-*/
-            m_available_packets.push_back(*it);
-            m_unorderedPackets.erase(it);
-        }
+        // Last chance to rebuild the lost packets we are about to pass
+        RecoverPackets();
+
+        while (m_packetCount > kLowWaterMark)
+            ReleasePacket();
     }
 }
 
@@ -66,7 +89,207 @@ void RTPPacketBuffer::PushFECPacket(
     const UDPPacket &packet,
     [[maybe_unused]] uint fec_stream_num)
 {
-    // TODO IMPLEMENT
-    // for now just free the packet for immediate reuse
-    FreePacket(packet);
+    // Row and column FEC are told apart by the FEC header,
+    // so both streams are handled alike.
+    RTPFECPacket fec(packet);
+    if (!fec.IsValid() || (fec.GetFECDataSize() == 0))
+    {
+        FreePacket(packet);
+        return;
+    }
+
+    m_fecPackets.push_back(fec);
+    while (m_fecPackets.size() > kMaxFECPackets)
+    {
+        FreePacket(m_fecPackets.front());
+        m_fecPackets.pop_front();
+    }
+
+    RecoverPackets();
+}
+
+/// Returns the key of the data packet with this RTP sequence number
+/// that is closest to the newest data packet. Once a data packet has
+/// been seen the keys are at least 1<<16, so this never has to clamp.
+uint64_t RTPPacketBuffer::ExtendSequenceNumber(uint sequence) const
+{
+    uint64_t key = (m_lastDataKey & ~UINT64_C(0xFFFF)) | (sequence & 0xFFFF);
+    if ((key > m_lastDataKey) && (key - m_lastDataKey > (1U<<15)) &&
+        (key >= (1U<<16)))
+    {
+        key -= 1U<<16;
+    }
+    else if ((key < m_lastDataKey) && (m_lastDataKey - key > (1U<<15)))
+    {
+        key += 1U<<16;
+    }
+    return key;
+}
+
+/// Returns the data packet with this key if it is waiting in the ring
+const RTPDataPacket *RTPPacketBuffer::FindPacket(uint64_t key) const
+{
+    if (!m_started || (key < m_nextKey) || (key >= m_nextKey + kRingSize))
+        return nullptr;
+    const Slot &slot = m_ring[key & (kRingSize - 1)];
+    return slot.m_used ? &slot.m_packet : nullptr;
+}
+
+/// Puts a data packet in its slot in the ring, the key must be in the
+/// window of kRingSize keys starting at m_nextKey.
+void RTPPacketBuffer::StorePacket(uint64_t key, const RTPDataPacket &packet)
+{
+    Slot &slot = m_ring[key & (kRingSize - 1)];
+    if (slot.m_used)
+        FreePacket(slot.m_packet); // duplicate
+    else
+        m_packetCount++;
+    slot.m_packet = packet;
+    slot.m_used   = true;
+}
+
+/// Passes on the packet with the lowest key, or counts it as lost
+void RTPPacketBuffer::ReleasePacket(void)
+{
+    Slot &slot = m_ring[m_nextKey & (kRingSize - 1)];
+    if (slot.m_used)
+    {
+/*
+        LOG(VB_RECORD, LOG_DEBUG, QString("Popping %1 as %2")
+            .arg(slot.m_packet.GetSequenceNumber()).arg(m_nextKey));
+*/
+        m_available_packets.push_back(slot.m_packet);
+        // Drop the ring's reference so the packet can be reused in place
+        slot.m_packet = RTPDataPacket();
+        slot.m_used   = false;
+        m_packetCount--;
+    }
+    else
+    {
+        m_lostPackets++;
+    }
+    m_nextKey++;
+}
+
+/** \brief Rebuilds lost data packets from the FEC packets.
+ *
+ *  A FEC packet can rebuild one lost packet of the ones it protects.
+ *  Rebuilding a packet with a column FEC packet may give a row FEC
+ *  packet that only has one lost packet left, so keep going until
+ *  nothing changes. FEC packets are kept until all the packets they
+ *  protect have been seen, or until those have been passed on.
+ */
+void RTPPacketBuffer::RecoverPackets(void)
+{
+    bool recovered = true;
+    while (recovered)
+    {
+        recovered = false;
+        auto it = m_fecPackets.begin();
+        while (it != m_fecPackets.end())
+        {
+            const RTPFECPacket &fec = *it;
+            uint     step  = fec.GetOffset();
+            uint     count = fec.GetNA();
+            uint64_t first = ExtendSequenceNumber(fec.GetSNBase());
+            uint64_t last  = first + (static_cast<uint64_t>(step) * (count - 1));
+
+            // Too late once the first packet has been passed on, and
+            // too early while the last one may just be out of order.
+            bool done = m_started && (first < m_nextKey);
+            if (!done && (last < m_lastDataKey))
+            {
+                uint     missing     = 0;
+                uint64_t missing_key = 0;
+                for (uint i = 0; (i < count) && (missing < 2); i++)
+                {
+                    uint64_t key = first + (static_cast<uint64_t>(step) * i);
+                    if (FindPacket(key) == nullptr)
+                    {
+                        missing++;
+                        missing_key = key;
+                    }
+                }
+
+                if (missing == 1)
+                    recovered |= RecoverPacket(fec, missing_key);
+                done = (missing < 2);
+            }
+
+            if (done)
+            {
+                FreePacket(*it);
+                it = m_fecPackets.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+}
+
+/// Rebuilds the data packet "key", the only one protected by "fec"
+/// that is missing.
+bool RTPPacketBuffer::RecoverPacket(const RTPFECPacket &fec, uint64_t key)
+{
+    uint64_t first        = ExtendSequenceNumber(fec.GetSNBase());
+    uint     length       = fec.GetLengthRecovery();
+    uint     payload_type = fec.GetPTRecovery();
+    uint     timestamp    = fec.GetTimeStampRecovery();
+    QByteArray payload(reinterpret_cast<const char*>(fec.GetFECData()),
+                       fec.GetFECDataSize());
+    QByteArray model;
+
+    for (uint i = 0; i < fec.GetNA(); i++)
+    {
+        const RTPDataPacket *protected_packet =
+            FindPacket(first + (static_cast<uint64_t>(fec.GetOffset()) * i));
+        if (protected_packet == nullptr)
+            continue;
+
+        QByteArray data = protected_packet->GetData();
+        if (data.size() < kRTPHeaderSize)
+            return false;
+
+        int size = data.size() - kRTPHeaderSize;
+        length       ^= size;
+        payload_type ^= data[1] & 0x7f;
+        timestamp    ^= qFromBigEndian<uint32_t>(data.constData() + 4);
+
+        char       *dst = payload.data();
+        const char *src = data.constData() + kRTPHeaderSize;
+        int n = std::min(size, static_cast<int>(payload.size()));
+        for (int j = 0; j < n; j++)
+            dst[j] ^= src[j];
+
+        model = data;
+    }
+
+    if (model.isEmpty() || (static_cast<int>(length) > payload.size()))
+    {
+        LOG(VB_RECORD, LOG_DEBUG,
+            QString("Could not recover packet %1").arg(key & 0xFFFF));
+        return false;
+    }
+
+    // SMPTE 2022-1 does not protect the version, padding, extension,
+    // CSRC count, marker and SSRC fields, they are the same for all
+    // packets of a stream so take them from one of the others.
+    UDPPacket packet(GetEmptyPacket());
+    QByteArray &data = packet.GetDataReference();
+    data.resize(kRTPHeaderSize + length);
+    memcpy(data.data(), model.constData(), kRTPHeaderSize);
+    data[1] = static_cast<char>((model[1] & 0x80) | (payload_type & 0x7f));
+    qToBigEndian<uint16_t>(key & 0xFFFF, data.data() + 2);
+    qToBigEndian<uint32_t>(timestamp, data.data() + 4);
+    memcpy(data.data() + kRTPHeaderSize, payload.constData(), length);
+
+    StorePacket(key, RTPDataPacket(packet));
+    m_recoveredPackets++;
+
+    LOG(VB_RECORD, LOG_DEBUG, QString("Recovered packet %1 with %2 FEC")
+        .arg(key & 0xFFFF).arg(fec.IsRowFEC() ? "row" : "column"));
+
+    return true;
 }
@@ -7,16 +7,19 @@
 #ifndef RTP_PACKET_BUFFER_H
 #define RTP_PACKET_BUFFER_H
 
-#include <QMap>
+#include <vector>
+
+#include <QList>
 
 #include "rtpdatapacket.h"
+#include "rtpfecpacket.h"
 #include "packetbuffer.h"
 
 class RTPPacketBuffer : public PacketBuffer
 {
   public:
     explicit RTPPacketBuffer(unsigned int bitrate) :
-        PacketBuffer(bitrate) {}
+        PacketBuffer(bitrate), m_ring(kRingSize) {}
 
     /// Adds RFC 3550 RTP data packet
     void PushDataPacket(const UDPPacket &udp_packet) override; // PacketBuffer
@@ -24,12 +27,44 @@ class RTPPacketBuffer : public PacketBuffer
     /// Adds SMPTE 2022 Forward Error Correction Stream packet
     void PushFECPacket(const UDPPacket &packet, unsigned int fec_stream_num) override; // PacketBuffer
 
+    /// Number of lost data packets rebuilt from FEC packets
+    uint64_t GetRecoveredPacketCount(void) const { return m_recoveredPackets; }
+
+    /// Number of data packets that were lost and could not be rebuilt
+    uint64_t GetLostPacketCount(void) const { return m_lostPackets; }
+
+    /// Number of sequence numbers the reordering ring spans, a power of 2
+    static constexpr uint64_t kRingSize { 4096 };
+
   private:
-    int      m_largeSequenceNumberSeenRecently { 0   };
-    uint64_t m_currentSequence                 { 0LL };
+    struct Slot
+    {
+        RTPDataPacket m_packet;
+        bool          m_used { false };
+    };
+
+    uint64_t ExtendSequenceNumber(uint sequence) const;
+    const RTPDataPacket *FindPacket(uint64_t key) const;
+    void StorePacket(uint64_t key, const RTPDataPacket &packet);
+    void ReleasePacket(void);
+    void RecoverPackets(void);
+    bool RecoverPacket(const RTPFECPacket &fec, uint64_t key);
+
+    /// Key of the newest data packet, the sequence number extended to 64 bits,
+    /// counted from 1<<16 so that it can be extended backwards
+    uint64_t m_lastDataKey                     { 0LL };
+    /// Key of the next packet to pass on, the start of the ring's window
+    uint64_t m_nextKey                         { 0LL };
+    bool     m_started                         { false };
+    int      m_packetCount                     { 0 };
+    uint64_t m_recoveredPackets                { 0LL };
+    uint64_t m_lostPackets                     { 0LL };
+
+    /// Packets waiting to be passed on in order, at m_ring[key % kRingSize]
+    std::vector<Slot> m_ring;
 
-    /// The key is the RTP sequence number + sequence if applicable
-    QMap<uint64_t, RTPDataPacket> m_unorderedPackets;
+    /// FEC packets that may still be needed to rebuild a lost packet
+    QList<RTPFECPacket> m_fecPackets;
 };
 
 #endif // RTP_PACKET_BUFFER_H
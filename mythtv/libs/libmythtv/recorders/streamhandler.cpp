@@ -7,6 +7,7 @@
 #include "streamhandler.h"
 
 #include "libmythbase/threadedfilewriter.h"
+#include "mpeg/mpegtables.h"
 
 #ifndef O_LARGEFILE
 #define O_LARGEFILE 0
@@ -68,6 +69,7 @@ void StreamHandler::AddListener(MPEGStreamData *data,
     }
 
     m_streamDataList[data] = output_file;
+    m_demux.SetListeners(m_streamDataList.keys());
 
     m_listenerLock.unlock();
 
@@ -103,6 +105,7 @@ void StreamHandler::RemoveListener(MPEGStreamData *data)
         if (!(*it).isEmpty())
             RemoveNamedOutputFile(*it);
         m_streamDataList.erase(it);
+        m_demux.SetListeners(m_streamDataList.keys());
     }
 
     m_listenerLock.unlock();
@@ -352,6 +355,11 @@ PIDPriority StreamHandler::GetPIDPriority(uint pid) const
     return tmp;
 }
 
+int StreamHandler::ProcessStreamData(const unsigned char *buffer, int len)
+{
+    return m_demux.Demux(buffer, len);
+}
+
 void StreamHandler::WriteMPTS(const unsigned char * buffer, uint len)
 {
     if (m_mptsTfw == nullptr)
@@ -418,3 +426,101 @@ void StreamHandler::RemoveNamedOutputFile([[maybe_unused]] const QString &file)
     }
 #endif //  !defined( USING_MINGW ) && !defined( _MSC_VER )
 }
+
+void StreamDemuxer::SetListeners(const QList<MPEGStreamData*> &listeners)
+{
+    m_listeners.assign(listeners.cbegin(), listeners.cend());
+    m_tableListeners.reserve(m_listeners.size());
+}
+
+/** \fn StreamDemuxer::Demux(const unsigned char*,int)
+ *  \brief Processes a buffer of TS data on behalf of all listeners.
+ *
+ *   With a single listener, or if any listener needs the raw data
+ *   (program stream listeners), the buffer is simply passed to each
+ *   listener's ProcessData() as before.
+ *
+ *  \return number of unprocessed bytes at the end of the buffer.
+ */
+int StreamDemuxer::Demux(const unsigned char *buffer, int len)
+{
+    bool legacy = m_listeners.size() <= 1;
+    bool crcbug = false;
+    for (auto *sd : m_listeners)
+    {
+        legacy |= sd->HasPSListeners();
+        crcbug |= sd->HasCRCBug();
+    }
+
+    if (legacy)
+    {
+        m_useLegacyPath = true;
+        int remainder = 0;
+        for (auto *sd : m_listeners)
+            remainder = sd->ProcessData(buffer, len);
+        return remainder;
+    }
+
+    if (m_useLegacyPath)
+    {
+        // Partial sections assembled in an earlier shared pass may be
+        // stale after running on the per-listener path for a while.
+        LOG(VB_RECORD, LOG_INFO, QString("SH[%1]: ").arg(m_cardId) +
+            QString("Using shared demux for %1 listeners")
+                .arg(m_listeners.size()));
+        Reset();
+        m_useLegacyPath = false;
+    }
+
+    SetIgnoreCRC(crcbug);
+    return ProcessData(buffer, len);
+}
+
+bool StreamDemuxer::ProcessTSPacket(const TSPacket& tspacket)
+{
+    const uint pid = tspacket.PID();
+    bool ok = !tspacket.TransportError() && HasValidAdaptationField(tspacket);
+    bool tables = ok && tspacket.HasPayload() && !tspacket.Scrambled();
+
+    m_tableListeners.clear();
+    for (auto *sd : m_listeners)
+    {
+        if (!sd->WantsTSPacket(pid))
+            continue;
+        if (tables && sd->IsTableOnlyPID(pid))
+            m_tableListeners.push_back(sd);
+        else
+            sd->ProcessTSPacket(tspacket);
+    }
+
+    if (m_tableListeners.empty())
+        return ok;
+
+    // Skip a section every listener has already found redundant, as
+    // each of them would in HandleTSTables(), but only when no section
+    // of ours is waiting for the start of this packet.
+    uint table_id = 0;
+    bool repeated = !GetPartialPSIP(pid);
+    for (auto *sd : m_tableListeners)
+        repeated = repeated && sd->IsRepeatedSection(tspacket, table_id);
+    if (repeated)
+    {
+        for (auto *sd : m_tableListeners)
+            sd->HandleRedundantTable(pid, table_id);
+        return ok;
+    }
+
+    bool morePSIPTables = false;
+    do
+    {
+        PSIPTable *psip = AssemblePSIP(&tspacket, morePSIPTables);
+        if (!psip)
+            break;
+
+        for (auto *sd : m_tableListeners)
+            sd->HandleAssembledTable(pid, *psip, false);
+        delete psip;
+    } while (morePSIPTables);
+
+    return ok;
+}
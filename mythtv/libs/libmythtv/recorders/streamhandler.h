@@ -50,6 +50,33 @@ class PIDInfo
 // iterator returning these in order of ascending pid number.
 using PIDInfoMap = QMap<uint,PIDInfo*>;
 
+/** \brief Shared demultiplexer used when several MPEGStreamData
+ *         listeners are attached to one StreamHandler.
+ *
+ *  Each buffer is synchronized and each TS packet validated once.
+ *  PSIP sections on PIDs that a listener only uses for tables are
+ *  assembled and CRC checked once, and each listener then only sees
+ *  the packets and sections for the PIDs it is interested in.
+ */
+class StreamDemuxer : public MPEGStreamData
+{
+  public:
+    explicit StreamDemuxer(int inputid) : MPEGStreamData(-1, inputid, false) {}
+    ~StreamDemuxer() override = default;
+
+    void SetListeners(const QList<MPEGStreamData*> &listeners);
+    int  Demux(const unsigned char *buffer, int len);
+
+    bool ProcessTSPacket(const TSPacket& tspacket) override; // MPEGStreamData
+    bool HandleTables(uint /* pid */, const PSIPTable & /* psip */) override // MPEGStreamData
+        { return true; }
+
+  private:
+    std::vector<MPEGStreamData*> m_listeners;
+    std::vector<MPEGStreamData*> m_tableListeners;
+    bool                         m_useLegacyPath {true};
+};
+
 // locking order
 // _pid_lock -> _listener_lock
 // _add_rm_lock -> _listener_lock
@@ -102,6 +129,9 @@ class StreamHandler : protected MThread, public DeviceReaderCB
         { return new PIDInfo(pid, stream_type, pes_type); }
 
   protected:
+    /// Pass a buffer of TS data to every listener, returns remainder.
+    /// \note: The _listener_lock must be held when this is called.
+    int ProcessStreamData(const unsigned char *buffer, int len);
     /// Write out a copy of the raw MPTS
     void WriteMPTS(const unsigned char * buffer, uint len);
     /// At minimum this sets _running_desired, this may also send
@@ -153,6 +183,7 @@ class StreamHandler : protected MThread, public DeviceReaderCB
     mutable QRecursiveMutex m_listenerLock;
 #endif
     StreamDataList      m_streamDataList;
+    StreamDemuxer       m_demux                 {m_inputId};
 };
 
 #endif // STREAM_HANDLER_H
@@ -0,0 +1,150 @@
+/*
+ *  Class BenchEITFixups
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+// Times EITFixUp::Fix() on a chunk of events, the way EITHelper hands
+// them over, for some of the busier fixups.  The events are made from
+// a handful of typical titles and descriptions.  Building and deleting
+// them is part of every iteration, bench_fix with kFixNone shows how
+// much of the time that is.
+//
+//   ./bench_eitfixups -iterations 20
+//   ./bench_eitfixups bench_fixBatch:UK
+
+#include <array>
+
+#include "libmythbase/programinfo.h"
+#include "libmythtv/eitfixup.h"
+
+#include "bench_eitfixups.h"
+
+// Same as EITHelper::kChunkSize
+static constexpr size_t kEvents { 200 };
+
+struct BenchEvent
+{
+    const char *m_title;
+    const char *m_description;
+};
+
+static const std::array<const BenchEvent,8> kBenchEvents
+{{
+    { "Book of the Week",
+      "Girl in the Dark: Anna Lyndsey's account of finding light in the "
+      "darkness after illness changed her life. 3/5. A Descent into "
+      "Darkness: The disquieting persistence of the light." },
+    { "Hoarders",
+      "Fascinating series chronicling the lives of serial hoarders. Often "
+      "facing loss of their children, career, or divorce, can people with "
+      "this disorder be helped? S3, Ep1" },
+    { "New: Inspector Montalbano",
+      "Brand New Series. The inspector investigates the murder of a young "
+      "woman (2019) [AD,S] Also in HD." },
+    { "Journaal",
+      "Met: Jan Jansen, Piet de Vries en Klaas Bakker e.a. Afl.: De terugkeer. "
+      "Nieuws uit binnen- en buitenland. txt (Stereo)" },
+    { "Goede tijden, slechte tijden (RTL)",
+      "Presentatie: Linda de Mol. Serie/soap. Een nieuwe dag in Meerdijk "
+      "breedbeeld herh." },
+    { "Tatort",
+      "Kriminalfilm, Deutschland 2020. Die Kommissare ermitteln in einem "
+      "neuen Fall. Regie: Max Mustermann" },
+    { "News at Ten",
+      "The latest national and international news, followed by weather." },
+    { "Film: The Third Man",
+      "Classic thriller starring Joseph Cotten and Orson Welles. (1949)" },
+}};
+
+std::vector<DBEventEIT*> BenchEITFixups::makeEvents(FixupValue fixup)
+{
+    QDateTime start = QDateTime::fromString("2022-10-17T06:00:00Z", Qt::ISODate);
+
+    std::vector<DBEventEIT*> events;
+    events.reserve(kEvents);
+    for (size_t i = 0; i < kEvents; ++i)
+    {
+        const BenchEvent &sample = kBenchEvents[i % kBenchEvents.size()];
+        events.push_back(new DBEventEIT(
+            1000 + (i % 20), sample.m_title, sample.m_description,
+            start.addSecs(1800 * i), start.addSecs(1800 * (i + 1)),
+            fixup, SUB_UNKNOWN, AUD_UNKNOWN, VID_UNKNOWN));
+    }
+    return events;
+}
+
+void BenchEITFixups::deleteEvents(std::vector<DBEventEIT*> &events)
+{
+    for (auto *event : events)
+        delete event;
+    events.clear();
+}
+
+// kFixGenericDVB is left out, it looks up the channel's default
+// authority in the database.
+static void add_fixup_rows(void)
+{
+    QTest::addColumn<FixupValue>("fixup");
+
+    QTest::newRow("None")    << FixupValue(EITFixUp::kFixNone);
+    QTest::newRow("UK")      << FixupValue(EITFixUp::kFixUK);
+    QTest::newRow("NL")      << FixupValue(EITFixUp::kFixNL);
+    QTest::newRow("RTL")     << FixupValue(EITFixUp::kFixRTL);
+    QTest::newRow("DK")      << FixupValue(EITFixUp::kFixDK);
+    QTest::newRow("P7S1")    << FixupValue(EITFixUp::kFixP7S1);
+    QTest::newRow("GreekEIT")
+        << FixupValue(EITFixUp::kFixGreekSubtitle | EITFixUp::kFixGreekEIT |
+                      EITFixUp::kFixGreekCategories);
+}
+
+void BenchEITFixups::bench_fix_data(void)
+{
+    add_fixup_rows();
+}
+
+// One event after the other, as EITHelper used to do it.
+void BenchEITFixups::bench_fix(void)
+{
+    QFETCH(FixupValue, fixup);
+
+    QBENCHMARK
+    {
+        std::vector<DBEventEIT*> events = makeEvents(fixup);
+        for (auto *event : events)
+            EITFixUp::Fix(*event);
+        deleteEvents(events);
+    }
+}
+
+void BenchEITFixups::bench_fixBatch_data(void)
+{
+    add_fixup_rows();
+}
+
+// The whole chunk at once, shared out between the pool threads.
+void BenchEITFixups::bench_fixBatch(void)
+{
+    QFETCH(FixupValue, fixup);
+
+    QBENCHMARK
+    {
+        std::vector<DBEventEIT*> events = makeEvents(fixup);
+        EITFixUp::Fix(events);
+        deleteEvents(events);
+    }
+}
+
+QTEST_APPLESS_MAIN(BenchEITFixups)
@@ -0,0 +1,39 @@
+/*
+ *  Class BenchEITFixups
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include "libmythtv/eithelper.h" /* for FixupValue */
+#include "libmythtv/programdata.h"
+
+class BenchEITFixups : public QObject
+{
+    Q_OBJECT
+
+    static std::vector<DBEventEIT*> makeEvents(FixupValue fixup);
+    static void deleteEvents(std::vector<DBEventEIT*> &events);
+
+  private slots:
+    // Test cases
+    static void bench_fix_data(void);
+    static void bench_fix(void);
+    static void bench_fixBatch_data(void);
+    static void bench_fixBatch(void);
+};
@@ -4,6 +4,9 @@ TEMPLATE = subdirs
 
 SUBDIRS += $$files(test_*)
 
+# Benchmarks are built with the tests, but only run by hand.
+SUBDIRS += $$files(bench_*)
+
 unittest.target = test
 unittest.commands = ../../../programs/scripts/unittests.sh
 unix:QMAKE_EXTRA_TARGETS += unittest
@@ -18,8 +18,10 @@
  *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <array>
 #include <cstdio>
 #include <iostream>
+#include <vector>
 
 #include "test_eitfixups.h"
 
@@ -924,6 +926,63 @@ void TestEITFixups::test64BitEnum(void)
     QVERIFY(1<<31 & 1ULL<<32);
 }
 
+// A batch is fixed up on the thread pool, check that it gives the
+// same results as fixing up one event after the other.
+void TestEITFixups::testBatchFix(void)
+{
+    static const std::array<const std::pair<const char*,const char*>,3> kSamples
+    {{
+        { "Book of the Week",
+          "Girl in the Dark: Anna Lyndsey's account of finding light in the "
+          "darkness after illness changed her life. 3/5. A Descent into "
+          "Darkness: The disquieting persistence of the light." },
+        { "New: Inspector Montalbano",
+          "Brand New Series. The inspector investigates the murder of a "
+          "young woman (2019) [AD,S] Also in HD." },
+        { "Hoarders",
+          "Fascinating series chronicling the lives of serial hoarders. "
+          "S3, Ep1 (Stereo)" },
+    }};
+
+    QDateTime start = QDateTime::fromString("2015-03-05T00:30:00Z", Qt::ISODate);
+    std::vector<DBEventEIT*> batch;
+    for (uint i = 0; i < 100; ++i)
+    {
+        const auto & [title, description] = kSamples[i % kSamples.size()];
+        batch.push_back(new DBEventEIT(11381, title, description,
+                                       start.addSecs(1800LL * i),
+                                       start.addSecs(1800LL * (i + 1)),
+                                       EITFixUp::kFixUK, SUB_UNKNOWN,
+                                       AUD_UNKNOWN, VID_UNKNOWN));
+    }
+
+    EITFixUp::Fix(batch);
+
+    for (uint i = 0; i < batch.size(); ++i)
+    {
+        const auto & [title, description] = kSamples[i % kSamples.size()];
+        DBEventEIT event(11381, title, description,
+                         start.addSecs(1800LL * i),
+                         start.addSecs(1800LL * (i + 1)),
+                         EITFixUp::kFixUK, SUB_UNKNOWN,
+                         AUD_UNKNOWN, VID_UNKNOWN);
+        EITFixUp::Fix(event);
+
+        QCOMPARE(batch[i]->m_title,         event.m_title);
+        QCOMPARE(batch[i]->m_subtitle,      event.m_subtitle);
+        QCOMPARE(batch[i]->m_description,   event.m_description);
+        QCOMPARE(batch[i]->m_season,        event.m_season);
+        QCOMPARE(batch[i]->m_episode,       event.m_episode);
+        QCOMPARE(batch[i]->m_totalepisodes, event.m_totalepisodes);
+        QCOMPARE(batch[i]->m_audioProps,    event.m_audioProps);
+        QCOMPARE(batch[i]->m_subtitleType,  event.m_subtitleType);
+        QCOMPARE(batch[i]->m_airdate,       event.m_airdate);
+    }
+
+    for (auto *event : batch)
+        delete event;
+}
+
 void TestEITFixups::testDvbEitAuthority_data()
 {
     QTest::addColumn<quint32>("chanid");
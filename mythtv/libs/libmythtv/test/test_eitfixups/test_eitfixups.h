@@ -65,6 +65,7 @@ class TestEITFixups : public QObject
     static void testDeDisneyChannel(void);
     static void testATV(void);
     static void test64BitEnum(void);
+    static void testBatchFix(void);
     static void testDvbEitAuthority_data();
     static void testDvbEitAuthority();
     static void testGenericTitle_data(void);
@@ -23,6 +23,8 @@
 #include "libmythtv/iptvtuningdata.h"
 #include "libmythtv/channelscan/iptvchannelfetcher.h"
 #include "libmythtv/recorders/rtp/rtpdatapacket.h"
+#include "libmythtv/recorders/rtp/rtpfecpacket.h"
+#include "libmythtv/recorders/rtp/rtppacketbuffer.h"
 #include "libmythtv/recorders/rtp/rtptsdatapacket.h"
 
 class TestIPTVRecorder: public QObject
@@ -486,4 +488,161 @@ class TestIPTVRecorder: public QObject
         QCOMPARE (ts_packet2.GetTSData()[0], (uint8_t)0x47);
         QCOMPARE (ts_packet2.GetTSDataSize(), (unsigned int)7 * 188);
     }
+
+    /**
+     * Test rebuilding a lost RTP packet with SMPTE 2022-1 row FEC
+     */
+    static void RecoverRTPFEC(void)
+    {
+        auto make_data = [](uint seq, int ts_count)
+        {
+            QByteArray data(12 + (ts_count * 188), '\0');
+            data[0] = 0x80;
+            data[1] = RTPDataPacket::kPayLoadTypeTS;
+            qToBigEndian<uint16_t>(seq, data.data() + 2);
+            qToBigEndian<uint32_t>(seq * 3003, data.data() + 4);
+            qToBigEndian<uint32_t>(0x12345678, data.data() + 8);
+            for (int i = 12; i < data.size(); i++)
+                data[i] = static_cast<char>((seq * 7) + i);
+            return data;
+        };
+
+        /* row of five packets starting at 10 with a short packet 12 */
+        QList<QByteArray> row;
+        for (uint seq = 10; seq < 15; seq++)
+            row.push_back(make_data(seq, (seq == 12) ? 3 : 7));
+
+        QByteArray fec(12 + RTPFECPacket::kFECHeaderSize + (7 * 188), '\0');
+        fec[0] = 0x80;
+        fec[1] = 96;
+        uint length = 0;
+        uint timestamp = 0;
+        char *payload = fec.data() + 12 + RTPFECPacket::kFECHeaderSize;
+        for (const auto & data : qAsConst(row))
+        {
+            length ^= data.size() - 12;
+            timestamp ^= qFromBigEndian<uint32_t>(data.constData() + 4);
+            for (int i = 12; i < data.size(); i++)
+                payload[i - 12] ^= data[i];
+        }
+        qToBigEndian<uint16_t>(10, fec.data() + 12);
+        qToBigEndian<uint16_t>(length, fec.data() + 14);
+        // E bit and the XOR of five identical payload types
+        fec[16] = static_cast<char>(0x80 | RTPDataPacket::kPayLoadTypeTS);
+        qToBigEndian<uint32_t>(timestamp, fec.data() + 20);
+        fec[24] = 0x40; // D = 1, row FEC
+        fec[25] = 1;    // offset
+        fec[26] = 5;    // NA
+
+        RTPFECPacket fec_packet;
+        fec_packet.GetDataReference() = fec;
+        QVERIFY (fec_packet.IsValid());
+        QVERIFY (fec_packet.IsRowFEC());
+        QCOMPARE (fec_packet.GetSNBase(), 10U);
+        QCOMPARE (fec_packet.GetOffset(), 1U);
+        QCOMPARE (fec_packet.GetNA(), 5U);
+
+        /* lose packet 12 and send the FEC packet a little late */
+        RTPPacketBuffer buffer(0);
+        const uint kPackets = 600;
+        for (uint seq = 0; seq < kPackets; seq++)
+        {
+            if (seq == 20)
+                buffer.PushFECPacket(fec_packet, 0);
+            if (seq == 12)
+                continue;
+            UDPPacket packet;
+            packet.GetDataReference() = make_data(seq, (seq == 12) ? 3 : 7);
+            buffer.PushDataPacket(packet);
+        }
+
+        QCOMPARE (buffer.GetRecoveredPacketCount(), (uint64_t)1);
+        QCOMPARE (buffer.GetLostPacketCount(), (uint64_t)0);
+
+        uint expected = 0;
+        while (buffer.HasAvailablePacket())
+        {
+            RTPDataPacket packet(buffer.PopDataPacket());
+            QVERIFY (packet.IsValid());
+            QCOMPARE (packet.GetSequenceNumber(), expected);
+            if (expected == 12)
+                QCOMPARE (packet.GetData(), row[2]);
+            expected++;
+        }
+        QVERIFY (expected > 12);
+    }
+
+    /**
+     * Test reordering RTP packets across a sequence number wrap
+     */
+    static void ReorderRTP(void)
+    {
+        RTPPacketBuffer buffer(0);
+        const uint kFirst = 65000;
+        const uint kPackets = 1200;
+        for (uint i = 0; i < kPackets; i++)
+        {
+            /* swap every pair of packets */
+            uint seq = (kFirst + ((i % 2) ? i - 1 : i + 1)) & 0xFFFF;
+            UDPPacket packet(buffer.GetEmptyPacket());
+            QByteArray &data = packet.GetDataReference();
+            data = QByteArray(12 + 188, '\0');
+            data[0] = 0x80;
+            data[1] = RTPDataPacket::kPayLoadTypeTS;
+            qToBigEndian<uint16_t>(seq, data.data() + 2);
+            buffer.PushDataPacket(packet);
+        }
+
+        /* the first packet sets the start of the window, so its
+         * predecessor arrives too late */
+        uint expected = kFirst + 1;
+        while (buffer.HasAvailablePacket())
+        {
+            RTPDataPacket packet(buffer.PopDataPacket());
+            QVERIFY (packet.IsValid());
+            QCOMPARE (packet.GetSequenceNumber(), expected & 0xFFFF);
+            expected++;
+        }
+        QVERIFY (expected > kFirst + 1000);
+        QCOMPARE (buffer.GetLostPacketCount(), (uint64_t)0);
+    }
+
+    /**
+     * Test a packet from before the first sequence number wrap that
+     * arrives after the wrap, shortly after the stream started
+     */
+    static void LateRTPBeforeWrap(void)
+    {
+        RTPPacketBuffer buffer(0);
+        auto push = [&buffer](uint seq)
+        {
+            UDPPacket packet(buffer.GetEmptyPacket());
+            QByteArray &data = packet.GetDataReference();
+            data = QByteArray(12 + 188, '\0');
+            data[0] = 0x80;
+            data[1] = RTPDataPacket::kPayLoadTypeTS;
+            qToBigEndian<uint16_t>(seq, data.data() + 2);
+            buffer.PushDataPacket(packet);
+        };
+
+        const uint kPackets = 1200;
+        for (uint seq = 5; seq < kPackets; seq++)
+        {
+            push(seq);
+            if (seq == 10)
+                push(65534);
+        }
+
+        /* the late packet is dropped, not taken for one far ahead */
+        uint expected = 5;
+        while (buffer.HasAvailablePacket())
+        {
+            RTPDataPacket packet(buffer.PopDataPacket());
+            QVERIFY (packet.IsValid());
+            QCOMPARE (packet.GetSequenceNumber(), expected);
+            expected++;
+        }
+        QVERIFY (expected > 1000);
+        QCOMPARE (buffer.GetLostPacketCount(), (uint64_t)0);
+    }
 };
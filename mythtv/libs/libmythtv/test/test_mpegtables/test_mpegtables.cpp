@@ -20,12 +20,20 @@
 
 #include "test_mpegtables.h"
 
+#include <thread>
+#include <vector>
+
 #include <iconv.h>
 
+#include "libmythbase/mythconfig.h"
 #include "libmythtv/mpeg/atsc_huffman.h"
 #include "libmythtv/mpeg/atsctables.h"
 #include "libmythtv/mpeg/dvbtables.h"
+#include "libmythtv/mpeg/mpegcrc.h"
+#include "libmythtv/mpeg/mpegstreamdata.h"
 #include "libmythtv/mpeg/mpegtables.h"
+#include "libmythtv/mpeg/streamlisteners.h"
+#include "libmythtv/mpeg/tspacket.h"
 
 extern "C" {
 #include "libavutil/crc.h"
@@ -2297,6 +2305,266 @@ void TestMPEGTables::clone_test(void)
     QVERIFY (!si_table.IsClone());
 }
 
+static uint32_t av_mpeg_crc32(const unsigned char *data, size_t size)
+{
+    return av_bswap32(av_crc(av_crc_get_table(AV_CRC_32_IEEE), UINT32_MAX,
+                             data, size));
+}
+
+void TestMPEGTables::crc_test(void)
+{
+    // 16 bytes of slack so that every alignment can be tested
+    std::vector<unsigned char> data(4096 + 16);
+    uint32_t seed = 0x12345678;
+    for (auto & byte : data)
+    {
+        seed = (seed * 1103515245) + 12345;
+        byte = seed >> 24;
+    }
+
+    for (size_t align = 0; align < 16; align++)
+    {
+        for (size_t size = 0; size <= 4096; size++)
+        {
+            const unsigned char *p = data.data() + align;
+            uint32_t expected = av_mpeg_crc32(p, size);
+            if (mpeg_crc32_sw(p, size) != expected ||
+                mpeg_crc32_hw(p, size) != expected ||
+                mpeg_crc32(p, size) != expected)
+            {
+                QFAIL(qPrintable(QString("CRC mismatch, size %1, alignment %2")
+                                 .arg(size).arg(align)));
+            }
+        }
+    }
+
+    // A CRC can be continued, and covering the CRC itself yields 0.
+    const unsigned char *p = data.data();
+    QCOMPARE (mpeg_crc32_hw(p + 1000, 3000, mpeg_crc32_sw(p, 1000)),
+              av_mpeg_crc32(p, 4000));
+    std::array<unsigned char,8> section { 0x70, 0x70, 0x05, 0xe5, 0x3a, 0x00, 0x00, 0x00 };
+    uint32_t crc = mpeg_crc32(section.data(), 4);
+    for (size_t i = 0; i < 4; i++)
+        section[4 + i] = crc >> (24 - (8 * i));
+    QCOMPARE (mpeg_crc32(section.data(), section.size()), 0U);
+}
+
+void TestMPEGTables::crc_benchmark_data(void)
+{
+    QTest::addColumn<bool>("useHW");
+    QTest::addColumn<int>("size");
+    for (int size : { 184, 1024, 4096 })
+    {
+        QTest::newRow(qPrintable(QString("libavutil %1").arg(size)))
+            << false << size;
+        QTest::newRow(qPrintable(QString("mpeg_crc32 %1").arg(size)))
+            << true << size;
+    }
+}
+
+void TestMPEGTables::crc_benchmark(void)
+{
+    QFETCH(bool, useHW);
+    QFETCH(int, size);
+
+    if (useHW)
+        qInfo() << "mpeg_crc32() uses"
+                << (mpeg_crc32_hw_name() ? mpeg_crc32_hw_name() : "slice-by-8");
+
+    std::vector<unsigned char> data(size, 0x5a);
+    uint32_t expected = av_mpeg_crc32(data.data(), data.size());
+    uint32_t crc = 0;
+    if (useHW)
+    {
+        QBENCHMARK
+        {
+            for (int i = 0; i < 256; i++)
+                crc = mpeg_crc32(data.data(), data.size());
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            for (int i = 0; i < 256; i++)
+                crc = av_mpeg_crc32(data.data(), data.size());
+        }
+    }
+    QCOMPARE (crc, expected);
+}
+
+void TestMPEGTables::pes_alloc_test(void)
+{
+#ifndef USING_VALGRIND
+    PESAllocStats before = pes_alloc_stats();
+#endif
+
+    std::array<unsigned char*,3> blocks {
+        pes_alloc(188), pes_alloc(4096), pes_alloc(8192) };
+    for (auto *block : blocks)
+        QVERIFY (block != nullptr);
+    QCOMPARE (reinterpret_cast<uintptr_t>(blocks[0]) % 16, uintptr_t(0));
+    QCOMPARE (reinterpret_cast<uintptr_t>(blocks[1]) % 16, uintptr_t(0));
+    memset(blocks[0], 0xff, 188);
+    memset(blocks[1], 0xff, 4096);
+    memset(blocks[2], 0xff, 8192);
+
+#ifndef USING_VALGRIND
+    PESAllocStats during = pes_alloc_stats();
+    for (size_t i = 0; i < 3; ++i)
+    {
+        QCOMPARE (during.m_inUse[i], before.m_inUse[i] + 1);
+        QVERIFY (during.m_highWater[i] >= during.m_inUse[i]);
+    }
+#endif
+
+    for (auto *block : blocks)
+        pes_free(block);
+
+#ifndef USING_VALGRIND
+    PESAllocStats after = pes_alloc_stats();
+    for (size_t i = 0; i < 3; ++i)
+        QCOMPARE (after.m_inUse[i], before.m_inUse[i]);
+#endif
+}
+
+void TestMPEGTables::pes_alloc_thread_test(void)
+{
+#ifndef USING_VALGRIND
+    PESAllocStats before = pes_alloc_stats();
+#endif
+
+    // Enough blocks to pass several magazines through the depot.
+    std::vector<unsigned char*> blocks;
+    std::thread producer([&blocks]()
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            blocks.push_back(pes_alloc(188));
+            blocks.push_back(pes_alloc(4096));
+        }
+    });
+    producer.join();
+
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        QVERIFY (blocks[i] != nullptr);
+        memset(blocks[i], 0xff, (i % 2) ? 4096 : 188);
+    }
+
+    std::thread consumer([&blocks]()
+    {
+        for (auto *block : blocks)
+            pes_free(block);
+    });
+    consumer.join();
+
+#ifndef USING_VALGRIND
+    PESAllocStats after = pes_alloc_stats();
+    for (size_t i = 0; i < 3; ++i)
+        QCOMPARE (after.m_inUse[i], before.m_inUse[i]);
+    QVERIFY (after.m_crossThreadFrees >=
+             before.m_crossThreadFrees + blocks.size());
+#endif
+
+    // The block is freed after the thread's cache has been flushed.
+    struct LateFree
+    {
+        ~LateFree() { pes_free(m_block); }
+        unsigned char *m_block { nullptr };
+    };
+    std::thread exiting([]()
+    {
+        thread_local LateFree t_late;
+        t_late.m_block = pes_alloc(188);
+        pes_free(pes_alloc(4096));
+    });
+    exiting.join();
+
+#ifndef USING_VALGRIND
+    after = pes_alloc_stats();
+    for (size_t i = 0; i < 3; ++i)
+        QCOMPARE (after.m_inUse[i], before.m_inUse[i]);
+#endif
+}
+
+class PATCounter : public MPEGStreamListener,
+                   public MPEGSingleProgramStreamListener
+{
+  public:
+    void HandlePAT(const ProgramAssociationTable */*pat*/) override
+        { m_pats++; }
+    void HandleCAT(const ConditionalAccessTable */*cat*/) override { }
+    void HandlePMT(uint /*program_num*/,
+                   const ProgramMapTable */*pmt*/) override { }
+    void HandleEncryptionStatus(uint /*program_number*/,
+                                bool /*encrypted*/) override { }
+    void HandleSingleProgramPAT(ProgramAssociationTable */*pat*/,
+                                bool insert) override
+        { if (!insert) m_heartbeats++; }
+    void HandleSingleProgramPMT(ProgramMapTable */*pmt*/,
+                                bool /*insert*/) override { }
+
+    uint m_pats       {0};
+    uint m_heartbeats {0};
+};
+
+void TestMPEGTables::repeated_section_test(void)
+{
+    std::vector<uint8_t> si_data {
+        0x00, 0xb0, 0x31, 0x04, 0x37, 0xdf, 0x00, 0x00,  0x2b, 0x66, 0xf7, 0xd4, 0x6d, 0x66, 0xe0, 0x64,
+        0x6d, 0x67, 0xe0, 0xc8, 0x6d, 0x68, 0xe1, 0x2c,  0x6d, 0x6b, 0xe2, 0x58, 0x6d, 0x6c, 0xe2, 0xbc,
+        0x6d, 0x6d, 0xe3, 0x20, 0x6d, 0x6e, 0xe2, 0x8a,  0x6d, 0x70, 0xe4, 0x4c, 0x6d, 0x71, 0xe1, 0x9b,
+        0xc0, 0x79, 0xa6, 0x2b
+    };
+
+    auto make_packet = [](const std::vector<uint8_t> &section)
+    {
+        TSPacket *pkt = TSPacket::CreatePayloadOnlyPacket();
+        std::vector<uint8_t> payload { 0x00 }; // pointer field
+        payload.insert(payload.end(), section.cbegin(), section.cend());
+        pkt->InitPayload(payload.data(), payload.size());
+        return pkt;
+    };
+
+    MPEGStreamData sd(-1, 0, false);
+    PATCounter counter;
+    sd.AddMPEGListener(&counter);
+    sd.AddMPEGSPListener(&counter);
+
+    // version 15, the repeats only produce a heartbeat
+    TSPacket *v15 = make_packet(si_data);
+    for (uint i = 0; i < 3; i++)
+        sd.ProcessTSPacket(*v15);
+    QCOMPARE (counter.m_pats,       1U);
+    QCOMPARE (counter.m_heartbeats, 2U);
+
+    // version 16 is a new table
+    si_data[5] = 0xe1;
+    update_crc(si_data);
+    TSPacket *v16 = make_packet(si_data);
+    sd.ProcessTSPacket(*v16);
+    sd.ProcessTSPacket(*v16);
+    QCOMPARE (counter.m_pats,       2U);
+    QCOMPARE (counter.m_heartbeats, 3U);
+
+    // and so is going back to version 15
+    sd.ProcessTSPacket(*v15);
+    QCOMPARE (counter.m_pats,       3U);
+
+    // forgetting the version makes the same section new again
+    sd.ProcessTSPacket(*v15);
+    QCOMPARE (counter.m_pats,       3U);
+    sd.SetVersionPAT(0x0437, -1, 0);
+    sd.ProcessTSPacket(*v15);
+    QCOMPARE (counter.m_pats,       4U);
+
+    sd.RemoveMPEGListener(&counter);
+    sd.RemoveMPEGSPListener(&counter);
+    delete v15;
+    delete v16;
+}
+
 void TestMPEGTables::PrivateDataSpecifierDescriptor_test (void)
 {
     /* from https://code.mythtv.org/trac/ticket/12091 */
@@ -79,6 +79,23 @@ class TestMPEGTables: public QObject
      */
     static void clone_test(void);
 
+    /** test mpeg_crc32() against the libavutil CRC for every length
+     *  up to a full private section, at every alignment */
+    static void crc_test(void);
+    static void crc_benchmark_data(void);
+    static void crc_benchmark(void);
+
+    /** test the pes_alloc() size classes and counters */
+    static void pes_alloc_test(void);
+
+    /** test pes_alloc() blocks freed on another thread, and by
+     *  thread_local destructors after the thread cache is gone */
+    static void pes_alloc_thread_test(void);
+
+    /** test that repeated sections are dropped without losing
+     *  the heartbeat or new table versions */
+    static void repeated_section_test(void);
+
     /** test PrivateDataSpecifierDescriptor */
     static void PrivateDataSpecifierDescriptor_test (void);
 
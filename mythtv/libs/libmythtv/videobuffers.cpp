@@ -184,8 +184,7 @@ void VideoBuffers::Init(uint NumDecode, uint NeedFree,
     // pointer to VideoFrames work even after a few push_backs
     m_buffers.reserve(std::max(NumDecode, 128U));
     m_buffers.resize(NumDecode);
-    for (uint i = 0; i < NumDecode; i++)
-        m_vbufferMap[At(i)] = i;
+    m_frameQueues.assign(NumDecode, 0);
 
     m_needFreeFrames            = NeedFree;
     m_needPrebufferFrames       = NeedPrebufferNormal;
@@ -272,7 +271,9 @@ void VideoBuffers::Reset()
     m_decode.clear();
     m_pause.clear();
     m_displayed.clear();
-    m_vbufferMap.clear();
+    m_frameQueues.clear();
+    for (auto & size : m_queueSize)
+        size = 0;
 }
 
 /**
@@ -293,19 +294,19 @@ MythVideoFrame *VideoBuffers::GetNextFreeFrameInternal(BufferType EnqueueTo)
     // Try to get a frame not being used by the decoder
     for (size_t i = 0; i < m_available.size(); i++)
     {
-        frame = m_available.dequeue();
-        if (m_decode.contains(frame))
-            m_available.enqueue(frame);
+        frame = Pop(kVideoBuffer_avail);
+        if (InQueue(kVideoBuffer_decode, frame))
+            Push(kVideoBuffer_avail, frame);
         else
             break;
     }
 
-    while (frame && m_used.contains(frame))
+    while (frame && InQueue(kVideoBuffer_used, frame))
     {
         LOG(VB_PLAYBACK, LOG_NOTICE,
             QString("GetNextFreeFrame() served a busy frame %1. Dropping. %2")
                 .arg(DebugString(frame, true), GetStatus()));
-        frame = m_available.dequeue();
+        frame = Pop(kVideoBuffer_avail);
     }
 
     if (frame)
@@ -362,12 +363,14 @@ void VideoBuffers::ReleaseFrame(MythVideoFrame *Frame)
 {
     QMutexLocker locker(&m_globalLock);
 
-    m_vpos = m_vbufferMap[Frame];
-    m_limbo.remove(Frame);
+    int index = FrameIndex(Frame);
+    if (index >= 0)
+        m_vpos = static_cast<uint>(index);
+    Pull(kVideoBuffer_limbo, Frame);
     //non directrendering frames are ffmpeg handled
     if (Frame->m_directRendering)
-        m_decode.enqueue(Frame);
-    m_used.enqueue(Frame);
+        Push(kVideoBuffer_decode, Frame);
+    Push(kVideoBuffer_used, Frame);
 }
 
 /**
@@ -381,20 +384,18 @@ void VideoBuffers::DeLimboFrame(MythVideoFrame *Frame)
 
     m_globalLock.lock();
 
-    if (m_limbo.contains(Frame))
-        m_limbo.remove(Frame);
+    Pull(kVideoBuffer_limbo, Frame);
 
     // if decoder didn't release frame and the buffer is getting released by
     // the decoder assume that the frame is lost and return to available
-    if (!m_decode.contains(Frame))
+    if (!InQueue(kVideoBuffer_decode, Frame))
     {
         ReleaseDecoderResources(Frame, discards);
         SafeEnqueue(kVideoBuffer_avail, Frame);
     }
 
     // remove from decode queue since the decoder is finished
-    while (m_decode.contains(Frame))
-        m_decode.remove(Frame);
+    Pull(kVideoBuffer_decode, Frame);
 
     m_globalLock.unlock();
 
@@ -408,7 +409,9 @@ void VideoBuffers::DeLimboFrame(MythVideoFrame *Frame)
 void VideoBuffers::StartDisplayingFrame(void)
 {
     QMutexLocker locker(&m_globalLock);
-    m_rpos = m_vbufferMap[m_used.head()];
+    int index = FrameIndex(m_used.head());
+    if (index >= 0)
+        m_rpos = static_cast<uint>(index);
 }
 
 /**
@@ -421,16 +424,14 @@ void VideoBuffers::DoneDisplayingFrame(MythVideoFrame *Frame)
 
     m_globalLock.lock();
 
-    if(m_used.contains(Frame))
-        Remove(kVideoBuffer_used, Frame);
-
-    Enqueue(kVideoBuffer_finished, Frame);
+    Pull(kVideoBuffer_used, Frame);
+    Push(kVideoBuffer_finished, Frame);
 
     // check if any finished frames are no longer used by decoder and return to available
     frame_queue_t ula(m_finished);
     for (auto & it : ula)
     {
-        if (!m_decode.contains(it))
+        if (!InQueue(kVideoBuffer_decode, it))
         {
             Remove(kVideoBuffer_finished, it);
             ReleaseDecoderResources(it, discards);
@@ -515,8 +516,8 @@ bool VideoBuffers::DiscardAndRecreate(MythCodecID CodecID, QSize VideoDim, int R
     {
         for (uint i = 0; i < Size(); i++)
         {
-            if (!m_available.contains(At(i)) && !m_pause.contains(At(i)) &&
-                !m_displayed.contains(At(i)))
+            if (!InQueue(kVideoBuffer_avail, At(i)) && !InQueue(kVideoBuffer_pause, At(i)) &&
+                !InQueue(kVideoBuffer_displayed, At(i)))
             {
                 LOG(VB_GENERAL, LOG_INFO,
                     QString("VideoBuffers::DiscardFrames(): %1 (%2) not "
@@ -529,11 +530,12 @@ bool VideoBuffers::DiscardAndRecreate(MythCodecID CodecID, QSize VideoDim, int R
         }
     }
 
-    for (auto & it : m_decode)
-        Remove(kVideoBuffer_all, it);
-    for (auto & it : m_decode)
-        m_available.enqueue(it);
-    m_decode.clear();
+    frame_queue_t decode(m_decode);
+    for (auto & it : decode)
+    {
+        Remove(static_cast<BufferType>(kVideoBuffer_all | kVideoBuffer_decode), it);
+        Push(kVideoBuffer_avail, it);
+    }
 
     Reset();
 
@@ -584,9 +586,9 @@ bool VideoBuffers::DiscardAndRecreate(MythCodecID CodecID, QSize VideoDim, int R
     return result;
 }
 
+// Callers hold m_globalLock
 frame_queue_t *VideoBuffers::Queue(BufferType Type)
 {
-    QMutexLocker locker(&m_globalLock);
     frame_queue_t *queue = nullptr;
     if (Type == kVideoBuffer_avail)
         queue = &m_available;
@@ -607,23 +609,90 @@ frame_queue_t *VideoBuffers::Queue(BufferType Type)
 
 const frame_queue_t *VideoBuffers::Queue(BufferType Type) const
 {
-    QMutexLocker locker(&m_globalLock);
-    const frame_queue_t *queue = nullptr;
-    if (Type == kVideoBuffer_avail)
-        queue = &m_available;
-    else if (Type == kVideoBuffer_used)
-        queue = &m_used;
-    else if (Type == kVideoBuffer_displayed)
-        queue = &m_displayed;
-    else if (Type == kVideoBuffer_limbo)
-        queue = &m_limbo;
-    else if (Type == kVideoBuffer_pause)
-        queue = &m_pause;
-    else if (Type == kVideoBuffer_decode)
-        queue = &m_decode;
-    else if (Type == kVideoBuffer_finished)
-        queue = &m_finished;
-    return queue;
+    return const_cast<VideoBuffers*>(this)->Queue(Type);
+}
+
+/// Index into m_queueSize of a single queue, -1 for a combination of them
+int VideoBuffers::QueueIndex(BufferType Type)
+{
+    auto type = static_cast<uint>(Type);
+    if (type == 0 || (type & (type - 1)) != 0 || type > kVideoBuffer_decode)
+        return -1;
+    int index = 0;
+    for (; (type & 1) == 0; type >>= 1)
+        index++;
+    return index;
+}
+
+/// Position of the frame in m_buffers, -1 if it is not one of ours
+int VideoBuffers::FrameIndex(const MythVideoFrame *Frame) const
+{
+    if (!Frame || m_buffers.empty())
+        return -1;
+    ptrdiff_t index = Frame - m_buffers.data();
+    if (index < 0 || static_cast<size_t>(index) >= m_frameQueues.size())
+        return -1;
+    return static_cast<int>(index);
+}
+
+bool VideoBuffers::InQueue(BufferType Type, const MythVideoFrame *Frame) const
+{
+    int index = FrameIndex(Frame);
+    if (index < 0)
+        return Queue(Type) && Queue(Type)->contains(const_cast<MythVideoFrame*>(Frame));
+    return (m_frameQueues[static_cast<size_t>(index)] & Type) != 0U;
+}
+
+/*! \brief Move Frame to the tail of a single queue.
+ *
+ * Like Enqueue() this does not touch the other queues the frame is in.
+ * The membership table means the removal only walks the queue when the
+ * frame is actually in it.
+ */
+void VideoBuffers::Push(BufferType Type, MythVideoFrame *Frame)
+{
+    frame_queue_t *queue = Queue(Type);
+    if (!queue || !Frame)
+        return;
+    int index = FrameIndex(Frame);
+    if (index < 0 || (m_frameQueues[static_cast<size_t>(index)] & Type))
+        queue->remove(Frame);
+    else
+        m_queueSize[static_cast<size_t>(QueueIndex(Type))]++;
+    if (index >= 0)
+        m_frameQueues[static_cast<size_t>(index)] |= Type;
+    queue->enqueue(Frame);
+    if (index < 0)
+        m_queueSize[static_cast<size_t>(QueueIndex(Type))] = static_cast<uint>(queue->size());
+}
+
+void VideoBuffers::Pull(BufferType Type, MythVideoFrame *Frame)
+{
+    frame_queue_t *queue = Queue(Type);
+    if (!queue || !Frame)
+        return;
+    int index = FrameIndex(Frame);
+    if (index >= 0)
+    {
+        if (!(m_frameQueues[static_cast<size_t>(index)] & Type))
+            return;
+        m_frameQueues[static_cast<size_t>(index)] &= ~static_cast<uint>(Type);
+    }
+    queue->remove(Frame);
+    m_queueSize[static_cast<size_t>(QueueIndex(Type))] = static_cast<uint>(queue->size());
+}
+
+MythVideoFrame *VideoBuffers::Pop(BufferType Type)
+{
+    frame_queue_t *queue = Queue(Type);
+    if (!queue || queue->empty())
+        return nullptr;
+    MythVideoFrame *frame = queue->dequeue();
+    int index = FrameIndex(frame);
+    if (index >= 0)
+        m_frameQueues[static_cast<size_t>(index)] &= ~static_cast<uint>(Type);
+    m_queueSize[static_cast<size_t>(QueueIndex(Type))] = static_cast<uint>(queue->size());
+    return frame;
 }
 
 MythVideoFrame* VideoBuffers::At(uint FrameNum)
@@ -639,10 +708,7 @@ const MythVideoFrame* VideoBuffers::At(uint FrameNum) const
 MythVideoFrame *VideoBuffers::Dequeue(BufferType Type)
 {
     QMutexLocker locker(&m_globalLock);
-    frame_queue_t *queue = Queue(Type);
-    if (!queue)
-        return nullptr;
-    return queue->dequeue();
+    return Pop(Type);
 }
 
 MythVideoFrame *VideoBuffers::Head(BufferType Type)
@@ -669,17 +735,12 @@ MythVideoFrame *VideoBuffers::Tail(BufferType Type)
 
 void VideoBuffers::Enqueue(BufferType Type, MythVideoFrame *Frame)
 {
-    if (!Frame)
+    if (!Frame || !Queue(Type))
         return;
-    frame_queue_t *queue = Queue(Type);
-    if (!queue)
-        return;
-    m_globalLock.lock();
-    queue->remove(Frame);
-    queue->enqueue(Frame);
+    QMutexLocker locker(&m_globalLock);
+    Push(Type, Frame);
     if (Type == kVideoBuffer_pause)
         Frame->m_pauseFrame = true;
-    m_globalLock.unlock();
 }
 
 void VideoBuffers::Remove(BufferType Type, MythVideoFrame *Frame)
@@ -688,20 +749,9 @@ void VideoBuffers::Remove(BufferType Type, MythVideoFrame *Frame)
         return;
 
     QMutexLocker locker(&m_globalLock);
-    if ((Type & kVideoBuffer_avail) == kVideoBuffer_avail)
-        m_available.remove(Frame);
-    if ((Type & kVideoBuffer_used) == kVideoBuffer_used)
-        m_used.remove(Frame);
-    if ((Type & kVideoBuffer_displayed) == kVideoBuffer_displayed)
-        m_displayed.remove(Frame);
-    if ((Type & kVideoBuffer_limbo) == kVideoBuffer_limbo)
-        m_limbo.remove(Frame);
-    if ((Type & kVideoBuffer_pause) == kVideoBuffer_pause)
-        m_pause.remove(Frame);
-    if ((Type & kVideoBuffer_decode) == kVideoBuffer_decode)
-        m_decode.remove(Frame);
-    if ((Type & kVideoBuffer_finished) == kVideoBuffer_finished)
-        m_finished.remove(Frame);
+    for (uint type = kVideoBuffer_avail; type <= kVideoBuffer_decode; type <<= 1)
+        if ((Type & type) == type)
+            Pull(static_cast<BufferType>(type), Frame);
 }
 
 void VideoBuffers::SafeEnqueue(BufferType Type, MythVideoFrame* Frame)
@@ -739,22 +789,22 @@ frame_queue_t::iterator VideoBuffers::End(BufferType Type)
     return (queue ? queue->end() : m_available.end());
 }
 
+/// Lock free, so the decoder and the display thread can poll the queue
+/// sizes without contending for m_globalLock.
 uint VideoBuffers::Size(BufferType Type) const
 {
-    QMutexLocker locker(&m_globalLock);
-    const frame_queue_t *queue = Queue(Type);
-    if (queue)
-        return queue->size();
-    return 0;
+    int index = QueueIndex(Type);
+    if (index < 0)
+        return 0;
+    return m_queueSize[static_cast<size_t>(index)];
 }
 
 bool VideoBuffers::Contains(BufferType Type, MythVideoFrame *Frame) const
 {
     QMutexLocker locker(&m_globalLock);
-    const frame_queue_t *queue = Queue(Type);
-    if (queue)
-        return queue->contains(Frame);
-    return false;
+    if (!Queue(Type))
+        return false;
+    return InQueue(Type, Frame);
 }
 
 MythVideoFrame* VideoBuffers::GetLastDecodedFrame(void)
@@ -851,8 +901,8 @@ void VideoBuffers::DiscardFrames(bool NextFrameIsKeyFrame)
     {
         for (uint i = 0; i < Size(); i++)
         {
-            if (!m_available.contains(At(i)) && !m_pause.contains(At(i)) &&
-                !m_displayed.contains(At(i)))
+            if (!InQueue(kVideoBuffer_avail, At(i)) && !InQueue(kVideoBuffer_pause, At(i)) &&
+                !InQueue(kVideoBuffer_displayed, At(i)))
             {
                 // This message is DEBUG because it does occur
                 // after Reset is called.
@@ -871,11 +921,12 @@ void VideoBuffers::DiscardFrames(bool NextFrameIsKeyFrame)
 
     // Make sure frames used by decoder are last...
     // This is for libmpeg2 which still uses the frames after a reset.
-    for (it = m_decode.begin(); it != m_decode.end(); ++it)
-        Remove(kVideoBuffer_all, *it);
-    for (it = m_decode.begin(); it != m_decode.end(); ++it)
-        m_available.enqueue(*it);
-    m_decode.clear();
+    frame_queue_t decode(m_decode);
+    for (it = decode.begin(); it != decode.end(); ++it)
+    {
+        Remove(static_cast<BufferType>(kVideoBuffer_all | kVideoBuffer_decode), *it);
+        Push(kVideoBuffer_avail, *it);
+    }
 
     LOG(VB_PLAYBACK, LOG_INFO,
         QString("VideoBuffers::DiscardFrames(%1): %2 -- done")
@@ -905,10 +956,10 @@ void VideoBuffers::ClearAfterSeek(void)
         for (uint i = 0; (i < Size()) && (m_used.count() > 1); i++)
         {
             MythVideoFrame *buffer = At(i);
-            if (m_used.contains(buffer) && !m_decode.contains(buffer))
+            if (InQueue(kVideoBuffer_used, buffer) && !InQueue(kVideoBuffer_decode, buffer))
             {
-                m_used.remove(buffer);
-                m_available.enqueue(buffer);
+                Pull(kVideoBuffer_used, buffer);
+                Push(kVideoBuffer_avail, buffer);
                 ReleaseDecoderResources(buffer, discards);
             }
         }
@@ -918,12 +969,12 @@ void VideoBuffers::ClearAfterSeek(void)
             for (uint i = 0; i < Size(); i++)
             {
                 MythVideoFrame *buffer = At(i);
-                if (m_used.contains(buffer) && !m_decode.contains(buffer))
+                if (InQueue(kVideoBuffer_used, buffer) && !InQueue(kVideoBuffer_decode, buffer))
                 {
-                    m_used.remove(buffer);
-                    m_available.enqueue(buffer);
+                    Pull(kVideoBuffer_used, buffer);
+                    Push(kVideoBuffer_avail, buffer);
                     ReleaseDecoderResources(buffer, discards);
-                    m_vpos = m_vbufferMap[buffer];
+                    m_vpos = i;
                     m_rpos = m_vpos;
                     break;
                 }
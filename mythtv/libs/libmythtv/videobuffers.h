@@ -2,6 +2,8 @@
 #define VIDEOBUFFERS_H
 
 // Std
+#include <array>
+#include <atomic>
 #include <vector>
 #include <map>
 
@@ -98,8 +100,16 @@ class MTV_PUBLIC VideoBuffers
     QString GetStatus(uint Num = 0) const;
 
   private:
+    static constexpr size_t kNumQueues { 7 };
+
     frame_queue_t       *Queue(BufferType Type);
     const frame_queue_t *Queue(BufferType Type) const;
+    static int           QueueIndex(BufferType Type);
+    int                  FrameIndex(const MythVideoFrame *Frame) const;
+    bool                 InQueue(BufferType Type, const MythVideoFrame *Frame) const;
+    void                 Push(BufferType Type, MythVideoFrame *Frame);
+    void                 Pull(BufferType Type, MythVideoFrame *Frame);
+    MythVideoFrame      *Pop(BufferType Type);
     MythVideoFrame      *GetNextFreeFrameInternal(BufferType EnqueueTo);
     static void          SetDeinterlacingFlags(MythVideoFrame &Frame, MythDeintType Single,
                                                MythDeintType Double, MythCodecID CodecID);
@@ -111,8 +121,11 @@ class MTV_PUBLIC VideoBuffers
     frame_queue_t        m_displayed;
     frame_queue_t        m_decode;
     frame_queue_t        m_finished;
-    vbuffer_map_t        m_vbufferMap;
     frame_vector_t       m_buffers;
+    /// For each frame, the BufferType flags of the queues it is in
+    std::vector<uint>    m_frameQueues;
+    /// Queue sizes, readable without taking m_globalLock
+    std::array<std::atomic<uint>,kNumQueues> m_queueSize {};
     const VideoFrameTypes* m_renderFormats { nullptr };
 
     uint                 m_needFreeFrames            { 0 };
@@ -22,7 +22,7 @@ QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
 # Input
 HEADERS  = mythmainwindowprivate.h mythmainwindow.h mythpainter.h mythimage.h mythrect.h
 HEADERS += mythpainterwindow.h mythpainterwindowqt.h
-HEADERS += mythuithemecache.h
+HEADERS += mythuithemecache.h mythimagelru.h
 HEADERS += mythuithemehelper.h
 HEADERS += mythuilocation.h
 HEADERS += mythuiscreenbounds.h
@@ -55,7 +55,7 @@ HEADERS += mythuiprocedural.h
 
 SOURCES  = mythmainwindowprivate.cpp mythmainwindow.cpp mythpainter.cpp mythimage.cpp mythrect.cpp
 SOURCES += mythpainterwindow.cpp mythpainterwindowqt.cpp
-SOURCES += mythuithemecache.cpp
+SOURCES += mythuithemecache.cpp mythimagelru.cpp
 SOURCES += mythuithemehelper.cpp
 SOURCES += mythuilocation.cpp
 SOURCES += mythuiscreenbounds.cpp
@@ -98,6 +98,7 @@ inc.path = $${PREFIX}/include/mythtv/libmythui/
 inc.files  = mythrect.h mythmainwindow.h mythpainter.h mythimage.h
 inc.files += myththemebase.h themeinfo.h
 inc.files += mythuiscreenbounds.h mythuithemecache.h mythuithemehelper.h
+inc.files += mythimagelru.h
 inc.files += mythuilocation.h
 inc.files += mythpainter_qt.h mythuistatetype.h mythuihelper.h
 inc.files += mythscreenstack.h mythscreentype.h mythuitype.h mythuiimage.h
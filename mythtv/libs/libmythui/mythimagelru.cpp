@@ -0,0 +1,92 @@
+// MythTV
+#include "mythimagelru.h"
+
+/// Returns the image for Key and makes it the most recently used, or
+/// nullptr. Refresh also updates the time returned by Peek().
+MythImage* MythImageLRU::Get(const QString& Key, bool Refresh)
+{
+    auto found = m_index.constFind(Key);
+    if (found == m_index.constEnd())
+    {
+        m_misses++;
+        return nullptr;
+    }
+
+    m_hits++;
+    EntryList::iterator entry = found.value();
+    m_entries.splice(m_entries.begin(), m_entries, entry);
+    if (Refresh)
+        entry->m_used = SystemClock::now();
+    return entry->m_image;
+}
+
+/// Returns the image for Key without counting a lookup or changing its age.
+MythImage* MythImageLRU::Peek(const QString& Key, SystemTime* LastUsed) const
+{
+    auto found = m_index.constFind(Key);
+    if (found == m_index.constEnd())
+        return nullptr;
+    if (LastUsed)
+        *LastUsed = found.value()->m_used;
+    return found.value()->m_image;
+}
+
+/// Makes Key the most recently used without counting a lookup.
+void MythImageLRU::Touch(const QString& Key)
+{
+    auto found = m_index.constFind(Key);
+    if (found != m_index.constEnd())
+        m_entries.splice(m_entries.begin(), m_entries, found.value());
+}
+
+/// Adds Image as the most recently used entry. Key must not be present.
+void MythImageLRU::Insert(const QString& Key, MythImage* Image, int64_t Cost)
+{
+    m_entries.push_front({ Key, Image, Cost, SystemClock::now() });
+    m_index.insert(Key, m_entries.begin());
+    m_cost += Cost;
+}
+
+/// Removes Key and returns its image, with the reference it was inserted with.
+MythImage* MythImageLRU::Take(const QString& Key, bool Evicted)
+{
+    auto found = m_index.find(Key);
+    if (found == m_index.end())
+        return nullptr;
+
+    EntryList::iterator entry = found.value();
+    MythImage* image = entry->m_image;
+    m_cost -= entry->m_cost;
+    if (Evicted)
+        m_evictions++;
+    m_index.erase(found);
+    m_entries.erase(entry);
+    return image;
+}
+
+/// Returns the least recently used image, or nullptr if the cache is empty.
+MythImage* MythImageLRU::Oldest(QString* Key) const
+{
+    if (m_entries.empty())
+        return nullptr;
+    if (Key)
+        *Key = m_entries.back().m_key;
+    return m_entries.back().m_image;
+}
+
+/// Empties the cache, returning every image with its reference.
+QList<MythImage*> MythImageLRU::TakeAll()
+{
+    QList<MythImage*> result;
+    for (const auto & entry : m_entries)
+        result.append(entry.m_image);
+    m_entries.clear();
+    m_index.clear();
+    m_cost = 0;
+    return result;
+}
+
+MythImageLRU::Stats MythImageLRU::GetStats() const
+{
+    return { static_cast<int>(m_index.size()), m_cost, m_hits, m_misses, m_evictions };
+}
@@ -0,0 +1,70 @@
+#ifndef MYTHIMAGELRU_H
+#define MYTHIMAGELRU_H
+
+// Std
+#include <list>
+
+// Qt
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+// MythTV
+#include "libmythbase/mythchrono.h"
+#include "libmythui/mythuiexp.h"
+
+class MythImage;
+
+/** \brief A least recently used list of MythImages charged by byte cost.
+ *
+ *  Lookups, insertions and removals are O(1). The cache stores the
+ *  reference handed to Insert() and hands it back from Take(), it never
+ *  calls IncrRef() or DecrRef() itself, so owners can do their own
+ *  bookkeeping for images entering and leaving the cache.
+ *
+ *  \note Not thread safe, the owner must serialise access.
+ */
+class MUI_PUBLIC MythImageLRU
+{
+  public:
+    struct Stats
+    {
+        int     m_count     { 0 };
+        int64_t m_cost      { 0 };
+        quint64 m_hits      { 0 };
+        quint64 m_misses    { 0 };
+        quint64 m_evictions { 0 };
+    };
+
+    MythImage* Get(const QString& Key, bool Refresh = true);
+    MythImage* Peek(const QString& Key, SystemTime* LastUsed = nullptr) const;
+    bool       Contains(const QString& Key) const { return m_index.contains(Key); }
+    void       Touch(const QString& Key);
+    void       Insert(const QString& Key, MythImage* Image, int64_t Cost);
+    MythImage* Take(const QString& Key, bool Evicted = false);
+    MythImage* Oldest(QString* Key = nullptr) const;
+    QList<MythImage*> TakeAll();
+    QStringList Keys() const { return m_index.keys(); }
+    int        Count() const { return static_cast<int>(m_index.size()); }
+    int64_t    Cost() const { return m_cost; }
+    Stats      GetStats() const;
+
+  private:
+    struct Entry
+    {
+        QString    m_key;
+        MythImage* m_image { nullptr };
+        int64_t    m_cost  { 0 };
+        SystemTime m_used;
+    };
+    using EntryList = std::list<Entry>;
+
+    EntryList                             m_entries; ///< most recently used first
+    QHash<QString, EntryList::iterator>   m_index;
+    int64_t                               m_cost      { 0 };
+    quint64                               m_hits      { 0 };
+    quint64                               m_misses    { 0 };
+    quint64                               m_evictions { 0 };
+};
+
+#endif
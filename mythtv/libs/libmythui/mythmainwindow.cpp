@@ -433,6 +433,22 @@ void MythMainWindow::drawScreen(QPaintEvent* Event)
     m_repaintRegion = QRegion();
 }
 
+static QString CacheStatsString(const QString &Name, const MythImageLRU::Stats &Stats)
+{
+    return QString("%1: %2 images %3 KB, %4 hits %5 misses %6 evictions")
+        .arg(Name).arg(Stats.m_count).arg(Stats.m_cost / 1024)
+        .arg(Stats.m_hits).arg(Stats.m_misses).arg(Stats.m_evictions);
+}
+
+/// Shows the image cache counters along with the widget names debug overlay.
+void MythMainWindow::DrawCacheStats(MythPainter* Painter)
+{
+    QString text = CacheStatsString("Image cache", GetMythUI()->GetImageCacheStats()) +
+        "\n" + CacheStatsString("Text cache", Painter->GetStringCacheStats());
+    QRect area(m_uiScreenRect.topLeft(), QSize(m_uiScreenRect.width() / 2, 40));
+    Painter->DrawDebugText(area, text);
+}
+
 void MythMainWindow::Draw(MythPainter* Painter)
 {
     if (!Painter)
@@ -462,6 +478,9 @@ void MythMainWindow::Draw(MythPainter* Painter)
             for (auto *screen : qAsConst(redrawList))
                 screen->Draw(Painter, 0, 0, 255, rect);
         }
+
+        if (Painter->ShowBorders() && Painter->ShowTypeNames())
+            DrawCacheStats(Painter);
     }
 
     Painter->End();
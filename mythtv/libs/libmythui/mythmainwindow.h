@@ -152,6 +152,8 @@ class MUI_PUBLIC MythMainWindow : public MythUIScreenBounds
     void DelayedAction();
 
   private:
+    void DrawCacheStats(MythPainter* Painter);
+
     MythMainWindowPrivate* m_priv      { nullptr };
     MythDisplay*       m_display       { nullptr };
     QRegion            m_repaintRegion;
@@ -347,14 +347,10 @@ MythImage *MythPainter::GetImageFromString(const QString &msg,
                        QString::number(flags) +
                        QString::number(font.color().rgba()) + msg;
 
-    MythImage *im = nullptr;
-    if (m_stringToImageMap.contains(incoming))
+    MythImage *im = m_stringImageCache.Get(incoming);
+    if (im)
     {
-        m_stringExpireList.remove(incoming);
-        m_stringExpireList.push_back(incoming);
-        im = m_stringToImageMap[incoming];
-        if (im)
-            im->IncrRef();
+        im->IncrRef();
     }
     else
     {
@@ -363,9 +359,7 @@ MythImage *MythPainter::GetImageFromString(const QString &msg,
         DrawTextPriv(im, msg, flags, r, font);
 
         im->IncrRef();
-        m_softwareCacheSize += im->GetSize();
-        m_stringToImageMap[incoming] = im;
-        m_stringExpireList.push_back(incoming);
+        m_stringImageCache.Insert(incoming, im, im->GetSize());
         ExpireImages(m_maxSoftwareCacheSize);
     }
     return im;
@@ -387,14 +381,10 @@ MythImage *MythPainter::GetImageFromTextLayout(const LayoutVector &layouts,
     for (auto *layout : qAsConst(layouts))
         incoming += layout->text();
 
-    MythImage *im = nullptr;
-    if (m_stringToImageMap.contains(incoming))
+    MythImage *im = m_stringImageCache.Get(incoming);
+    if (im)
     {
-        m_stringExpireList.remove(incoming);
-        m_stringExpireList.push_back(incoming);
-        im = m_stringToImageMap[incoming];
-        if (im)
-            im->IncrRef();
+        im->IncrRef();
     }
     else
     {
@@ -455,9 +445,7 @@ MythImage *MythPainter::GetImageFromTextLayout(const LayoutVector &layouts,
         im->Assign(pm.copy(0, 0, dest.width(), dest.height()));
 
         im->IncrRef();
-        m_softwareCacheSize += im->GetSize();
-        m_stringToImageMap[incoming] = im;
-        m_stringExpireList.push_back(incoming);
+        m_stringImageCache.Insert(incoming, im, im->GetSize());
         ExpireImages(m_maxSoftwareCacheSize);
     }
     return im;
@@ -507,14 +495,10 @@ MythImage* MythPainter::GetImageFromRect(const QRect area, int radius,
 
     incoming += QString::number(hash1) + QString::number(hash2);
 
-    MythImage *im = nullptr;
-    if (m_stringToImageMap.contains(incoming))
+    MythImage *im = m_stringImageCache.Get(incoming);
+    if (im)
     {
-        m_stringExpireList.remove(incoming);
-        m_stringExpireList.push_back(incoming);
-        im = m_stringToImageMap[incoming];
-        if (im)
-            im->IncrRef();
+        im->IncrRef();
     }
     else
     {
@@ -523,9 +507,7 @@ MythImage* MythPainter::GetImageFromRect(const QRect area, int radius,
         DrawRectPriv(im, area, radius, ellipse, fillBrush, linePen);
 
         im->IncrRef();
-        m_softwareCacheSize += im->GetSize();
-        m_stringToImageMap[incoming] = im;
-        m_stringExpireList.push_back(incoming);
+        m_stringImageCache.Insert(incoming, im, im->GetSize());
         ExpireImages(m_maxSoftwareCacheSize);
     }
     return im;
@@ -559,44 +541,47 @@ void MythPainter::CheckFormatImage(MythImage *im)
 
 void MythPainter::ExpireImages(int64_t max)
 {
-    bool recompute = false;
-    while (!m_stringExpireList.empty())
+    QString oldkey;
+    while (m_stringImageCache.Cost() >= max &&
+           m_stringImageCache.Oldest(&oldkey))
     {
-        if (m_softwareCacheSize < max)
-            break;
-
-        QString oldmsg = m_stringExpireList.front();
-        m_stringExpireList.pop_front();
-
-        QMap<QString, MythImage*>::iterator it =
-            m_stringToImageMap.find(oldmsg);
-        if (it == m_stringToImageMap.end())
-        {
-            recompute = true;
-            continue;
-        }
-        MythImage *oldim = *it;
-        it = m_stringToImageMap.erase(it);
-
+        MythImage *oldim = m_stringImageCache.Take(oldkey, max > 0);
         if (oldim)
-        {
-            m_softwareCacheSize -= oldim->GetSize();
-            if (m_softwareCacheSize < 0)
-            {
-                m_softwareCacheSize = 0;
-                recompute = true;
-            }
             oldim->DecrRef();
-        }
-    }
-    if (recompute)
-    {
-        m_softwareCacheSize = 0;
-        for (auto *img : qAsConst(m_stringToImageMap))
-            m_softwareCacheSize += img->GetSize();
     }
 }
 
+/// Draws Text on a dark background, bypassing the string image cache so
+/// that cache statistics are not skewed by displaying them.
+void MythPainter::DrawDebugText(const QRect Area, const QString &Text)
+{
+    if (Area.width() <= 0 || Area.height() <= 0)
+        return;
+
+    QImage image(Area.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(0, 0, 0, 160));
+
+    QPainter painter(&image);
+    QFont font("Droid Sans");
+    font.setPointSize(8);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    painter.drawText(QRect(QPoint(0, 0), Area.size()),
+                     Qt::AlignLeft | Qt::AlignTop, Text);
+    painter.end();
+
+    MythImage *im = GetFormatImage();
+    im->SetFileName("DrawDebugText");
+    im->Assign(image);
+    DrawImage(Area, im, QRect(QPoint(0, 0), Area.size()), 255);
+    im->DecrRef();
+}
+
+MythImageLRU::Stats MythPainter::GetStringCacheStats(void) const
+{
+    return m_stringImageCache.GetStats();
+}
+
 // the following assume graphics hardware operates natively at 32bpp
 void MythPainter::SetMaximumCacheSizes(int hardware, int software)
 {
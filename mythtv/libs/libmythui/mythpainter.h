@@ -14,6 +14,7 @@ class QRegion;
 class QPoint;
 class QColor;
 
+#include "mythimagelru.h"
 #include "mythuiexp.h"
 
 #include <list>
@@ -103,6 +104,8 @@ class MUI_PUBLIC MythPainter : public QObject
     bool ShowTypeNames(void) const { return m_showNames; }
 
     void SetMaximumCacheSizes(int hardware, int software);
+    MythImageLRU::Stats GetStringCacheStats(void) const;
+    void DrawDebugText(QRect Area, const QString &Text);
 
   protected:
     static void DrawTextPriv(MythImage *im, const QString &msg, int flags,
@@ -137,14 +140,12 @@ class MUI_PUBLIC MythPainter : public QObject
     int m_maxHardwareCacheSize  { 0 };
 
   private:
-    int64_t m_softwareCacheSize {0};
     int64_t m_maxSoftwareCacheSize {48LL * 1024 * 1024};
 
     QMutex           m_allocationLock;
     QSet<MythImage*> m_allocatedImages;
 
-    QMap<QString, MythImage *> m_stringToImageMap;
-    std::list<QString>         m_stringExpireList;
+    MythImageLRU m_stringImageCache;
 
     bool m_showBorders          {false};
     bool m_showNames            {false};
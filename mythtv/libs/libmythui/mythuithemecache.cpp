@@ -35,15 +35,11 @@ MythUIThemeCache::~MythUIThemeCache()
     PruneCacheDir(GetRemoteCacheDir());
     PruneCacheDir(GetThumbnailDir());
 
-    QMutableMapIterator<QString, MythImage *> i(m_imageCache);
-    while (i.hasNext())
+    for (auto * image : m_imageCache.TakeAll())
     {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
+        image->SetIsInCache(false);
+        image->DecrRef();
     }
-    m_cacheTrack.clear();
 
     delete m_imageThreadPool;
 }
@@ -62,17 +58,12 @@ void MythUIThemeCache::UpdateImageCache()
 {
     QMutexLocker locker(&m_cacheLock);
 
-    QMutableMapIterator<QString, MythImage *> i(m_imageCache);
-
-    while (i.hasNext())
+    for (auto * image : m_imageCache.TakeAll())
     {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
+        image->SetIsInCache(false);
+        image->DecrRef();
     }
 
-    m_cacheTrack.clear();
     m_cacheSize.fetchAndStoreOrdered(0);
 
     ClearOldImageCache();
@@ -279,11 +270,13 @@ MythImage* MythUIThemeCache::LoadCacheImage(QString File, const QString& Label,
 
         QMutexLocker locker(&m_cacheLock);
 
-        if (m_imageCache.contains(Label) &&
-            m_cacheTrack[Label] + kImageCacheTimeout > now)
+        SystemTime lastused;
+        if (m_imageCache.Peek(Label, &lastused) &&
+            lastused + kImageCacheTimeout > now)
         {
-            m_imageCache[Label]->IncrRef();
-            return m_imageCache[Label];
+            MythImage *image = m_imageCache.Get(Label, false);
+            image->IncrRef();
+            return image;
         }
     }
 
@@ -391,11 +384,11 @@ MythImage* MythUIThemeCache::GetImageFromCache(const QString& URL)
 {
     QMutexLocker locker(&m_cacheLock);
 
-    if (m_imageCache.contains(URL))
+    MythImage *image = m_imageCache.Get(URL);
+    if (image)
     {
-        m_cacheTrack[URL] = SystemClock::now();
-        m_imageCache[URL]->IncrRef();
-        return m_imageCache[URL];
+        image->IncrRef();
+        return image;
     }
 
     /*
@@ -424,56 +417,41 @@ MythImage *MythUIThemeCache::CacheImage(const QString& URL, MythImage* Image, bo
     }
 
     // delete the oldest cached images until we fall below threshold.
+    // Images still in use elsewhere can't be expired, they are moved to
+    // the front so each one is only looked at once per insertion.
     QMutexLocker locker(&m_cacheLock);
 
+    int remaining = m_imageCache.Count();
     while ((m_cacheSize.fetchAndAddOrdered(0) + Image->sizeInBytes()) >=
-           m_maxCacheSize.fetchAndAddOrdered(0) && !m_imageCache.empty())
+           m_maxCacheSize.fetchAndAddOrdered(0) && remaining-- > 0)
     {
-        QMap<QString, MythImage *>::iterator it = m_imageCache.begin();
-        auto oldestTime = SystemClock::now();
-        QString oldestKey = it.key();
-
-        int count = 0;
+        QString oldestKey;
+        MythImage *oldest = m_imageCache.Oldest(&oldestKey);
 
-        for (; it != m_imageCache.end(); ++it)
+        bool inuse = (oldest == Image) || (2 != oldest->IncrRef());
+        if (oldest != Image)
+            oldest->DecrRef();
+        if (inuse)
         {
-            if (m_cacheTrack[it.key()] < oldestTime)
-            {
-                if ((2 == it.value()->IncrRef()) && (it.value() != Image))
-                {
-                    oldestTime = m_cacheTrack[it.key()];
-                    oldestKey = it.key();
-                    count++;
-                }
-                it.value()->DecrRef();
-            }
+            m_imageCache.Touch(oldestKey);
+            continue;
         }
 
-        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +QString("%1 images are eligible for expiry").arg(count));
-        if (count > 0)
-        {
-            LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("Cache too big (%1), removing :%2:")
-                .arg(m_cacheSize.fetchAndAddOrdered(0) + Image->sizeInBytes())
-                .arg(oldestKey));
-
-            m_imageCache[oldestKey]->SetIsInCache(false);
-            m_imageCache[oldestKey]->DecrRef();
-            m_imageCache.remove(oldestKey);
-            m_cacheTrack.remove(oldestKey);
-        }
-        else
-        {
-            break;
-        }
-    }
+        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("Cache too big (%1), removing :%2:")
+            .arg(m_cacheSize.fetchAndAddOrdered(0) + Image->sizeInBytes())
+            .arg(oldestKey));
 
-    QMap<QString, MythImage *>::iterator it = m_imageCache.find(URL);
+        m_imageCache.Take(oldestKey, true);
+        oldest->SetIsInCache(false);
+        oldest->DecrRef();
+    }
 
-    if (it == m_imageCache.end())
+    MythImage *cached = m_imageCache.Peek(URL);
+    if (!cached)
     {
         Image->IncrRef();
-        m_imageCache[URL] = Image;
-        m_cacheTrack[URL] = SystemClock::now();
+        m_imageCache.Insert(URL, Image, Image->sizeInBytes());
+        cached = Image;
 
         Image->SetIsInCache(true);
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
@@ -482,22 +460,20 @@ MythImage *MythUIThemeCache::CacheImage(const QString& URL, MythImage* Image, bo
     }
 
     LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("MythUIHelper::CacheImage : Cache Count = :%1: size :%2:")
-        .arg(m_imageCache.count()).arg(m_cacheSize.fetchAndAddRelaxed(0)));
+        .arg(m_imageCache.Count()).arg(m_cacheSize.fetchAndAddRelaxed(0)));
 
-    return m_imageCache[URL];
+    return cached;
 }
 
 void MythUIThemeCache::RemoveFromCacheByURL(const QString& URL)
 {
     QMutexLocker locker(&m_cacheLock);
-    QMap<QString, MythImage *>::iterator it = m_imageCache.find(URL);
+    MythImage *image = m_imageCache.Take(URL);
 
-    if (it != m_imageCache.end())
+    if (image)
     {
-        m_imageCache[URL]->SetIsInCache(false);
-        m_imageCache[URL]->DecrRef();
-        m_imageCache.remove(URL);
-        m_cacheTrack.remove(URL);
+        image->SetIsInCache(false);
+        image->DecrRef();
     }
 
     QString dstfile = GetCacheDirByUrl(URL) + '/' + URL;
@@ -513,7 +489,7 @@ void MythUIThemeCache::RemoveFromCacheByFile(const QString& File)
     partialKey.replace('/', '-');
 
     m_cacheLock.lock();
-    QList<QString> m_imageCacheKeys = m_imageCache.keys();
+    QList<QString> m_imageCacheKeys = m_imageCache.Keys();
     m_cacheLock.unlock();
 
     for (it = m_imageCacheKeys.begin(); it != m_imageCacheKeys.end(); ++it)
@@ -548,7 +524,7 @@ void MythUIThemeCache::RemoveFromCacheByFile(const QString& File)
 bool MythUIThemeCache::IsImageInCache(const QString& URL)
 {
     QMutexLocker locker(&m_cacheLock);
-    if (m_imageCache.contains(URL))
+    if (m_imageCache.Contains(URL))
         return true;
     if (QFileInfo::exists(URL))
         return true;
@@ -572,3 +548,9 @@ MThreadPool* MythUIThemeCache::GetImageThreadPool()
     return m_imageThreadPool;
 }
 
+MythImageLRU::Stats MythUIThemeCache::GetImageCacheStats()
+{
+    QMutexLocker locker(&m_cacheLock);
+    return m_imageCache.GetStats();
+}
+
@@ -12,6 +12,7 @@
 // MythTV
 #include "libmythbase/mythchrono.h"
 #include "libmythui/mythimage.h"
+#include "libmythui/mythimagelru.h"
 
 enum ImageCacheMode
 {
@@ -41,6 +42,7 @@ class MUI_PUBLIC MythUIThemeCache
     void        IncludeInCacheSize(MythImage* Image);
     void        ExcludeFromCacheSize(MythImage* Image);
     MThreadPool* GetImageThreadPool();
+    MythImageLRU::Stats GetImageCacheStats();
 
   private:
     QString     GetCacheDirByUrl(const QString& URL);
@@ -50,8 +52,7 @@ class MUI_PUBLIC MythUIThemeCache
     void        RemoveCacheDir(const QString& Dir);
     static void PruneCacheDir(const QString& Dir);
 
-    QMap<QString, MythImage *> m_imageCache;
-    QMap<QString, SystemTime> m_cacheTrack;
+    MythImageLRU m_imageCache;
 #if QT_VERSION < QT_VERSION_CHECK(5,14,0)
     QMutex m_cacheLock                    { QMutex::Recursive };
 #else
@@ -0,0 +1,99 @@
+/*
+ *  Class TestMythImageLRU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <array>
+
+#include "test_mythimagelru.h"
+
+// The cache never dereferences its images, so plain addresses will do.
+static std::array<char,4> s_images {};
+static MythImage *image(int i)
+{
+    return reinterpret_cast<MythImage*>(&s_images[i]);
+}
+
+void TestMythImageLRU::test_order(void)
+{
+    MythImageLRU cache;
+    QString key;
+
+    QVERIFY(cache.Oldest(&key) == nullptr);
+
+    cache.Insert("a", image(0), 1);
+    cache.Insert("b", image(1), 1);
+    cache.Insert("c", image(2), 1);
+    QCOMPARE(cache.Oldest(&key), image(0));
+    QCOMPARE(key, QString("a"));
+
+    QCOMPARE(cache.Get("a"), image(0));
+    QCOMPARE(cache.Oldest(&key), image(1));
+
+    cache.Touch("b");
+    QCOMPARE(cache.Oldest(&key), image(2));
+
+    QCOMPARE(cache.Peek("c"), image(2));
+    QCOMPARE(cache.Oldest(&key), image(2));
+
+    QCOMPARE(cache.Take("c"), image(2));
+    QVERIFY(!cache.Contains("c"));
+    QCOMPARE(cache.Oldest(&key), image(0));
+    QCOMPARE(cache.Count(), 2);
+}
+
+void TestMythImageLRU::test_cost(void)
+{
+    MythImageLRU cache;
+
+    cache.Insert("a", image(0), 100);
+    cache.Insert("b", image(1), 250);
+    QCOMPARE(cache.Cost(), static_cast<int64_t>(350));
+
+    cache.Take("a");
+    QCOMPARE(cache.Cost(), static_cast<int64_t>(250));
+
+    cache.Insert("c", image(2), 50);
+    QList<MythImage*> all = cache.TakeAll();
+    QCOMPARE(all.size(), 2);
+    QVERIFY(all.contains(image(1)));
+    QVERIFY(all.contains(image(2)));
+    QCOMPARE(cache.Cost(), static_cast<int64_t>(0));
+    QCOMPARE(cache.Count(), 0);
+}
+
+void TestMythImageLRU::test_stats(void)
+{
+    MythImageLRU cache;
+
+    cache.Insert("a", image(0), 10);
+    cache.Insert("b", image(1), 20);
+    cache.Get("a");
+    cache.Get("a", false);
+    cache.Get("x");
+    cache.Peek("b");
+    cache.Take("b", true);
+    cache.Take("a");
+
+    MythImageLRU::Stats stats = cache.GetStats();
+    QCOMPARE(stats.m_count, 0);
+    QCOMPARE(stats.m_cost, static_cast<int64_t>(0));
+    QCOMPARE(stats.m_hits, 2ULL);
+    QCOMPARE(stats.m_misses, 1ULL);
+    QCOMPARE(stats.m_evictions, 1ULL);
+}
+
+QTEST_APPLESS_MAIN(TestMythImageLRU)
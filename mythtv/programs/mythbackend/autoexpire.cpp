@@ -828,10 +828,11 @@ void AutoExpire::PrintExpireList(const QString& expHost)
     ClearExpireList(expireList);
 }
 
-/** \fn AutoExpire::GetAllExpiring(QStringList&)
+/** \fn AutoExpire::GetAllExpiring(QStringList&, bool)
  *  \brief Gets the full list of programs that can expire in expiration order
+ *  \param binary Use the binary program list format of ProgramListWriter
  */
-void AutoExpire::GetAllExpiring(QStringList &strList)
+void AutoExpire::GetAllExpiring(QStringList &strList, bool binary)
 {
     QMutexLocker lockit(&m_instanceLock);
     pginfolist_t expireList;
@@ -846,8 +847,11 @@ void AutoExpire::GetAllExpiring(QStringList &strList)
 
     strList << QString::number(expireList.size());
 
-    for (auto & info : expireList)
-        info->ToStringList(strList);
+    {
+        ProgramListWriter writer(strList, binary);
+        for (auto & info : expireList)
+            writer.Add(*info);
+    }
 
     ClearExpireList(expireList);
 }
@@ -72,7 +72,7 @@ class AutoExpire : public QObject
 
     uint64_t GetDesiredSpace(int fsID) const;
 
-    void GetAllExpiring(QStringList &strList);
+    void GetAllExpiring(QStringList &strList, bool binary = false);
     void GetAllExpiring(pginfolist_t &list);
     static void ClearExpireList(pginfolist_t &expireList, bool deleteProg = true);
 
@@ -1,12 +1,17 @@
 // C++ headers
 #include <utility>
 
+// POSIX headers
+#include <fcntl.h>
+#include <unistd.h>
+
 // Qt headers
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
 
 // MythTV
+#include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythdate.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/mythsocket.h"
@@ -24,7 +29,22 @@ BEFileTransfer::BEFileTransfer(QString &filename, MythSocket *remote,
 {
     m_pginfo = new ProgramInfo(filename);
     m_pginfo->MarkAsInUse(true, kFileTransferInUseID);
-    if (m_rbuffer && m_rbuffer->IsOpen())
+    if (!m_rbuffer || !m_rbuffer->IsOpen())
+        return;
+
+    // A local file that is no longer being written can be sent straight
+    // from the page cache, anything else is read through the ringbuffer.
+    QFileInfo info(filename);
+    if (m_rbuffer->GetType() == kMythBufferFile && info.isFile() &&
+        !gCoreContext->IsRegisteredFileForWrite(filename) &&
+        MythDate::secsInPast(info.lastModified().toUTC()) > 60s)
+    {
+        m_sendfd = open(QFile::encodeName(filename).constData(), O_RDONLY);
+    }
+
+    if (m_sendfd >= 0)
+        LOG(VB_FILE, LOG_INFO, QString("Sending %1 with sendfile").arg(filename));
+    else
         m_rbuffer->Start();
 }
 
@@ -55,6 +75,9 @@ BEFileTransfer::~BEFileTransfer()
         m_rbuffer = nullptr;
     }
 
+    if (m_sendfd >= 0)
+        close(m_sendfd);
+
     if (m_pginfo)
     {
         m_pginfo->MarkAsInUse(false, kFileTransferInUseID);
@@ -137,6 +160,21 @@ int BEFileTransfer::RequestBlock(int size)
     while (m_readsLocked)
         m_readsUnlockedCond.wait(&m_lock, 100 /*ms*/);
 
+    if (m_sendfd >= 0)
+    {
+        if (!m_readthreadlive)
+            return -1;
+
+        tot = m_sock->SendFile(m_sendfd, m_sendpos, std::max(size,0));
+        if (tot > 0)
+            m_sendpos += tot;
+
+        if (m_pginfo)
+            m_pginfo->UpdateInUseMark();
+
+        return tot;
+    }
+
     m_requestBuffer.resize(std::max((size_t)std::max(size,0) + 128, m_requestBuffer.size()));
     char *buf = (m_requestBuffer).data();
     while (tot < size && !m_rbuffer->GetStopReads() && m_readthreadlive)
@@ -238,6 +276,24 @@ long long BEFileTransfer::Seek(long long curpos, long long pos, int whence)
 
     m_ateof = false;
 
+    if (m_sendfd >= 0)
+    {
+        QMutexLocker locker(&m_lock);
+
+        if (whence == SEEK_CUR)
+            pos += curpos;
+        else if (whence == SEEK_END)
+            pos += m_rbuffer->GetRealFileSize();
+        else if (whence != SEEK_SET)
+            return -1;
+
+        if (pos < 0)
+            return -1;
+
+        m_sendpos = pos;
+        return pos;
+    }
+
     Pause();
 
     if (whence == SEEK_CUR)
@@ -57,6 +57,11 @@ class BEFileTransfer : public ReferenceCounter
     MythSocket     *m_sock              {nullptr};
     bool            m_ateof             {false};
 
+    /// Descriptor a finished local file is sent from with
+    /// MythSocket::SendFile(), -1 if reads go through m_rbuffer.
+    int             m_sendfd            {-1};
+    long long       m_sendpos           {0};
+
     std::vector<char> m_requestBuffer;
 
     QMutex          m_lock;
@@ -534,6 +534,9 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     pbs->IncrRef();
     m_sockListLock.unlock();
 
+    // Clients that can read binary program lists say so after the command
+    bool binary = (listline.size() > 1) && (listline[1] == kProgramListBinary);
+
     if (command == "QUERY_FILETRANSFER")
     {
         if (tokens.size() != 2)
@@ -546,7 +549,7 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
         if (tokens.size() != 2)
             SendErrorResponse(pbs, "Bad QUERY_RECORDINGS query");
         else
-            HandleQueryRecordings(tokens[1], pbs);
+            HandleQueryRecordings(tokens[1], pbs, binary);
     }
     else if (command == "QUERY_RECORDING")
     {
@@ -687,15 +690,15 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     else if (command == "QUERY_GETALLPENDING")
     {
         if (tokens.size() == 1)
-            HandleGetPendingRecordings(pbs);
+            HandleGetPendingRecordings(pbs, binary);
         else if (tokens.size() == 2)
-            HandleGetPendingRecordings(pbs, tokens[1]);
+            HandleGetPendingRecordings(pbs, binary, tokens[1]);
         else
-            HandleGetPendingRecordings(pbs, tokens[1], tokens[2].toInt());
+            HandleGetPendingRecordings(pbs, binary, tokens[1], tokens[2].toInt());
     }
     else if (command == "QUERY_GETALLSCHEDULED")
     {
-        HandleGetScheduledRecordings(pbs);
+        HandleGetScheduledRecordings(pbs, binary);
     }
     else if (command == "QUERY_GETCONFLICTING")
     {
@@ -703,7 +706,7 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
     else if (command == "QUERY_GETEXPIRING")
     {
-        HandleGetExpiringRecordings(pbs);
+        HandleGetExpiringRecordings(pbs, binary);
     }
     else if (command == "QUERY_SG_GETFILELIST")
     {
@@ -2172,8 +2175,11 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
  * or "Descending".
  * Returns programinfo (title, subtitle, description, category, chanid,
  * channum, callsign, channel.name, fileURL, \e et \e cetera)
+ * If the request is followed by kProgramListBinary the programs are
+ * returned in the binary format written by ProgramListWriter.
  */
-void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
+void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs,
+                                       bool binary)
 {
     MythSocket *pbssock = pbs->getSocket();
     QString playbackhost = pbs->getHostname();
@@ -2204,6 +2210,7 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
         delete *mit;
 
     QStringList outputlist(QString::number(destination.size()));
+    ProgramListWriter writer(outputlist, binary);
     QMap<QString, int> backendPortMap;
     int port = gCoreContext->GetBackendServerPort();
     QString host = gCoreContext->GetHostName();
@@ -2289,8 +2296,9 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
         if (slave)
             slave->DecrRef();
 
-        proginfo->ToStringList(outputlist);
+        writer.Add(*proginfo);
     }
+    writer.Flush();
 
     SendResponse(pbssock, outputlist);
 }
@@ -2508,6 +2516,7 @@ void MainServer::DoDeleteThread(DeleteStruct *ds)
     nameFilters.push_back(fInfo.fileName() + ".old");
     nameFilters.push_back(fInfo.fileName() + ".map");
     nameFilters.push_back(fInfo.fileName() + ".tmp.map");
+    nameFilters.push_back(fInfo.fileName() + ".seekidx");
     nameFilters.push_back(fInfo.baseName() + ".srt");  // e.g. 1234_20150213165800.srt
 
     QDir dir (fInfo.path());
@@ -3829,7 +3838,7 @@ void MainServer::HandleQueryGuideDataThrough(PlaybackSock *pbs)
     SendResponse(pbssock, strlist);
 }
 
-void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
+void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs, bool binary,
                                             const QString& tmptable, int recordid)
 {
     MythSocket *pbssock = pbs->getSocket();
@@ -3839,12 +3848,12 @@ void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
     if (m_sched)
     {
         if (tmptable.isEmpty())
-            m_sched->GetAllPending(strList);
+            m_sched->GetAllPending(strList, binary);
         else
         {
             auto *sched = new Scheduler(false, m_encoderList, tmptable, m_sched);
             sched->FillRecordListFromDB(recordid);
-            sched->GetAllPending(strList);
+            sched->GetAllPending(strList, binary);
             delete sched;
 
             if (recordid > 0)
@@ -3881,14 +3890,15 @@ void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
     SendResponse(pbssock, strList);
 }
 
-void MainServer::HandleGetScheduledRecordings(PlaybackSock *pbs)
+void MainServer::HandleGetScheduledRecordings(PlaybackSock *pbs, bool binary)
 {
     MythSocket *pbssock = pbs->getSocket();
 
     QStringList strList;
 
     if (m_sched)
-        Scheduler::GetAllScheduled(strList);
+        Scheduler::GetAllScheduled(strList, Scheduler::kSortTitle, true,
+                                   binary);
     else
         strList << QString::number(0);
 
@@ -3913,14 +3923,14 @@ void MainServer::HandleGetConflictingRecordings(QStringList &slist,
     SendResponse(pbssock, strlist);
 }
 
-void MainServer::HandleGetExpiringRecordings(PlaybackSock *pbs)
+void MainServer::HandleGetExpiringRecordings(PlaybackSock *pbs, bool binary)
 {
     MythSocket *pbssock = pbs->getSocket();
 
     QStringList strList;
 
     if (m_expirer)
-        m_expirer->GetAllExpiring(strList);
+        m_expirer->GetAllExpiring(strList, binary);
     else
         strList << QString::number(0);
 
@@ -176,7 +176,8 @@ class MainServer : public QObject, public MythSocketCBs
     bool HandleDeleteFile(const QStringList &slist, PlaybackSock *pbs);
     bool HandleDeleteFile(const QString& filename, const QString& storagegroup,
                           PlaybackSock *pbs = nullptr);
-    void HandleQueryRecordings(const QString& type, PlaybackSock *pbs);
+    void HandleQueryRecordings(const QString& type, PlaybackSock *pbs,
+                               bool binary);
     void HandleQueryRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleStopRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleStopRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
@@ -202,10 +203,11 @@ class MainServer : public QObject, public MythSocketCBs
     void HandleQueryFindFile(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryFileHash(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryGuideDataThrough(PlaybackSock *pbs);
-    void HandleGetPendingRecordings(PlaybackSock *pbs, const QString& table = "", int recordid=-1);
-    void HandleGetScheduledRecordings(PlaybackSock *pbs);
+    void HandleGetPendingRecordings(PlaybackSock *pbs, bool binary,
+                                    const QString& table = "", int recordid=-1);
+    void HandleGetScheduledRecordings(PlaybackSock *pbs, bool binary);
     void HandleGetConflictingRecordings(QStringList &slist, PlaybackSock *pbs);
-    void HandleGetExpiringRecordings(PlaybackSock *pbs);
+    void HandleGetExpiringRecordings(PlaybackSock *pbs, bool binary);
     void HandleSGGetFileList(QStringList &sList, PlaybackSock *pbs);
     void HandleSGFileQuery(QStringList &sList, PlaybackSock *pbs);
     void HandleGetFreeInputInfo(PlaybackSock *pbs, uint excluded_input);
@@ -24,6 +24,7 @@
 #include <QString>
 #include <QMutex>
 #include <QFile>
+#include <QHash>
 #include <QMap>
 
 // MythTV
@@ -462,8 +463,15 @@ bool Scheduler::FillRecordList(void)
     std::stable_sort(m_workList.begin(), m_workList.end(), comp_priority);
     LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
     BuildListMaps();
+    LOG(VB_SCHEDULE, LOG_INFO, "RestorePlacements...");
+    RestorePlacements();
     LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
+    auto placestart = nowAsDuration<std::chrono::microseconds>();
     SchedNewRecords();
+    m_schedNewRecordsTime =
+        nowAsDuration<std::chrono::microseconds>() - placestart;
+    LOG(VB_SCHEDULE, LOG_INFO, "SavePlacements...");
+    SavePlacements();
     LOG(VB_SCHEDULE, LOG_INFO, "SchedLiveTV...");
     SchedLiveTV();
     LOG(VB_SCHEDULE, LOG_INFO, "ClearListMaps...");
@@ -1058,6 +1066,342 @@ void Scheduler::ClearListMaps(void)
     m_cacheIsSameProgram.clear();
 }
 
+// Showings that take part in placement, see BuildListMaps().
+static bool is_placeable(const RecordingInfo *p)
+{
+    return (p->GetRecordingStatus() == RecStatus::Recording ||
+            p->GetRecordingStatus() == RecStatus::Tuning ||
+            p->GetRecordingStatus() == RecStatus::Failing ||
+            p->GetRecordingStatus() == RecStatus::WillRecord ||
+            p->GetRecordingStatus() == RecStatus::Pending ||
+            p->GetRecordingStatus() == RecStatus::Unknown);
+}
+
+static QString placement_key(const RecordingInfo *p)
+{
+    return QString("%1:%2:%3:%4")
+        .arg(p->GetRecordingRuleID()).arg(p->GetChanID())
+        .arg(p->GetScheduledStartTime().toSecsSinceEpoch())
+        .arg(p->GetInputID());
+}
+
+// Everything SchedNewRecords() and the sorts before it look at.  Two
+// showings with the same signature are placed the same way provided
+// everything they can interact with is unchanged too.
+static size_t placement_signature(const RecordingInfo *p,
+                                  const QDateTime &schedtime,
+                                  const QDateTime &pasttime)
+{
+    QString sig = QString("%1|%2|%3|%4|%5|%6|%7|%8|%9")
+        .arg(p->GetRecordingStartTime().toSecsSinceEpoch())
+        .arg(p->GetRecordingEndTime().toSecsSinceEpoch())
+        .arg(p->GetRecordingPriority())
+        .arg(p->GetRecordingPriority2())
+        .arg(p->m_schedOrder)
+        .arg(p->m_mplexId)
+        .arg(p->m_sgroupId)
+        .arg(static_cast<int>(p->GetRecordingStatus()))
+        .arg(static_cast<int>(p->GetRecordingRuleType()));
+    sig += QString("|%1|%2|%3|%4|%5|%6|%7|%8")
+        .arg(p->GetParentRecordingRuleID())
+        .arg(p->GetFindID())
+        .arg(static_cast<int>(p->GetDuplicateCheckMethod()))
+        .arg(static_cast<int>(p->GetCategoryType()))
+        .arg(static_cast<int>(p->IsReactivated()))
+        .arg(static_cast<int>(p->GetRecordingStartTime() < schedtime))
+        .arg(static_cast<int>(p->GetRecordingStartTime() < pasttime))
+        .arg(p->GetProgramID());
+    sig += QChar('|') + p->GetTitle() + QChar('|') + p->GetSubtitle() +
+        QChar('|') + p->GetDescription();
+    return qHash(sig);
+}
+
+static size_t placement_root(std::vector<size_t> &parent, size_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static void placement_union(std::vector<size_t> &parent, size_t a, size_t b)
+{
+    a = placement_root(parent, a);
+    b = placement_root(parent, b);
+    if (a != b)
+        parent[std::max(a, b)] = std::min(a, b);
+}
+
+void Scheduler::InvalidatePlacements(void)
+{
+    m_placementCache.clear();
+    m_placementValid = false;
+}
+
+/** \brief Reuse the previous placement for showings a change can't reach.
+ *
+ *  The showings in the list maps form a graph.  Two showings are
+ *  connected when they share a title or a recording rule, or when
+ *  they overlap (or touch) in time on the same conflict list.  These
+ *  are the only ways FindConflict(), MarkOtherShowings() and
+ *  TryAnotherShowing() let one showing influence another.  Every
+ *  connected component that contains a new, changed or removed
+ *  showing is placed again by SchedNewRecords().  All other showings
+ *  get their previous status back and are left alone.
+ *
+ *  A full placement is done when "SchedIncremental" is off, when the
+ *  inputs or "SchedOpenEnd" have changed, when the last full placement
+ *  is more than an hour old, or when the change reaches more than half
+ *  of the showings.
+ *
+ *  \return Number of showings whose placement was reused.
+ */
+uint Scheduler::RestorePlacements(void)
+{
+    static constexpr int64_t kFullPlacementInterval { 60LL * 60 };
+
+    m_placementItems.clear();
+    m_frozenPlacements.clear();
+    m_parkedPlacements.clear();
+
+    if (m_specSched ||
+        !gCoreContext->GetBoolSetting("SchedIncremental", false))
+    {
+        InvalidatePlacements();
+        return 0;
+    }
+
+    QDateTime pasttime = MythDate::current().addSecs(-30);
+    for (auto *p : m_workList)
+    {
+        if (!is_placeable(p) || !m_sinputInfoMap[p->GetInputID()].m_conflictList)
+            continue;
+        m_placementItems.push_back(
+            { p, placement_key(p),
+              placement_signature(p, m_schedTime, pasttime) });
+    }
+
+    auto openEnd = (OpenEndType)gCoreContext->GetNumSetting("SchedOpenEnd",
+                                                            openEndNever);
+    if (!m_placementValid || openEnd != m_placementOpenEnd ||
+        !m_lastFullPlacement.isValid() ||
+        m_lastFullPlacement.secsTo(m_schedTime) > kFullPlacementInterval)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, "Full placement");
+        return 0;
+    }
+
+    size_t count = m_placementItems.size();
+    std::vector<bool> dirty(count, false);
+    QSet<QString> dirtyTitles;
+    QSet<uint> dirtyRules;
+    struct DirtyWindow
+    {
+        const RecList *m_list;
+        QDateTime      m_start;
+        QDateTime      m_end;
+    };
+    std::vector<DirtyWindow> dirtyWindows;
+
+    // Whatever a changed or removed showing used to be connected to
+    // has to be placed again as well.
+    auto markOld = [&](const SchedPlacement &old)
+    {
+        dirtyTitles.insert(old.m_title);
+        dirtyRules.insert(old.m_recordId);
+        if (old.m_parentId)
+            dirtyRules.insert(old.m_parentId);
+        auto it = m_sinputInfoMap.constFind(old.m_inputId);
+        if (it != m_sinputInfoMap.constEnd() && (*it).m_conflictList)
+            dirtyWindows.push_back({ (*it).m_conflictList,
+                                     old.m_startTime, old.m_endTime });
+    };
+
+    QSet<QString> seen;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const PlacementItem &item = m_placementItems[i];
+        seen.insert(item.m_key);
+        auto it = m_placementCache.constFind(item.m_key);
+        if (it == m_placementCache.constEnd())
+        {
+            dirty[i] = true;
+        }
+        else if ((*it).m_signature != item.m_signature)
+        {
+            dirty[i] = true;
+            markOld(*it);
+        }
+    }
+    for (auto it = m_placementCache.cbegin();
+         it != m_placementCache.cend(); ++it)
+    {
+        if (!seen.contains(it.key()))
+            markOld(*it);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const RecordingInfo *p = m_placementItems[i].m_info;
+        if (dirty[i])
+            continue;
+        if (dirtyTitles.contains(p->GetTitle().toLower()) ||
+            dirtyRules.contains(p->GetRecordingRuleID()) ||
+            (p->GetParentRecordingRuleID() &&
+             dirtyRules.contains(p->GetParentRecordingRuleID())))
+        {
+            dirty[i] = true;
+            continue;
+        }
+        const RecList *list = m_sinputInfoMap[p->GetInputID()].m_conflictList;
+        for (const auto &w : dirtyWindows)
+        {
+            if (w.m_list == list &&
+                p->GetRecordingStartTime() <= w.m_end &&
+                p->GetRecordingEndTime() >= w.m_start)
+            {
+                dirty[i] = true;
+                break;
+            }
+        }
+    }
+
+    // Connect the showings into components.
+    std::vector<size_t> parent(count);
+    for (size_t i = 0; i < count; ++i)
+        parent[i] = i;
+
+    QHash<QString, size_t> byTitle;
+    QHash<uint, size_t> byRule;
+    QHash<const RecList *, std::vector<size_t> > byList;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const RecordingInfo *p = m_placementItems[i].m_info;
+        auto t = byTitle.constFind(p->GetTitle().toLower());
+        if (t == byTitle.constEnd())
+            byTitle.insert(p->GetTitle().toLower(), i);
+        else
+            placement_union(parent, i, *t);
+
+        for (uint ruleid : { p->GetRecordingRuleID(),
+                             p->GetParentRecordingRuleID() })
+        {
+            if (!ruleid)
+                continue;
+            auto r = byRule.constFind(ruleid);
+            if (r == byRule.constEnd())
+                byRule.insert(ruleid, i);
+            else
+                placement_union(parent, i, *r);
+        }
+
+        byList[m_sinputInfoMap[p->GetInputID()].m_conflictList].push_back(i);
+    }
+
+    for (auto &list : byList)
+    {
+        std::sort(list.begin(), list.end(),
+                  [this](size_t a, size_t b)
+                  {
+                      return m_placementItems[a].m_info->GetRecordingStartTime() <
+                          m_placementItems[b].m_info->GetRecordingStartTime();
+                  });
+        QDateTime maxEnd;
+        size_t anchor = 0;
+        for (size_t i : list)
+        {
+            const RecordingInfo *p = m_placementItems[i].m_info;
+            if (maxEnd.isValid() && p->GetRecordingStartTime() <= maxEnd)
+                placement_union(parent, i, anchor);
+            else
+                anchor = i;
+            if (!maxEnd.isValid() || p->GetRecordingEndTime() > maxEnd)
+                maxEnd = p->GetRecordingEndTime();
+        }
+    }
+
+    QSet<size_t> dirtyRoots;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (dirty[i])
+            dirtyRoots.insert(placement_root(parent, i));
+    }
+
+    size_t affected = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (dirtyRoots.contains(placement_root(parent, i)))
+            ++affected;
+    }
+
+    if (affected * 2 > count)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO,
+            QString("Full placement, %1 of %2 showings affected")
+            .arg(affected).arg(count));
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (dirtyRoots.contains(placement_root(parent, i)))
+            continue;
+        RecordingInfo *p = m_placementItems[i].m_info;
+        RecStatus::Type status =
+            m_placementCache.value(m_placementItems[i].m_key).m_status;
+        // Keep unplaced showings away from SchedNewRecords() until
+        // SavePlacements() hands them back to SchedLiveTV().
+        if (status == RecStatus::Unknown)
+        {
+            status = RecStatus::Conflict;
+            m_parkedPlacements.push_back(p);
+        }
+        p->SetRecordingStatus(status);
+        m_frozenPlacements.insert(p);
+    }
+
+    LOG(VB_SCHEDULE, LOG_INFO,
+        QString("Incremental placement, %1 of %2 showings affected")
+        .arg(affected).arg(count));
+
+    return count - affected;
+}
+
+/** \brief Remember the outcome of SchedNewRecords() for
+ *         RestorePlacements().
+ */
+void Scheduler::SavePlacements(void)
+{
+    for (auto *p : m_parkedPlacements)
+        p->SetRecordingStatus(RecStatus::Unknown);
+
+    if (m_frozenPlacements.isEmpty())
+        m_lastFullPlacement = m_schedTime;
+
+    m_placementCache.clear();
+    for (const auto &item : m_placementItems)
+    {
+        const RecordingInfo *p = item.m_info;
+        SchedPlacement &placement = m_placementCache[item.m_key];
+        placement.m_signature = item.m_signature;
+        placement.m_status    = p->GetRecordingStatus();
+        placement.m_title     = p->GetTitle().toLower();
+        placement.m_recordId  = p->GetRecordingRuleID();
+        placement.m_parentId  = p->GetParentRecordingRuleID();
+        placement.m_inputId   = p->GetInputID();
+        placement.m_startTime = p->GetRecordingStartTime();
+        placement.m_endTime   = p->GetRecordingEndTime();
+    }
+    m_placementValid = !m_placementItems.empty();
+    m_placementOpenEnd = m_openEnd;
+
+    m_placementItems.clear();
+    m_frozenPlacements.clear();
+    m_parkedPlacements.clear();
+}
+
 bool Scheduler::IsSameProgram(
     const RecordingInfo *a, const RecordingInfo *b) const
 {
@@ -1389,6 +1733,15 @@ void Scheduler::SchedNewRecords(void)
     m_openEnd =
         (OpenEndType)gCoreContext->GetNumSetting("SchedOpenEnd", openEndNever);
 
+    // Showings restored by RestorePlacements() already carry their
+    // final status, only their start times are of interest here.
+    for (const auto *p : qAsConst(m_frozenPlacements))
+    {
+        if (p->GetRecordingStatus() == RecStatus::WillRecord &&
+            p->GetRecordingStartTime() < m_livetvTime)
+            m_livetvTime = p->GetRecordingStartTime();
+    }
+
     auto i = m_workList.begin();
     for ( ; i != m_workList.end(); ++i)
     {
@@ -1396,7 +1749,8 @@ void Scheduler::SchedNewRecords(void)
             (*i)->GetRecordingStatus() != RecStatus::Tuning &&
             (*i)->GetRecordingStatus() != RecStatus::Pending)
             break;
-        MarkOtherShowings(*i);
+        if (!m_frozenPlacements.contains(*i))
+            MarkOtherShowings(*i);
     }
 
     while (i != m_workList.end())
@@ -1823,6 +2177,13 @@ RecStatus::Type Scheduler::GetRecStatus(const ProgramInfo &pginfo)
 }
 
 void Scheduler::GetAllPending(QStringList &strList) const
+{
+    GetAllPending(strList, false);
+}
+
+/// Returns all pending programs serialized into a QStringList, in the
+/// binary program list format if \p binary is set.
+void Scheduler::GetAllPending(QStringList &strList, bool binary) const
 {
     RecList retlist;
     bool hasconflicts = GetAllPending(retlist);
@@ -1830,10 +2191,11 @@ void Scheduler::GetAllPending(QStringList &strList) const
     strList << QString::number(static_cast<int>(hasconflicts));
     strList << QString::number(retlist.size());
 
+    ProgramListWriter writer(strList, binary);
     while (!retlist.empty())
     {
         RecordingInfo *p = retlist.front();
-        p->ToStringList(strList);
+        writer.Add(*p);
         delete p;
         retlist.pop_front();
     }
@@ -1841,7 +2203,7 @@ void Scheduler::GetAllPending(QStringList &strList) const
 
 /// Returns all scheduled programs serialized into a QStringList
 void Scheduler::GetAllScheduled(QStringList &strList, SchedSortColumn sortBy,
-                                bool ascending)
+                                bool ascending, bool binary)
 {
     RecList schedlist;
 
@@ -1849,10 +2211,11 @@ void Scheduler::GetAllScheduled(QStringList &strList, SchedSortColumn sortBy,
 
     strList << QString::number(schedlist.size());
 
+    ProgramListWriter writer(strList, binary);
     while (!schedlist.empty())
     {
         RecordingInfo *pginfo = schedlist.front();
-        pginfo->ToStringList(strList);
+        writer.Add(*pginfo);
         delete pginfo;
         schedlist.pop_front();
     }
@@ -5825,6 +6188,8 @@ bool Scheduler::CreateConflictLists(void)
 
 bool Scheduler::InitInputInfoMap(void)
 {
+    InvalidatePlacements();
+
     // Cache some input related info so we don't have to keep
     // rereading it from the database.
     MSqlQuery query(MSqlQuery::InitCon());
@@ -5873,6 +6238,8 @@ void Scheduler::AddChildInput(uint parentid, uint childid)
         QString("AddChildInput: Handling parent = %1, input = %2")
         .arg(parentid).arg(childid));
 
+    InvalidatePlacements();
+
     // This code should stay substantially similar to that above in
     // InitInputInfoMap().
     SchedInputInfo &siinfo = m_sinputInfoMap[childid];
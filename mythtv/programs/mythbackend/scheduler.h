@@ -10,6 +10,7 @@
 #include <QObject>
 #include <QString>
 #include <QMutex>
+#include <QHash>
 #include <QMap>
 #include <QSet>
 
@@ -44,6 +45,8 @@ class SchedInputInfo
 
 class Scheduler : public MThread, public MythScheduler
 {
+    friend class BenchScheduler;
+
   public:
     Scheduler(bool runthread, QMap<int, EncoderLink *> *_tvList,
               const QString& tmptable = "record", Scheduler *master_sched = nullptr);
@@ -80,6 +83,7 @@ class Scheduler : public MThread, public MythScheduler
     bool GetAllPending(RecList &retList, int recRuleId = 0) const;
     bool GetAllPending(ProgramList &retList, int recRuleId = 0) const;
     void GetAllPending(QStringList &strList) const override; // MythScheduler
+    void GetAllPending(QStringList &strList, bool binary) const;
     QMap<QString,ProgramInfo*> GetRecording(void) const override; // MythScheduler
     RecordingInfo* GetRecording(uint recordedid) const;
 
@@ -87,7 +91,7 @@ class Scheduler : public MThread, public MythScheduler
                            kSortPriority, kSortType };
     static void GetAllScheduled(QStringList &strList,
                                 SchedSortColumn sortBy = kSortTitle,
-                                bool ascending = true);
+                                bool ascending = true, bool binary = false);
     static void GetAllScheduled(RecList &proglist,
                                 SchedSortColumn sortBy = kSortTitle,
                                 bool ascending = true);
@@ -153,6 +157,9 @@ class Scheduler : public MThread, public MythScheduler
     void PruneOverlaps(void);
     void BuildListMaps(void);
     void ClearListMaps(void);
+    uint RestorePlacements(void);
+    void SavePlacements(void);
+    void InvalidatePlacements(void);
 
     bool IsBusyRecording(const RecordingInfo *rcinfo);
 
@@ -281,12 +288,43 @@ class Scheduler : public MThread, public MythScheduler
     // Try to avoid LiveTV sessions until this time
     QDateTime m_livetvTime;
 
+    // Time spent in SchedNewRecords() by the last FillRecordList()
+    std::chrono::microseconds m_schedNewRecordsTime {0us};
+
     QDateTime m_lastPrepareTime;
     // Delay shutdown util this time (ms since epoch);
     std::chrono::milliseconds m_delayShutdownTime        {0ms};
 
     OpenEndType m_openEnd { openEndNever };
 
+    // Incremental placement.  The outcome of the previous
+    // SchedNewRecords() for every showing that took part in it, keyed
+    // by recordid/chanid/starttime/inputid.
+    struct SchedPlacement
+    {
+        size_t          m_signature {0};
+        RecStatus::Type m_status    {RecStatus::Unknown};
+        QString         m_title;
+        uint            m_recordId  {0};
+        uint            m_parentId  {0};
+        uint            m_inputId   {0};
+        QDateTime       m_startTime;
+        QDateTime       m_endTime;
+    };
+    struct PlacementItem
+    {
+        RecordingInfo  *m_info      {nullptr};
+        QString         m_key;
+        size_t          m_signature {0};
+    };
+    QHash<QString, SchedPlacement> m_placementCache;
+    std::vector<PlacementItem> m_placementItems;
+    QSet<const RecordingInfo *> m_frozenPlacements;
+    RecList m_parkedPlacements;
+    QDateTime m_lastFullPlacement;
+    OpenEndType m_placementOpenEnd { openEndNever };
+    bool m_placementValid              {false};
+
     // cache IsSameProgram()
     using IsSameKey = std::pair<const RecordingInfo*,const RecordingInfo*>;
     using IsSameCacheType = QMap<IsSameKey,bool>;
@@ -136,6 +136,34 @@ class V2Job : public QObject
 Q_DECLARE_METATYPE(V2Job*)
 
 
+/// Live fill level and counters of one tuner's device read buffer.
+class V2DeviceBuffer : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "Version", "1.0" );
+
+    SERVICE_PROPERTY2( QString   , Device          )
+    SERVICE_PROPERTY2( quint64   , Size            )
+    SERVICE_PROPERTY2( quint64   , Used            )
+    SERVICE_PROPERTY2( quint64   , MaxUsed         )
+    SERVICE_PROPERTY2( quint64   , BytesIn         )
+    SERVICE_PROPERTY2( quint64   , BytesOut        )
+    SERVICE_PROPERTY2( quint64   , DeviceReads     )
+    SERVICE_PROPERTY2( quint64   , BufferReads     )
+    SERVICE_PROPERTY2( quint64   , FullCount       )
+    SERVICE_PROPERTY2( quint64   , DriverOverflows )
+    SERVICE_PROPERTY2( quint64   , Discarded       )
+
+    public:
+        Q_INVOKABLE V2DeviceBuffer(QObject *parent = nullptr)
+            : QObject( parent )
+        {
+        }
+    private:
+        Q_DISABLE_COPY(V2DeviceBuffer);
+};
+Q_DECLARE_METATYPE(V2DeviceBuffer*)
+
 class V2BackendStatus : public QObject
 {
     Q_OBJECT
@@ -146,6 +174,7 @@ class V2BackendStatus : public QObject
     Q_CLASSINFO( "Frontends", "type=V2Frontend")
     Q_CLASSINFO( "Backends", "type=V2Backend")
     Q_CLASSINFO( "JobQueue", "type=V2Job")
+    Q_CLASSINFO( "DeviceBuffers", "type=V2DeviceBuffer")
     Q_CLASSINFO( "AsOf"    , "transient=true"   )
 
     SERVICE_PROPERTY2( QDateTime   , AsOf            )
@@ -156,6 +185,7 @@ class V2BackendStatus : public QObject
     SERVICE_PROPERTY2( QVariantList, Frontends )
     SERVICE_PROPERTY2( QVariantList, Backends  )
     SERVICE_PROPERTY2( QVariantList, JobQueue      )
+    SERVICE_PROPERTY2( QVariantList, DeviceBuffers )
     Q_PROPERTY( QObject*  MachineInfo    READ MachineInfo     USER true)
     SERVICE_PROPERTY_PTR(V2MachineInfo, MachineInfo     )
     SERVICE_PROPERTY2( QString     , Miscellaneous        )
@@ -191,6 +221,15 @@ class V2BackendStatus : public QObject
             return pObject;
         }
 
+        V2DeviceBuffer *AddNewDeviceBuffer()
+        {
+            // We must make sure the object added to the QVariantList has
+            // a parent of 'this'
+            auto *pObject = new V2DeviceBuffer( this );
+            m_DeviceBuffers.append( QVariant::fromValue<QObject *>( pObject ));
+            return pObject;
+        }
+
 
     private:
         Q_DISABLE_COPY(V2BackendStatus);
@@ -36,6 +36,7 @@
 #include "libmythbase/mythversion.h"
 #include "libmythtv/cardutil.h"
 #include "libmythtv/jobqueue.h"
+#include "libmythtv/recorders/DeviceReadBuffer.h"
 #include "libmythtv/tv.h"
 #include "libmythtv/tv_rec.h"
 #include "libmythupnp/upnp.h"
@@ -72,6 +73,7 @@ void V2Status::RegisterCustomTypes()
     qRegisterMetaType<V2CastMember*>("V2CastMember");
     qRegisterMetaType<V2Input*>("V2Input");
     qRegisterMetaType<V2Backend*>("V2Backend");
+    qRegisterMetaType<V2DeviceBuffer*>("V2DeviceBuffer");
 }
 
 V2Status::V2Status () : MythHTTPService(s_service)
@@ -241,6 +243,24 @@ V2BackendStatus*  V2Status::GetBackendStatus()
         V2FillProgramInfo( pProgram, &pginfo, true, false, false);
     }
 
+    // Device read buffers of the local tuners
+    const QList<DeviceReadBufferStats> drbStats = DeviceReadBuffer::GetAllStats();
+    for (const auto & stats : drbStats)
+    {
+        V2DeviceBuffer *pBuffer = pStatus->AddNewDeviceBuffer();
+        pBuffer->setDevice(stats.m_device);
+        pBuffer->setSize(stats.m_size);
+        pBuffer->setUsed(stats.m_used);
+        pBuffer->setMaxUsed(stats.m_maxUsed);
+        pBuffer->setBytesIn(stats.m_bytesIn);
+        pBuffer->setBytesOut(stats.m_bytesOut);
+        pBuffer->setDeviceReads(stats.m_deviceReads);
+        pBuffer->setBufferReads(stats.m_bufferReads);
+        pBuffer->setFullCount(stats.m_fullCount);
+        pBuffer->setDriverOverflows(stats.m_driverOverflows);
+        pBuffer->setDiscarded(stats.m_discarded);
+    }
+
     // Machine Info
     V2MachineInfo *pMachineInfo = pStatus->MachineInfo();
     FillDriveSpace(pMachineInfo);
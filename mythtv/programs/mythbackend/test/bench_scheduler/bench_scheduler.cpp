@@ -0,0 +1,459 @@
+/*
+ *  Class BenchScheduler
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+// The scheduler is benchmarked against a scratch MySQL database,
+// because the matching queries are MySQL specific.  Nothing is run
+// unless one is named in the environment, and its name repeated to
+// confirm that its contents may be thrown away:
+//
+//   MYTHBENCH_DBNAME   scratch database (required, never mythconverg)
+//   MYTHBENCH_WIPE_DB  must be set to the same name (required)
+//   MYTHBENCH_DBHOST   default localhost
+//   MYTHBENCH_DBUSER   default mythtv
+//   MYTHBENCH_DBPASS   default mythtv
+//   MYTHBENCH_RUNS     default 3
+//
+// The guide, input and rule tables in that database are replaced
+// with synthetic data, sized by MYTHBENCH_CHANNELS, MYTHBENCH_DAYS,
+// MYTHBENCH_RULES, MYTHBENCH_INPUTS and MYTHBENCH_INPUTGROUPS.  A
+// database that holds recordings or video sources other than the
+// benchmark's own is never touched.
+
+#include <iostream>
+#include <random>
+#include <utility>
+
+#include <QDateTime>
+#include <QSqlDatabase>
+
+#include "libmythbase/mythchrono.h"
+#include "libmythbase/mythcorecontext.h"
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythdb.h"
+#include "libmythbase/mythdbparams.h"
+#include "libmythtv/dbcheck.h"
+#include "libmythtv/tv_rec.h"
+
+#include "encoderlink.h"
+#include "scheduler.h"
+
+#include "bench_scheduler.h"
+
+static constexpr char const * const TESTVERSION = "bench_scheduler_1.0";
+
+// Fixed seed, so that runs on different trees see the same schedule.
+static constexpr uint kBenchSeed { 20221017 };
+
+// Rows per multi-row INSERT.
+static constexpr int kBatchRows { 500 };
+
+static int bench_env(const char *name, int defval)
+{
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return (ok && value > 0) ? value : defval;
+}
+
+static QString bench_env(const char *name, const QString &defval)
+{
+    QString value = qEnvironmentVariable(name);
+    return value.isEmpty() ? defval : value;
+}
+
+static QString bench_secs(std::chrono::microseconds t, int precision)
+{
+    return QString::number(std::chrono::duration_cast<floatsecs>(t).count(), 'f',
+                           precision);
+}
+
+// Run a list of statements, stopping at the first error.
+static bool bench_exec(const QStringList &statements)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    for (const auto &statement : statements)
+    {
+        if (!query.exec(statement))
+        {
+            MythDB::DBError("BenchScheduler", query);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Collects rows and writes them as multi-row INSERTs.
+class BenchInserter
+{
+  public:
+    explicit BenchInserter(QString prefix) : m_prefix(std::move(prefix)) {}
+    ~BenchInserter() { flush(); }
+
+    void add(const QString &row)
+    {
+        m_rows.push_back(row);
+        if (m_rows.size() >= kBatchRows)
+            flush();
+    }
+
+    bool flush(void)
+    {
+        if (m_rows.isEmpty())
+            return true;
+        bool ok = bench_exec({ m_prefix + m_rows.join(",") });
+        m_rows.clear();
+        m_ok = m_ok && ok;
+        return m_ok;
+    }
+
+  private:
+    QString     m_prefix;
+    QStringList m_rows;
+    bool        m_ok {true};
+};
+
+static QString bench_quote(const QString &value)
+{
+    QString escaped = value;
+    escaped.replace('\\', "\\\\").replace('\'', "\\'");
+    return QString("'%1'").arg(escaped);
+}
+
+static QString bench_time(const QDateTime &dt)
+{
+    return bench_quote(dt.toUTC().toString("yyyy-MM-dd HH:mm:ss"));
+}
+
+// Returns why the database looks like a real one, or an empty string
+// if it is empty or only holds data from earlier benchmark runs.
+static QString bench_in_use(void)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.exec("SELECT table_name FROM information_schema.tables "
+                    "WHERE table_schema = DATABASE() "
+                    "AND table_name IN ('recorded', 'videosource')"))
+    {
+        MythDB::DBError("BenchScheduler", query);
+        return "its tables can not be listed";
+    }
+    QStringList tables;
+    while (query.next())
+        tables << query.value(0).toString();
+
+    if (tables.contains("recorded") &&
+        (!query.exec("SELECT COUNT(*) FROM recorded") || !query.next() ||
+         query.value(0).toInt() > 0))
+    {
+        return "it holds recordings";
+    }
+    if (tables.contains("videosource") &&
+        (!query.exec("SELECT COUNT(*) FROM videosource "
+                     "WHERE name <> 'Bench'") || !query.next() ||
+         query.value(0).toInt() > 0))
+    {
+        return "it holds video sources";
+    }
+    return {};
+}
+
+// Before all test cases
+void BenchScheduler::initTestCase()
+{
+    QString dbname = qEnvironmentVariable("MYTHBENCH_DBNAME");
+    if (dbname.isEmpty())
+        QSKIP("Set MYTHBENCH_DBNAME to a scratch MySQL database to run.");
+    if (dbname == "mythconverg")
+        QSKIP("Refusing to overwrite the mythconverg database.");
+    if (qEnvironmentVariable("MYTHBENCH_WIPE_DB") != dbname)
+        QSKIP("Set MYTHBENCH_WIPE_DB to the MYTHBENCH_DBNAME value to "
+              "confirm its contents may be replaced.");
+    if (!QSqlDatabase::drivers().contains("QMYSQL"))
+        QSKIP("This benchmark requires the MySQL database driver.");
+
+    m_size.m_channels    = bench_env("MYTHBENCH_CHANNELS",    m_size.m_channels);
+    m_size.m_days        = bench_env("MYTHBENCH_DAYS",        m_size.m_days);
+    m_size.m_rules       = bench_env("MYTHBENCH_RULES",       m_size.m_rules);
+    m_size.m_inputs      = bench_env("MYTHBENCH_INPUTS",      m_size.m_inputs);
+    m_size.m_inputGroups = bench_env("MYTHBENCH_INPUTGROUPS", m_size.m_inputGroups);
+
+    gCoreContext = new MythCoreContext(TESTVERSION, nullptr);
+
+    DatabaseParams params {};
+    params.m_dbHostName = bench_env("MYTHBENCH_DBHOST", "localhost");
+    params.m_dbHostPing = false;
+    params.m_dbUserName = bench_env("MYTHBENCH_DBUSER", "mythtv");
+    params.m_dbPassword = bench_env("MYTHBENCH_DBPASS", "mythtv");
+    params.m_dbName     = dbname;
+    params.m_dbType     = "QMYSQL";
+    GetMythDB()->SetDatabaseParams(params);
+
+    QString inUse = bench_in_use();
+    if (!inUse.isEmpty())
+    {
+        QSKIP(qPrintable(QString("Refusing to overwrite %1, %2.")
+                         .arg(dbname, inUse)));
+    }
+
+    QVERIFY2(UpgradeTVDatabaseSchema(true, true),
+             "Unable to create the MythTV schema in the scratch database.");
+
+    std::cout << QString("Generating %1 channels x %2 days, %3 rules, "
+                         "%4 inputs in %5 input groups\n")
+        .arg(m_size.m_channels).arg(m_size.m_days).arg(m_size.m_rules)
+        .arg(m_size.m_inputs).arg(m_size.m_inputGroups).toStdString();
+
+    generateSources();
+    generateGuide();
+    generateRules();
+
+    static QMap<int, EncoderLink *> s_tvList;
+    m_sched = new Scheduler(false, &s_tvList);
+    m_sched->m_dbConn = MSqlQuery::SchedCon();
+}
+
+// After all test cases
+void BenchScheduler::cleanupTestCase()
+{
+    delete m_sched;
+    m_sched = nullptr;
+}
+
+void BenchScheduler::generateSources(void)
+{
+    QVERIFY(bench_exec({
+                "DELETE FROM videosource",
+                "DELETE FROM capturecard",
+                "DELETE FROM inputgroup",
+                "INSERT INTO videosource (sourceid, name) "
+                "VALUES (1, 'Bench')" }));
+
+    QString host = bench_quote(gCoreContext->GetHostName());
+    BenchInserter cards(
+        "INSERT INTO capturecard (cardid, parentid, videodevice, cardtype, "
+        "  hostname, sourceid, inputname, displayname, schedgroup, "
+        "  schedorder, livetvorder) VALUES ");
+    BenchInserter groups(
+        "INSERT INTO inputgroup (cardinputid, inputgroupid, inputgroupname) "
+        "VALUES ");
+    for (int i = 1; i <= m_size.m_inputs; ++i)
+    {
+        int group = ((i - 1) % m_size.m_inputGroups) + 1;
+        cards.add(QString("(%1, 0, 'bench%1', 'MOCK', %2, 1, 'MPEG2TS', "
+                          "'Bench %1', 1, %1, %1)").arg(i).arg(host));
+        groups.add(QString("(%1, %2, 'bench_group_%2')").arg(i).arg(group));
+    }
+    QVERIFY(cards.flush() && groups.flush());
+}
+
+void BenchScheduler::generateGuide(void)
+{
+    QVERIFY(bench_exec({ "DELETE FROM channel", "DELETE FROM program" }));
+
+    BenchInserter channels(
+        "INSERT INTO channel (chanid, channum, sourceid, callsign, name, "
+        "  visible, last_record) VALUES ");
+    for (int c = 0; c < m_size.m_channels; ++c)
+    {
+        channels.add(QString("(%1, '%2', 1, 'BENCH%2', 'Bench %2', 1, "
+                             "'1970-01-01 00:00:00')")
+                     .arg(1000 + c).arg(c + 1));
+    }
+    QVERIFY(channels.flush());
+
+    // Three titles for every rule, so that most of the guide is not
+    // recorded and the rules compete for the inputs.
+    int titles = m_size.m_rules * 3;
+    std::minstd_rand rng(kBenchSeed);
+    std::uniform_int_distribution<int> pickTitle(0, titles - 1);
+    std::uniform_int_distribution<int> pickLength(1, 4);
+
+    QDateTime start = MythDate::current();
+    start.setTime(QTime(0, 0));
+
+    BenchInserter programs(
+        "INSERT INTO program (chanid, starttime, endtime, title, subtitle, "
+        "  description, category, category_type, seriesid, programid, "
+        "  audioprop, subtitletypes, videoprop) VALUES ");
+    QVector<int> episode(titles, 0);
+    for (int c = 0; c < m_size.m_channels; ++c)
+    {
+        QDateTime t = start;
+        QDateTime end = start.addDays(m_size.m_days);
+        while (t < end)
+        {
+            int title = pickTitle(rng);
+            QDateTime next = t.addSecs(30LL * 60 * pickLength(rng));
+            int ep = ++episode[title];
+            programs.add(QString("(%1, %2, %3, 'Bench Show %4', "
+                                 "'Episode %5', 'Bench Show %4 episode %5', "
+                                 "'Bench', 'series', 'SH%6', "
+                                 "'EP%6%7', '', '', '')")
+                         .arg(1000 + c)
+                         .arg(bench_time(t), bench_time(next))
+                         .arg(title).arg(ep)
+                         .arg(title, 6, 10, QChar('0'))
+                         .arg(ep, 4, 10, QChar('0')));
+            t = next;
+        }
+    }
+    QVERIFY(programs.flush());
+}
+
+void BenchScheduler::generateRules(void)
+{
+    QVERIFY(bench_exec({
+                "DELETE FROM record",
+                "DELETE FROM recordmatch",
+                "DELETE FROM oldrecorded",
+                "DELETE FROM oldfind",
+                "DELETE FROM recorded" }));
+
+    // Anchor each rule to the first showing of its title.
+    MSqlQuery query(MSqlQuery::InitCon());
+    QVERIFY(query.exec("SELECT title, chanid, starttime FROM program "
+                       "ORDER BY starttime, chanid"));
+    QHash<QString, QPair<uint, QDateTime> > first;
+    while (query.next())
+    {
+        QString title = query.value(0).toString();
+        if (!first.contains(title))
+            first.insert(title, { query.value(1).toUInt(),
+                    MythDate::as_utc(query.value(2).toDateTime()) });
+    }
+
+    std::minstd_rand rng(kBenchSeed + 1);
+    std::uniform_int_distribution<int> pickType(0, 99);
+    std::uniform_int_distribution<int> pickPriority(-1, 2);
+
+    BenchInserter rules(
+        "INSERT INTO record (recordid, type, chanid, starttime, startdate, "
+        "  endtime, enddate, title, description, season, episode, "
+        "  recpriority, dupmethod, dupin, station, inetref, next_record, "
+        "  last_record, last_delete) VALUES ");
+    for (int r = 0; r < m_size.m_rules; ++r)
+    {
+        QString title = QString("Bench Show %1").arg(r);
+        if (!first.contains(title))
+            continue;
+
+        // Mostly "any channel, any time", plus a mix of the other
+        // common rule types.
+        int roll = pickType(rng);
+        RecordingType type = kAllRecord;
+        if (roll >= 95)
+            type = kDailyRecord;
+        else if (roll >= 85)
+            type = kOneRecord;
+        else if (roll >= 70)
+            type = kWeeklyRecord;
+
+        uint chanid = first[title].first;
+        QDateTime startts = first[title].second;
+        QDateTime endts = startts.addSecs(30LL * 60);
+        rules.add(QString("(%1, %2, %3, %4, %5, %6, %7, %8, '', 0, 0, %9, "
+                          "6, 15, 'BENCH%10', '', '1970-01-01 00:00:00', "
+                          "'1970-01-01 00:00:00', '1970-01-01 00:00:00')")
+                  .arg(r + 1).arg(static_cast<int>(type)).arg(chanid)
+                  .arg(bench_quote(startts.toString("HH:mm:ss")),
+                       bench_quote(startts.toString("yyyy-MM-dd")),
+                       bench_quote(endts.toString("HH:mm:ss")),
+                       bench_quote(endts.toString("yyyy-MM-dd")),
+                       bench_quote(title))
+                  .arg(pickPriority(rng))
+                  .arg(chanid - 999));
+    }
+    QVERIFY(rules.flush());
+}
+
+std::chrono::microseconds BenchScheduler::timeUpdateMatches(void)
+{
+    auto start = nowAsDuration<std::chrono::microseconds>();
+    m_sched->m_recordMatchLock.lock();
+    m_sched->UpdateMatches(0, 0, 0, QDateTime());
+    m_sched->m_recordMatchLock.unlock();
+    return nowAsDuration<std::chrono::microseconds>() - start;
+}
+
+std::chrono::microseconds BenchScheduler::timeUpdateDuplicates(void)
+{
+    auto start = nowAsDuration<std::chrono::microseconds>();
+    m_sched->UpdateDuplicates();
+    return nowAsDuration<std::chrono::microseconds>() - start;
+}
+
+std::chrono::microseconds BenchScheduler::timeFillRecordList(void)
+{
+    // FillRecordList() expects to be called with the schedule locked.
+    QMutexLocker locker(&m_sched->m_schedLock);
+    auto start = nowAsDuration<std::chrono::microseconds>();
+    m_sched->FillRecordList();
+    return nowAsDuration<std::chrono::microseconds>() - start;
+}
+
+std::chrono::microseconds BenchScheduler::timeSchedNewRecords(void)
+{
+    return m_sched->m_schedNewRecordsTime;
+}
+
+// A MATCH request for every rule, as after a guide data update.
+void BenchScheduler::bench_fullReschedule(void)
+{
+    int runs = bench_env("MYTHBENCH_RUNS", 3);
+    for (int run = 1; run <= runs; ++run)
+    {
+        auto matchTime = timeUpdateMatches();
+        m_sched->CreateTempTables();
+        auto checkTime = timeUpdateDuplicates();
+        auto placeTime = timeFillRecordList();
+        auto schedTime = timeSchedNewRecords();
+        m_sched->DeleteTempTables();
+
+        std::cout << QString("Run %1: Scheduled %2 items in %3 "
+                             "= %4 match + %5 check + %6 place "
+                             "(%7 SchedNewRecords)\n")
+            .arg(run)
+            .arg(m_sched->m_recList.size())
+            .arg(bench_secs(matchTime + checkTime + placeTime, 1),
+                 bench_secs(matchTime, 2), bench_secs(checkTime, 2),
+                 bench_secs(placeTime, 2), bench_secs(schedTime, 2))
+            .toStdString();
+    }
+    QVERIFY(!m_sched->m_recList.empty());
+}
+
+// A PLACE request, as sent for every EIT update.
+void BenchScheduler::bench_placeOnly(void)
+{
+    int runs = bench_env("MYTHBENCH_RUNS", 3);
+    for (int run = 1; run <= runs; ++run)
+    {
+        m_sched->CreateTempTables();
+        auto placeTime = timeFillRecordList();
+        auto schedTime = timeSchedNewRecords();
+        m_sched->DeleteTempTables();
+
+        std::cout << QString("Run %1: Scheduled %2 items in %3 "
+                             "= 0.00 match + 0.00 check + %3 place "
+                             "(%4 SchedNewRecords)\n")
+            .arg(run)
+            .arg(m_sched->m_recList.size())
+            .arg(bench_secs(placeTime, 2), bench_secs(schedTime, 2))
+            .toStdString();
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchScheduler)
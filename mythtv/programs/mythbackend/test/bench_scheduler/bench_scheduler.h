@@ -0,0 +1,59 @@
+/*
+ *  Class BenchScheduler
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+class Scheduler;
+
+// Synthetic guide and rule sizes.  Each can be overridden from the
+// environment, e.g. MYTHBENCH_CHANNELS=300.
+struct BenchSchedulerSize
+{
+    int m_channels    {100};
+    int m_days        {14};
+    int m_rules       {500};
+    int m_inputs      {4};
+    int m_inputGroups {2};
+};
+
+class BenchScheduler : public QObject
+{
+    Q_OBJECT
+
+  private:
+    void generateSources(void);
+    void generateGuide(void);
+    void generateRules(void);
+
+    std::chrono::microseconds timeUpdateMatches(void);
+    std::chrono::microseconds timeUpdateDuplicates(void);
+    std::chrono::microseconds timeFillRecordList(void);
+    std::chrono::microseconds timeSchedNewRecords(void);
+
+    BenchSchedulerSize m_size;
+    Scheduler         *m_sched {nullptr};
+
+  private slots:
+    // Before/after all test cases
+    void initTestCase(void);
+    void cleanupTestCase(void);
+
+    // Test cases
+    void bench_fullReschedule(void);
+    void bench_placeOnly(void);
+};
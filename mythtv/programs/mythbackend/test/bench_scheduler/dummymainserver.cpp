@@ -0,0 +1,19 @@
+#include "mainserver.h"
+
+// The scheduler only reaches the main server to ask about connected
+// clients and disk space, neither of which the benchmark has.
+
+bool MainServer::isClientConnected(bool /*onlyBlockingClients*/)
+{
+    return false;
+}
+
+void MainServer::ShutSlaveBackendsDown(const QString &/*haltcmd*/)
+{
+}
+
+void MainServer::GetFilesystemInfos(QList<FileSystemInfo> &fsInfos,
+                                    bool /*useCache*/)
+{
+    fsInfos.clear();
+}
@@ -1,15 +1,22 @@
 // C++ headers
 #include <algorithm> // for min/max, clamp
 #include <cmath>
+#include <deque>
 #include <iostream> // for cerr
+#include <memory>
 #include <thread> // for sleep_for
 
 // Qt headers
 #include <QCoreApplication>
+#include <QMutex>
+#include <QRunnable>
 #include <QString>
+#include <QThread>
+#include <QWaitCondition>
 
 // MythTV headers
 #include "libmyth/mythcontext.h"
+#include "libmythbase/mthreadpool.h"
 #include "libmythbase/mythmiscutil.h"
 #include "libmythbase/programinfo.h"
 #include "libmythbase/sizetliteral.h"
@@ -227,6 +234,7 @@ void ClassicCommDetector::Init()
     LOG(VB_COMMFLAG, LOG_INFO,
         QString("Using Sample Spacing of %1 horizontal & %2 vertical pixels.")
             .arg(m_horizSpacing).arg(m_vertSpacing));
+    pixelKernels::initSampleMask(&m_sampleMask, m_horizSpacing);
 
     m_framesProcessed = 0;
     m_totalMinBrightness = 0;
@@ -278,6 +286,158 @@ void ClassicCommDetector::deleteLater(void)
     CommDetectorBase::deleteLater();
 }
 
+/// One frame on its way through a FramePipeline.
+struct PipelineSlot
+{
+    MythVideoFrame frame;       ///< copy of the decoded luma plane
+    FrameScratch   scratch;
+    FrameAnalysis  analysis;
+    bool           done {false};
+};
+
+/** \class FramePipeline
+ *  \brief Analyses decoded frames on a pool of threads.
+ *
+ *  The decoding thread copies each frame into a free slot and submits it;
+ *  finished slots are handed back in the order they were submitted so that
+ *  the detector can apply them one after another.
+ */
+class FramePipeline
+{
+  public:
+    FramePipeline(const ClassicCommDetector *detector, int threads);
+    ~FramePipeline();
+
+    PipelineSlot *GetFreeSlot(void);
+    void Submit(PipelineSlot *slot);
+    PipelineSlot *TakeNext(bool wait);
+    void Release(PipelineSlot *slot);
+
+    void Analyze(PipelineSlot *slot);
+
+  private:
+    const ClassicCommDetector                 *m_detector;
+    MThreadPool                                m_pool {"CommFlagAnalysis"};
+    std::vector<std::unique_ptr<PipelineSlot>> m_slots;
+    std::vector<PipelineSlot*>                 m_free;
+    std::deque<PipelineSlot*>                  m_queued;
+    QMutex                                     m_lock;
+    QWaitCondition                             m_finished;
+};
+
+class FrameAnalysisTask : public QRunnable
+{
+  public:
+    FrameAnalysisTask(FramePipeline *pipeline, PipelineSlot *slot)
+      : m_pipeline(pipeline), m_slot(slot) {}
+    void run(void) override { m_pipeline->Analyze(m_slot); }
+
+  private:
+    FramePipeline *m_pipeline;
+    PipelineSlot  *m_slot;
+};
+
+FramePipeline::FramePipeline(const ClassicCommDetector *detector, int threads)
+  : m_detector(detector)
+{
+    m_pool.setMaxThreadCount(threads);
+
+    // Enough frames to keep every thread busy while the oldest is waited on.
+    for (int i = 0; i < threads * 2; i++)
+    {
+        m_slots.push_back(std::make_unique<PipelineSlot>());
+        m_free.push_back(m_slots.back().get());
+    }
+}
+
+FramePipeline::~FramePipeline()
+{
+    m_pool.waitForDone();
+}
+
+PipelineSlot *FramePipeline::GetFreeSlot(void)
+{
+    if (m_free.empty())
+        return nullptr;
+    PipelineSlot *slot = m_free.back();
+    m_free.pop_back();
+    return slot;
+}
+
+void FramePipeline::Submit(PipelineSlot *slot)
+{
+    slot->done = false;
+    m_queued.push_back(slot);
+    m_pool.start(new FrameAnalysisTask(this, slot), "CommFlagFrame");
+}
+
+PipelineSlot *FramePipeline::TakeNext(bool wait)
+{
+    if (m_queued.empty())
+        return nullptr;
+
+    PipelineSlot *slot = m_queued.front();
+    QMutexLocker locker(&m_lock);
+    while (!slot->done)
+    {
+        if (!wait)
+            return nullptr;
+        m_finished.wait(&m_lock);
+    }
+    m_queued.pop_front();
+    return slot;
+}
+
+void FramePipeline::Release(PipelineSlot *slot)
+{
+    m_free.push_back(slot);
+}
+
+void FramePipeline::Analyze(PipelineSlot *slot)
+{
+    m_detector->AnalyzeFrame(&slot->frame, slot->scratch, slot->analysis);
+
+    QMutexLocker locker(&m_lock);
+    slot->done = true;
+    m_finished.wakeAll();
+}
+
+/// A part of the recording decoded by its own player; see
+/// ClassicCommDetector::GoChunked().
+struct FlagChunk
+{
+    PlayerContext             *context {nullptr};
+    long long                  start   {0};
+    long long                  end     {-1}; ///< first frame of the next chunk
+    std::vector<FrameAnalysis> frames;
+    Histogram                  first;        ///< histogram of frames[0]
+    Histogram                  last;         ///< histogram of frames.back()
+};
+
+class ChunkFlagTask : public QRunnable
+{
+  public:
+    ChunkFlagTask(const ClassicCommDetector *detector, FlagChunk &chunk,
+                  std::atomic<long long> &progress,
+                  const std::atomic<bool> &abort,
+                  std::atomic<int> &finished)
+      : m_detector(detector), m_chunk(chunk), m_progress(progress),
+        m_abort(abort), m_finished(finished) {}
+
+    void run(void) override
+    {
+        m_detector->AnalyzeChunk(m_chunk, m_progress, m_abort);
+        m_finished++;
+    }
+
+  private:
+    const ClassicCommDetector *m_detector;
+    FlagChunk                 &m_chunk;
+    std::atomic<long long>    &m_progress;
+    const std::atomic<bool>   &m_abort;
+    std::atomic<int>          &m_finished;
+};
+
 bool ClassicCommDetector::go()
 {
     int secsSince = 0;
@@ -404,16 +564,39 @@ bool ClassicCommDetector::go()
     }
 
 
-    float aspect = m_player->GetVideoAspect();
+    m_lastAspect = m_player->GetVideoAspect();
     int prevpercent = -1;
 
-    SetVideoParams(aspect);
+    SetVideoParams(m_lastAspect);
 
     emit breathe();
 
+    // Analyse frames on several threads, or even decode several parts of
+    // the recording at once. Neither helps a recording that is still being
+    // made, as that is flagged at the rate it is recorded.
+    int threads = gCoreContext->GetNumSetting("CommFlagThreads", 0);
+    if (threads <= 0)
+        threads = QThread::idealThreadCount();
+    if (m_stillRecording)
+        threads = 1;
+
+    int chunked = -1;
+    if ((threads > 1) && gCoreContext->GetBoolSetting("CommFlagChunked", false))
+        chunked = GoChunked(threads, myTotalFrames, flagTime);
+    if (chunked == 0)
+        return false;
+
+    std::unique_ptr<FramePipeline> pipeline;
+    if ((threads > 1) && (chunked < 0))
+    {
+        LOG(VB_COMMFLAG, LOG_INFO,
+            QString("Analysing frames on %1 threads").arg(threads));
+        pipeline = std::make_unique<FramePipeline>(this, threads);
+    }
+
     m_player->ResetTotalDuration();
 
-    while (m_player->GetEof() == kEofStateNone)
+    while ((chunked < 0) && (m_player->GetEof() == kEofStateNone))
     {
         std::chrono::microseconds startTime {0us};
         if (m_stillRecording)
@@ -422,16 +605,9 @@ bool ClassicCommDetector::go()
         MythVideoFrame* currentFrame = m_player->GetRawVideoFrame();
         long long currentFrameNumber = currentFrame->m_frameNumber;
 
-        //Lucas: maybe we should make the nuppelvideoplayer send out a signal
-        //when the aspect ratio changes.
-        //In order to not change too many things at a time, I"m using basic
-        //polling for now.
-        float newAspect = currentFrame->m_aspect;
-        if (newAspect != aspect)
-        {
-            SetVideoParams(aspect);
-            aspect = newAspect;
-        }
+        // The pipeline checks the aspect ratio when it applies the frame.
+        if (!pipeline)
+            CheckAspect(currentFrame->m_aspect);
 
         if (((currentFrameNumber % 500) == 0) ||
             (((currentFrameNumber % 100) == 0) &&
@@ -499,59 +675,14 @@ bool ClassicCommDetector::go()
             ((m_showProgress || m_stillRecording) &&
              ((currentFrameNumber % 100) == 0)))
         {
-            float flagFPS { 0.0 };
-            float elapsed = flagTime.elapsed() / 1000.0;
-
-            if (elapsed != 0.0F)
-                flagFPS = currentFrameNumber / elapsed;
-            else
-                flagFPS = 0.0;
-
-            int percentage = 0;
-            if (myTotalFrames)
-                percentage = currentFrameNumber * 100 / myTotalFrames;
-
-            if (percentage > 100)
-                percentage = 100;
-
-            if (m_showProgress)
-            {
-                if (myTotalFrames)
-                {
-                    QString tmp = QString("\r%1%/%2fps  \r")
-                        .arg(percentage, 3).arg((int)flagFPS, 4);
-                    std::cerr << qPrintable(tmp) << std::flush;
-                }
-                else
-                {
-                    QString tmp = QString("\r%1/%2fps  \r")
-                        .arg(currentFrameNumber, 6).arg((int)flagFPS, 4);
-                    std::cerr << qPrintable(tmp) << std::flush;
-                }
-            }
-
-            if (myTotalFrames)
-            {
-                emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
-                    "%1% Completed @ %2 fps.")
-                        .arg(percentage).arg(flagFPS));
-            }
-            else
-            {
-                emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
-                    "%1 Frames Completed @ %2 fps.")
-                        .arg(currentFrameNumber).arg(flagFPS));
-            }
-
-            if (percentage % 10 == 0 && prevpercent != percentage)
-            {
-                prevpercent = percentage;
-                LOG(VB_GENERAL, LOG_INFO, QString("%1%% Completed @ %2 fps.")
-                    .arg(percentage) .arg(flagFPS));
-            }
+            ReportProgress(currentFrameNumber, myTotalFrames, flagTime,
+                           prevpercent);
         }
 
-        ProcessFrame(currentFrame, currentFrameNumber);
+        if (pipeline)
+            QueueFrame(*pipeline, currentFrame, currentFrameNumber);
+        else
+            ProcessFrame(currentFrame, currentFrameNumber);
 
         if (m_stillRecording)
         {
@@ -582,6 +713,12 @@ bool ClassicCommDetector::go()
         m_player->DiscardVideoFrame(currentFrame);
     }
 
+    if (pipeline)
+    {
+        while (PipelineSlot *slot = pipeline->TakeNext(true))
+            ApplySlot(*pipeline, slot);
+    }
+
     if (m_showProgress)
     {
 #if 0
@@ -745,43 +882,195 @@ void ClassicCommDetector::SetVideoParams(float aspect)
 void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
                                        long long frame_number)
 {
-    int max = 0;
-    int min = 255;
-    int blankPixelsChecked = 0;
-    long long totBrightness = 0;
-    auto *rowMax = new unsigned char[m_height];
-    auto *colMax = new unsigned char[m_width];
-    memset(rowMax, 0, sizeof(*rowMax)*m_height);
-    memset(colMax, 0, sizeof(*colMax)*m_width);
-    int topDarkRow = m_commDetectBorder;
-    int bottomDarkRow = m_height - m_commDetectBorder - 1;
-    int leftDarkCol = m_commDetectBorder;
-    int rightDarkCol = m_width - m_commDetectBorder - 1;
-    FrameInfoEntry fInfo {};
+    if (!CheckFrame(frame, frame_number))
+        return;
+
+    FrameAnalysis analysis;
+    analysis.frameNumber = frame_number;
+    analysis.aspect = frame->m_aspect;
+    AnalyzeFrame(frame, m_scratch, analysis);
+    ApplyFrameAnalysis(analysis, m_scratch.histogram);
 
+#ifdef SHOW_DEBUG_WIN
+    comm_debug_show(frame->buf);
+    getchar();
+#endif
+}
+
+bool ClassicCommDetector::CheckFrame(const MythVideoFrame *frame,
+                                     long long frame_number) const
+{
     if (!frame || !(frame->m_buffer) || frame_number == -1 ||
         frame->m_type != FMT_YV12)
     {
         LOG(VB_COMMFLAG, LOG_ERR, "CommDetect: Invalid video frame or codec, "
                                   "unable to process frame.");
-        delete[] rowMax;
-        delete[] colMax;
-        return;
+        return false;
     }
 
     if (!m_width || !m_height)
     {
         LOG(VB_COMMFLAG, LOG_ERR, "CommDetect: Width or Height is 0, "
                                   "unable to process frame.");
-        delete[] rowMax;
-        delete[] colMax;
-        return;
+        return false;
     }
 
-    m_curFrameNumber = frame_number;
-    unsigned char* framePtr = frame->m_buffer;
+    return true;
+}
+
+/*
+ * The part of processing a frame that only looks at the frame itself. This
+ * only reads the detector's settings, so several frames can be analysed at
+ * once as long as each thread has its own scratch space.
+ */
+void ClassicCommDetector::AnalyzeFrame(MythVideoFrame *frame,
+                                       FrameScratch &scratch,
+                                       FrameAnalysis &analysis) const
+{
+    const unsigned char* framePtr = frame->m_buffer;
     int bytesPerLine = frame->m_pitches[0];
 
+    if (m_commDetectMethod & COMM_DETECT_SCENE)
+        m_sceneChangeDetector->generateHistogram(frame, &scratch.histogram);
+
+    if (m_commDetectMethod & COMM_DETECT_BLANKS)
+    {
+        std::vector<unsigned char> &rowMax = scratch.rowMax;
+        std::vector<unsigned char> &colMax = scratch.colMax;
+
+        // Reuse the scratch rows; only their contents are reset.
+        rowMax.assign(m_height, 0);
+        colMax.assign(m_width, 0);
+
+        bool skipLogo = m_commDetectBlankCanHaveLogo && m_logoInfoAvailable;
+        int x0 = m_commDetectBorder;
+        int x1 = m_width - m_commDetectBorder;
+        pixelKernels::SampleStats stats;
+
+        for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
+                y += m_vertSpacing)
+        {
+            const unsigned char *row = framePtr + (y * bytesPerLine);
+            unsigned int logoMinX = 0;
+            unsigned int logoMaxX = 0;
+
+            if (!skipLogo || !m_logoDetector->logoRowSpan(y, logoMinX, logoMaxX))
+            {
+                rowMax[y] = pixelKernels::sampleRow(row, x0, x1,
+                    m_sampleMask, colMax.data(), &stats);
+                continue;
+            }
+
+            // Sample either side of the logo, staying on the sampling grid.
+            int leftEnd = std::clamp(static_cast<int>(logoMinX) + 1, x0,
+                                     std::max(x0, x1));
+            int rightStart = std::max(static_cast<int>(logoMaxX), leftEnd);
+            rightStart = x0 + ((rightStart - x0 + m_horizSpacing - 1) /
+                               m_horizSpacing * m_horizSpacing);
+
+            unsigned char leftMax = pixelKernels::sampleRow(row, x0, leftEnd,
+                m_sampleMask, colMax.data(), &stats);
+            unsigned char rightMax = pixelKernels::sampleRow(row, rightStart,
+                x1, m_sampleMask, colMax.data(), &stats);
+            rowMax[y] = std::max(leftMax, rightMax);
+        }
+
+        if (stats.count)
+        {
+            int topDarkRow = m_commDetectBorder;
+            int bottomDarkRow = m_height - m_commDetectBorder - 1;
+            int leftDarkCol = m_commDetectBorder;
+            int rightDarkCol = m_width - m_commDetectBorder - 1;
+
+            for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
+                    y += m_vertSpacing)
+            {
+                if (rowMax[y] > m_commDetectBoxBrightness)
+                    break;
+                topDarkRow = y;
+            }
+
+            for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
+                    y += m_vertSpacing)
+                if (rowMax[y] >= m_commDetectBoxBrightness)
+                    bottomDarkRow = y;
+
+            for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
+                    x += m_horizSpacing)
+            {
+                if (colMax[x] > m_commDetectBoxBrightness)
+                    break;
+                leftDarkCol = x;
+            }
+
+            for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
+                    x += m_horizSpacing)
+                if (colMax[x] >= m_commDetectBoxBrightness)
+                    rightDarkCol = x;
+
+            analysis.format = COMM_FORMAT_NORMAL;
+            if ((topDarkRow > m_commDetectBorder) &&
+                (topDarkRow < (m_height * .20)) &&
+                (bottomDarkRow < (m_height - m_commDetectBorder)) &&
+                (bottomDarkRow > (m_height * .80)))
+            {
+                analysis.format |= COMM_FORMAT_LETTERBOX;
+            }
+            if ((leftDarkCol > m_commDetectBorder) &&
+                     (leftDarkCol < (m_width * .20)) &&
+                     (rightDarkCol < (m_width - m_commDetectBorder)) &&
+                     (rightDarkCol > (m_width * .80)))
+            {
+                analysis.format |= COMM_FORMAT_PILLARBOX;
+            }
+
+            int min = stats.min;
+            int max = stats.max;
+            int avg = stats.sum / stats.count;
+            int dimAverage = min + 10;
+
+            analysis.checked = true;
+            analysis.minBrightness = min;
+            analysis.maxBrightness = max;
+            analysis.avgBrightness = avg;
+
+            // Is the frame really dark
+            if (((max - min) <= m_commDetectBlankFrameMaxDiff) &&
+                (max < m_commDetectDimBrightness))
+                analysis.blank = true;
+
+            // Are we non-strict and the frame is blank
+            if ((!m_aggressiveDetection) &&
+                ((max - min) <= m_commDetectBlankFrameMaxDiff))
+                analysis.blank = true;
+
+            // Are we non-strict and the frame is dark
+            //                   OR the frame is dim and has a low avg brightness
+            if ((!m_aggressiveDetection) &&
+                ((max < m_commDetectDarkBrightness) ||
+                 ((max < m_commDetectDimBrightness) && (avg < dimAverage))))
+                analysis.blank = true;
+        }
+    }
+
+    if ((m_logoInfoAvailable) && (m_commDetectMethod & COMM_DETECT_LOGO))
+    {
+        analysis.logoPresent =
+            m_logoDetector->doesThisFrameContainTheFoundLogo(frame);
+    }
+}
+
+/*
+ * The part of processing a frame that depends on the frames before it.
+ * Frames must be applied in order.
+ */
+void ClassicCommDetector::ApplyFrameAnalysis(const FrameAnalysis &analysis,
+                                             const Histogram &histogram)
+{
+    FrameInfoEntry fInfo {};
+
+    m_curFrameNumber = analysis.frameNumber;
+
     fInfo.minBrightness = -1;
     fInfo.maxBrightness = -1;
     fInfo.avgBrightness = -1;
@@ -790,8 +1079,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     fInfo.format = COMM_FORMAT_NORMAL;
     fInfo.flagMask = 0;
 
-    int& flagMask = m_frameInfo[m_curFrameNumber].flagMask;
-
     // Fill in dummy info records for skipped frames.
     if (m_lastFrameNumber != (m_curFrameNumber - 1))
     {
@@ -812,137 +1099,35 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
 
     m_frameInfo[m_curFrameNumber] = fInfo;
 
+    int& flagMask = m_frameInfo[m_curFrameNumber].flagMask;
+
     if (m_commDetectMethod & COMM_DETECT_BLANKS)
         m_frameIsBlank = false;
 
     if (m_commDetectMethod & COMM_DETECT_SCENE)
     {
-        m_sceneChangeDetector->processFrame(frame);
+        if (analysis.haveSimilarity)
+            m_sceneChangeDetector->processSimilarity(analysis.similarity);
+        else
+            m_sceneChangeDetector->processHistogram(histogram);
     }
 
     m_stationLogoPresent = false;
 
-    for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
-            y += m_vertSpacing)
+    if ((m_commDetectMethod & COMM_DETECT_BLANKS) && analysis.checked)
     {
-        for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
-                x += m_horizSpacing)
-        {
-            uchar pixel = framePtr[y * bytesPerLine + x];
-
-            if (m_commDetectMethod & COMM_DETECT_BLANKS)
-            {
-                 bool checkPixel = false;
-                 if (!m_commDetectBlankCanHaveLogo)
-                     checkPixel = true;
-
-                 if (!m_logoInfoAvailable ||
-                     !m_logoDetector->pixelInsideLogo(x,y))
-                     checkPixel=true;
-
-                 if (checkPixel)
-                 {
-                     blankPixelsChecked++;
-                     totBrightness += pixel;
+        m_frameInfo[m_curFrameNumber].format = analysis.format;
+        m_frameInfo[m_curFrameNumber].minBrightness = analysis.minBrightness;
+        m_frameInfo[m_curFrameNumber].maxBrightness = analysis.maxBrightness;
+        m_frameInfo[m_curFrameNumber].avgBrightness = analysis.avgBrightness;
 
-                     if (pixel < min)
-                          min = pixel;
-
-                     if (pixel > max)
-                          max = pixel;
-
-                     if (pixel > rowMax[y])
-                         rowMax[y] = pixel;
-
-                     if (pixel > colMax[x])
-                         colMax[x] = pixel;
-                 }
-            }
-        }
-    }
-
-    if ((m_commDetectMethod & COMM_DETECT_BLANKS) && blankPixelsChecked)
-    {
-        for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
-                y += m_vertSpacing)
-        {
-            if (rowMax[y] > m_commDetectBoxBrightness)
-                break;
-            topDarkRow = y;
-        }
-
-        for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
-                y += m_vertSpacing)
-            if (rowMax[y] >= m_commDetectBoxBrightness)
-                bottomDarkRow = y;
-
-        delete[] rowMax;
-        rowMax = nullptr;
-
-        for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
-                x += m_horizSpacing)
-        {
-            if (colMax[x] > m_commDetectBoxBrightness)
-                break;
-            leftDarkCol = x;
-        }
-
-        for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
-                x += m_horizSpacing)
-            if (colMax[x] >= m_commDetectBoxBrightness)
-                rightDarkCol = x;
-
-        delete[] colMax;
-        colMax = nullptr;
-
-        m_frameInfo[m_curFrameNumber].format = COMM_FORMAT_NORMAL;
-        if ((topDarkRow > m_commDetectBorder) &&
-            (topDarkRow < (m_height * .20)) &&
-            (bottomDarkRow < (m_height - m_commDetectBorder)) &&
-            (bottomDarkRow > (m_height * .80)))
-        {
-            m_frameInfo[m_curFrameNumber].format |= COMM_FORMAT_LETTERBOX;
-        }
-        if ((leftDarkCol > m_commDetectBorder) &&
-                 (leftDarkCol < (m_width * .20)) &&
-                 (rightDarkCol < (m_width - m_commDetectBorder)) &&
-                 (rightDarkCol > (m_width * .80)))
-        {
-            m_frameInfo[m_curFrameNumber].format |= COMM_FORMAT_PILLARBOX;
-        }
-
-        int avg = totBrightness / blankPixelsChecked;
-
-        m_frameInfo[m_curFrameNumber].minBrightness = min;
-        m_frameInfo[m_curFrameNumber].maxBrightness = max;
-        m_frameInfo[m_curFrameNumber].avgBrightness = avg;
-
-        m_totalMinBrightness += min;
-        m_commDetectDimAverage = min + 10;
-
-        // Is the frame really dark
-        if (((max - min) <= m_commDetectBlankFrameMaxDiff) &&
-            (max < m_commDetectDimBrightness))
-            m_frameIsBlank = true;
-
-        // Are we non-strict and the frame is blank
-        if ((!m_aggressiveDetection) &&
-            ((max - min) <= m_commDetectBlankFrameMaxDiff))
-            m_frameIsBlank = true;
-
-        // Are we non-strict and the frame is dark
-        //                   OR the frame is dim and has a low avg brightness
-        if ((!m_aggressiveDetection) &&
-            ((max < m_commDetectDarkBrightness) ||
-             ((max < m_commDetectDimBrightness) && (avg < m_commDetectDimAverage))))
-            m_frameIsBlank = true;
+        m_totalMinBrightness += analysis.minBrightness;
+        m_commDetectDimAverage = analysis.minBrightness + 10;
+        m_frameIsBlank = analysis.blank;
     }
 
     if ((m_logoInfoAvailable) && (m_commDetectMethod & COMM_DETECT_LOGO))
-    {
-        m_stationLogoPresent =
-            m_logoDetector->doesThisFrameContainTheFoundLogo(frame);
-    }
+        m_stationLogoPresent = analysis.logoPresent;
 
 #if 0
     if ((m_commDetectMethod == COMM_DETECT_ALL) &&
@@ -983,14 +1168,273 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
             .arg(m_frameInfo[m_curFrameNumber].flagMask, 4, 16, QChar('0')));
     }
 
-#ifdef SHOW_DEBUG_WIN
-    comm_debug_show(frame->buf);
-    getchar();
-#endif
-
     m_framesProcessed++;
-    delete[] rowMax;
-    delete[] colMax;
+}
+
+/*
+ * Lucas: maybe we should make the nuppelvideoplayer send out a signal
+ * when the aspect ratio changes.
+ * In order to not change too many things at a time, I"m using basic
+ * polling for now.
+ */
+void ClassicCommDetector::CheckAspect(float aspect)
+{
+    if (aspect != m_lastAspect)
+    {
+        SetVideoParams(m_lastAspect);
+        m_lastAspect = aspect;
+    }
+}
+
+void ClassicCommDetector::ReportProgress(long long framesDone,
+                                         long long totalFrames,
+                                         const QElapsedTimer &flagTime,
+                                         int &prevpercent)
+{
+    float flagFPS { 0.0 };
+    float elapsed = flagTime.elapsed() / 1000.0;
+
+    if (elapsed != 0.0F)
+        flagFPS = framesDone / elapsed;
+    else
+        flagFPS = 0.0;
+
+    int percentage = 0;
+    if (totalFrames)
+        percentage = framesDone * 100 / totalFrames;
+
+    if (percentage > 100)
+        percentage = 100;
+
+    if (m_showProgress)
+    {
+        if (totalFrames)
+        {
+            QString tmp = QString("\r%1%/%2fps  \r")
+                .arg(percentage, 3).arg((int)flagFPS, 4);
+            std::cerr << qPrintable(tmp) << std::flush;
+        }
+        else
+        {
+            QString tmp = QString("\r%1/%2fps  \r")
+                .arg(framesDone, 6).arg((int)flagFPS, 4);
+            std::cerr << qPrintable(tmp) << std::flush;
+        }
+    }
+
+    if (totalFrames)
+    {
+        emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+            "%1% Completed @ %2 fps.")
+                .arg(percentage).arg(flagFPS));
+    }
+    else
+    {
+        emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+            "%1 Frames Completed @ %2 fps.")
+                .arg(framesDone).arg(flagFPS));
+    }
+
+    if (percentage % 10 == 0 && prevpercent != percentage)
+    {
+        prevpercent = percentage;
+        LOG(VB_GENERAL, LOG_INFO, QString("%1%% Completed @ %2 fps.")
+            .arg(percentage) .arg(flagFPS));
+    }
+}
+
+void ClassicCommDetector::QueueFrame(FramePipeline &pipeline,
+                                     MythVideoFrame *frame,
+                                     long long frame_number)
+{
+    if (!CheckFrame(frame, frame_number))
+        return;
+
+    PipelineSlot *slot = pipeline.GetFreeSlot();
+    while (!slot)
+    {
+        ApplySlot(pipeline, pipeline.TakeNext(true));
+        slot = pipeline.GetFreeSlot();
+    }
+
+    // The analysers only look at the luma plane.
+    if ((slot->frame.m_width != frame->m_width) ||
+        (slot->frame.m_height != frame->m_height))
+        slot->frame.Init(FMT_YV12, frame->m_width, frame->m_height);
+    MythVideoFrame::CopyPlane(slot->frame.m_buffer, slot->frame.m_pitches[0],
+                              frame->m_buffer, frame->m_pitches[0],
+                              frame->m_width, frame->m_height);
+
+    slot->analysis = FrameAnalysis();
+    slot->analysis.frameNumber = frame_number;
+    slot->analysis.aspect = frame->m_aspect;
+    pipeline.Submit(slot);
+
+    while (PipelineSlot *done = pipeline.TakeNext(false))
+        ApplySlot(pipeline, done);
+}
+
+void ClassicCommDetector::ApplySlot(FramePipeline &pipeline,
+                                    PipelineSlot *slot)
+{
+    CheckAspect(slot->analysis.aspect);
+    ApplyFrameAnalysis(slot->analysis, slot->scratch.histogram);
+    pipeline.Release(slot);
+}
+
+/*
+ * Flag a finished recording by decoding "chunks" GOP aligned parts of it at
+ * once, each with its own player, and then applying the results in order.
+ * Returns 1 when done, 0 if stopped and -1 if the recording can't be split,
+ * in which case nothing has been flagged yet.
+ */
+int ClassicCommDetector::GoChunked(int chunks, long long totalFrames,
+                                   const QElapsedTimer &flagTime)
+{
+    std::vector<uint64_t> starts = m_player->GetChunkStarts(chunks);
+    if (starts.size() < 2)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO,
+            "Unable to split recording, flagging it in one piece");
+        return -1;
+    }
+
+    std::vector<FlagChunk> parts(starts.size());
+    bool ok = true;
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        FlagChunk &chunk = parts[i];
+        chunk.start = static_cast<long long>(starts[i]);
+        if (i + 1 < parts.size())
+            chunk.end = static_cast<long long>(starts[i + 1]);
+
+        chunk.context = m_player->CreateSibling();
+        auto *player = chunk.context ?
+            dynamic_cast<MythCommFlagPlayer*>(chunk.context->m_player) : nullptr;
+        if (!player || (player->OpenFile() < 0) || !player->InitVideo())
+        {
+            ok = false;
+            break;
+        }
+    }
+
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "Unable to open recording for chunked flagging, "
+            "flagging it in one piece");
+        for (auto &chunk : parts)
+            delete chunk.context;
+        return -1;
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Flagging recording in %1 chunks").arg(parts.size()));
+
+    std::atomic<long long> progress {0};
+    std::atomic<bool> abort {false};
+    std::atomic<int> finished {0};
+    int prevpercent = -1;
+
+    MThreadPool pool("CommFlagChunks");
+    pool.setMaxThreadCount(static_cast<int>(parts.size()));
+    for (auto &chunk : parts)
+    {
+        pool.start(new ChunkFlagTask(this, chunk, progress, abort, finished),
+                   "CommFlagChunk");
+    }
+
+    while (finished < static_cast<int>(parts.size()))
+    {
+        std::this_thread::sleep_for(500ms);
+        emit breathe();
+        if (m_bStop)
+            abort = true;
+        ReportProgress(progress, totalFrames, flagTime, prevpercent);
+    }
+    pool.waitForDone();
+
+    for (auto &chunk : parts)
+        delete chunk.context;
+
+    if (abort)
+        return 0;
+
+    // The first frame of each chunk is compared with the last frame of the
+    // chunk before it, just as if the recording had been decoded in one go.
+    const Histogram *previous = nullptr;
+    for (auto &chunk : parts)
+    {
+        if (chunk.frames.empty())
+            continue;
+
+        if (previous && (m_commDetectMethod & COMM_DETECT_SCENE))
+        {
+            chunk.frames[0].similarity =
+                chunk.first.calculateSimilarityWith(*previous);
+            chunk.frames[0].haveSimilarity = true;
+        }
+
+        for (const auto &analysis : chunk.frames)
+        {
+            CheckAspect(analysis.aspect);
+            ApplyFrameAnalysis(analysis, chunk.first);
+        }
+
+        previous = &chunk.last;
+    }
+
+    return 1;
+}
+
+void ClassicCommDetector::AnalyzeChunk(FlagChunk &chunk,
+                                       std::atomic<long long> &progress,
+                                       const std::atomic<bool> &abort) const
+{
+    auto *player = dynamic_cast<MythCommFlagPlayer*>(chunk.context->m_player);
+    FrameScratch scratch;
+    long long seekTo = chunk.start;
+
+    while (!abort && (player->GetEof() == kEofStateNone))
+    {
+        // The first chunk starts at the beginning; the others seek.
+        MythVideoFrame* frame = player->GetRawVideoFrame(seekTo > 0 ? seekTo : -1);
+        seekTo = -1;
+        long long frameNumber = frame->m_frameNumber;
+
+        if ((chunk.end >= 0) && (frameNumber >= chunk.end))
+        {
+            player->DiscardVideoFrame(frame);
+            break;
+        }
+
+        if (CheckFrame(frame, frameNumber))
+        {
+            FrameAnalysis analysis;
+            analysis.frameNumber = frameNumber;
+            analysis.aspect = frame->m_aspect;
+            AnalyzeFrame(frame, scratch, analysis);
+
+            if (m_commDetectMethod & COMM_DETECT_SCENE)
+            {
+                if (chunk.frames.empty())
+                {
+                    chunk.first = scratch.histogram;
+                }
+                else
+                {
+                    analysis.similarity =
+                        scratch.histogram.calculateSimilarityWith(chunk.last);
+                    analysis.haveSimilarity = true;
+                }
+                chunk.last = scratch.histogram;
+            }
+            chunk.frames.push_back(analysis);
+        }
+
+        player->DiscardVideoFrame(frame);
+        progress++;
+    }
 }
 
 void ClassicCommDetector::ClearAllMaps(void)
@@ -2,7 +2,9 @@
 #define CLASSIC_COMMDETECTOR_H
 
 // C++ headers
+#include <atomic>
 #include <cstdint>
+#include <vector>
 
 // Qt headers
 #include <QObject>
@@ -16,10 +18,16 @@
 
 // Commercial Flagging headers
 #include "CommDetectorBase.h"
+#include "Histogram.h"
+#include "pixelkernels.h"
 
 class MythCommFlagPlayer;
 class LogoDetectorBase;
-class SceneChangeDetectorBase;
+class ClassicSceneChangeDetector;
+class FramePipeline;
+class ChunkFlagTask;
+struct PipelineSlot;
+struct FlagChunk;
 
 enum frameMaskValues {
     COMM_FRAME_SKIPPED       = 0x0001,
@@ -44,6 +52,31 @@ class FrameInfoEntry
     QString toString(uint64_t frame, bool verbose) const;
 };
 
+/// Everything ClassicCommDetector measures in a single frame, before it is
+/// combined with the frames around it.
+struct FrameAnalysis
+{
+    long long frameNumber    {-1};
+    float     aspect         {-1.0F};
+    bool      checked        {false}; ///< blank detection sampled some pixels
+    int       minBrightness  {-1};
+    int       maxBrightness  {-1};
+    int       avgBrightness  {-1};
+    int       format         {0};
+    bool      blank          {false};
+    bool      logoPresent    {false};
+    bool      haveSimilarity {false}; ///< scene similarity already computed
+    float     similarity     {0.0F};
+};
+
+/// Working storage for analysing one frame; one per analysis thread.
+struct FrameScratch
+{
+    std::vector<unsigned char> rowMax;
+    std::vector<unsigned char> colMax;
+    Histogram                  histogram;
+};
+
 class ClassicCommDetector : public CommDetectorBase
 {
     Q_OBJECT
@@ -69,6 +102,8 @@ class ClassicCommDetector : public CommDetectorBase
         void logoDetectorBreathe();
 
         friend class ClassicLogoDetector;
+        friend class FramePipeline;
+        friend class ChunkFlagTask;
 
     protected:
         ~ClassicCommDetector() override = default;
@@ -159,6 +194,9 @@ class ClassicCommDetector : public CommDetectorBase
         int m_height                       {0};
         int m_horizSpacing                 {0};
         int m_vertSpacing                  {0};
+        pixelKernels::SampleMask m_sampleMask;
+        FrameScratch m_scratch;
+        float m_lastAspect                 {-1.0F};
         bool m_blankFramesOnly             {false};
         int m_blankFrameCount              {0};
         int m_currentAspect                {0};
@@ -182,7 +220,7 @@ class ClassicCommDetector : public CommDetectorBase
 
         bool m_decoderFoundAspectChanges   {false};
 
-        SceneChangeDetectorBase* m_sceneChangeDetector {nullptr};
+        ClassicSceneChangeDetector* m_sceneChangeDetector {nullptr};
 
 protected:
         MythCommFlagPlayer *m_player       {nullptr};
@@ -203,6 +241,21 @@ protected:
         void Init();
         void SetVideoParams(float aspect);
         void ProcessFrame(MythVideoFrame *frame, long long frame_number);
+        bool CheckFrame(const MythVideoFrame *frame, long long frame_number) const;
+        void AnalyzeFrame(MythVideoFrame *frame, FrameScratch &scratch,
+                          FrameAnalysis &analysis) const;
+        void ApplyFrameAnalysis(const FrameAnalysis &analysis,
+                                const Histogram &histogram);
+        void CheckAspect(float aspect);
+        void ReportProgress(long long framesDone, long long totalFrames,
+                            const QElapsedTimer &flagTime, int &prevpercent);
+        void QueueFrame(FramePipeline &pipeline, MythVideoFrame *frame,
+                        long long frame_number);
+        void ApplySlot(FramePipeline &pipeline, PipelineSlot *slot);
+        int  GoChunked(int chunks, long long totalFrames,
+                       const QElapsedTimer &flagTime);
+        void AnalyzeChunk(FlagChunk &chunk, std::atomic<long long> &progress,
+                          const std::atomic<bool> &abort) const;
         QMap<long long, FrameInfoEntry> m_frameInfo;
 
 public slots:
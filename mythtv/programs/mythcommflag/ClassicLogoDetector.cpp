@@ -382,7 +382,7 @@ bool ClassicLogoDetector::doesThisFrameContainTheFoundLogo(
     int testEdges = 0;
     int testNotEdges = 0;
 
-    unsigned char* framePtr = frame->m_buffer;
+    const unsigned char* framePtr = frame->m_buffer;
     int bytesPerLine = frame->m_pitches[0];
 
     for (uint y = m_logoMinY; y <= m_logoMaxY; y++ )
@@ -428,7 +428,6 @@ bool ClassicLogoDetector::doesThisFrameContainTheFoundLogo(
         }
     }
 
-    m_frameNumber++;
     double goodEdgeRatio = (testEdges) ?
         (double)goodEdges / (double)testEdges : 0.0;
     double badEdgeRatio = (testNotEdges) ?
@@ -446,6 +445,17 @@ bool ClassicLogoDetector::pixelInsideLogo(unsigned int x, unsigned int y)
             (y > m_logoMinY) && (y < m_logoMaxY));
 }
 
+bool ClassicLogoDetector::logoRowSpan(unsigned int y,
+                                      unsigned int &minx, unsigned int &maxx)
+{
+    if (!m_logoInfoAvailable || (y <= m_logoMinY) || (y >= m_logoMaxY))
+        return false;
+
+    minx = m_logoMinX;
+    maxx = m_logoMaxX;
+    return true;
+}
+
 void ClassicLogoDetector::DetectEdges(MythVideoFrame *frame, EdgeMaskEntry *edges,
                                       int edgeDiff)
 {
@@ -16,6 +16,8 @@ class ClassicLogoDetector : public LogoDetectorBase
     bool searchForLogo(MythCommFlagPlayer* player) override; // LogoDetectorBase
     bool doesThisFrameContainTheFoundLogo(MythVideoFrame* frame) override; // LogoDetectorBase
     bool pixelInsideLogo(unsigned int x, unsigned int y) override; // LogoDetectorBase
+    bool logoRowSpan(unsigned int y, unsigned int &minx,
+                     unsigned int &maxx) override; // LogoDetectorBase
 
     unsigned int getRequiredAvailableBufferForSearch() override; // LogoDetectorBase
 
@@ -28,7 +30,6 @@ class ClassicLogoDetector : public LogoDetectorBase
     void DetectEdges(MythVideoFrame *frame, EdgeMaskEntry *edges, int edgeDiff);
 
     ClassicCommDetector *m_commDetector                    {nullptr};
-    unsigned int         m_frameNumber                     {0};
     unsigned int         m_commDetectBorder                {16};
 
     int                  m_commDetectLogoSamplesNeeded     {240};
@@ -1,5 +1,3 @@
-#include <algorithm>
-
 #include "ClassicSceneChangeDetector.h"
 #include "Histogram.h"
 
@@ -28,17 +26,32 @@ void ClassicSceneChangeDetector::deleteLater(void)
 
 void ClassicSceneChangeDetector::processFrame(MythVideoFrame* frame)
 {
-    m_histogram->generateFromImage(frame, m_width, m_height, m_commdetectborder,
+    generateHistogram(frame, m_histogram);
+    processHistogram(*m_histogram);
+}
+
+void ClassicSceneChangeDetector::generateHistogram(const MythVideoFrame* frame,
+                                                   Histogram* histogram) const
+{
+    histogram->generateFromImage(frame, m_width, m_height, m_commdetectborder,
                                  m_width-m_commdetectborder, m_commdetectborder,
                                  m_height-m_commdetectborder, m_xspacing, m_yspacing);
-    float similar = m_histogram->calculateSimilarityWith(*m_previousHistogram);
+}
 
+void ClassicSceneChangeDetector::processHistogram(const Histogram& histogram)
+{
+    float similar = histogram.calculateSimilarityWith(*m_previousHistogram);
+    *m_previousHistogram = histogram;
+    processSimilarity(similar);
+}
+
+void ClassicSceneChangeDetector::processSimilarity(float similar)
+{
     bool isSceneChange = (similar < .85F && !m_previousFrameWasSceneChange);
 
     emit haveNewInformation(m_frameNumber,isSceneChange,similar);
     m_previousFrameWasSceneChange = isSceneChange;
 
-    std::swap(m_histogram,m_previousHistogram);
     m_frameNumber++;
 }
 
@@ -15,6 +15,13 @@ class ClassicSceneChangeDetector : public SceneChangeDetectorBase
 
     void processFrame(MythVideoFrame* frame) override; // SceneChangeDetectorBase
 
+    // processFrame() in steps, so that the histograms of several frames
+    // can be generated in parallel. Frames must still be processed in order.
+    void generateHistogram(const MythVideoFrame* frame,
+                           Histogram* histogram) const;
+    void processHistogram(const Histogram& histogram);
+    void processSimilarity(float similar);
+
   private:
     ~ClassicSceneChangeDetector() override;
 
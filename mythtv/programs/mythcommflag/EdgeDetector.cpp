@@ -1,6 +1,9 @@
 // C++ headers
 #include <algorithm>
+#include <array>
+#include <climits>
 #include <cstdlib>
+#include <utility>
 
 #include "libmythbase/mythconfig.h"
 
@@ -16,11 +19,31 @@ extern "C" {
 // Commercial Flagging headers
 #include "EdgeDetector.h"
 #include "FrameAnalyzer.h"
+#include "pixelkernels.h"
 
 namespace edgeDetector {
 
 using namespace frameAnalyzer;
 
+/*
+ * The runs of columns [0, width) of row "rr" that lie outside the exclude
+ * rectangle, as (first column, count) pairs; the same pixels as the ones
+ * for which rrccinrect() is false.
+ */
+static std::array<std::pair<int,int>,2>
+row_segments(int rr, int width, int excluderow, int excludecol,
+        int excludewidth, int excludeheight)
+{
+    int lo = width;
+    int hi = width;
+    if (rr >= excluderow && rr < excluderow + excludeheight)
+    {
+        lo = std::clamp(excludecol, 0, width);
+        hi = std::clamp(excludecol + excludewidth, lo, width);
+    }
+    return {{ {0, lo}, {hi, width - hi} }};
+}
+
 unsigned int *
 sgm_init_exclude(unsigned int *sgm, const AVFrame *src, int srcheight,
         int excluderow, int excludecol, int excludewidth, int excludeheight)
@@ -39,17 +62,13 @@ sgm_init_exclude(unsigned int *sgm, const AVFrame *src, int srcheight,
     int cc2 = srcwidth - 1;
     for (int rr = 0; rr < rr2; rr++)
     {
-        for (int cc = 0; cc < cc2; cc++)
+        const uchar *row0 = src->data[0] + (rr * srcwidth);
+        unsigned int *sgmrow = sgm + (rr * srcwidth);
+        for (const auto & [cc, width] : row_segments(rr, cc2, excluderow,
+                    excludecol, excludewidth, excludeheight))
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                uchar *rr0 = &src->data[0][rr * srcwidth + cc];
-                uchar *rr1 = &src->data[0][(rr + 1) * srcwidth + cc];
-                int dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                int dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[rr * srcwidth + cc] = dx * dx + dy * dy;
-            }
+            pixelKernels::squaredGradientRow(sgmrow + cc, row0 + cc,
+                    row0 + srcwidth + cc, width);
         }
     }
     return sgm;
@@ -63,11 +82,6 @@ sgm_init(unsigned int *sgm, const AVFrame *src, int srcheight)
 }
 #endif /* LATER */
 
-static int sort_ascending(const void *aa, const void *bb)
-{
-    return *(unsigned int*)aa - *(unsigned int*)bb;
-}
-
 static int
 edge_mark(AVFrame *dst, int dstheight,
         int extratop, int extraright,
@@ -98,14 +112,13 @@ edge_mark(AVFrame *dst, int dstheight,
     int nn = 0;
     for (int rr = 0; rr < dstheight; rr++)
     {
-        for (int cc = 0; cc < dstwidth; cc++)
+        const unsigned int *sgmrow = sgm + ((extratop + rr) * padded_width) +
+            extraleft;
+        for (const auto & [cc, width] : row_segments(rr, dstwidth,
+                    excluderow, excludecol, excludewidth, excludeheight))
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                sgmsorted[nn++] = sgm[(extratop + rr) * padded_width +
-                    extraleft + cc];
-            }
+            std::copy(sgmrow + cc, sgmrow + cc + width, sgmsorted + nn);
+            nn += width;
         }
     }
 
@@ -125,29 +138,37 @@ edge_mark(AVFrame *dst, int dstheight,
             return 0;
     }
 
-    qsort(sgmsorted, nn, sizeof(*sgmsorted), sort_ascending);
-
-    int ii = percentile * nn / 100;
+    /*
+     * Only the order statistics around the percentile are needed, so select
+     * rather than sort: "first" and "last" are the positions the threshold
+     * value would span in the sorted array, and "nextval" the value that
+     * would follow it.
+     */
+    int ii = std::min(percentile * nn / 100, nn - 1);
+    std::nth_element(sgmsorted, sgmsorted + ii, sgmsorted + nn);
     uint thresholdval = sgmsorted[ii];
 
+    int first = 0;
+    int last = -1;
+    uint nextval = UINT_MAX;
+    for (int jj = 0; jj < nn; jj++)
+    {
+        uint val = sgmsorted[jj];
+        if (val < thresholdval)
+            first++;
+        if (val <= thresholdval)
+            last++;
+        else if (val < nextval)
+            nextval = val;
+    }
+
     /*
      * Try not to pick up too many edges, and eliminate degenerate edge-less
      * cases.
      */
-    int first = ii;
-    for ( ; first > 0 && sgmsorted[first] == thresholdval; first--) ;
-    if (sgmsorted[first] != thresholdval)
-        first++;
     if (first * 100 / nn < kMinThresholdPct)
     {
-        int last = ii;
-        int last2 = nn - 1;
-        for ( ; last < last2 && sgmsorted[last] == thresholdval;
-                last++) ;
-        if (sgmsorted[last] != thresholdval)
-            last--;
-
-        uint newthresholdval = sgmsorted[std::min(last + 1, nn - 1)];
+        uint newthresholdval = last + 1 < nn ? nextval : thresholdval;
         if (thresholdval == newthresholdval)
         {
             /* Degenerate case; no edges (e.g., blank frame). */
@@ -160,13 +181,14 @@ edge_mark(AVFrame *dst, int dstheight,
     /* sgm is a padded matrix; dst is the unpadded matrix. */
     for (int rr = 0; rr < dstheight; rr++)
     {
-        for (int cc = 0; cc < dstwidth; cc++)
+        const unsigned int *sgmrow = sgm + ((extratop + rr) * padded_width) +
+            extraleft;
+        uchar *dstrow = dst->data[0] + (rr * dstwidth);
+        for (const auto & [cc, width] : row_segments(rr, dstwidth,
+                    excluderow, excludecol, excludewidth, excludeheight))
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight) &&
-                    sgm[(extratop + rr) * padded_width + extraleft + cc] >=
-                        thresholdval)
-                dst->data[0][rr * dstwidth + cc] = UCHAR_MAX;
+            pixelKernels::thresholdRow(dstrow + cc, sgmrow + cc, width,
+                    thresholdval);
         }
     }
     return 0;
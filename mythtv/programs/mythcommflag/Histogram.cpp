@@ -6,7 +6,7 @@
 
 #include "Histogram.h"
 
-void Histogram::generateFromImage(MythVideoFrame* frame, unsigned int frameWidth,
+void Histogram::generateFromImage(const MythVideoFrame* frame, unsigned int frameWidth,
          unsigned int frameHeight, unsigned int minScanX, unsigned int maxScanX,
          unsigned int minScanY, unsigned int maxScanY, unsigned int XSpacing,
          unsigned int YSpacing)
@@ -20,7 +20,7 @@ void Histogram::generateFromImage(MythVideoFrame* frame, unsigned int frameWidth
     if (maxScanY > frameHeight-1)
         maxScanY = frameHeight-1;
 
-    unsigned char* framePtr = frame->m_buffer;
+    const unsigned char* framePtr = frame->m_buffer;
     int bytesPerLine = frame->m_pitches[0];
     for(unsigned int y = minScanY; y < maxScanY; y += YSpacing)
     {
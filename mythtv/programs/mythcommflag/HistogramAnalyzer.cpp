@@ -15,7 +15,6 @@
 #include "HistogramAnalyzer.h"
 #include "PGMConverter.h"
 #include "TemplateFinder.h"
-#include "quickselect.h"
 
 using namespace commDetector2;
 using namespace frameAnalyzer;
@@ -175,7 +174,6 @@ HistogramAnalyzer::~HistogramAnalyzer()
     delete []m_fWidth;
     delete []m_fHeight;
     delete []m_histogram;
-    delete []m_buf;
 }
 
 enum FrameAnalyzer::analyzeFrameResult
@@ -231,9 +229,6 @@ HistogramAnalyzer::MythPlayerInited(MythPlayer *player, long long nframes)
     memset(m_histogram, 0, nframes * sizeof(*m_histogram));
     memset(m_monochromatic, 0, nframes * sizeof(*m_monochromatic));
 
-    unsigned int npixels = width * height;
-    m_buf = new unsigned char[npixels];
-
     if (m_debugHistVal)
     {
         if (readData(m_debugdata, m_mean, m_median, m_stddev, m_fRow, m_fCol,
@@ -289,7 +284,7 @@ HistogramAnalyzer::analyzeFrame(const MythVideoFrame *frame, long long frameno)
     unsigned int        livepixels = 0;
     unsigned int        npixels = 0;
     unsigned int        halfnpixels = 0;
-    unsigned char       *pp = nullptr;
+    unsigned int        rank = 0;
     unsigned char       bordercolor = 0;
     unsigned long long  sumval = 0;
     unsigned long long  sumsquares = 0;
@@ -340,21 +335,27 @@ HistogramAnalyzer::analyzeFrame(const MythVideoFrame *frame, long long frameno)
         ((rr2 - rr1) / kRInc) * ((cc3 - cc2) / kCInc) +   /* right */
         ((rr3 - rr2) / kRInc) * (cc3 / kCInc);            /* bottom */
 
-    pp = &m_buf[borderpixels];
     m_histVal.fill(0);
     m_histVal[kDefaultColor] += borderpixels;
     for (int rr = rr1; rr < rr2; rr += kRInc)
     {
-        int rroffset = rr * pgmwidth;
+        const unsigned char *row = pgm->data[0] + (rr * pgmwidth);
+
+        /* Exclude logo area from analysis: split the row around it. */
+        int skip1 = cc2;
+        int skip2 = cc2;
+        if (m_logo && rr >= m_logoRr1 && rr <= m_logoRr2)
+        {
+            skip1 = m_logoCc1;
+            skip2 = m_logoCc2;
+        }
 
         for (int cc = cc1; cc < cc2; cc += kCInc)
         {
-            if (m_logo && rr >= m_logoRr1 && rr <= m_logoRr2 &&
-                    cc >= m_logoCc1 && cc <= m_logoCc2)
-                continue; /* Exclude logo area from analysis. */
+            if (cc >= skip1 && cc <= skip2)
+                continue;
 
-            unsigned char val = pgm->data[0][rroffset + cc];
-            *pp++ = val;
+            unsigned char val = row[cc];
             sumval += val;
             sumsquares += 1ULL * val * val;
             livepixels++;
@@ -381,10 +382,27 @@ HistogramAnalyzer::analyzeFrame(const MythVideoFrame *frame, long long frameno)
         sumsquares += 1ULL * borderpixels * bordercolor * bordercolor;
     }
 
-    memset(m_buf, bordercolor, borderpixels * sizeof(*m_buf));
+    /*
+     * Median of the samples, counting the margin pixels as "bordercolor":
+     * the same element quick_select_median() would pick, but read straight
+     * off the histogram instead of selecting from a copy of the samples.
+     */
+    m_histVal[kDefaultColor] -= borderpixels;
+    m_histVal[bordercolor] += borderpixels;
+    rank = (npixels - 1) / 2;
+    m_median[frameno] = 0;
+    for (unsigned int color = 0, seen = 0; color < UCHAR_MAX + 1; color++)
+    {
+        seen += m_histVal[color];
+        if (seen > rank)
+        {
+            m_median[frameno] = color;
+            break;
+        }
+    }
+
     m_monochromatic[frameno] = ismonochromatic ? 1 : 0;
     m_mean[frameno] = (float)sumval / npixels;
-    m_median[frameno] = quick_select_median(m_buf, npixels);
     m_stddev[frameno] = npixels > 1 ?
         sqrt((sumsquares - (float)sumval * sumval / npixels) / (npixels - 1)) :
             0;
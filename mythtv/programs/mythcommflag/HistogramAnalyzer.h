@@ -64,7 +64,6 @@ private:
     Histogram            *m_histogram     {nullptr}; /* histogram */
     unsigned char        *m_monochromatic {nullptr}; /* computed boolean */
     std::array<int,UCHAR_MAX+1> m_histVal {0}; /* temporary buffer */
-    unsigned char        *m_buf           {nullptr}; /* temporary buffer */
     long long             m_lastFrameNo   {-1};
 
     /* Debugging */
@@ -15,8 +15,14 @@ class LogoDetectorBase : public QObject
         m_width(w),m_height(h) {}
 
     virtual bool searchForLogo(MythCommFlagPlayer* player) = 0;
+    // Once the logo has been found, this may be called for several frames
+    // at once from different threads.
     virtual bool doesThisFrameContainTheFoundLogo(MythVideoFrame* frame) = 0;
     virtual bool pixelInsideLogo(unsigned int x, unsigned int y) = 0;
+    // On row y, pixelInsideLogo() is true exactly for minx < x < maxx.
+    // Returns false if no pixel of the row is inside the logo.
+    virtual bool logoRowSpan(unsigned int y,
+                             unsigned int &minx, unsigned int &maxx) = 0;
     virtual unsigned int getRequiredAvailableBufferForSearch() = 0;
 
   signals:
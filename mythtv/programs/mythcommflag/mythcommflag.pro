@@ -20,6 +20,7 @@ HEADERS += Histogram.h
 HEADERS += quickselect.h
 HEADERS += CommDetector2.h
 HEADERS += pgm.h
+HEADERS += pixelkernels.h
 HEADERS += EdgeDetector.h CannyEdgeDetector.h
 HEADERS += PGMConverter.h BorderDetector.h
 HEADERS += FrameAnalyzer.h
@@ -41,6 +42,7 @@ SOURCES += Histogram.cpp
 SOURCES += quickselect.cpp
 SOURCES += CommDetector2.cpp
 SOURCES += pgm.cpp
+SOURCES += pixelkernels.cpp
 SOURCES += EdgeDetector.cpp CannyEdgeDetector.cpp
 SOURCES += PGMConverter.cpp BorderDetector.cpp
 SOURCES += FrameAnalyzer.cpp
@@ -7,6 +7,7 @@
 
 // Commercial Flagging headers
 #include "pgm.h"
+#include "pixelkernels.h"
 
 extern "C" {
 #include "libavcodec/avcodec.h"
@@ -260,34 +261,19 @@ int pgm_convolve_radial(AVFrame *dst, AVFrame *s1, AVFrame *s2,
 
     /* "s1" convolve with column vector => "s2" */
     int rr2 = mask_radius + srcheight;
-    int cc2 = mask_radius + srcwidth;
     for (int rr = mask_radius; rr < rr2; rr++)
     {
-        for (int cc = mask_radius; cc < cc2; cc++)
-        {
-            double sum = 0;
-            for (int ii = -mask_radius; ii <= mask_radius; ii++)
-            {
-                sum += mask[ii + mask_radius] *
-                    s1->data[0][(rr + ii) * newwidth + cc];
-            }
-            s2->data[0][rr * newwidth + cc] = lround(sum);
-        }
+        ptrdiff_t off = (static_cast<ptrdiff_t>(rr) * newwidth) + mask_radius;
+        pixelKernels::convolveColumn(s2->data[0] + off, s1->data[0] + off,
+                newwidth, srcwidth, mask, mask_radius);
     }
 
     /* "s2" convolve with row vector => "dst" */
     for (int rr = mask_radius; rr < rr2; rr++)
     {
-        for (int cc = mask_radius; cc < cc2; cc++)
-        {
-            double sum = 0;
-            for (int ii = -mask_radius; ii <= mask_radius; ii++)
-            {
-                sum += mask[ii + mask_radius] *
-                    s2->data[0][rr * newwidth + cc + ii];
-            }
-            dst->data[0][rr * newwidth + cc] = lround(sum);
-        }
+        ptrdiff_t off = (static_cast<ptrdiff_t>(rr) * newwidth) + mask_radius;
+        pixelKernels::convolveRow(dst->data[0] + off, s2->data[0] + off,
+                srcwidth, mask, mask_radius);
     }
 
     return 0;
@@ -0,0 +1,490 @@
+// C++ headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+// Qt headers
+#include <QtGlobal>
+
+// MythTV headers
+#include "libmythbase/mythconfig.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+// Commercial Flagging headers
+#include "pixelkernels.h"
+
+#ifdef Q_PROCESSOR_X86_64
+#   include <emmintrin.h>
+static const bool s_haveSIMD = true;
+#elif HAVE_INTRINSICS_NEON
+#   include <arm_neon.h>
+static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_NEON;
+#else
+static const bool s_haveSIMD = false;
+#endif
+
+/*
+ * The convolutions need double precision lanes to give the same results
+ * as the C code; NEON only has those on AArch64.
+ */
+#if defined(Q_PROCESSOR_X86_64) || (HAVE_INTRINSICS_NEON && defined(__aarch64__))
+#define HAVE_SIMD_DOUBLE 1 // NOLINT(cppcoreguidelines-macro-usage)
+#else
+#define HAVE_SIMD_DOUBLE 0 // NOLINT(cppcoreguidelines-macro-usage)
+#endif
+
+namespace pixelKernels {
+
+bool
+haveSIMD(void)
+{
+    return s_haveSIMD;
+}
+
+void
+initSampleMask(SampleMask *mask, int step)
+{
+    mask->step = step;
+    mask->period = 0;
+    if (step < 1 || step > 16)
+        return;     /* sampleRow uses the C loop */
+
+    /* The pattern repeats after lcm(16, step) bytes. */
+    mask->period = step / std::gcd(step, 16);
+    for (int bb = 0; bb < mask->period; bb++)
+    {
+        for (int ll = 0; ll < 16; ll++)
+            mask->lanes[bb][ll] = ((bb * 16 + ll) % step) ? 0 : UCHAR_MAX;
+    }
+}
+
+static unsigned char
+sample_row_c(const unsigned char *row, int x0, int x1, int step,
+        unsigned char *colmax, SampleStats *stats)
+{
+    unsigned char rowmax = 0;
+    unsigned char rowmin = UCHAR_MAX;
+    for (int xx = x0; xx < x1; xx += step)
+    {
+        unsigned char pixel = row[xx];
+        stats->count++;
+        stats->sum += pixel;
+        rowmin = std::min(rowmin, pixel);
+        rowmax = std::max(rowmax, pixel);
+        colmax[xx] = std::max(colmax[xx], pixel);
+    }
+    stats->min = std::min(stats->min, rowmin);
+    return rowmax;
+}
+
+unsigned char
+sampleRow(const unsigned char *row, int x0, int x1, const SampleMask &mask,
+        unsigned char *colmax, SampleStats *stats)
+{
+    const int       step = std::max(1, mask.step);
+    const int       len = x1 - x0;
+    int             off = 0;
+    unsigned char   rowmax = 0;
+
+    if (len <= 0)
+        return 0;
+
+#if defined(Q_PROCESSOR_X86_64) || HAVE_INTRINSICS_NEON
+    if (s_haveSIMD && mask.period && len >= 16)
+    {
+        /*
+         * Whole 16-byte blocks: unsampled lanes are forced to 0 for the
+         * maximum/sum/colmax and to 255 for the minimum. Every block holds
+         * at least one sample as step <= 16.
+         */
+        const unsigned char *src = row + x0;
+        unsigned char       *cmax = colmax + x0;
+        unsigned char       vmin = UCHAR_MAX;
+        unsigned char       vmax = 0;
+        unsigned long long  vsum = 0;
+        int                 bb = 0;
+
+#ifdef Q_PROCESSOR_X86_64
+        const __m128i   zero = _mm_setzero_si128();
+        const __m128i   ones = _mm_set1_epi8(-1);
+        __m128i         mn = ones;
+        __m128i         mx = zero;
+        __m128i         sum = zero;
+        for ( ; off + 16 <= len; off += 16)
+        {
+            __m128i msk = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(mask.lanes[bb].data()));
+            __m128i pix = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + off));
+            __m128i hit = _mm_and_si128(pix, msk);
+            mx = _mm_max_epu8(mx, hit);
+            mn = _mm_min_epu8(mn, _mm_or_si128(pix, _mm_xor_si128(msk, ones)));
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(hit, zero));
+            auto *cptr = reinterpret_cast<__m128i*>(cmax + off);
+            _mm_storeu_si128(cptr, _mm_max_epu8(_mm_loadu_si128(cptr), hit));
+            if (++bb == mask.period)
+                bb = 0;
+        }
+        mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 8));
+        mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 4));
+        mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 2));
+        mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 1));
+        mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 8));
+        mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 4));
+        mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 2));
+        mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 1));
+        vmax = _mm_cvtsi128_si32(mx) & UCHAR_MAX;
+        vmin = _mm_cvtsi128_si32(mn) & UCHAR_MAX;
+        vsum = static_cast<uint64_t>(_mm_cvtsi128_si64(sum)) +
+            static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum)));
+#else
+        uint8x16_t      mn = vdupq_n_u8(UCHAR_MAX);
+        uint8x16_t      mx = vdupq_n_u8(0);
+        uint64x2_t      sum = vdupq_n_u64(0);
+        for ( ; off + 16 <= len; off += 16)
+        {
+            uint8x16_t msk = vld1q_u8(mask.lanes[bb].data());
+            uint8x16_t pix = vld1q_u8(src + off);
+            uint8x16_t hit = vandq_u8(pix, msk);
+            mx = vmaxq_u8(mx, hit);
+            mn = vminq_u8(mn, vornq_u8(pix, msk));
+            sum = vpadalq_u32(sum, vpaddlq_u16(vpaddlq_u8(hit)));
+            vst1q_u8(cmax + off, vmaxq_u8(vld1q_u8(cmax + off), hit));
+            if (++bb == mask.period)
+                bb = 0;
+        }
+        uint8x8_t hmx = vpmax_u8(vget_low_u8(mx), vget_high_u8(mx));
+        uint8x8_t hmn = vpmin_u8(vget_low_u8(mn), vget_high_u8(mn));
+        for (int ii = 0; ii < 3; ii++)
+        {
+            hmx = vpmax_u8(hmx, hmx);
+            hmn = vpmin_u8(hmn, hmn);
+        }
+        vmax = vget_lane_u8(hmx, 0);
+        vmin = vget_lane_u8(hmn, 0);
+        vsum = vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+#endif
+
+        stats->count += (off + step - 1) / step;
+        stats->sum += vsum;
+        stats->min = std::min(stats->min, vmin);
+        rowmax = vmax;
+    }
+#endif
+
+    /* Remaining samples, starting on the sampling grid. */
+    int xx = x0 + ((off + step - 1) / step * step);
+    rowmax = std::max(rowmax, sample_row_c(row, xx, x1, step, colmax, stats));
+    stats->max = std::max(stats->max, rowmax);
+    return rowmax;
+}
+
+#if defined(Q_PROCESSOR_X86_64)
+/* Load 4 pixels as two pairs of doubles. */
+static inline void
+load4_pd(const unsigned char *src, __m128d *lo, __m128d *hi)
+{
+    int32_t word = 0;
+    memcpy(&word, src, sizeof(word));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i pix = _mm_unpacklo_epi16(
+            _mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero), zero);
+    *lo = _mm_cvtepi32_pd(pix);
+    *hi = _mm_cvtepi32_pd(_mm_srli_si128(pix, 8));
+}
+
+/* lround() of two non-negative doubles, as int32 in the low 64 bits. */
+static inline __m128i
+round_pd(__m128d sum)
+{
+    __m128d whole = _mm_cvtepi32_pd(_mm_cvttpd_epi32(sum));
+    __m128d up = _mm_and_pd(_mm_cmpge_pd(_mm_sub_pd(sum, whole),
+                _mm_set1_pd(0.5)), _mm_set1_pd(1.0));
+    return _mm_cvttpd_epi32(_mm_add_pd(whole, up));
+}
+
+static inline void
+store4_pd(unsigned char *dst, __m128d lo, __m128d hi)
+{
+    __m128i pix = _mm_unpacklo_epi64(round_pd(lo), round_pd(hi));
+    pix = _mm_packs_epi32(pix, pix);
+    pix = _mm_packus_epi16(pix, pix);
+    int32_t word = _mm_cvtsi128_si32(pix);
+    memcpy(dst, &word, sizeof(word));
+}
+
+/* Sum of the taps for 4 pixels; same order of operations as the C code. */
+static inline void
+convolve4(unsigned char *dst, const unsigned char *src, ptrdiff_t step,
+        const double *mask, int radius)
+{
+    __m128d lo = _mm_setzero_pd();
+    __m128d hi = _mm_setzero_pd();
+    for (int ii = -radius; ii <= radius; ii++)
+    {
+        __m128d weight = _mm_set1_pd(mask[ii + radius]);
+        __m128d plo {};
+        __m128d phi {};
+        load4_pd(src + (ii * step), &plo, &phi);
+        lo = _mm_add_pd(lo, _mm_mul_pd(weight, plo));
+        hi = _mm_add_pd(hi, _mm_mul_pd(weight, phi));
+    }
+    store4_pd(dst, lo, hi);
+}
+#elif HAVE_SIMD_DOUBLE
+static inline void
+convolve4(unsigned char *dst, const unsigned char *src, ptrdiff_t step,
+        const double *mask, int radius)
+{
+    float64x2_t lo = vdupq_n_f64(0.0);
+    float64x2_t hi = vdupq_n_f64(0.0);
+    for (int ii = -radius; ii <= radius; ii++)
+    {
+        float64x2_t weight = vdupq_n_f64(mask[ii + radius]);
+        uint32_t word = 0;
+        memcpy(&word, src + (ii * step), sizeof(word));
+        uint32x4_t pix = vmovl_u16(vget_low_u16(vmovl_u8(
+                        vreinterpret_u8_u32(vdup_n_u32(word)))));
+        lo = vaddq_f64(lo, vmulq_f64(weight,
+                    vcvtq_f64_u64(vmovl_u32(vget_low_u32(pix)))));
+        hi = vaddq_f64(hi, vmulq_f64(weight,
+                    vcvtq_f64_u64(vmovl_u32(vget_high_u32(pix)))));
+    }
+    /* vcvtaq rounds half away from zero, like lround(). */
+    uint32x4_t whole = vcombine_u32(vmovn_u64(vcvtaq_u64_f64(lo)),
+                                    vmovn_u64(vcvtaq_u64_f64(hi)));
+    uint16x4_t half = vqmovn_u32(whole);
+    uint8x8_t  pix = vqmovn_u16(vcombine_u16(half, half));
+    uint32_t   word = vget_lane_u32(vreinterpret_u32_u8(pix), 0);
+    memcpy(dst, &word, sizeof(word));
+}
+#endif
+
+void
+convolveColumn(unsigned char *dst, const unsigned char *src,
+        ptrdiff_t stride, int width, const double *mask, int radius)
+{
+    int cc = 0;
+#if HAVE_SIMD_DOUBLE
+    if (s_haveSIMD)
+    {
+        for ( ; cc + 4 <= width; cc += 4)
+            convolve4(dst + cc, src + cc, stride, mask, radius);
+    }
+#endif
+    for ( ; cc < width; cc++)
+    {
+        double sum = 0;
+        for (int ii = -radius; ii <= radius; ii++)
+            sum += mask[ii + radius] * src[(ii * stride) + cc];
+        dst[cc] = lround(sum);
+    }
+}
+
+void
+convolveRow(unsigned char *dst, const unsigned char *src, int width,
+        const double *mask, int radius)
+{
+    int cc = 0;
+#if HAVE_SIMD_DOUBLE
+    if (s_haveSIMD)
+    {
+        for ( ; cc + 4 <= width; cc += 4)
+            convolve4(dst + cc, src + cc, 1, mask, radius);
+    }
+#endif
+    for ( ; cc < width; cc++)
+    {
+        double sum = 0;
+        for (int ii = -radius; ii <= radius; ii++)
+            sum += mask[ii + radius] * src[cc + ii];
+        dst[cc] = lround(sum);
+    }
+}
+
+void
+squaredGradientRow(unsigned int *sgm, const unsigned char *row0,
+        const unsigned char *row1, int width)
+{
+    int cc = 0;
+#ifdef Q_PROCESSOR_X86_64
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; cc + 8 <= width; cc += 8)
+    {
+        __m128i nw = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row0 + cc)), zero);
+        __m128i ne = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row0 + cc + 1)), zero);
+        __m128i sw = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row1 + cc)), zero);
+        __m128i se = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row1 + cc + 1)), zero);
+        __m128i dx = _mm_sub_epi16(se, nw);
+        __m128i dy = _mm_sub_epi16(sw, ne);
+        /* madd of interleaved (dx, dy) pairs with themselves: dx*dx + dy*dy */
+        __m128i lo = _mm_unpacklo_epi16(dx, dy);
+        __m128i hi = _mm_unpackhi_epi16(dx, dy);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sgm + cc),
+                _mm_madd_epi16(lo, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sgm + cc + 4),
+                _mm_madd_epi16(hi, hi));
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        for ( ; cc + 8 <= width; cc += 8)
+        {
+            int16x8_t dx = vreinterpretq_s16_u16(
+                    vsubl_u8(vld1_u8(row1 + cc + 1), vld1_u8(row0 + cc)));
+            int16x8_t dy = vreinterpretq_s16_u16(
+                    vsubl_u8(vld1_u8(row1 + cc), vld1_u8(row0 + cc + 1)));
+            int32x4_t lo = vmull_s16(vget_low_s16(dx), vget_low_s16(dx));
+            int32x4_t hi = vmull_s16(vget_high_s16(dx), vget_high_s16(dx));
+            lo = vmlal_s16(lo, vget_low_s16(dy), vget_low_s16(dy));
+            hi = vmlal_s16(hi, vget_high_s16(dy), vget_high_s16(dy));
+            vst1q_u32(sgm + cc, vreinterpretq_u32_s32(lo));
+            vst1q_u32(sgm + cc + 4, vreinterpretq_u32_s32(hi));
+        }
+    }
+#endif
+    for ( ; cc < width; cc++)
+    {
+        int dx = row1[cc + 1] - row0[cc];   /* southeast - northwest */
+        int dy = row1[cc] - row0[cc + 1];   /* southwest - northeast */
+        sgm[cc] = (dx * dx) + (dy * dy);
+    }
+}
+
+void
+thresholdRow(unsigned char *dst, const unsigned int *src, int width,
+        unsigned int threshold)
+{
+    if (threshold == 0)
+    {
+        memset(dst, UCHAR_MAX, width);
+        return;
+    }
+
+    int cc = 0;
+#ifdef Q_PROCESSOR_X86_64
+    /* Unsigned src >= threshold, as a signed compare with the sign flipped. */
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    const __m128i limit = _mm_xor_si128(
+            _mm_set1_epi32(static_cast<int>(threshold - 1)), bias);
+    for ( ; cc + 16 <= width; cc += 16)
+    {
+        const auto *in = reinterpret_cast<const __m128i*>(src + cc);
+        __m128i q0 = _mm_cmpgt_epi32(_mm_xor_si128(_mm_loadu_si128(in), bias), limit);
+        __m128i q1 = _mm_cmpgt_epi32(_mm_xor_si128(_mm_loadu_si128(in + 1), bias), limit);
+        __m128i q2 = _mm_cmpgt_epi32(_mm_xor_si128(_mm_loadu_si128(in + 2), bias), limit);
+        __m128i q3 = _mm_cmpgt_epi32(_mm_xor_si128(_mm_loadu_si128(in + 3), bias), limit);
+        __m128i out = _mm_packs_epi16(_mm_packs_epi32(q0, q1),
+                                      _mm_packs_epi32(q2, q3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + cc), out);
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        const uint32x4_t limit = vdupq_n_u32(threshold);
+        for ( ; cc + 8 <= width; cc += 8)
+        {
+            uint16x4_t lo = vmovn_u32(vcgeq_u32(vld1q_u32(src + cc), limit));
+            uint16x4_t hi = vmovn_u32(vcgeq_u32(vld1q_u32(src + cc + 4), limit));
+            vst1_u8(dst + cc, vmovn_u16(vcombine_u16(lo, hi)));
+        }
+    }
+#endif
+    for ( ; cc < width; cc++)
+        dst[cc] = src[cc] >= threshold ? UCHAR_MAX : 0;
+}
+
+int
+countNonZero(const unsigned char *buf, int len)
+{
+    int ii = 0;
+    int count = 0;
+#ifdef Q_PROCESSOR_X86_64
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i zeros = zero;
+    for ( ; ii + 16 <= len; ii += 16)
+    {
+        __m128i isz = _mm_cmpeq_epi8(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(buf + ii)), zero);
+        zeros = _mm_add_epi64(zeros, _mm_sad_epu8(_mm_and_si128(isz, one), zero));
+    }
+    count = ii - _mm_cvtsi128_si32(zeros) -
+        _mm_cvtsi128_si32(_mm_unpackhi_epi64(zeros, zeros));
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        const uint8x16_t one = vdupq_n_u8(1);
+        uint32x4_t acc = vdupq_n_u32(0);
+        for ( ; ii + 16 <= len; ii += 16)
+        {
+            uint8x16_t pix = vld1q_u8(buf + ii);
+            acc = vpadalq_u16(acc, vpaddlq_u8(vandq_u8(vtstq_u8(pix, pix), one)));
+        }
+        count = vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) +
+            vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+    }
+#endif
+    for ( ; ii < len; ii++)
+    {
+        if (buf[ii])
+            count++;
+    }
+    return count;
+}
+
+int
+countBothNonZero(const unsigned char *aa, const unsigned char *bb, int len)
+{
+    int ii = 0;
+    int count = 0;
+#ifdef Q_PROCESSOR_X86_64
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i zeros = zero;
+    for ( ; ii + 16 <= len; ii += 16)
+    {
+        __m128i isz = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(aa + ii)), zero),
+            _mm_cmpeq_epi8(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(bb + ii)), zero));
+        zeros = _mm_add_epi64(zeros, _mm_sad_epu8(_mm_and_si128(isz, one), zero));
+    }
+    count = ii - _mm_cvtsi128_si32(zeros) -
+        _mm_cvtsi128_si32(_mm_unpackhi_epi64(zeros, zeros));
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        const uint8x16_t one = vdupq_n_u8(1);
+        uint32x4_t acc = vdupq_n_u32(0);
+        for ( ; ii + 16 <= len; ii += 16)
+        {
+            uint8x16_t pa = vld1q_u8(aa + ii);
+            uint8x16_t pb = vld1q_u8(bb + ii);
+            uint8x16_t both = vandq_u8(vtstq_u8(pa, pa), vtstq_u8(pb, pb));
+            acc = vpadalq_u16(acc, vpaddlq_u8(vandq_u8(both, one)));
+        }
+        count = vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) +
+            vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+    }
+#endif
+    for ( ; ii < len; ii++)
+    {
+        if (aa[ii] && bb[ii])
+            count++;
+    }
+    return count;
+}
+
+};  /* namespace */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
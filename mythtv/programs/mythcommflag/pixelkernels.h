@@ -0,0 +1,86 @@
+/*
+ * pixelkernels.h
+ *
+ * Inner loops of the frame analyzers, with SSE2 and NEON versions where
+ * the platform has them. Every kernel produces exactly the same result as
+ * the plain C version.
+ */
+
+#ifndef PIXELKERNELS_H
+#define PIXELKERNELS_H
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+namespace pixelKernels {
+
+/* Are the vector versions of the kernels in use? */
+bool haveSIMD(void);
+
+/*
+ * Lane masks for sampling every "step"th pixel of a row. The pattern
+ * repeats every "period" 16-byte blocks. Build once per step and keep it
+ * with the other per-detector scratch space.
+ */
+struct SampleMask
+{
+    int     step    {0};
+    int     period  {0};
+    std::array<std::array<uint8_t,16>,16> lanes {};
+};
+
+void initSampleMask(SampleMask *mask, int step);
+
+/* Running statistics over sampled pixels. */
+struct SampleStats
+{
+    unsigned int        count   {0};
+    unsigned char       min     {UCHAR_MAX};
+    unsigned char       max     {0};
+    unsigned long long  sum     {0};
+};
+
+/*
+ * Sample row[x] for x = x0, x0 + step, ... < x1. Folds the samples into
+ * "stats", raises colmax[x] to each sample and returns the largest sample
+ * (0 if there are none).
+ */
+unsigned char sampleRow(const unsigned char *row, int x0, int x1,
+        const SampleMask &mask, unsigned char *colmax, SampleStats *stats);
+
+/*
+ * One-dimensional convolution of "width" pixels with a (2 * radius + 1) tap
+ * mask, rounded like lround(). "src" points at the centre tap of the first
+ * pixel; the column version steps between taps by "stride" bytes.
+ */
+void convolveColumn(unsigned char *dst, const unsigned char *src,
+        ptrdiff_t stride, int width, const double *mask, int radius);
+void convolveRow(unsigned char *dst, const unsigned char *src, int width,
+        const double *mask, int radius);
+
+/*
+ * Squared gradient magnitude on 45-degree rotated axes:
+ * sgm[cc] = (row1[cc + 1] - row0[cc])^2 + (row1[cc] - row0[cc + 1])^2.
+ * Reads width + 1 pixels of each row.
+ */
+void squaredGradientRow(unsigned int *sgm, const unsigned char *row0,
+        const unsigned char *row1, int width);
+
+/* dst[cc] = UCHAR_MAX where src[cc] >= threshold, 0 elsewhere. */
+void thresholdRow(unsigned char *dst, const unsigned int *src, int width,
+        unsigned int threshold);
+
+/* Number of non-zero bytes. */
+int countNonZero(const unsigned char *buf, int len);
+
+/* Number of positions where both buffers are non-zero. */
+int countBothNonZero(const unsigned char *aa, const unsigned char *bb,
+        int len);
+
+};  /* namespace */
+
+#endif  /* !PIXELKERNELS_H */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -298,6 +298,42 @@ static GlobalCheckBoxSetting *CommFlagFast()
     return gc;
 }
 
+static GlobalSpinBoxSetting *CommFlagThreads()
+{
+    auto *gs = new GlobalSpinBoxSetting("CommFlagThreads", 0, 64, 1);
+
+    gs->setLabel(GeneralSettings::tr("Commercial detection threads"));
+
+    gs->setValue(0);
+
+    gs->setHelpText(GeneralSettings::tr("Number of threads used to analyze "
+                                        "the frames of a finished recording "
+                                        "while looking for commercials. 0 "
+                                        "uses one thread per CPU core, 1 "
+                                        "analyzes each frame as it is "
+                                        "decoded."));
+    return gs;
+}
+
+static GlobalCheckBoxSetting *CommFlagChunked()
+{
+    auto *gc = new GlobalCheckBoxSetting("CommFlagChunked");
+
+    gc->setLabel(GeneralSettings::tr("Decode finished recordings in parallel "
+                                     "for commercial detection"));
+
+    gc->setValue(false);
+
+    gc->setHelpText(GeneralSettings::tr("If enabled, a finished recording is "
+                                        "split into as many parts as there "
+                                        "are commercial detection threads, "
+                                        "and the parts are decoded at the "
+                                        "same time. This is much faster on "
+                                        "machines with many cores, but uses "
+                                        "more memory."));
+    return gc;
+}
+
 static HostComboBoxSetting *AutoCommercialSkip()
 {
     auto *gc = new HostComboBoxSetting("AutoCommercialSkip");
@@ -3028,6 +3064,25 @@ static GlobalComboBoxSetting *GRSchedOpenEnd()
     return bc;
 }
 
+static GlobalCheckBoxSetting *GRSchedIncremental()
+{
+    auto *bc = new GlobalCheckBoxSetting("SchedIncremental");
+
+    bc->setLabel(GeneralRecPrioritiesSettings::tr("Incremental scheduling"));
+
+    bc->setHelpText(
+        GeneralRecPrioritiesSettings::tr("If enabled, a reschedule only "
+                                         "places again the showings that "
+                                         "the changed rules or guide data "
+                                         "can affect. A full reschedule is "
+                                         "still done at least once an "
+                                         "hour."));
+
+    bc->setValue(false);
+
+    return bc;
+}
+
 static GlobalSpinBoxSetting *GRPrefInputRecPriority()
 {
     auto *bs = new GlobalSpinBoxSetting("PrefInputPriority", 1, 99, 1);
@@ -4578,6 +4633,8 @@ GeneralSettings::GeneralSettings()
 
     jobs->addChild(CommercialSkipMethod());
     jobs->addChild(CommFlagFast());
+    jobs->addChild(CommFlagThreads());
+    jobs->addChild(CommFlagChunked());
     jobs->addChild(AggressiveCommDetect());
     jobs->addChild(DeferAutoTranscodeDays());
 
@@ -4621,6 +4678,7 @@ GeneralRecPrioritiesSettings::GeneralRecPrioritiesSettings()
     sched->setLabel(tr("Scheduler Options"));
 
     sched->addChild(GRSchedOpenEnd());
+    sched->addChild(GRSchedIncremental());
     sched->addChild(GRPrefInputRecPriority());
     sched->addChild(GRHDTVRecPriority());
     sched->addChild(GRWSRecPriority());
@@ -1,3 +1,4 @@
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <unistd.h>
@@ -6,6 +7,49 @@
 #include "ts.h"
 #include "libmythbase/mythlogging.h"
 
+#define OUT_BUFFER_SIZE (4*1024*1024)
+
+static void flush_output(multiplex_t *mx, const uint8_t *data, size_t length)
+{
+	while (length > 0) {
+		ssize_t written = write(mx->fd_out, data, length);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0) {
+			mx->error++;
+			if (mx->error <= 0) mx->error = 1; // avoid int rollover to zero
+			if (mx->error < 10) { // mythtv#244: log only first few failures
+				LOG(VB_GENERAL, LOG_ERR,
+				    QString("%1 writes failed: %2")
+				    .arg(mx->error).arg(strerror(errno)));
+			}
+			return;
+		}
+		data += written;
+		length -= written;
+	}
+}
+
+/* Packs are only a few KB, so they are collected in mx->obuf and
+   written out in blocks of OUT_BUFFER_SIZE */
+static void write_output(multiplex_t *mx, const uint8_t *data, size_t length)
+{
+	if (!mx->obuf) {
+		flush_output(mx, data, length);
+		return;
+	}
+	if (mx->olen + length > OUT_BUFFER_SIZE) {
+		flush_output(mx, mx->obuf, mx->olen);
+		mx->olen = 0;
+	}
+	if (length > OUT_BUFFER_SIZE) {
+		flush_output(mx, data, length);
+		return;
+	}
+	memcpy(mx->obuf + mx->olen, data, length);
+	mx->olen += length;
+}
+
 static int buffers_filled(multiplex_t *mx)
 {
 	int aavail=0;
@@ -202,12 +246,12 @@ static void writeout_video(multiplex_t *mx)
 	    viu->frame == I_FRAME){
 		if (!mx->startup && mx->is_ts){
 			write_ts_patpmt(mx->ext.data(), mx->extcnt, 1, outbuf.data());
-			write(mx->fd_out, outbuf.data(), static_cast<size_t>(mx->pack_size)*2);
+			write_output(mx, outbuf.data(), static_cast<size_t>(mx->pack_size)*2);
 			ptsinc(&mx->SCR, mx->SCRinc*2);
 		} else if (!mx->startup && mx->navpack){
 			write_nav_pack(mx->pack_size, mx->extcnt, 
 				       mx->SCR, mx->muxr, outbuf.data());
-			write(mx->fd_out, outbuf.data(), mx->pack_size);
+			write_output(mx, outbuf.data(), mx->pack_size);
 			ptsinc(&mx->SCR, mx->SCRinc);
 		} else mx->startup = 0;
 #ifdef OUT_DEBUG
@@ -298,15 +342,7 @@ static void writeout_video(multiplex_t *mx)
 	//estimate next pts based on bitrate of this stream and data written
 	viu->dts = uptsdiff(viu->dts + ((nlength*viu->ptsrate)>>8), 0);
 
-	if (write(mx->fd_out, outbuf.data(), written) != written) {
-	  mx->error++;
-	  if (mx->error <= 0) mx->error = 1; // avoid int rollover to zero
-	  if (mx->error < 10) { // mythtv#244: log only first few failures
-	    LOG(VB_GENERAL, LOG_ERR,
-		QString("%1 writes failed: %2")
-		.arg(mx->error).arg(strerror(errno)));
-          }
-	}
+	write_output(mx, outbuf.data(), written);
 
 #ifdef OUT_DEBUG
 	LOG(VB_GENERAL, LOG_DEBUG, "VPTS");
@@ -450,7 +486,7 @@ static void writeout_ext(multiplex_t *mx, int n)
 		return;
 
 	length -= nlength;
-	write(mx->fd_out, outbuf.data(), written);
+	write_output(mx, outbuf.data(), written);
 
 	dummy_add(dbuf, dpts, aiu->length-length);
 	aiu->length = length;
@@ -487,7 +523,7 @@ static void writeout_padding (multiplex_t *mx)
 
 	write_padding_pes( mx->pack_size, mx->extcnt, mx->SCR, 
 			   mx->muxr, outbuf.data());
-	write(mx->fd_out, outbuf.data(), mx->pack_size);
+	write_output(mx, outbuf.data(), mx->pack_size);
 }
 
 void check_times( multiplex_t *mx, int *video_ok, aok_arr &ext_ok, int *start)
@@ -649,7 +685,14 @@ int finish_mpg(multiplex_t *mx)
 	}
 	
 	if (mx->otype == REPLEX_MPEG2)
-		write(mx->fd_out, mpeg_end.data(), 4);
+		write_output(mx, mpeg_end.data(), 4);
+
+	if (mx->obuf) {
+		flush_output(mx, mx->obuf, mx->olen);
+		free(mx->obuf);
+		mx->obuf = nullptr;
+		mx->olen = 0;
+	}
 
 	if (close(mx->fd_out) < 0) {
 	  mx->error++;	    // mythtv#244: close could fail on full disk
@@ -710,6 +753,9 @@ void init_multiplex( multiplex_t *mx, sequence_t *seq_head,
 	mx->audio_delay = audio_delay;
 	mx->fd_out = fd;
 	mx->otype = otype;
+	// page aligned, so the kernel can copy whole pages from it
+	mx->obuf = static_cast<uint8_t *>(aligned_alloc(4096, OUT_BUFFER_SIZE));
+	mx->olen = 0;
 
 	switch(mx->otype){
 
@@ -875,14 +921,14 @@ void setup_multiplex(multiplex_t *mx)
 	if (mx->is_ts) {
 		std::array<uint8_t,2048> outbuf {};
 		write_ts_patpmt(mx->ext.data(), mx->extcnt, 1, outbuf.data());
-		write(mx->fd_out, outbuf.data(), static_cast<size_t>(mx->pack_size)*2);
+		write_output(mx, outbuf.data(), static_cast<size_t>(mx->pack_size)*2);
 		ptsinc(&mx->SCR, mx->SCRinc*2);
 		mx->startup = 1;
 	} else if (mx->navpack){
 		std::array<uint8_t,2048> outbuf {};
 		write_nav_pack(mx->pack_size, mx->extcnt, 
 			       mx->SCR, mx->muxr, outbuf.data());
-		write(mx->fd_out, outbuf.data(), mx->pack_size);
+		write_output(mx, outbuf.data(), mx->pack_size);
 		ptsinc(&mx->SCR, mx->SCRinc);
 		mx->startup = 1;
 	} else mx->startup = 0;
@@ -87,6 +87,10 @@ struct multiplex_t {
 	int (*fill_buffers)(void *p, int f);
 	void *priv;
 	int error; /* mythtv#244: added to catch full disk write failures */
+
+	/* packs are collected here and written out in large blocks */
+	uint8_t *obuf;
+	size_t olen;
 };
 
 void check_times( multiplex_t *mx, int *video_ok, aok_arr &ext_ok, int *start);
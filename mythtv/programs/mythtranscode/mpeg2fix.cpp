@@ -307,6 +307,7 @@ MPEG2fixup::MPEG2fixup(const QString &inf, const QString &outf,
 
 MPEG2fixup::~MPEG2fixup()
 {
+    delete m_reader;
     mpeg2_close(m_headerDecoder);
     mpeg2_close(m_imgDecoder);
 
@@ -586,6 +587,186 @@ void MPEG2replex::Start()
     }
 }
 
+MPEG2reader::~MPEG2reader()
+{
+    if (m_running)
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_stop = true;
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+        pthread_join(m_thread, nullptr);
+        pthread_cond_destroy(&m_cond);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    for (const auto & item : qAsConst(m_queue))
+        delete item.m_frame;
+    while (!m_spare.isEmpty())
+        delete m_spare.dequeue();
+    delete m_current;
+
+    if (m_decoder)
+        mpeg2_close(m_decoder);
+}
+
+void MPEG2reader::Start(AVFormatContext *inputFC, int vidId,
+                        const QList<int> &audioIds)
+{
+    m_inputFC = inputFC;
+    m_vidId = vidId;
+    m_audioIds = audioIds;
+    m_decoder = mpeg2_init();
+
+    pthread_mutex_init(&m_mutex, nullptr);
+    pthread_cond_init(&m_cond, nullptr);
+    m_running = (pthread_create(&m_thread, nullptr, ReadStart, this) == 0);
+    if (!m_running)
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            "Failed to start the reader thread, reading inline");
+        pthread_cond_destroy(&m_cond);
+        pthread_mutex_destroy(&m_mutex);
+    }
+}
+
+void *MPEG2reader::ReadStart(void *data)
+{
+    MThread::ThreadSetup("MPEG2Reader");
+    auto *reader = static_cast<MPEG2reader *>(data);
+    if (reader)
+        reader->Run();
+    MThread::ThreadCleanup();
+    return nullptr;
+}
+
+void MPEG2reader::Run()
+{
+    while (true)
+    {
+        pthread_mutex_lock(&m_mutex);
+        while (!m_stop &&
+               (m_bytes >= kMaxBytes || m_queue.size() >= kMaxFrames))
+        {
+            pthread_cond_wait(&m_cond, &m_mutex);
+        }
+        MPEG2frame *frame = m_spare.isEmpty() ? nullptr : m_spare.dequeue();
+        bool stop = m_stop;
+        pthread_mutex_unlock(&m_mutex);
+
+        if (stop)
+        {
+            delete frame;
+            return;
+        }
+
+        if (!frame)
+        {
+            frame = new MPEG2frame(0);
+            av_packet_unref(frame->m_pkt);
+        }
+
+        int ret = 0;
+        bool wanted = false;
+        while (!wanted)
+        {
+            frame->m_pkt->pts = AV_NOPTS_VALUE;
+            frame->m_pkt->dts = AV_NOPTS_VALUE;
+            ret = av_read_frame(m_inputFC, frame->m_pkt);
+            if (ret == -EAGAIN)
+                continue;
+            if (ret < 0)
+                break;
+            wanted = (frame->m_pkt->stream_index == m_vidId) ||
+                     m_audioIds.contains(frame->m_pkt->stream_index);
+            if (!wanted)
+                av_packet_unref(frame->m_pkt);
+        }
+
+        int info = 0;
+        if (wanted && frame->m_pkt->stream_index == m_vidId)
+        {
+            info = m_fixup->ProcessVideo(frame, m_decoder);
+        }
+        else if (wanted)
+        {
+            info = ParserDuration(frame->m_pkt->stream_index);
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        if (wanted)
+        {
+            m_queue.enqueue({frame, info});
+            m_bytes += frame->m_pkt->size;
+        }
+        else
+        {
+            m_spare.enqueue(frame);
+            m_result = ret;
+        }
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+
+        if (!wanted)
+            return;
+    }
+}
+
+/// Frame duration the parser found in the last packet of stream \a id
+int MPEG2reader::ParserDuration(int id) const
+{
+    const AVCodecParserContext *parser =
+        av_stream_get_parser(m_inputFC->streams[id]);
+    return parser ? parser->duration : 0;
+}
+
+/** \brief Returns the next packet the way av_read_frame() would
+ *
+ *   For video \a headers is set to a frame holding the parsed headers,
+ *   which stays valid until the next call, and \a info to the result
+ *   of ProcessVideo(). For audio \a info is the frame duration the
+ *   parser had found for this packet.
+ */
+int MPEG2reader::Read(AVPacket *pkt, MPEG2frame *&headers, int &info)
+{
+    headers = nullptr;
+    info = 0;
+    if (!m_running)
+    {
+        int ret = av_read_frame(m_inputFC, pkt);
+        if (ret >= 0 && pkt->stream_index != m_vidId)
+            info = ParserDuration(pkt->stream_index);
+        return ret;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_current)
+    {
+        av_packet_unref(m_current->m_pkt);
+        m_spare.enqueue(m_current);
+        m_current = nullptr;
+    }
+    while (m_queue.isEmpty() && !m_result)
+        pthread_cond_wait(&m_cond, &m_mutex);
+    if (m_queue.isEmpty())
+    {
+        int result = m_result;
+        pthread_mutex_unlock(&m_mutex);
+        return result;
+    }
+    Item item = m_queue.dequeue();
+    m_bytes -= item.m_frame->m_pkt->size;
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+
+    m_current = item.m_frame;
+    av_packet_ref(pkt, m_current->m_pkt);
+    if (pkt->stream_index == m_vidId)
+        headers = m_current;
+    info = item.m_info;
+    return 0;
+}
+
 #define INDEX_BUF (sizeof(index_unit) * 200)
 void MPEG2fixup::InitReplex()
 {
@@ -621,14 +802,14 @@ void MPEG2fixup::InitReplex()
         if (it.key() < 0)
             continue;   // will never happen in practice
         uint index = it.key();
-        if (index > m_inputFC->nb_streams)
+        if (index >= static_cast<uint>(m_streams.size()))
             continue;   // will never happen in practice
         AVCodecContext  *avctx = getCodecContext(index);
         if (avctx == nullptr)
             continue;
         int i = m_audMap[index];
         AVDictionaryEntry *metatag =
-            av_dict_get(m_inputFC->streams[index]->metadata,
+            av_dict_get(m_streams[index]->metadata,
                         "language", nullptr, 0);
         char *lang = metatag ? metatag->value : (char *)"";
         ring_init(&m_rx.m_extrbuf[i], memsize / 5);
@@ -795,6 +976,9 @@ bool MPEG2fixup::InitAV(const QString& inputfile, const char *type, int64_t offs
     // Open recording
     LOG(VB_GENERAL, LOG_INFO, QString("Opening %1").arg(inputfile));
 
+    delete m_reader;
+    m_reader = nullptr;
+
     if (m_inputFC)
     {
         avformat_close_input(&m_inputFC);
@@ -847,6 +1031,11 @@ bool MPEG2fixup::InitAV(const QString& inputfile, const char *type, int64_t offs
     if (VERBOSE_LEVEL_CHECK(VB_GENERAL, LOG_INFO))
         av_dump_format(m_inputFC, 0, ifname, 0);
 
+    // The reader thread may add streams to m_inputFC while demuxing
+    m_streams.clear();
+    for (unsigned int i = 0; i < m_inputFC->nb_streams; i++)
+        m_streams.append(m_inputFC->streams[i]);
+
     for (unsigned int i = 0; i < m_inputFC->nb_streams; i++)
     {
         switch (m_inputFC->streams[i]->codecpar->codec_type)
@@ -922,7 +1111,7 @@ int MPEG2fixup::ProcessVideo(MPEG2frame *vf, mpeg2dec_t *dec)
     int state = -1;
     int last_pos = 0;
 
-    if (dec == m_headerDecoder)
+    if (dec != m_imgDecoder)
     {
         mpeg2_reset(dec, 0);
         vf->m_isSequence = false;
@@ -937,7 +1126,7 @@ int MPEG2fixup::ProcessVideo(MPEG2frame *vf, mpeg2dec_t *dec)
     {
         state = mpeg2_parse(dec);
 
-        if (dec == m_headerDecoder)
+        if (dec != m_imgDecoder)
         {
             switch (state)
             {
@@ -980,7 +1169,7 @@ int MPEG2fixup::ProcessVideo(MPEG2frame *vf, mpeg2dec_t *dec)
         last_pos = (vf->m_pkt->size - mpeg2_getpos(dec)) - 4;
     }
 
-    if (dec != m_headerDecoder)
+    if (dec == m_imgDecoder)
     {
         while (state != STATE_BUFFER)
             state = mpeg2_parse(dec);
@@ -1376,14 +1565,31 @@ MPEG2frame *MPEG2fixup::GetPoolFrame(MPEG2frame *f)
     if (!tmpFrame)
         return tmpFrame;
 
-    tmpFrame->m_isSequence = f->m_isSequence;
-    tmpFrame->m_isGop      = f->m_isGop;
-    tmpFrame->m_mpeg2_seq  = f->m_mpeg2_seq;
-    tmpFrame->m_mpeg2_gop  = f->m_mpeg2_gop;
-    tmpFrame->m_mpeg2_pic  = f->m_mpeg2_pic;
+    CopyHeaders(tmpFrame, f);
     return tmpFrame;
 }
 
+/// Copies the parsed headers of \a src to \a dst, which holds the same data
+void MPEG2fixup::CopyHeaders(MPEG2frame *dst, const MPEG2frame *src)
+{
+    auto rebase = [dst, src](uint8_t *pos, uint8_t *old) -> uint8_t *
+    {
+        const uint8_t *data = src->m_pkt->data;
+        if (!pos || !data || pos < data || pos >= data + src->m_pkt->size ||
+            dst->m_pkt->size != src->m_pkt->size)
+            return old;
+        return dst->m_pkt->data + (pos - data);
+    };
+
+    dst->m_isSequence = src->m_isSequence;
+    dst->m_isGop      = src->m_isGop;
+    dst->m_mpeg2_seq  = src->m_mpeg2_seq;
+    dst->m_mpeg2_gop  = src->m_mpeg2_gop;
+    dst->m_mpeg2_pic  = src->m_mpeg2_pic;
+    dst->m_framePos   = rebase(src->m_framePos, dst->m_framePos);
+    dst->m_gopPos     = rebase(src->m_gopPos, dst->m_gopPos);
+}
+
 int MPEG2fixup::GetFrame(AVPacket *pkt)
 {
     while (true)
@@ -1397,11 +1603,14 @@ int MPEG2fixup::GetFrame(AVPacket *pkt)
             return static_cast<int>(m_fileEnd);
         }
 
+        MPEG2frame *headers = nullptr;
+        int info = 0;
         while (!done)
         {
             pkt->pts = AV_NOPTS_VALUE;
             pkt->dts = AV_NOPTS_VALUE;
-            int ret = av_read_frame(m_inputFC, pkt);
+            int ret = m_reader ? m_reader->Read(pkt, headers, info)
+                               : av_read_frame(m_inputFC, pkt);
 
             if (ret < 0)
             {
@@ -1468,14 +1677,23 @@ int MPEG2fixup::GetFrame(AVPacket *pkt)
             return 1;
         }
 
-        switch (m_inputFC->streams[pkt->stream_index]->codecpar->codec_type)
+        switch (m_streams[pkt->stream_index]->codecpar->codec_type)
         {
             case AVMEDIA_TYPE_VIDEO:
                 m_vFrame.append(tmpFrame);
                 av_packet_unref(pkt);
 
-                if (!ProcessVideo(m_vFrame.last(), m_headerDecoder))
+                // The reader thread has already parsed the headers
+                if (headers)
+                {
+                    CopyHeaders(tmpFrame, headers);
+                    if (!info)
+                        return 0;
+                }
+                else if (!ProcessVideo(m_vFrame.last(), m_headerDecoder))
+                {
                     return 0;
+                }
                 m_framePool.enqueue(m_vFrame.takeLast());
                 break;
 
@@ -1483,6 +1701,8 @@ int MPEG2fixup::GetFrame(AVPacket *pkt)
                 if (m_aFrame.contains(pkt->stream_index))
                 {
                     m_aFrame[pkt->stream_index]->append(tmpFrame);
+                    if (m_reader)
+                        m_aDuration[pkt->stream_index] = info;
                 }
                 else
                 {
@@ -2112,6 +2332,9 @@ int MPEG2fixup::Start()
         return GENERIC_EXIT_NOT_OK;
     }
 
+    m_reader = new MPEG2reader(this);
+    m_reader->Start(m_inputFC, m_vidId, m_aFrame.keys());
+
     if (!FindStart())
     {
         av_packet_free(&pkt);
@@ -2573,6 +2796,11 @@ int MPEG2fixup::Start()
             AVCodecParserContext *CPC = getCodecParserContext(it.key());
             bool backwardsPTS = false;
 
+            // The reader thread keeps the parser ahead of these frames
+            int duration = 0;
+            if (CPC)
+                duration = m_reader ? m_aDuration.value(it.key()) : CPC->duration;
+
             while (!af->isEmpty())
             {
                 if (!CC || !CPC)
@@ -2582,7 +2810,7 @@ int MPEG2fixup::Start()
                 }
                 // What to do if the CC is corrupt?
                 // Just wait and hope it repairs itself
-                if (CC->sample_rate == 0 || !CPC || CPC->duration == 0)
+                if (CC->sample_rate == 0 || !CPC || duration == 0)
                     break;
 
                 // The order of processing frames is critical to making
@@ -2597,7 +2825,7 @@ int MPEG2fixup::Start()
                 //   if we get this far, update the expected PTS, and write out
                 //     the audio frame
                 int64_t incPTS =
-                         90000LL * (int64_t)CPC->duration / CC->sample_rate;
+                         90000LL * (int64_t)duration / CC->sample_rate;
 
                 if (poq.UpdateOrigPTS(it.key(), origaPTS[it.key()],
                                                   af->first()->m_pkt) < 0)
@@ -2666,7 +2894,7 @@ int MPEG2fixup::Start()
                 }
 
                 int64_t nextPTS = add2x33(af->first()->m_pkt->pts,
-                           90000LL * (int64_t)CPC->duration / CC->sample_rate);
+                           90000LL * (int64_t)duration / CC->sample_rate);
 
                 if ((cutState[it.key()] == 1 &&
                      cmp2x33(nextPTS, cutStartPTS) > 0) ||
@@ -2739,6 +2967,9 @@ int MPEG2fixup::Start()
       ex = REENCODE_ERROR;
     }
 
+    delete m_reader;
+    m_reader = nullptr;
+
     av_packet_free(&pkt);
     av_packet_free(&lastRealvPkt);
     avformat_close_input(&m_inputFC);
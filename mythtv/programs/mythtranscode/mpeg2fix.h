@@ -119,6 +119,51 @@ using FrameList  = QList<MPEG2frame *>;
 using FrameQueue = QQueue<MPEG2frame *>;
 using FrameMap   = QMap<int, FrameList *>;
 
+class MPEG2fixup;
+
+/** Demuxes the input and parses the video headers on a thread of its own,
+ *  up to kMaxBytes ahead of MPEG2fixup::GetFrame().
+ */
+class MPEG2reader
+{
+  public:
+    explicit MPEG2reader(MPEG2fixup *fixup) : m_fixup(fixup) {}
+    ~MPEG2reader();
+    void Start(AVFormatContext *inputFC, int vidId, const QList<int> &audioIds);
+    int Read(AVPacket *pkt, MPEG2frame *&headers, int &info);
+
+  private:
+    struct Item
+    {
+        MPEG2frame *m_frame {nullptr};
+        int         m_info  {0};
+    };
+
+    static void *ReadStart(void *data);
+    void Run();
+    int ParserDuration(int id) const;
+
+    static constexpr size_t kMaxBytes  { 32LL * 1024 * 1024 };
+    static constexpr int    kMaxFrames { 4096 };
+
+    MPEG2fixup      *m_fixup      {nullptr};
+    AVFormatContext *m_inputFC    {nullptr};
+    int              m_vidId      {-1};
+    QList<int>       m_audioIds;
+    mpeg2dec_t      *m_decoder    {nullptr};
+
+    pthread_t        m_thread     {};
+    bool             m_running    {false};
+    pthread_mutex_t  m_mutex      {};
+    pthread_cond_t   m_cond       {};
+    QQueue<Item>     m_queue;
+    FrameQueue       m_spare;
+    MPEG2frame      *m_current    {nullptr};
+    size_t           m_bytes      {0};
+    int              m_result     {0};
+    bool             m_stop       {false};
+};
+
 class MPEG2fixup
 {
   public:
@@ -145,6 +190,8 @@ class MPEG2fixup
     static void *ReplexStart(void *data);
     MPEG2replex m_rx;
 
+    friend class MPEG2reader;
+
   private:
     static int FindMPEG2Header(const uint8_t *buf, int size, uint8_t code);
     void InitReplex();
@@ -160,6 +207,7 @@ class MPEG2fixup
     bool BuildFrame(AVPacket *pkt, const QString& fname);
     MPEG2frame *GetPoolFrame(AVPacket *pkt);
     MPEG2frame *GetPoolFrame(MPEG2frame *f);
+    static void CopyHeaders(MPEG2frame *dst, const MPEG2frame *src);
     int GetFrame(AVPacket *pkt);
     bool FindStart();
     static void SetRepeat(MPEG2frame *vf, int nb_fields, bool topff);
@@ -197,20 +245,20 @@ class MPEG2fixup
     }
     int GetStreamType(int id) const
     {
-        return (m_inputFC->streams[id]->codecpar->codec_id == AV_CODEC_ID_AC3) ?
+        return (m_streams[id]->codecpar->codec_id == AV_CODEC_ID_AC3) ?
                AV_CODEC_ID_AC3 : AV_CODEC_ID_MP2;
     }
     AVCodecContext *getCodecContext(uint id)
     {
-        if (id >= m_inputFC->nb_streams)
+        if (id >= static_cast<uint>(m_streams.size()))
             return nullptr;
-        return m_codecMap.GetCodecContext(m_inputFC->streams[id]);
+        return m_codecMap.GetCodecContext(m_streams[id]);
     }
     AVCodecParserContext *getCodecParserContext(uint id)
     {
-        if (id >= m_inputFC->nb_streams)
+        if (id >= static_cast<uint>(m_streams.size()))
             return nullptr;
-        return av_stream_get_parser(m_inputFC->streams[id]);
+        return av_stream_get_parser(m_streams[id]);
     }
 
     static void dumpList(FrameList *list);
@@ -223,11 +271,13 @@ class MPEG2fixup
 
     FrameList     m_vFrame;
     FrameMap      m_aFrame;
+    QMap<int, int> m_aDuration;
     FrameQueue    m_framePool;
     FrameQueue    m_unreadFrames;
     int           m_displayFrame    {0};
     mpeg2dec_t   *m_headerDecoder   {nullptr};
     mpeg2dec_t   *m_imgDecoder      {nullptr};
+    MPEG2reader  *m_reader          {nullptr};
 
     frm_dir_map_t m_delMap;
     frm_dir_map_t m_saveMap;
@@ -236,6 +286,7 @@ class MPEG2fixup
 
     MythCodecMap     m_codecMap     {};
     AVFormatContext *m_inputFC      {nullptr};
+    QList<AVStream *> m_streams;
     AVFrame         *m_picture      {nullptr};
 
     int             m_vidId         {-1};
@@ -296,6 +296,42 @@ static GlobalCheckBoxSetting *DeletesFollowLinks()
     return gc;
 };
 
+static GlobalCheckBoxSetting *SeekIndexFiles()
+{
+    auto *gc = new GlobalCheckBoxSetting("SeekIndexFiles");
+    gc->setLabel(QObject::tr("Store seek tables in index files"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, the seek table of new "
+                    "recordings is kept in a compact index file next to "
+                    "the recording instead of in the database. Only enable "
+                    "this if every frontend can reach the recordings "
+                    "through its storage groups. Existing "
+                    "recordings keep using the database unless they are "
+                    "converted with 'mythutil --migrateseekindex'."));
+    return gc;
+};
+
+static GlobalComboBoxSetting *RecordingWriteMode()
+{
+    auto *gc = new GlobalComboBoxSetting("RecordingWriteMode");
+    gc->setLabel(QObject::tr("Recording write mode"));
+    gc->addSelection(QObject::tr("Buffer list"), "0");
+    gc->addSelection(QObject::tr("Ring buffer"), "1");
+    gc->addSelection(QObject::tr("Ring buffer, drop page cache"), "2");
+    gc->addSelection(QObject::tr("Ring buffer, direct I/O"), "3");
+    gc->setValue(0);
+    gc->setHelpText(QObject::tr("This setting controls how recordings are "
+                    "written to disk. 'Buffer list' is the traditional "
+                    "method. The ring buffer modes copy into one "
+                    "preallocated buffer and write it out in large "
+                    "vectored writes, which uses less CPU with many "
+                    "simultaneous recordings. 'Drop page cache' keeps "
+                    "finished recordings from pushing other data out of "
+                    "memory, and 'direct I/O' bypasses the page cache "
+                    "entirely where the filesystem supports it."));
+    return gc;
+};
+
 static GlobalSpinBoxSetting *HDRingbufferSize()
 {
     auto *bs = new GlobalSpinBoxSetting(
@@ -952,6 +988,8 @@ BackendSettings::BackendSettings()
     fm->addChild(MasterBackendOverride());
     fm->addChild(DeletesFollowLinks());
     fm->addChild(TruncateDeletes());
+    fm->addChild(SeekIndexFiles());
+    fm->addChild(RecordingWriteMode());
     fm->addChild(HDRingbufferSize());
     fm->addChild(StorageScheduler());
     group2->addChild(fm);
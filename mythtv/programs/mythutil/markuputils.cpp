@@ -206,6 +206,32 @@ static int ClearSeekTable(const MythUtilCommandLineParser &cmdline)
     return GENERIC_EXIT_OK;
 }
 
+static int MigrateSeekIndex(const MythUtilCommandLineParser &cmdline)
+{
+    ProgramInfo pginfo;
+    if (!GetProgramInfo(cmdline, pginfo))
+        return GENERIC_EXIT_NO_RECORDING_DATA;
+
+    if (pginfo.GetSeekIndexFilename().isEmpty())
+    {
+        LOG(VB_STDIO|VB_FLUSH, LOG_ERR,
+            "Seek index files are not enabled, or the recording "
+            "is not available on this host.\n");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    cout << "Migrating Seek Table\n";
+    LOG(VB_GENERAL, LOG_NOTICE,
+        QString("Migrating Seek Table for Channel ID %1 @ %2 to %3")
+                .arg(pginfo.GetChanID())
+                .arg(pginfo.GetScheduledStartTime().toString(),
+                     pginfo.GetSeekIndexFilename()));
+    if (!pginfo.MigratePositionMapToSeekIndex())
+        return GENERIC_EXIT_NOT_OK;
+
+    return GENERIC_EXIT_OK;
+}
+
 static int ClearBookmarks(const MythUtilCommandLineParser &cmdline)
 {
     ProgramInfo pginfo;
@@ -381,6 +407,7 @@ void registerMarkupUtils(UtilMap &utilMap)
     utilMap["setskiplist"]            = &SetSkipList;
     utilMap["clearskiplist"]          = &ClearSkipList;
     utilMap["clearseektable"]         = &ClearSeekTable;
+    utilMap["migrateseekindex"]       = &MigrateSeekIndex;
     utilMap["clearbookmarks"]         = &ClearBookmarks;
     utilMap["getmarkup"]              = &GetMarkup;
     utilMap["setmarkup"]              = &SetMarkup;
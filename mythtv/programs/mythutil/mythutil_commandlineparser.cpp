@@ -73,6 +73,11 @@ void MythUtilCommandLineParser::LoadArguments(void)
                 "Clear the seek table.", "")
                 ->SetGroup("Recording Markup")
                 ->SetParentOf(ChanidStartimeVideo)
+        << add("--migrateseekindex", "migrateseekindex", false,
+                "Move the seek table from the database into a seek "
+                "index file next to the recording.", "")
+                ->SetGroup("Recording Markup")
+                ->SetParentOf(ChanidStartimeVideo)
         << add("--clearbookmarks", "clearbookmarks", false,
                 "Clear all bookmarks.", "This command will reset the playback "
                 "start to the very beginning of the recording file.")